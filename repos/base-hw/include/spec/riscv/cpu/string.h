@@ -1,5 +1,5 @@
 /*
- * \brief  CPU-specific memcpy
+ * \brief  CPU-specific memcpy and memset
  * \author Sebastian Sumpf
  * \date   2015-06-01
  */
@@ -27,6 +27,18 @@ namespace Genode {
 	 */
 	inline size_t memcpy_cpu(void *, const void *, size_t size) {
 		return size; }
+
+	/**
+	 * Fill memory block
+	 *
+	 * \param dst   destination memory block
+	 * \param i     byte value
+	 * \param size  number of bytes to fill
+	 *
+	 * \return      number of bytes not filled
+	 */
+	inline size_t memset_cpu(void *, int, size_t size) {
+		return size; }
 }
 
 #endif /* _INCLUDE__RISCV__CPU__STRING_H_ */
@@ -19,6 +19,8 @@
 
 #define size_t __SIZE_TYPE__ /* see comment in 'linux_syscalls.h' */
 #include <sys/stat.h>
+#include <sys/ptrace.h>
+#include <sys/user.h>
 #include <fcntl.h>
 #undef size_t
 
@@ -126,6 +128,30 @@ inline int lx_pollpid()
 }
 
 
+/*************************************
+ ** Inspection of component threads **
+ *************************************/
+
+inline long lx_ptrace(int request, int tid, void *addr, void *data)
+{
+	return lx_syscall(SYS_ptrace, request, tid, addr, data);
+}
+
+
+/**
+ * Wait for the next ptrace stop of the specified thread
+ *
+ * \return  TID of the thread, or negative error code
+ */
+inline int lx_wait_for_stop(int tid)
+{
+	enum { WALL = 0x40000000 /* __WALL */ };
+
+	int status = 0;
+	return lx_syscall(SYS_wait4, tid, &status, WALL, 0);
+}
+
+
 /********************************************
  ** Communication over Unix-domain sockets **
  ********************************************/
@@ -77,6 +77,24 @@ namespace Genode {
 			 */
 			Pager_object _pager;
 
+			/*
+			 * State of the thread while paused via 'pause'
+			 */
+			bool         _paused = false;
+			Thread_state _paused_state { };
+
+			/**
+			 * Stop thread via ptrace and obtain its register state
+			 *
+			 * \return  false if the thread could not be stopped
+			 */
+			bool _stop(Thread_state &state);
+
+			/**
+			 * Let stopped thread continue
+			 */
+			void _continue();
+
 		public:
 
 			/**
@@ -94,6 +112,10 @@ namespace Genode {
 
 			/**
 			 * Pause this thread
+			 *
+			 * Pausing and inspecting threads is implemented via ptrace.
+			 * Core is the parent of all Genode processes and is therefore
+			 * permitted to trace their threads.
 			 */
 			void pause();
 
@@ -114,11 +136,7 @@ namespace Genode {
 			void          pager(Pager_object *) { }
 			int           start(void *ip, void *sp) { return 0; }
 
-			Thread_state state()
-			{
-				warning("Not implemented");
-				throw Cpu_thread::State_access_failed();
-			}
+			Thread_state state();
 
 			void state(Thread_state)
 			{
@@ -167,6 +185,16 @@ namespace Genode {
 				_registry()->submit_exception(pid);
 			}
 
+			/**
+			 * Lock serializing the consumption of ptrace stops with the
+			 * polling for terminated processes
+			 *
+			 * Core's main thread polls for any terminated child via 'wait4',
+			 * which would also consume the ptrace stops of the main threads
+			 * of Genode processes.
+			 */
+			static Lock &ptrace_lock();
+
 			/**
 			 * Set CPU quota of the thread to 'quota'
 			 */
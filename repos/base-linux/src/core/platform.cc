@@ -136,6 +136,8 @@ void Platform::wait_for_exit()
 		 * terminated, we iterate until 'pollpid' (wrapper around 'wait4')
 		 * returns -1.
 		 */
+		Lock::Guard guard(Platform_thread::ptrace_lock());
+
 		for (;;) {
 			int const pid = lx_pollpid();
 
@@ -20,6 +20,9 @@
 #include "platform_thread.h"
 #include "server_socket_pair.h"
 
+/* Linux includes */
+#include <core_linux_syscalls.h>
+
 using namespace Genode;
 
 
@@ -86,6 +89,8 @@ Platform_thread::Platform_thread(size_t, const char *name, unsigned,
 
 Platform_thread::~Platform_thread()
 {
+	resume();
+
 	ep_sd_registry()->disassociate(_socket_pair.client_sd);
 
 	if (_socket_pair.client_sd)
@@ -104,15 +109,97 @@ void Platform_thread::cancel_blocking()
 }
 
 
+Lock &Platform_thread::ptrace_lock()
+{
+	static Lock lock;
+	return lock;
+}
+
+
+bool Platform_thread::_stop(Thread_state &state)
+{
+#if defined(__x86_64__) || defined(__i386__)
+
+	Lock::Guard guard(ptrace_lock());
+
+	int const tid = _tid;
+
+	if (lx_ptrace(PTRACE_SEIZE, tid, 0, 0) < 0)
+		return false;
+
+	struct user_regs_struct regs;
+
+	if (lx_ptrace(PTRACE_INTERRUPT, tid, 0, 0) < 0
+	 || lx_wait_for_stop(tid) != tid
+	 || lx_ptrace(PTRACE_GETREGS, tid, 0, &regs) < 0) {
+
+		lx_ptrace(PTRACE_DETACH, tid, 0, 0);
+		return false;
+	}
+
+#if defined(__x86_64__)
+	state.r8  = regs.r8;  state.r9  = regs.r9;  state.r10 = regs.r10;
+	state.r11 = regs.r11; state.r12 = regs.r12; state.r13 = regs.r13;
+	state.r14 = regs.r14; state.r15 = regs.r15; state.rax = regs.rax;
+	state.rbx = regs.rbx; state.rcx = regs.rcx; state.rdx = regs.rdx;
+	state.rdi = regs.rdi; state.rsi = regs.rsi; state.rbp = regs.rbp;
+	state.ip  = regs.rip; state.sp  = regs.rsp; state.eflags = regs.eflags;
+#else
+	state.edi = regs.edi; state.esi = regs.esi; state.ebp = regs.ebp;
+	state.ebx = regs.ebx; state.edx = regs.edx; state.ecx = regs.ecx;
+	state.eax = regs.eax; state.ip  = regs.eip; state.sp  = regs.esp;
+	state.eflags = regs.eflags;
+#endif
+	return true;
+
+#else
+
+	/* register layout not supported */
+	return false;
+#endif
+}
+
+
+void Platform_thread::_continue()
+{
+	lx_ptrace(PTRACE_DETACH, _tid, 0, 0);
+}
+
+
 void Platform_thread::pause()
 {
-	warning(__func__, "not implemented");
+	if (_paused)
+		return;
+
+	_paused = _stop(_paused_state);
+
+	if (!_paused)
+		warning("could not pause thread ", Cstring(_name));
 }
 
 
 void Platform_thread::resume()
 {
-	warning(__func__, "not implemented");
+	if (!_paused)
+		return;
+
+	_continue();
+	_paused = false;
+}
+
+
+Thread_state Platform_thread::state()
+{
+	if (_paused)
+		return _paused_state;
+
+	/* take a snapshot of the running thread */
+	Thread_state state;
+	if (!_stop(state))
+		throw Cpu_thread::State_access_failed();
+
+	_continue();
+	return state;
 }
 
 
@@ -55,12 +55,18 @@ class Genode::Allocator_avl_base : public Range_allocator
 		{
 			private:
 
+				friend class Allocator_avl_base;
+
 				addr_t _addr;       /* base address    */
 				size_t _size;       /* size of block   */
 				bool   _used;       /* block is in use */
 				short  _id;         /* for debugging   */
 				size_t _max_avail;  /* biggest free block size of subtree */
 
+				/* neighbours within the size-class list of free blocks */
+				Block *_bin_prev = nullptr;
+				Block *_bin_next = nullptr;
+
 				/**
 				 * Request max_avail value of subtree
 				 */
@@ -155,9 +161,30 @@ class Genode::Allocator_avl_base : public Range_allocator
 
 	private:
 
-		Avl_tree<Block>  _addr_tree;      /* blocks sorted by base address */
-		Allocator       *_md_alloc;       /* meta-data allocator           */
-		size_t           _md_entry_size;  /* size of block meta-data entry */
+		/*
+		 * Free blocks are additionally indexed by their size. Each bin
+		 * holds the free blocks of sizes within [2^i, 2^(i+1)).
+		 */
+		enum { NUM_BINS = 8*sizeof(size_t) };
+
+		Avl_tree<Block>  _addr_tree;         /* blocks sorted by base address */
+		Block           *_bins[NUM_BINS] { };/* free blocks by size class     */
+		Allocator       *_md_alloc;          /* meta-data allocator           */
+		size_t           _md_entry_size;     /* size of block meta-data entry */
+
+		static unsigned _bin(size_t size) { return log2(max(size, (size_t)1)); }
+
+		void _bin_insert(Block *b);
+		void _bin_remove(Block *b);
+
+		/**
+		 * Find best-fitting free block via the size index
+		 *
+		 * All blocks of a bin are smaller than the blocks of the next
+		 * bin. Hence, the best fit is found in the first bin that contains
+		 * a fitting block.
+		 */
+		Block *_find_best_fit_by_size(size_t size, unsigned align);
 
 		/**
 		 * Alloc meta-data block
@@ -58,11 +58,8 @@ class Genode::Entrypoint : Genode::Noncopyable
 		{
 			enum { STACK_SIZE = 2*1024*sizeof(long) };
 			Entrypoint &ep;
-			Signal_proxy_thread(Env &env, Entrypoint &ep)
-			:
-				Thread(env, "signal_proxy", STACK_SIZE),
-				ep(ep)
-			{ start(); }
+			Signal_proxy_thread(Env &env, Entrypoint &ep,
+			                    Affinity::Location location);
 
 			void entry() override { ep._process_incoming_signals(); }
 		};
@@ -134,6 +131,15 @@ class Genode::Entrypoint : Genode::Noncopyable
 
 		Entrypoint(Env &env, size_t stack_size, char const *name);
 
+		/**
+		 * Constructor
+		 *
+		 * \param location  CPU affinity of the entrypoint thread and its
+		 *                  signal-proxy thread
+		 */
+		Entrypoint(Env &env, size_t stack_size, char const *name,
+		           Affinity::Location location);
+
 		~Entrypoint()
 		{
 			_rpc_ep->dissolve(&_signal_proxy);
@@ -1,5 +1,5 @@
 /*
- * \brief  ARM-specific memcpy
+ * \brief  ARM-specific memcpy and memset
  * \author Sebastian Sumpf
  * \author Stefan Kalkowski
  * \date   2012-08-02
@@ -51,6 +51,46 @@ namespace Genode {
 		}
 		return size;
 	}
+
+	/**
+	 * Fill memory block
+	 *
+	 * \param dst   destination memory block
+	 * \param i     byte value
+	 * \param size  number of bytes to fill
+	 *
+	 * \return      number of bytes not filled
+	 */
+	inline size_t memset_cpu(void *dst, int i, size_t size)
+	{
+		unsigned char *d = (unsigned char *)dst;
+
+		/* fill to 4 byte alignment */
+		for (; (size > 0) && ((size_t)d & 0x3); *d++ = i, size--);
+
+		/* fill 32 byte chunks */
+		size_t chunks = size >> 5;
+		if (!chunks)
+			return size;
+
+		unsigned long const value = 0x01010101UL * (unsigned char)i;
+		asm volatile ("mov r3, %2          \n\t"
+		              "mov r4, r3          \n\t"
+		              "mov r5, r3          \n\t"
+		              "mov r6, r3          \n\t"
+		              "mov r7, r3          \n\t"
+		              "mov r8, r3          \n\t"
+		              "mov r9, r3          \n\t"
+		              "mov r10, r3         \n\t"
+		              "1:                  \n\t"
+		              "stmia %0!, {r3 - r10} \n\t"
+		              "subs %1, %1, #1     \n\t"
+		              "bne 1b              \n\t"
+		              : "+r" (d), "+r" (chunks) : "r" (value)
+		              : "r3","r4","r5","r6","r7","r8","r9","r10","cc","memory");
+
+		return size & 0x1f;
+	}
 }
 
 #endif /* _INCLUDE__SPEC__ARM__CPU__STRING_H_ */
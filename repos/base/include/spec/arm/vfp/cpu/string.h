@@ -1,9 +1,13 @@
 /*
- * \brief  ARM-specific memcpy using VFP
+ * \brief  ARM-specific memcpy and memset using VFP
  * \author Sebastian Sumpf
  * \date   2013-06-19
  *
  * Should work for VFPv2, VFPv3, and Advanced SIMD.
+ *
+ * Code that defines 'CPU_STRING_NO_SIMD' runs in kernel mode, where the FPU
+ * registers belong to the interrupted thread. There, both functions omit
+ * the FPU loops.
  */
 
 /*
@@ -42,6 +46,7 @@ namespace Genode {
 		for (; (size > 0) && (s_align > 0) && (s_align < 4);
 		     s_align++, *d++ = *s++, size--);
 
+#ifndef CPU_STRING_NO_SIMD
 		/* copy 64 byte chunks using FPU */
 		for (; size >= 64; size -= 64)
 			asm volatile ("pld [%0, #0xc0]  \n\t"
@@ -49,6 +54,7 @@ namespace Genode {
 			              "vstm %1!,{d0-d7} \n\t"
 			              : "+r"(s), "+r" (d)
                     :: "d0", "d1", "d2", "d3", "d4", "d5", "d6", "d7");
+#endif
 
 		/* copy left over 32 byte chunk */
 		for (; size >= 32; size -= 32)
@@ -64,6 +70,52 @@ namespace Genode {
 			              :: "r3");
 		return size;
 	}
+
+	/**
+	 * Fill memory block
+	 *
+	 * \param dst   destination memory block
+	 * \param i     byte value
+	 * \param size  number of bytes to fill
+	 *
+	 * \return      number of bytes not filled
+	 */
+	inline size_t memset_cpu(void *dst, int i, size_t size)
+	{
+#ifndef CPU_STRING_NO_SIMD
+		unsigned char *d = (unsigned char *)dst;
+
+		/* fill to 4 byte alignment */
+		for (; (size > 0) && ((size_t)d & 0x3); *d++ = i, size--);
+
+		/* fill 64 byte chunks using FPU */
+		size_t chunks = size >> 6;
+		if (!chunks)
+			return size;
+
+		unsigned long const value = 0x01010101UL * (unsigned char)i;
+		asm volatile ("vmov d0, %2, %2     \n\t"
+		              "vmov d1, %2, %2     \n\t"
+		              "vmov d2, %2, %2     \n\t"
+		              "vmov d3, %2, %2     \n\t"
+		              "vmov d4, %2, %2     \n\t"
+		              "vmov d5, %2, %2     \n\t"
+		              "vmov d6, %2, %2     \n\t"
+		              "vmov d7, %2, %2     \n\t"
+		              "1:                  \n\t"
+		              "vstm %0!, {d0-d7}   \n\t"
+		              "subs %1, %1, #1     \n\t"
+		              "bne 1b              \n\t"
+		              : "+r" (d), "+r" (chunks) : "r" (value)
+		              : "d0", "d1", "d2", "d3", "d4", "d5", "d6", "d7",
+		                "cc", "memory");
+
+		return size & 0x3f;
+#else
+		(void)dst; (void)i;
+		return size;
+#endif
+	}
 }
 
 #endif /* _INCLUDE__SPEC__ARM__VFP__CPU__STRING_H_ */
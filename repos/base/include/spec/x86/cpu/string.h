@@ -1,7 +1,19 @@
 /*
- * \brief  CPU-specific memcpy
+ * \brief  CPU-specific memcpy and memset
  * \author Sebastian Sumpf
  * \date   2012-08-02
+ *
+ * On x86_64, SSE2 is part of the architecture and used by the compiler
+ * anyway. Thus, the functions use SSE2 registers without further checks.
+ * AVX is used only if the CPU supports it and the kernel enabled the saving
+ * of the AVX state, which is checked once at runtime. Copies and fills that
+ * are large enough to evict most of the cache anyway are done with
+ * non-temporal stores, which bypass the cache.
+ *
+ * On x86_32, the use of SSE registers depends on the kernel, so the generic
+ * implementations in 'util/string.h' are used. The same holds for code that
+ * defines 'CPU_STRING_NO_SIMD' because it runs in kernel mode, where the
+ * SIMD registers belong to the interrupted thread.
  */
 
 /*
@@ -16,6 +28,177 @@
 
 namespace Genode {
 
+#if defined(__x86_64__) && !defined(CPU_STRING_NO_SIMD)
+
+	namespace Cpu_string {
+
+		enum {
+			/* below this size, the setup costs more than SIMD gains */
+			SIMD_MIN_SIZE = 128,
+
+			/* from this size on, bypass the cache */
+			NON_TEMPORAL_MIN_SIZE = 1024*1024,
+		};
+
+		enum Simd { SIMD_UNKNOWN, SIMD_SSE2, SIMD_AVX };
+
+		inline Simd detect_simd()
+		{
+			unsigned eax = 1, ebx = 0, ecx = 0, edx = 0;
+			asm volatile ("cpuid" : "+a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx));
+
+			enum { OSXSAVE = 1U << 27, AVX = 1U << 28 };
+			if ((ecx & (OSXSAVE | AVX)) != (OSXSAVE | AVX))
+				return SIMD_SSE2;
+
+			/* check that the kernel saves the SSE and AVX state */
+			unsigned xcr0_lo = 0, xcr0_hi = 0;
+			asm volatile ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+
+			enum { XCR0_SSE = 1U << 1, XCR0_AVX = 1U << 2 };
+			if ((xcr0_lo & (XCR0_SSE | XCR0_AVX)) != (XCR0_SSE | XCR0_AVX))
+				return SIMD_SSE2;
+
+			return SIMD_AVX;
+		}
+
+		/**
+		 * Return SIMD extension used for memory operations
+		 *
+		 * The detection may race between threads but always yields the
+		 * same result.
+		 */
+		inline Simd simd()
+		{
+			static Simd volatile simd = SIMD_UNKNOWN;
+			if (simd == SIMD_UNKNOWN)
+				simd = detect_simd();
+
+			return simd;
+		}
+
+		/**
+		 * Copy 64-byte chunks to a 16-byte aligned destination
+		 */
+		inline void copy_sse2(char *&d, char const *&s, size_t &size)
+		{
+			for (; size >= 64; size -= 64, d += 64, s += 64)
+				asm volatile ("movdqu   (%0), %%xmm0 \n\t"
+				              "movdqu 16(%0), %%xmm1 \n\t"
+				              "movdqu 32(%0), %%xmm2 \n\t"
+				              "movdqu 48(%0), %%xmm3 \n\t"
+				              "movdqa %%xmm0,   (%1) \n\t"
+				              "movdqa %%xmm1, 16(%1) \n\t"
+				              "movdqa %%xmm2, 32(%1) \n\t"
+				              "movdqa %%xmm3, 48(%1) \n\t"
+				              : : "r" (s), "r" (d)
+				              : "xmm0", "xmm1", "xmm2", "xmm3", "memory");
+		}
+
+		/**
+		 * Copy 128-byte chunks to a 16-byte aligned destination
+		 */
+		inline void copy_avx(char *&d, char const *&s, size_t &size)
+		{
+			for (; size >= 128; size -= 128, d += 128, s += 128)
+				asm volatile ("vmovdqu    (%0), %%ymm0 \n\t"
+				              "vmovdqu  32(%0), %%ymm1 \n\t"
+				              "vmovdqu  64(%0), %%ymm2 \n\t"
+				              "vmovdqu  96(%0), %%ymm3 \n\t"
+				              "vmovdqu %%ymm0,   (%1) \n\t"
+				              "vmovdqu %%ymm1, 32(%1) \n\t"
+				              "vmovdqu %%ymm2, 64(%1) \n\t"
+				              "vmovdqu %%ymm3, 96(%1) \n\t"
+				              : : "r" (s), "r" (d)
+				              : "xmm0", "xmm1", "xmm2", "xmm3", "memory");
+
+			/*
+			 * Avoid the penalty of mixing AVX and SSE code. As this clears
+			 * the upper halves of all AVX registers, they are marked as
+			 * clobbered.
+			 */
+			asm volatile ("vzeroupper" : : : "xmm0",  "xmm1",  "xmm2",  "xmm3",
+			                                  "xmm4",  "xmm5",  "xmm6",  "xmm7",
+			                                  "xmm8",  "xmm9",  "xmm10", "xmm11",
+			                                  "xmm12", "xmm13", "xmm14", "xmm15");
+		}
+
+		/**
+		 * Copy 64-byte chunks to a 16-byte aligned destination, bypassing
+		 * the cache
+		 */
+		inline void copy_non_temporal(char *&d, char const *&s, size_t &size)
+		{
+			for (; size >= 64; size -= 64, d += 64, s += 64)
+				asm volatile ("prefetchnta 256(%0)     \n\t"
+				              "movdqu    (%0), %%xmm0 \n\t"
+				              "movdqu  16(%0), %%xmm1 \n\t"
+				              "movdqu  32(%0), %%xmm2 \n\t"
+				              "movdqu  48(%0), %%xmm3 \n\t"
+				              "movntdq %%xmm0,   (%1) \n\t"
+				              "movntdq %%xmm1, 16(%1) \n\t"
+				              "movntdq %%xmm2, 32(%1) \n\t"
+				              "movntdq %%xmm3, 48(%1) \n\t"
+				              : : "r" (s), "r" (d)
+				              : "xmm0", "xmm1", "xmm2", "xmm3", "memory");
+
+			/* order the weakly-ordered stores before subsequent stores */
+			asm volatile ("sfence" : : : "memory");
+		}
+
+		/**
+		 * Fill 64-byte chunks of a 16-byte aligned destination
+		 */
+		inline void fill_sse2(char *&d, int i, size_t &size, bool non_temporal)
+		{
+			unsigned long const pattern = 0x0101010101010101UL * (unsigned char)i;
+
+			unsigned long chunks = size / 64;
+			if (!chunks)
+				return;
+
+			size -= chunks * 64;
+
+			/*
+			 * The pattern is moved to the SSE register within the asm
+			 * statement because a vector operand cannot be passed from code
+			 * compiled without SSE2 support, e.g., with '-mno-sse2'.
+			 */
+			if (non_temporal) {
+				asm volatile ("movq       %2, %%xmm0     \n\t"
+				              "punpcklqdq %%xmm0, %%xmm0 \n\t"
+				              "1:                        \n\t"
+				              "movntdq    %%xmm0,   (%0) \n\t"
+				              "movntdq    %%xmm0, 16(%0) \n\t"
+				              "movntdq    %%xmm0, 32(%0) \n\t"
+				              "movntdq    %%xmm0, 48(%0) \n\t"
+				              "add        $64, %0        \n\t"
+				              "dec        %1             \n\t"
+				              "jnz        1b             \n\t"
+				              "sfence                    \n\t"
+				              : "+r" (d), "+r" (chunks) : "r" (pattern)
+				              : "xmm0", "cc", "memory");
+				return;
+			}
+
+			asm volatile ("movq       %2, %%xmm0     \n\t"
+			              "punpcklqdq %%xmm0, %%xmm0 \n\t"
+			              "1:                        \n\t"
+			              "movdqa     %%xmm0,   (%0) \n\t"
+			              "movdqa     %%xmm0, 16(%0) \n\t"
+			              "movdqa     %%xmm0, 32(%0) \n\t"
+			              "movdqa     %%xmm0, 48(%0) \n\t"
+			              "add        $64, %0        \n\t"
+			              "dec        %1             \n\t"
+			              "jnz        1b             \n\t"
+			              : "+r" (d), "+r" (chunks) : "r" (pattern)
+			              : "xmm0", "cc", "memory");
+		}
+	}
+
+#endif
+
+
 	/**
 	 * Copy memory block
 	 *
@@ -25,7 +208,63 @@ namespace Genode {
 	 *
 	 * \return      number of bytes not copied
 	 */
-	inline size_t memcpy_cpu(void *, const void *, size_t size) { return size; }
+	inline size_t memcpy_cpu(void *dst, const void *src, size_t size)
+	{
+#if defined(__x86_64__) && !defined(CPU_STRING_NO_SIMD)
+		using namespace Cpu_string;
+
+		if (size < SIMD_MIN_SIZE)
+			return size;
+
+		char *d = (char *)dst;
+		char const *s = (char const *)src;
+
+		/* copy to 16 byte alignment of the destination */
+		for (; (unsigned long)d & 0xf; size--)
+			*d++ = *s++;
+
+		if (size >= NON_TEMPORAL_MIN_SIZE)
+			copy_non_temporal(d, s, size);
+		else if (simd() == SIMD_AVX)
+			copy_avx(d, s, size);
+
+		copy_sse2(d, s, size);
+#else
+		(void)dst; (void)src;
+#endif
+		return size;
+	}
+
+
+	/**
+	 * Fill memory block
+	 *
+	 * \param dst   destination memory block
+	 * \param i     byte value
+	 * \param size  number of bytes to fill
+	 *
+	 * \return      number of bytes not filled
+	 */
+	inline size_t memset_cpu(void *dst, int i, size_t size)
+	{
+#if defined(__x86_64__) && !defined(CPU_STRING_NO_SIMD)
+		using namespace Cpu_string;
+
+		if (size < SIMD_MIN_SIZE)
+			return size;
+
+		char *d = (char *)dst;
+
+		/* fill to 16 byte alignment */
+		for (; (unsigned long)d & 0xf; size--)
+			*d++ = i;
+
+		fill_sse2(d, i, size, size >= NON_TEMPORAL_MIN_SIZE);
+#else
+		(void)dst; (void)i;
+#endif
+		return size;
+	}
 }
 
 #endif /* _INCLUDE__SPEC__X86__CPU__STRING_H_ */
@@ -232,7 +232,13 @@ namespace Genode {
 	 */
 	inline void *memset(void *dst, int i, size_t size)
 	{
-		while (size--) ((char *)dst)[size] = i;
+		/* try cpu specific version first */
+		size_t const done = size - memset_cpu(dst, i, size);
+
+		char *d = (char *)dst + done;
+		size -= done;
+
+		while (size--) d[size] = i;
 		return dst;
 	}
 
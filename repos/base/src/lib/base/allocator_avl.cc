@@ -129,6 +129,9 @@ int Allocator_avl_base::_add_block(Block *block_metadata,
 	/* insert block into avl tree */
 	_addr_tree.insert(block_metadata);
 
+	if (!used)
+		_bin_insert(block_metadata);
+
 	return 0;
 }
 
@@ -137,12 +140,71 @@ void Allocator_avl_base::_destroy_block(Block *b)
 {
 	if (!b) return;
 
-	/* remove block from both avl trees */
+	/* remove block from avl tree and size index */
 	_addr_tree.remove(b);
+
+	if (!b->used())
+		_bin_remove(b);
+
 	_md_alloc->free(b, _md_entry_size);
 }
 
 
+void Allocator_avl_base::_bin_insert(Block *b)
+{
+	Block *&head = _bins[_bin(b->size())];
+
+	b->_bin_prev = nullptr;
+	b->_bin_next = head;
+
+	if (head)
+		head->_bin_prev = b;
+
+	head = b;
+}
+
+
+void Allocator_avl_base::_bin_remove(Block *b)
+{
+	if (b->_bin_prev)
+		b->_bin_prev->_bin_next = b->_bin_next;
+	else
+		_bins[_bin(b->size())] = b->_bin_next;
+
+	if (b->_bin_next)
+		b->_bin_next->_bin_prev = b->_bin_prev;
+
+	b->_bin_prev = b->_bin_next = nullptr;
+}
+
+
+Allocator_avl_base::Block *
+Allocator_avl_base::_find_best_fit_by_size(size_t size, unsigned align)
+{
+	for (unsigned i = _bin(size); i < NUM_BINS; i++) {
+
+		Block *best = nullptr;
+
+		for (Block *b = _bins[i]; b; b = b->_bin_next) {
+
+			if (!b->_fits(size, align, 0UL, ~0UL))
+				continue;
+
+			if (!best || b->size() < best->size())
+				best = b;
+
+			/* a perfect fit cannot be improved */
+			if (best->size() == size)
+				break;
+		}
+
+		if (best)
+			return best;
+	}
+	return nullptr;
+}
+
+
 void Allocator_avl_base::_cut_from_block(Block *b, addr_t addr, size_t size,
                                          Block *dst1, Block *dst2)
 {
@@ -271,9 +333,17 @@ Allocator_avl_base::alloc_aligned(size_t size, void **out_addr, int align,
 	if (!_alloc_two_blocks_metadata(&dst1, &dst2))
 		return Alloc_return(Alloc_return::OUT_OF_METADATA);
 
-	/* find best fitting block */
+	/*
+	 * Find best fitting block, use the size index if the allocation is
+	 * not constrained to an address range
+	 */
 	Block *b = _addr_tree.first();
-	b = b ? b->find_best_fit(size, align, from, to) : 0;
+	if (b && b->max_avail() < size)
+		b = nullptr;
+	else if (b && from == 0 && to == ~0UL)
+		b = _find_best_fit_by_size(size, align);
+	else
+		b = b ? b->find_best_fit(size, align, from, to) : 0;
 
 	if (!b) {
 		_md_alloc->free(dst1, sizeof(Block));
@@ -328,11 +328,29 @@ Entrypoint::Entrypoint(Env &env)
 }
 
 
+Entrypoint::Signal_proxy_thread::Signal_proxy_thread(Env &env, Entrypoint &ep,
+                                                     Affinity::Location location)
+:
+	Thread(env, "signal_proxy", STACK_SIZE, location, Weight(), env.cpu()),
+	ep(ep)
+{
+	start();
+}
+
+
 Entrypoint::Entrypoint(Env &env, size_t stack_size, char const *name)
+:
+	Entrypoint(env, stack_size, name, Affinity::Location())
+{ }
+
+
+Entrypoint::Entrypoint(Env &env, size_t stack_size, char const *name,
+                       Affinity::Location location)
 :
 	_env(env),
-	_rpc_ep(&env.pd(), stack_size, name), _signalling_initialized(true)
+	_rpc_ep(&env.pd(), stack_size, name, true, location),
+	_signalling_initialized(true)
 {
-	_signal_proxy_thread.construct(env, *this);
+	_signal_proxy_thread.construct(env, *this, location);
 }
 
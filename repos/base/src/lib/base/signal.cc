@@ -131,33 +131,64 @@ namespace Genode {
 		private:
 
 			/*
-			 * Currently, the registry is just a linked list. If this becomes a
-			 * scalability problem, we might introduce a more sophisticated
-			 * associative data structure.
+			 * Contexts are kept in a hash table of singly-linked lists
+			 * indexed by the context address, which is also used as signal
+			 * imprint. This keeps the lookup cost on signal delivery
+			 * independent of the number of contexts of the component.
+			 *
+			 * Instead of one lock for the whole registry, the buckets are
+			 * protected by a small set of locks, which lets threads
+			 * delivering signals to different contexts proceed in parallel.
 			 */
-			Lock mutable                        _lock;
-			List<List_element<Signal_context> > _list;
+			enum { BUCKETS_LOG2 = 8, BUCKETS = 1 << BUCKETS_LOG2,
+			       LOCKS_LOG2   = 4, LOCKS   = 1 << LOCKS_LOG2 };
+
+			typedef List<List_element<Signal_context> > Bucket;
+
+			Lock mutable _locks[LOCKS];
+			Bucket       _buckets[BUCKETS];
+
+			static unsigned _index(Signal_context const *context)
+			{
+				/*
+				 * Contexts are heap objects, so the lowest address bits
+				 * carry no information. Fibonacci hashing mixes the
+				 * remaining bits into the high bits of the 32-bit
+				 * product, which form the bucket index.
+				 */
+				unsigned long long const a = (addr_t)context >> 4;
+				uint32_t const v = (uint32_t)(a ^ (a >> 32));
+				return (uint32_t)(v * 2654435761U) >> (32 - BUCKETS_LOG2);
+			}
+
+			static unsigned _lock_index(unsigned index) { return index & (LOCKS - 1); }
 
 		public:
 
 			void insert(List_element<Signal_context> *le)
 			{
-				Lock::Guard guard(_lock);
-				_list.insert(le);
+				unsigned const i = _index(le->object());
+
+				Lock::Guard guard(_locks[_lock_index(i)]);
+				_buckets[i].insert(le);
 			}
 
 			void remove(List_element<Signal_context> *le)
 			{
-				Lock::Guard guard(_lock);
-				_list.remove(le);
+				unsigned const i = _index(le->object());
+
+				Lock::Guard guard(_locks[_lock_index(i)]);
+				_buckets[i].remove(le);
 			}
 
 			bool test_and_lock(Signal_context *context) const
 			{
-				Lock::Guard guard(_lock);
+				unsigned const i = _index(context);
+
+				Lock::Guard guard(_locks[_lock_index(i)]);
 
-				/* search list for context */
-				List_element<Signal_context> const *le = _list.first();
+				/* search bucket for context */
+				List_element<Signal_context> const *le = _buckets[i].first();
 				for ( ; le; le = le->next()) {
 
 					if (context == le->object()) {
@@ -0,0 +1,159 @@
+/*
+ * \brief  Allocator_avl stress test and benchmark
+ * \author Norman Feske
+ * \date   2017-11-28
+ *
+ * The test performs random allocations and deallocations of varying sizes
+ * and alignments within a large virtual range, similar to the allocation
+ * pattern of core's address-space allocators. It checks that allocated
+ * blocks never overlap and that all memory is available again at the end.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/allocator_avl.h>
+#include <base/log.h>
+#include <timer_session/connection.h>
+
+using namespace Genode;
+
+
+struct Random
+{
+	uint32_t _state = 0x12345678;
+
+	uint32_t next()
+	{
+		/* xorshift */
+		_state ^= _state << 13;
+		_state ^= _state >> 17;
+		_state ^= _state << 5;
+		return _state;
+	}
+};
+
+
+struct Main
+{
+	enum {
+		RANGE_BASE = 0x10000000,
+		RANGE_SIZE = 1UL << 30,
+		NUM_SLOTS  = 4096,
+		NUM_ROUNDS = 1000000,
+	};
+
+	struct Slot { addr_t addr; size_t size; };
+
+	Env &_env;
+
+	Heap              _heap  { _env.ram(), _env.rm() };
+	Timer::Connection _timer { _env };
+	Allocator_avl     _alloc { &_heap };
+	Random            _random { };
+
+	Slot _slots[NUM_SLOTS] { };
+
+	size_t _random_size()
+	{
+		/* mostly small blocks, occasionally large ones */
+		uint32_t const r = _random.next();
+		switch (r % 8) {
+		case 0:  return 1 + (r >> 8) % (1024*1024);
+		case 1:
+		case 2:  return 1 + (r >> 8) % (64*1024);
+		default: return 1 + (r >> 8) % 4096;
+		}
+	}
+
+	void _check_overlap(unsigned i)
+	{
+		for (unsigned j = 0; j < NUM_SLOTS; j++) {
+			if (j == i || !_slots[j].size)
+				continue;
+
+			if (_slots[i].addr < _slots[j].addr + _slots[j].size
+			 && _slots[j].addr < _slots[i].addr + _slots[i].size) {
+				error("blocks ", Hex(_slots[i].addr), " and ",
+				      Hex(_slots[j].addr), " overlap");
+				throw -1;
+			}
+		}
+	}
+
+	void _free(Slot &slot)
+	{
+		_alloc.free((void *)slot.addr, slot.size);
+		slot.size = 0;
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- Allocator_avl test ---");
+
+		_alloc.add_range(RANGE_BASE, RANGE_SIZE);
+		size_t const initial_avail = _alloc.avail();
+
+		unsigned long allocs = 0, failed = 0;
+		unsigned long const start_ms = _timer.elapsed_ms();
+
+		for (unsigned round = 0; round < NUM_ROUNDS; round++) {
+
+			unsigned const i = _random.next() % NUM_SLOTS;
+			Slot &slot = _slots[i];
+
+			if (slot.size) {
+				_free(slot);
+				continue;
+			}
+
+			size_t const size  = _random_size();
+			int    const align = (_random.next() % 4) ? 0 : 12 + _random.next() % 5;
+
+			void *addr = nullptr;
+			if (_alloc.alloc_aligned(size, &addr, align).error()) {
+				failed++;
+				continue;
+			}
+
+			slot.addr = (addr_t)addr;
+			slot.size = size;
+			allocs++;
+
+			if (slot.addr & ((1UL << align) - 1)) {
+				error("block ", Hex(slot.addr), " violates alignment ", align);
+				throw -1;
+			}
+
+			/* checking all blocks is expensive, sample every 64th allocation */
+			if (!(allocs % 64))
+				_check_overlap(i);
+		}
+
+		unsigned long const duration_ms = _timer.elapsed_ms() - start_ms;
+
+		log((unsigned)NUM_ROUNDS, " operations (", allocs, " allocations, ", failed,
+		    " failed) in ", duration_ms, " ms (",
+		    (unsigned long)NUM_ROUNDS/max(duration_ms, 1UL), " ops/ms)");
+
+		for (unsigned i = 0; i < NUM_SLOTS; i++)
+			if (_slots[i].size)
+				_free(_slots[i]);
+
+		if (_alloc.avail() != initial_avail) {
+			error("avail ", _alloc.avail(), " differs from initial ", initial_avail);
+			throw -1;
+		}
+
+		log("Test done");
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
@@ -0,0 +1,156 @@
+/*
+ * \brief  Test and benchmark of memcpy and memset
+ * \author Sebastian Sumpf
+ * \date   2017-12-19
+ *
+ * The test first checks the results of 'memcpy' and 'memset' for various
+ * sizes and alignments of source and destination. Afterwards, it measures
+ * the throughput of both functions for block sizes from 16 B to 16 MiB.
+ * Each size is measured by processing the same amount of data, so that
+ * small sizes reflect the per-call overhead and large sizes the memory
+ * bandwidth.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/component.h>
+#include <base/attached_ram_dataspace.h>
+#include <base/log.h>
+#include <timer_session/connection.h>
+#include <util/string.h>
+
+using namespace Genode;
+
+
+struct Main
+{
+	enum {
+		MIN_SIZE      = 16,
+		MAX_SIZE      = 16*1024*1024,
+		BYTES_PER_RUN = 256*1024*1024,
+		SLACK         = 64,
+	};
+
+	Env &_env;
+
+	Timer::Connection      _timer  { _env };
+	Attached_ram_dataspace _src_ds { _env.ram(), _env.rm(), MAX_SIZE + SLACK };
+	Attached_ram_dataspace _dst_ds { _env.ram(), _env.rm(), MAX_SIZE + SLACK };
+
+	char * const _src = _src_ds.local_addr<char>();
+	char * const _dst = _dst_ds.local_addr<char>();
+
+	/**
+	 * Byte-wise reference that the tested functions must match
+	 */
+	static bool _equal(char const *a, char const *b, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+			if (a[i] != b[i])
+				return false;
+
+		return true;
+	}
+
+	void _check_memcpy(size_t size, unsigned src_off, unsigned dst_off)
+	{
+		for (size_t i = 0; i < size + SLACK; i++) {
+			_src[i] = (char)(i * 7 + 1);
+			_dst[i] = 0;
+		}
+		memcpy(_dst + dst_off, _src + src_off, size);
+
+		bool const untouched = (dst_off == 0 || _dst[dst_off - 1] == 0)
+		                    && _dst[dst_off + size] == 0;
+
+		if (!_equal(_dst + dst_off, _src + src_off, size) || !untouched) {
+			error("memcpy of ", size, " bytes with offsets ", src_off,
+			      "/", dst_off, " failed");
+			throw -1;
+		}
+	}
+
+	void _check_memset(size_t size, unsigned dst_off)
+	{
+		for (size_t i = 0; i < size + SLACK; i++)
+			_dst[i] = 0;
+
+		memset(_dst + dst_off, 0xa5, size);
+
+		bool ok = (dst_off == 0 || _dst[dst_off - 1] == 0)
+		       && _dst[dst_off + size] == 0;
+
+		for (size_t i = 0; ok && i < size; i++)
+			ok = (unsigned char)_dst[dst_off + i] == 0xa5;
+
+		if (!ok) {
+			error("memset of ", size, " bytes with offset ", dst_off, " failed");
+			throw -1;
+		}
+	}
+
+	/**
+	 * Return throughput in MiB/s of calling 'fn' repeatedly for 'size' bytes
+	 */
+	template <typename FN>
+	unsigned long _measure(size_t size, FN const &fn)
+	{
+		unsigned long const rounds = BYTES_PER_RUN / size;
+
+		unsigned long const start_us = _timer.elapsed_us();
+		for (unsigned long i = 0; i < rounds; i++)
+			fn();
+
+		unsigned long const duration_us =
+			max(_timer.elapsed_us() - start_us, 1UL);
+
+		return (unsigned long)(((unsigned long long)rounds * size)
+		                       / duration_us * 1000000 / (1024*1024));
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- memcpy/memset test ---");
+
+		/* sizes around the thresholds of the CPU-specific variants */
+		size_t const sizes[] = { 0, 1, 7, 8, 15, 16, 31, 63, 64, 65, 127, 128,
+		                         129, 255, 256, 1000, 4096, 4097, 65535,
+		                         1024*1024 - 1, 1024*1024 + 17 };
+
+		for (size_t size : sizes)
+			for (unsigned src_off = 0; src_off < 17; src_off += 4)
+				for (unsigned dst_off = 0; dst_off < 17; dst_off += 3) {
+					_check_memcpy(size, src_off, dst_off);
+					_check_memset(size, dst_off);
+				}
+
+		log("results correct");
+
+		for (size_t size = MIN_SIZE; size <= MAX_SIZE; size *= 2) {
+
+			unsigned long const aligned = _measure(size, [&] () {
+				memcpy(_dst, _src, size); });
+
+			unsigned long const unaligned = _measure(size, [&] () {
+				memcpy(_dst + 3, _src + 1, size); });
+
+			unsigned long const set = _measure(size, [&] () {
+				memset(_dst, 0x5a, size); });
+
+			log("size ", Number_of_bytes(size), ": "
+			    "memcpy ", aligned, " MiB/s, "
+			    "unaligned memcpy ", unaligned, " MiB/s, "
+			    "memset ", set, " MiB/s");
+		}
+
+		log("Test done");
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
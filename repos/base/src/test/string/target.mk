@@ -0,0 +1,3 @@
+TARGET = test-string
+SRC_CC = main.cc
+LIBS   = base
@@ -547,7 +547,6 @@ DUMMY(0, hrtimer_start)
 DUMMY(0, icmp6_hdr)
 DUMMY(0, inet_twsk_deschedule_put)
 DUMMY(0, inet_twsk_free)
-DUMMY_STOP(0, iov_iter_advance)
 DUMMY_STOP(0, iov_iter_get_pages)
 DUMMY(0, ip_tunnel_core_init)
 DUMMY(0, iptunnel_metadata_reply)
@@ -20,7 +20,7 @@
 
 
 static inline msghdr create_msghdr(void *name, int namelen, size_t datalen,
-                                   struct iovec *iov)
+                                   struct iovec *iov, unsigned long nr_segs = 1)
 {
 	msghdr msg;
 
@@ -30,7 +30,7 @@ static inline msghdr create_msghdr(void *name, int namelen, size_t datalen,
 	msg.msg_iter.iov_offset = 0;
 	msg.msg_iter.count      = datalen;
 	msg.msg_iter.iov        = iov;
-	msg.msg_iter.nr_segs    = 1;
+	msg.msg_iter.nr_segs    = nr_segs;
 	msg.msg_control         = nullptr;
 	msg.msg_controllen      = 0;
 	msg.msg_flags           = 0;
@@ -535,49 +535,64 @@ extern "C" void lx_trace_event(char const *fmt, ...)
  ** linux/uio.h **
  *****************/
 
-static inline size_t _copy_iter(void *addr, size_t bytes,
-                                struct iov_iter *i, bool to_iter)
+/**
+ * Walk the next 'bytes' of the iterator segment by segment
+ *
+ * For each contiguous part, 'fn(base, len, offset)' is called with 'offset'
+ * being the number of bytes processed before. The iterator is advanced
+ * accordingly. Consumed segments are skipped like done by Linux.
+ */
+template <typename FN>
+static size_t _for_each_segment(size_t bytes, struct iov_iter *i, FN const &fn)
 {
-	if (addr == nullptr) { return 0; }
+	if (bytes > i->count) { bytes = i->count; }
 
-	if (i->count == 0 ||
-	    i->iov == nullptr ||
-	    i->iov->iov_len == 0) {
-		return 0;
-	}
+	size_t done = 0;
+	while (done < bytes && i->nr_segs && i->iov) {
 
-	if (i->nr_segs > 1) {
-		Genode::error(__func__, ": too many segments ", i->nr_segs);
-		return 0;
-	}
+		struct iovec const * const iov = i->iov;
+
+		if (i->iov_offset >= iov->iov_len) {
+			i->iov++;
+			i->nr_segs--;
+			i->iov_offset = 0;
+			continue;
+		}
 
-	/* make sure the whole iter fits as there is only 1 iovec */
-	if (i->iov->iov_len < i->count) {
-		Genode::error(__func__, ": "
-		              "iov->iov_len: ", i->iov->iov_len, " < "
-		              "i->count: ", i->count);
-		return 0;
+		size_t const avail = iov->iov_len - i->iov_offset;
+		size_t const len   = Genode::min(avail, bytes - done);
+
+		fn((char *)iov->iov_base + i->iov_offset, len, done);
+
+		i->iov_offset += len;
+		i->count      -= len;
+		done          += len;
 	}
 
-	struct iovec const * const iov = i->iov;
-	size_t const           iov_len = iov->iov_len;
-	void * const              base = (iov->iov_base + i->iov_offset);
+	return done;
+}
 
-	if (bytes > i->count) { bytes = i->count; }
 
-	size_t const         len = (size_t)(bytes < iov_len ? bytes : iov_len);
-	void * const         dst = to_iter ? base : addr;
-	void const * const   src = to_iter ? addr : base;
+static inline size_t _copy_iter(void *addr, size_t bytes,
+                                struct iov_iter *i, bool to_iter)
+{
+	if (addr == nullptr) { return 0; }
+
+	char * const buf = (char *)addr;
+
+	return _for_each_segment(bytes, i, [&] (char *base, size_t len, size_t offset) {
+
+		void * const       dst = to_iter ? base : buf + offset;
+		void const * const src = to_iter ? buf + offset : base;
 
-	/* actual function body */
-	{
 		Genode::memcpy(dst, src, len);
-	}
+	});
+}
 
-	i->iov_offset += len;
-	i->count      -= len;
 
-	return len;
+void iov_iter_advance(struct iov_iter *i, size_t bytes)
+{
+	_for_each_segment(bytes, i, [&] (char *, size_t, size_t) { });
 }
 
 
@@ -612,52 +627,23 @@ static size_t _csum_and_copy_iter(void *addr, size_t bytes, __wsum *csum,
 {
 	if (addr == nullptr) { return 0; }
 
-	if (i->count == 0 ||
-	    i->iov == nullptr ||
-	    i->iov->iov_len == 0) {
-		return 0;
-	}
+	char * const buf = (char *)addr;
 
-	if (i->nr_segs > 1) {
-		Genode::error(__func__, ": too many segments ", i->nr_segs);
-		return 0;
-	}
+	return _for_each_segment(bytes, i, [&] (char *base, size_t len, size_t offset) {
 
-	/* make sure the whole iter fits as there is only 1 iovec */
-	if (i->iov->iov_len < i->count) {
-		Genode::error(__func__, ": "
-		              "iov->iov_len: ", i->iov->iov_len, " < "
-		              "i->count: ", i->count);
-		return 0;
-	}
+		void * const       dst = to_iter ? base : buf + offset;
+		void const * const src = to_iter ? buf + offset : base;
 
-	struct iovec const * const iov = i->iov;
-	size_t const           iov_len = iov->iov_len;
-	void * const              base = (iov->iov_base + i->iov_offset);
-
-	if (bytes > i->count) { bytes = i->count; }
-
-	size_t const         len = (size_t)(bytes < iov_len ? bytes : iov_len);
-	void * const         dst = to_iter ? base : addr;
-	void const * const   src = to_iter ? addr : base;
-
-	/* actual function body */
-	{
 		int err = 0;
 		__wsum next = csum_and_copy_from_user(src, dst, len, 0, &err);
 
 		if (err) {
-			Genode::error(__func__, ": err: ", err, " - sleeping");
+			Genode::error("_csum_and_copy_iter: err: ", err, " - sleeping");
 			Genode::sleep_forever();
 		}
 
-		*csum = csum_block_add(*csum, next, 0);
-	}
-
-	i->iov_offset += len;
-	i->count      -= len;
-
-	return len;
+		*csum = csum_block_add(*csum, next, offset);
+	});
 }
 
 
@@ -205,6 +205,50 @@ struct Vfs::Node
 		Genode::error("lxip: write to read-only handle");
 		return -1;
 	}
+
+	typedef File_io_service::Io_vector Io_vector;
+
+	/**
+	 * Pass sequence of buffers to handle read callback
+	 *
+	 * The default implementation reads one buffer after another.
+	 */
+	virtual Lxip::ssize_t readv(Io_vector const *vec, unsigned count,
+	                            file_size seek)
+	{
+		Lxip::ssize_t total = 0;
+		for (unsigned i = 0; i < count; i++) {
+			Lxip::ssize_t const res = read(vec[i].base, vec[i].size, seek + total);
+			if (res < 0)
+				return total ? total : res;
+
+			total += res;
+			if ((Genode::size_t)res < vec[i].size)
+				break;
+		}
+		return total;
+	}
+
+	/**
+	 * Pass sequence of buffers to handle write callback
+	 *
+	 * The default implementation writes one buffer after another.
+	 */
+	virtual Lxip::ssize_t writev(Io_vector const *vec, unsigned count,
+	                             file_size seek)
+	{
+		Lxip::ssize_t total = 0;
+		for (unsigned i = 0; i < count; i++) {
+			Lxip::ssize_t const res = write(vec[i].base, vec[i].size, seek + total);
+			if (res < 0)
+				return total ? total : res;
+
+			total += res;
+			if ((Genode::size_t)res < vec[i].size)
+				break;
+		}
+		return total;
+	}
 };
 
 
@@ -385,6 +429,61 @@ class Vfs::Lxip_data_file : public Vfs::Lxip_file
 				throw Would_block();
 			return ret;
 		}
+
+		/*
+		 * The vectored operations pass all buffers to a single 'sendmsg'
+		 * or 'recvmsg' call. The network stack copies the data directly
+		 * from or to the buffers of the application. Buffers beyond
+		 * 'MAX_IOVEC' are left to the next call.
+		 */
+
+		enum { MAX_IOVEC = 64 };
+
+		static unsigned _fill_iovec(Linux::iovec *iov, Io_vector const *vec,
+		                            unsigned count, Genode::size_t &len)
+		{
+			unsigned const n = Genode::min(count, (unsigned)MAX_IOVEC);
+
+			len = 0;
+			for (unsigned i = 0; i < n; i++) {
+				iov[i].iov_base = vec[i].base;
+				iov[i].iov_len  = vec[i].size;
+				len += vec[i].size;
+			}
+			return n;
+		}
+
+		Lxip::ssize_t writev(Io_vector const *vec, unsigned count,
+		                     file_size /* ignored */) override
+		{
+			using namespace Linux;
+
+			iovec          iov[MAX_IOVEC];
+			Genode::size_t len = 0;
+			unsigned const n   = _fill_iovec(iov, vec, count, len);
+
+			msghdr msg = create_msghdr(&_parent.remote_addr(),
+			                           sizeof(sockaddr_in), len, iov, n);
+
+			return _sock.ops->sendmsg(&_sock, &msg, len);
+		}
+
+		Lxip::ssize_t readv(Io_vector const *vec, unsigned count,
+		                    file_size /* ignored */) override
+		{
+			using namespace Linux;
+
+			iovec          iov[MAX_IOVEC];
+			Genode::size_t len = 0;
+			unsigned const n   = _fill_iovec(iov, vec, count, len);
+
+			msghdr msg = create_msghdr(nullptr, 0, len, iov, n);
+
+			Lxip::ssize_t ret = _sock.ops->recvmsg(&_sock, &msg, len, MSG_DONTWAIT);
+			if (ret == -EAGAIN)
+				throw Would_block();
+			return ret;
+		}
 };
 
 
@@ -1651,6 +1750,52 @@ class Vfs::Lxip_file_system : public Vfs::File_system,
 			catch (File::Would_block) { return READ_QUEUED; }
 		}
 
+		Write_result writev(Vfs_handle *vfs_handle,
+		                    File_io_service::Io_vector const *vec,
+		                    unsigned vec_count, file_size &out_count) override
+		{
+			Vfs::File &file =
+				static_cast<Vfs::Lxip_vfs_file_handle *>(vfs_handle)->file;
+
+			out_count = 0;
+
+			try {
+				Lxip::ssize_t res = file.writev(vec, vec_count, vfs_handle->seek());
+				if (res < 0) return WRITE_ERR_IO;
+
+				out_count = res;
+
+			} catch (File::Would_block) { return WRITE_ERR_WOULD_BLOCK; }
+			return WRITE_OK;
+		}
+
+		bool queue_readv(Vfs_handle *, File_io_service::Io_vector const *,
+		                 unsigned) override
+		{
+			/* data is taken directly from the socket in 'complete_readv' */
+			return true;
+		}
+
+		Read_result complete_readv(Vfs_handle *vfs_handle,
+		                           File_io_service::Io_vector const *vec,
+		                           unsigned vec_count,
+		                           file_size &out_count) override
+		{
+			Vfs::Node &node =
+				static_cast<Vfs::Lxip_vfs_handle *>(vfs_handle)->node;
+
+			out_count = 0;
+
+			try {
+				Lxip::ssize_t res = node.readv(vec, vec_count, vfs_handle->seek());
+				if (res < 0) return READ_ERR_IO;
+
+				out_count = res;
+
+			} catch (File::Would_block) { return READ_QUEUED; }
+			return READ_OK;
+		}
+
 		Ftruncate_result ftruncate(Vfs_handle *vfs_handle, file_size) override
 		{
 			/* report ok because libc always executes ftruncate() when opening rw */
@@ -145,10 +145,15 @@ int rumpuser_getparam(const char *name, void *buf, size_t buflen)
 {
 	enum { RESERVE_MEM = 2U * 1024 * 1024 };
 
-	/* support one cpu */
+	enum { MAX_CPUS = 32 };
+
+	/* number of virtual CPUs as configured, one by default */
 	Genode::log(name);
 	if (!Genode::strcmp(name, "_RUMPUSER_NCPU")) {
-		Genode::strncpy((char *)buf, "1", 2);
+		unsigned cpus = Rump::env().config_rom().xml().attribute_value("cpus", 1U);
+		cpus = Genode::max(1U, Genode::min(cpus, (unsigned)MAX_CPUS));
+
+		Genode::snprintf((char *)buf, buflen, "%u", cpus);
 		return 0;
 	}
 
@@ -14,6 +14,7 @@
 #include "sched.h"
 #include <base/allocator_avl.h>
 #include <base/printf.h>
+#include <base/semaphore.h>
 #include <block_session/connection.h>
 #include <rump/env.h>
 #include <rump_fs/fs.h>
@@ -25,18 +26,140 @@ enum  { GENODE_FD = 64 };
 
 /**
  * Block session connection
+ *
+ * Requests are submitted asynchronously. Several rump threads may have
+ * requests in flight, which keeps the queue of the block device filled.
+ * Acknowledgements are processed by a dedicated completion thread, which
+ * finishes the requests by calling their 'biodone' callbacks.
  */
 class Backend
 {
 	private:
 
+		enum {
+			QUEUE_DEPTH      = 16,
+			MAX_REQUEST_SIZE = 64*1024,
+
+			/* packet buffer plus space for the packet queues */
+			TX_BUF_SIZE = QUEUE_DEPTH*MAX_REQUEST_SIZE + 64*1024,
+		};
+
+		struct Request
+		{
+			Block::Packet_descriptor packet;
+			void                    *data    = nullptr;
+			int                      op      = 0;
+			rump_biodone_fn          biodone = nullptr;
+			void                    *donearg = nullptr;
+			bool                     used    = false;
+		};
+
 		Genode::Allocator_avl              _alloc { &Rump::env().heap() };
-		Block::Connection                  _session { Rump::env().env(), &_alloc };
+		Block::Connection                  _session { Rump::env().env(), &_alloc, TX_BUF_SIZE };
 		Genode::size_t                     _blk_size; /* block size of the device   */
 		Block::sector_t                    _blk_cnt;  /* number of blocks of device */
 		Block::Session::Operations         _blk_ops;
 		Genode::Lock                       _session_lock;
 
+		Request                            _requests[QUEUE_DEPTH];
+		unsigned                           _in_flight = 0;
+
+		/* threads waiting for the completion of a request */
+		unsigned                           _waiters = 0;
+		Genode::Semaphore                  _completed;
+
+		Hard_context_thread               *_completion_thread = nullptr;
+
+		static void *_completion_entry(void *arg)
+		{
+			/* create an lwp for the thread, see 'biothread' of librumpuser */
+			_rump_upcalls.hyp_schedule();
+			_rump_upcalls.hyp_lwproc_newlwp(0);
+			_rump_upcalls.hyp_unschedule();
+
+			Backend &backend = *(Backend *)arg;
+			for (;;)
+				backend._complete(backend._session.tx()->get_acked_packet());
+
+			return nullptr;
+		}
+
+		/**
+		 * Block until a request completed, must be called with lock held
+		 */
+		void _wait_for_completion()
+		{
+			/* a request submitted by a 'biodone' callback cannot wait for itself */
+			if (Genode::Thread::myself() == _completion_thread) {
+				_session_lock.unlock();
+				_complete(_session.tx()->get_acked_packet());
+				_session_lock.lock();
+				return;
+			}
+
+			_waiters++;
+			_session_lock.unlock();
+			_completed.down();
+			_session_lock.lock();
+		}
+
+		void _complete(Block::Packet_descriptor const &packet)
+		{
+			using namespace Block;
+
+			Request *r = nullptr;
+			Request  request;
+			{
+				Genode::Lock::Guard guard(_session_lock);
+
+				for (unsigned i = 0; i < QUEUE_DEPTH && !r; i++)
+					if (_requests[i].used
+					 && _requests[i].packet.offset() == packet.offset())
+						r = &_requests[i];
+
+				if (r)
+					request = *r;
+			}
+
+			if (!r) {
+				Genode::error("I/O back end: unexpected acknowledgement");
+				return;
+			}
+
+			size_t const length = request.packet.block_count() * _blk_size;
+
+			/* in packet, the slot remains reserved until released below */
+			if (packet.operation() == Packet_descriptor::READ)
+				Genode::memcpy(request.data, _session.tx()->packet_content(packet), length);
+
+			bool const succeeded = packet.succeeded();
+
+			{
+				Genode::Lock::Guard guard(_session_lock);
+
+				_session.tx()->release_packet(packet);
+
+				/* sync request */
+				if (request.op & RUMPUSER_BIO_SYNC)
+					_session.sync();
+
+				r->used = false;
+				_in_flight--;
+
+				/* let blocked submitters retry */
+				for (; _waiters; _waiters--)
+					_completed.up();
+			}
+
+			if (!request.biodone)
+				return;
+
+			int nlocks;
+			rumpkern_sched(0, nullptr);
+			request.biodone(request.donearg, length, succeeded ? 0 : EIO);
+			rumpkern_unsched(&nlocks, nullptr);
+		}
+
 	public:
 
 		Backend()
@@ -55,50 +178,88 @@ class Backend
 		void sync()
 		{
 			Genode::Lock::Guard guard(_session_lock);
+
+			/* write requests in flight are not covered by the sync */
+			while (_in_flight)
+				_wait_for_completion();
+
 			_session.sync();
 		}
 
-		bool submit(int op, int64_t offset, size_t length, void *data)
+		/**
+		 * Submit request
+		 *
+		 * The request is completed asynchronously by calling 'biodone'.
+		 *
+		 * \return false if the request could not be submitted
+		 */
+		bool submit(int op, int64_t offset, size_t length, void *data,
+		            rump_biodone_fn biodone, void *donearg)
 		{
 			using namespace Block;
 
-			Genode::Lock::Guard guard(_session_lock);
-
-			Packet_descriptor::Opcode opcode;
-			opcode = op & RUMPUSER_BIO_WRITE ? Packet_descriptor::WRITE :
-			                                   Packet_descriptor::READ;
-			/* allocate packet */
-			try {
-				Packet_descriptor packet( _session.dma_alloc_packet(length),
-				                         opcode, offset / _blk_size,
-				                         length / _blk_size);
-
-				/* out packet -> copy data */
-				if (opcode == Packet_descriptor::WRITE)
-					Genode::memcpy(_session.tx()->packet_content(packet), data, length);
-
-				_session.tx()->submit_packet(packet);
-			} catch(Block::Session::Tx::Source::Packet_alloc_failed) {
-				Genode::error("I/O back end: Packet allocation failed!");
+			if (length > MAX_REQUEST_SIZE) {
+				Genode::error("I/O back end: request of ", length, " bytes exceeds "
+				              "maximum of ", (unsigned)MAX_REQUEST_SIZE);
 				return false;
 			}
 
-			/* wait and process result */
-			Packet_descriptor packet = _session.tx()->get_acked_packet();
+			Genode::Lock::Guard guard(_session_lock);
 
-			/* in packet */
-			if (opcode == Packet_descriptor::READ)
-				Genode::memcpy(data, _session.tx()->packet_content(packet), length);
+			/* the thread is created on demand as it requires a running rump kernel */
+			if (!_completion_thread)
+				_completion_thread = new (Rump::env().heap())
+					Hard_context_thread("rump_io", _completion_entry, this, 0);
 
-			bool succeeded = packet.succeeded();
-			_session.tx()->release_packet(packet);
+			Packet_descriptor::Opcode opcode;
+			opcode = op & RUMPUSER_BIO_WRITE ? Packet_descriptor::WRITE :
+			                                   Packet_descriptor::READ;
 
-			/* sync request */
-			if (op & RUMPUSER_BIO_SYNC) {
-				_session.sync();
+			for (;;) {
+
+				Request *r = nullptr;
+				for (unsigned i = 0; i < QUEUE_DEPTH && !r; i++)
+					if (!_requests[i].used)
+						r = &_requests[i];
+
+				if (!r || !_session.tx()->ready_to_submit()) {
+					_wait_for_completion();
+					continue;
+				}
+
+				/* allocate packet */
+				try {
+					Packet_descriptor packet( _session.dma_alloc_packet(length),
+					                         opcode, offset / _blk_size,
+					                         length / _blk_size);
+
+					/* out packet -> copy data */
+					if (opcode == Packet_descriptor::WRITE)
+						Genode::memcpy(_session.tx()->packet_content(packet), data, length);
+
+					r->packet  = packet;
+					r->data    = data;
+					r->op      = op;
+					r->biodone = biodone;
+					r->donearg = donearg;
+					r->used    = true;
+					_in_flight++;
+
+					_session.tx()->submit_packet(packet);
+					return true;
+
+				} catch(Block::Session::Tx::Source::Packet_alloc_failed) {
+
+					/* the buffer is fragmented, wait for requests in flight */
+					if (_in_flight) {
+						_wait_for_completion();
+						continue;
+					}
+
+					Genode::error("I/O back end: Packet allocation failed!");
+					return false;
+				}
 			}
-
-			return succeeded;
 		}
 };
 
@@ -154,12 +315,13 @@ void rumpuser_bio(int fd, int op, void *data, size_t dlen, int64_t off,
 		            "bio ",   donearg, " "
 		            "sync: ", !!(op & RUMPUSER_BIO_SYNC));
 
-	bool succeeded = backend().submit(op, off, dlen, data);
+	bool submitted = backend().submit(op, off, dlen, data, biodone, donearg);
 
 	rumpkern_sched(nlocks, 0);
 
-	if (biodone)
-		biodone(donearg, dlen, succeeded ? 0 : EIO);
+	/* on success, the request is completed by the completion thread */
+	if (!submitted && biodone)
+		biodone(donearg, 0, EIO);
 }
 
 
@@ -108,6 +108,8 @@ class Rump_fs::Directory : public Node
 
 		int fd() const override { return _fd; }
 
+		void sync() override { rump_sys_fsync(_fd); }
+
 		File * file(char const *name, Mode mode, bool create) override
 		{
 			return new (&_alloc) File(_fd, name, mode, create);
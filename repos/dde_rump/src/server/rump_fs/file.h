@@ -167,6 +167,8 @@ class Rump_fs::File : public Node
 
 			mark_as_updated();
 		}
+
+		void sync() override { rump_sys_fsync(_fd); }
 };
 
 #endif /* _FILE_H_ */
@@ -20,12 +20,14 @@
 #include <root/component.h>
 #include <base/component.h>
 #include <base/heap.h>
+#include <util/reconstructible.h>
 
 #include "undef.h"
 
 #include <rump/env.h>
 #include <rump_fs/fs.h>
 #include <sys/resource.h>
+#include <util/hard_context.h>
 #include "file_system.h"
 #include "directory.h"
 #include "open_node.h"
@@ -38,20 +40,71 @@ namespace Rump_fs {
 	struct Main;
 	struct Root;
 	struct Session_component;
+	struct Worker;
 }
 
+
+/**
+ * Entrypoint that processes the packets of sessions
+ *
+ * Sessions are distributed among the workers, which call the rump kernel
+ * concurrently. Hence, the packets of independent clients are processed in
+ * parallel, given that the rump kernel has enough virtual CPUs.
+ */
+struct Rump_fs::Worker : Hard_context
+{
+	enum { STACK_SIZE = 8*1024*sizeof(long) };
+
+	Genode::Entrypoint ep;
+
+	bool _entered = false;
+
+	Worker(Genode::Env &env, char const *name)
+	: Hard_context(0), ep(env, STACK_SIZE, name) { }
+
+	/**
+	 * Make the thread of the entrypoint known to the rump kernel
+	 *
+	 * Must be called by the entrypoint's thread before using the rump
+	 * kernel. As the thread has no lwp of its own, the rump kernel
+	 * schedules it like the component's main entrypoint.
+	 */
+	void enter()
+	{
+		if (_entered)
+			return;
+
+		Hard_context::thread(Genode::Thread::myself());
+		Hard_context_registry::r().insert(this);
+		_entered = true;
+	}
+};
+
 class Rump_fs::Session_component : public Session_rpc_object
 {
 	private:
 
 		typedef File_system::Open_node<Node> Open_node;
 
+		/*
+		 * Maximum number of packets processed at once before other
+		 * sessions of the worker get the chance to proceed
+		 */
+		enum { MAX_BATCH = 32 };
+
 		Allocator                   &_md_alloc;
 		Directory                   &_root;
 		Id_space<File_system::Node>  _open_node_registry;
 		bool                         _writable;
+		Worker                      &_worker;
+
+		/*
+		 * Serialize RPC functions executed by the main entrypoint with
+		 * packet processing executed by the worker
+		 */
+		Genode::Lock _lock;
 
-		Signal_handler<Session_component> _process_packet_handler;
+		Constructible<Signal_handler<Session_component>> _process_packet_handler;
 
 
 		/******************************
@@ -95,7 +148,9 @@ class Rump_fs::Session_component : public Session_rpc_object
 				break;
 
 			case Packet_descriptor::SYNC:
-				rump_sys_sync();
+
+				/* write back the dirty data of the file only */
+				open_node.node().sync();
 				break;
 			}
 
@@ -124,12 +179,16 @@ class Rump_fs::Session_component : public Session_rpc_object
 		}
 
 		/**
-		 * Called by signal dispatcher, executed in the context of the main
-		 * thread (not serialized with the RPC functions)
+		 * Called by signal dispatcher, executed in the context of the
+		 * worker (serialized with the RPC functions by '_lock')
 		 */
 		void _process_packets()
 		{
-			while (tx_sink()->packet_avail()) {
+			_worker.enter();
+
+			Genode::Lock::Guard guard(_lock);
+
+			for (unsigned i = 0; i < MAX_BATCH && tx_sink()->packet_avail(); i++) {
 
 				/*
 				 * Make sure that the '_process_packet' function does not
@@ -148,6 +207,10 @@ class Rump_fs::Session_component : public Session_rpc_object
 
 				_process_packet();
 			}
+
+			/* continue with the remaining packets after other sessions */
+			if (tx_sink()->packet_avail() && tx_sink()->ready_to_ack())
+				Signal_transmitter(*_process_packet_handler).submit();
 		}
 
 		/**
@@ -168,20 +231,24 @@ class Rump_fs::Session_component : public Session_rpc_object
 		                  size_t              tx_buf_size,
 		                  char const         *root_dir,
 		                  bool                writeable,
-		                  Allocator          &md_alloc)
+		                  Allocator          &md_alloc,
+		                  Worker             &worker)
 		:
 			Session_rpc_object(env.ram().alloc(tx_buf_size), env.rm(), env.ep().rpc_ep()),
 			_md_alloc(md_alloc),
 			_root(*new (&_md_alloc) Directory(_md_alloc, root_dir, false)),
 			_writable(writeable),
-			_process_packet_handler(env.ep(), *this, &Session_component::_process_packets)
+			_worker(worker)
 		{
+			_process_packet_handler.construct(worker.ep, *this,
+			                                  &Session_component::_process_packets);
+
 			/*
 			 * Register '_process_packets' dispatch function as signal
 			 * handler for packet-avail and ready-to-ack signals.
 			 */
-			_tx.sigh_packet_avail(_process_packet_handler);
-			_tx.sigh_ready_to_ack(_process_packet_handler);
+			_tx.sigh_packet_avail(*_process_packet_handler);
+			_tx.sigh_ready_to_ack(*_process_packet_handler);
 		}
 
 		/**
@@ -189,6 +256,11 @@ class Rump_fs::Session_component : public Session_rpc_object
 		 */
 		~Session_component()
 		{
+			/* wait for the worker to finish processing packets */
+			_process_packet_handler.destruct();
+
+			Genode::Lock::Guard guard(_lock);
+
 			Dataspace_capability ds = tx_sink()->dataspace();
 			Rump::env().env().ram().free(static_cap_cast<Ram_dataspace>(ds));
 			destroy(&_md_alloc, &_root);
@@ -200,6 +272,8 @@ class Rump_fs::Session_component : public Session_rpc_object
 
 		File_handle file(Dir_handle dir_handle, Name const &name, Mode mode, bool create)
 		{
+			Genode::Lock::Guard guard(_lock);
+
 			if (!valid_name(name.string()))
 				throw Invalid_name();
 
@@ -230,6 +304,8 @@ class Rump_fs::Session_component : public Session_rpc_object
 
 		Symlink_handle symlink(Dir_handle dir_handle, Name const &name, bool create)
 		{
+			Genode::Lock::Guard guard(_lock);
+
 			if (!File_system::supports_symlinks())
 				throw Permission_denied();
 
@@ -262,6 +338,8 @@ class Rump_fs::Session_component : public Session_rpc_object
 
 		Dir_handle dir(Path const &path, bool create)
 		{
+			Genode::Lock::Guard guard(_lock);
+
 			char const *path_str = path.string();
 			_assert_valid_path(path_str);
 
@@ -284,6 +362,8 @@ class Rump_fs::Session_component : public Session_rpc_object
 
 		Node_handle node(Path const &path)
 		{
+			Genode::Lock::Guard guard(_lock);
+
 			char const *path_str = path.string();
 
 			_assert_valid_path(path_str);
@@ -297,6 +377,8 @@ class Rump_fs::Session_component : public Session_rpc_object
 
 		void close(Node_handle handle)
 		{
+			Genode::Lock::Guard guard(_lock);
+
 			auto close_fn = [&] (Open_node &open_node) {
 				Node &node = open_node.node();
 				destroy(_md_alloc, &open_node);
@@ -312,6 +394,8 @@ class Rump_fs::Session_component : public Session_rpc_object
 
 		Status status(Node_handle node_handle)
 		{
+			Genode::Lock::Guard guard(_lock);
+
 			auto status_fn = [&] (Open_node &open_node) {
 				return open_node.node().status();
 			};
@@ -327,6 +411,8 @@ class Rump_fs::Session_component : public Session_rpc_object
 
 		void unlink(Dir_handle dir_handle, Name const &name)
 		{
+			Genode::Lock::Guard guard(_lock);
+
 			if (!valid_name(name.string()))
 				throw Invalid_name();
 
@@ -347,6 +433,8 @@ class Rump_fs::Session_component : public Session_rpc_object
 
 		void truncate(File_handle file_handle, file_size_t size)
 		{
+			Genode::Lock::Guard guard(_lock);
+
 			if (!_writable)
 				throw Permission_denied();
 
@@ -364,6 +452,8 @@ class Rump_fs::Session_component : public Session_rpc_object
 		void move(Dir_handle from_dir_handle, Name const &from_name,
 		          Dir_handle   to_dir_handle, Name const   &to_name)
 		{
+			Genode::Lock::Guard guard(_lock);
+
 			if (!_writable)
 				throw Permission_denied();
 
@@ -421,12 +511,42 @@ class Rump_fs::Root : public Root_component<Session_component>
 {
 	private:
 
+		enum { MAX_WORKERS = 32 };
+
 		Genode::Env &_env;
 
 		int _sessions { 0 };
 
 		Genode::Attached_rom_dataspace _config { _env, "config" };
 
+		/*
+		 * By default, there is one worker per virtual CPU of the rump
+		 * kernel
+		 */
+		unsigned const _num_workers {
+			max(1U, min((unsigned)MAX_WORKERS,
+			            _config.xml().attribute_value("threads",
+			            _config.xml().attribute_value("cpus", 1U)))) };
+
+		Constructible<Worker> _workers[MAX_WORKERS];
+
+		unsigned _next_worker { 0 };
+
+		/**
+		 * Select worker for a new session in a round-robin fashion
+		 */
+		Worker &_worker()
+		{
+			unsigned const i = _next_worker;
+			_next_worker = (_next_worker + 1) % _num_workers;
+
+			if (!_workers[i].constructed()) {
+				Genode::String<16> const name("rump_fs_ep", i);
+				_workers[i].construct(_env, name.string());
+			}
+			return *_workers[i];
+		}
+
 	protected:
 
 		Session_component *_create_session(const char *args)
@@ -504,7 +624,8 @@ class Rump_fs::Root : public Root_component<Session_component>
 
 			try {
 				return new (md_alloc())
-					Session_component(_env, tx_buf_size, root_dir, writeable, *md_alloc());
+					Session_component(_env, tx_buf_size, root_dir, writeable,
+					                  *md_alloc(), _worker());
 
 			} catch (Lookup_failed) {
 				Genode::error("File system root directory \"", root_dir, "\" does not exist");
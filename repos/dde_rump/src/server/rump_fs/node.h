@@ -91,6 +91,11 @@ class Rump_fs::Node : public Node_base
 		{
 			Genode::error(__PRETTY_FUNCTION__, " called on a non-file node");
 		}
+
+		/**
+		 * Write back dirty data of the node
+		 */
+		virtual void sync() { }
 };
 
 #endif /* _NODE_H_ */
@@ -0,0 +1,10 @@
+REQUIRES = linux
+
+INC_DIR  = $(REP_DIR)/src/server/cpu_sampler
+INC_DIR += $(BASE_DIR)/../base-linux/src/include
+
+SRC_CC = native_cpu.cc
+
+SHARED_LIB = yes
+
+vpath %.cc $(REP_DIR)/src/lib/cpu_sampler_platform-linux
@@ -0,0 +1,109 @@
+/*
+ * \brief  Linux-specific 'Native_cpu' setup
+ * \author Christian Prochaska
+ * \date   2017-11-29
+ *
+ * On Linux, each thread registers its PID and TID at core and requests
+ * the socket descriptors of entrypoints via the 'Native_cpu' interface.
+ * The thread capabilities passed as arguments refer to the threads of the
+ * CPU sampler and must be translated to the threads of the parent.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <linux_native_cpu/client.h>
+
+/* Cpu_sampler includes */
+#include "cpu_session_component.h"
+#include "cpu_thread_component.h"
+
+
+namespace Cpu_sampler {
+	class Native_cpu_component;
+}
+
+
+using namespace Genode;
+
+
+class Cpu_sampler::Native_cpu_component : public Rpc_object<Linux_native_cpu,
+                                                          Native_cpu_component>
+{
+	private:
+
+		Cpu_session_component   &_cpu_session_component;
+		Linux_native_cpu_client  _linux_native_cpu;
+
+		template <typename FN>
+		void _with_parent_thread(Thread_capability thread_cap, FN const &fn)
+		{
+			_cpu_session_component.thread_ep().apply(thread_cap,
+				[&] (Cpu_sampler::Cpu_thread_component *cpu_thread) {
+					if (cpu_thread)
+						fn(cpu_thread->parent_thread()); });
+		}
+
+	public:
+
+		Native_cpu_component(Cpu_session_component &cpu_session_component)
+		: _cpu_session_component(cpu_session_component),
+		  _linux_native_cpu(_cpu_session_component.parent_cpu_session().native_cpu())
+		{
+			_cpu_session_component.thread_ep().manage(this);
+		}
+
+		~Native_cpu_component()
+		{
+			_cpu_session_component.thread_ep().dissolve(this);
+		}
+
+		void thread_id(Thread_capability thread_cap, int pid, int tid) override
+		{
+			_with_parent_thread(thread_cap, [&] (Thread_capability parent) {
+				_linux_native_cpu.thread_id(parent, pid, tid); });
+		}
+
+		Untyped_capability server_sd(Thread_capability thread_cap) override
+		{
+			Untyped_capability sd;
+			_with_parent_thread(thread_cap, [&] (Thread_capability parent) {
+				sd = _linux_native_cpu.server_sd(parent); });
+			return sd;
+		}
+
+		Untyped_capability client_sd(Thread_capability thread_cap) override
+		{
+			Untyped_capability sd;
+			_with_parent_thread(thread_cap, [&] (Thread_capability parent) {
+				sd = _linux_native_cpu.client_sd(parent); });
+			return sd;
+		}
+};
+
+
+Capability<Cpu_session::Native_cpu>
+Cpu_sampler::Cpu_session_component::_setup_native_cpu()
+{
+	Native_cpu_component *native_cpu_component =
+		new (_md_alloc) Native_cpu_component(*this);
+
+	return native_cpu_component->cap();
+}
+
+
+void Cpu_sampler::Cpu_session_component::_cleanup_native_cpu()
+{
+	Native_cpu_component *native_cpu_component = nullptr;
+	_thread_ep.apply(_native_cpu_cap,
+	                 [&] (Native_cpu_component *c) { native_cpu_component = c; });
+
+	if (!native_cpu_component) return;
+
+	destroy(_md_alloc, native_cpu_component);
+}
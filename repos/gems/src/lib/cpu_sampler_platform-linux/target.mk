@@ -0,0 +1,2 @@
+TARGET = cpu_sampler_platform-linux
+LIBS   = cpu_sampler_platform-linux
@@ -0,0 +1,145 @@
+/*
+ * \brief  Aggregation of sampled call stacks
+ * \author Christian Prochaska
+ * \date   2017-11-29
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _CALL_GRAPH_H_
+#define _CALL_GRAPH_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <util/string.h>
+
+namespace Cpu_sampler {
+
+	using namespace Genode;
+
+	class Call_graph;
+}
+
+
+/**
+ * Table of distinct call stacks and their sample counts
+ *
+ * The table has a fixed capacity, which is allocated up front to keep the
+ * sampling path free from allocations. Samples of stacks that do not fit
+ * into the table anymore are merely counted as dropped.
+ */
+class Cpu_sampler::Call_graph
+{
+	public:
+
+		enum { MAX_DEPTH = 32 };
+
+		struct Stack
+		{
+			unsigned long count;
+			unsigned      depth;
+
+			/* function addresses, innermost frame first */
+			addr_t        frames[MAX_DEPTH];
+		};
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Call_graph(Call_graph const &);
+		Call_graph &operator = (Call_graph const &);
+
+		Allocator &_alloc;
+
+		unsigned const _capacity;
+		Stack  * const _stacks;
+
+		unsigned      _used    = 0;
+		unsigned long _dropped = 0;
+
+		static unsigned _hash(addr_t const *frames, unsigned depth)
+		{
+			unsigned long h = depth;
+			for (unsigned i = 0; i < depth; i++)
+				h = (h ^ frames[i]) * 0x9e3779b1UL;
+
+			return h ^ (h >> 16);
+		}
+
+	public:
+
+		Call_graph(Allocator &alloc, unsigned capacity)
+		:
+			_alloc(alloc), _capacity(capacity ? capacity : 1),
+			_stacks((Stack *)alloc.alloc(_capacity*sizeof(Stack)))
+		{
+			reset();
+		}
+
+		~Call_graph() { _alloc.free(_stacks, _capacity*sizeof(Stack)); }
+
+		unsigned      capacity() const { return _capacity; }
+		unsigned long dropped()  const { return _dropped;  }
+
+		void reset()
+		{
+			for (unsigned i = 0; i < _capacity; i++)
+				_stacks[i].count = 0;
+
+			_used    = 0;
+			_dropped = 0;
+		}
+
+		/**
+		 * Account one sample of the given call stack
+		 */
+		void add(addr_t const *frames, unsigned depth)
+		{
+			depth = min(depth, (unsigned)MAX_DEPTH);
+
+			/* open addressing with linear probing */
+			unsigned const start = _hash(frames, depth) % _capacity;
+			for (unsigned n = 0; n < _capacity; n++) {
+
+				Stack &s = _stacks[(start + n) % _capacity];
+
+				if (!s.count) {
+
+					/* leave one slot free to terminate the probing */
+					if (_used + 1 >= _capacity && _capacity > 1)
+						break;
+
+					s.count = 1;
+					s.depth = depth;
+					memcpy(s.frames, frames, depth*sizeof(addr_t));
+					_used++;
+					return;
+				}
+
+				if (s.depth == depth
+				 && !memcmp(s.frames, frames, depth*sizeof(addr_t))) {
+					s.count++;
+					return;
+				}
+			}
+
+			_dropped++;
+		}
+
+		template <typename FN>
+		void for_each(FN const &fn) const
+		{
+			for (unsigned i = 0; i < _capacity; i++)
+				if (_stacks[i].count)
+					fn(_stacks[i]);
+		}
+};
+
+#endif /* _CALL_GRAPH_H_ */
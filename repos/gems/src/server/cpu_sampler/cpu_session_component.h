@@ -19,9 +19,11 @@
 #include <base/rpc_server.h>
 #include <cpu_session/client.h>
 #include <os/session_policy.h>
+#include <util/reconstructible.h>
 
 /* local includes */
 #include "cpu_thread_component.h"
+#include "symbols.h"
 #include "thread_list_change_handler.h"
 
 namespace Cpu_sampler {
@@ -69,12 +71,29 @@ class Cpu_sampler::Cpu_session_component : public Rpc_object<Cpu_session>
 		Capability<Cpu_session::Native_cpu>      _setup_native_cpu();
 		void _cleanup_native_cpu();
 
+		Constructible<Symbolizer>                _symbolizer;
+
 	public:
 
 		Session_label &session_label() { return _session_label; }
+		Session_label const &session_label() const { return _session_label; }
 		Cpu_session_client &parent_cpu_session() { return _parent_cpu_session; }
 		Rpc_entrypoint &thread_ep() { return _thread_ep; }
 
+		/**
+		 * Return symbolizer for the ELF objects of the sampled component
+		 *
+		 * The symbolizer is created on first use because it requests the
+		 * ELF images of the binary and its shared libraries as ROM modules.
+		 */
+		Symbolizer &symbolizer(Elf_object::Name const &binary)
+		{
+			if (!_symbolizer.constructed() || _symbolizer->binary() != binary)
+				_symbolizer.construct(_env, _md_alloc, binary);
+
+			return *_symbolizer;
+		}
+
 		/**
 		 * Constructor
 		 */
@@ -13,6 +13,8 @@
 
 /* Genode includes */
 #include <base/snprintf.h>
+#include <pd_session/client.h>
+#include <region_map/client.h>
 
 /* local includes */
 #include "cpu_session_component.h"
@@ -39,7 +41,8 @@ Cpu_sampler::Cpu_thread_component::Cpu_thread_component(
                                                                 name,
                                                                 affinity,
                                                                 weight,
-                                                                utcb))
+                                                                utcb)),
+  _pd(pd)
 {
 	char label_buf[Session_label::size()];
 
@@ -62,10 +65,116 @@ Cpu_sampler::Cpu_thread_component::~Cpu_thread_component()
 {
 	flush();
 
+	if (_stack_window)
+		_env.rm().detach(_stack_window);
+
 	_cpu_session_component.thread_ep().dissolve(this);
 }
 
 
+/**
+ * Return local address of the stack-area slot containing 'sp'
+ *
+ * \return nullptr if 'sp' does not refer to the stack area or the stack
+ *         area of the sampled component is not accessible
+ */
+char const *Cpu_sampler::Cpu_thread_component::_stack_slot_local(addr_t sp)
+{
+	addr_t const area_base = Thread::stack_area_virtual_base();
+	size_t const slot_size = Thread::stack_virtual_size();
+
+	if (sp < area_base || sp - area_base >= Thread::stack_area_virtual_size())
+		return nullptr;
+
+	if (!_stack_area_requested) {
+		_stack_area_requested = true;
+		try {
+			Pd_session_client pd(_pd);
+			_stack_area_ds = Region_map_client(pd.stack_area()).dataspace();
+		} catch (...) { }
+	}
+
+	if (!_stack_area_ds.valid())
+		return nullptr;
+
+	addr_t const slot = sp & ~(slot_size - 1);
+
+	if (_stack_window && slot == _stack_slot)
+		return _stack_window;
+
+	if (_stack_window) {
+		_env.rm().detach(_stack_window);
+		_stack_window = nullptr;
+	}
+
+	try {
+		_stack_window = _env.rm().attach(_stack_area_ds, slot_size,
+		                                 slot - area_base);
+		_stack_slot   = slot;
+	} catch (...) {
+		warning("could not attach stack of thread ", _label);
+		_stack_area_ds = Dataspace_capability();
+	}
+
+	return _stack_window;
+}
+
+
+/**
+ * Walk the chain of frame pointers of the paused thread
+ *
+ * The first frame is the instruction pointer, the following frames are the
+ * return addresses minus one to refer to the call instruction. The walk is
+ * restricted to the part of the stack slot between the stack pointer and
+ * the top of the stack, which is backed by the stack dataspace.
+ */
+unsigned Cpu_sampler::Cpu_thread_component::_unwind(Thread_state const &state,
+                                                   addr_t *frames, unsigned max)
+{
+	if (!max)
+		return 0;
+
+	frames[0] = state.ip;
+
+#if defined(__x86_64__)
+	addr_t fp = state.rbp;
+#elif defined(__i386__)
+	addr_t fp = state.ebp;
+#else
+	addr_t fp = 0;
+#endif
+
+	char const * const local = _stack_slot_local(state.sp);
+	if (!local)
+		return 1;
+
+	/* spare the UTCB, which may be located at the top of the slot */
+	addr_t const limit = _stack_slot + Thread::stack_virtual_size()
+	                   - 2*4096 - 2*sizeof(addr_t);
+
+	unsigned depth = 1;
+	for (addr_t sp = state.sp; depth < max; depth++) {
+
+		if (fp < sp || fp > limit || (fp & (sizeof(addr_t) - 1)))
+			break;
+
+		addr_t const *frame = (addr_t const *)(local + (fp - _stack_slot));
+
+		addr_t const ret = frame[1];
+		if (!ret)
+			break;
+
+		frames[depth] = ret - 1;
+
+		/* frames must be located at increasing addresses */
+		sp = fp + 2*sizeof(addr_t);
+		fp = frame[0];
+	}
+
+	return depth;
+}
+
+
 void Cpu_sampler::Cpu_thread_component::take_sample()
 {
 	if (verbose_take_sample)
@@ -83,12 +192,34 @@ void Cpu_sampler::Cpu_thread_component::take_sample()
 
 		Thread_state thread_state = _parent_cpu_thread.state();
 
+		if (_config.format == Sample_config::RAW) {
+
+			_parent_cpu_thread.resume();
+
+			_sample_buf[_sample_buf_index++] = thread_state.ip;
+
+			if (_sample_buf_index == SAMPLE_BUF_SIZE)
+				flush();
+
+			return;
+		}
+
+		addr_t frames[Call_graph::MAX_DEPTH];
+
+		unsigned const depth =
+			_unwind(thread_state, frames, min(_config.stack_depth,
+			                                  (unsigned)Call_graph::MAX_DEPTH));
+
 		_parent_cpu_thread.resume();
 
-		_sample_buf[_sample_buf_index++] = thread_state.ip;
+		/* aggregate samples per function rather than per address */
+		Symbolizer &symbolizer =
+			_cpu_session_component.symbolizer(_config.binary);
+
+		for (unsigned i = 0; i < depth; i++)
+			frames[i] = symbolizer.function(frames[i]);
 
-		if (_sample_buf_index == SAMPLE_BUF_SIZE)
-			flush();
+		_call_graph->add(frames, depth);
 
 	} catch (Cpu_thread::State_access_failed) {
 
@@ -98,13 +229,34 @@ void Cpu_sampler::Cpu_thread_component::take_sample()
 }
 
 
-void Cpu_sampler::Cpu_thread_component::reset()
+void Cpu_sampler::Cpu_thread_component::reset(Sample_config const &config)
 {
+	_config           = config;
 	_sample_buf_index = 0;
+
+	if (_config.format == Sample_config::RAW) {
+		_call_graph.destruct();
+		return;
+	}
+
+	if (_call_graph.constructed()
+	 && _call_graph->capacity() == max(_config.max_stacks, 1U))
+		_call_graph->reset();
+	else
+		_call_graph.construct(_md_alloc, _config.max_stacks);
 }
 
 
 void Cpu_sampler::Cpu_thread_component::flush()
+{
+	if (_config.format == Sample_config::RAW)
+		_flush_raw();
+	else
+		_flush_folded();
+}
+
+
+void Cpu_sampler::Cpu_thread_component::_flush_raw()
 {
 	if (_sample_buf_index == 0)
 		return;
@@ -134,6 +286,99 @@ void Cpu_sampler::Cpu_thread_component::flush()
 }
 
 
+namespace Cpu_sampler { class Folded_line; }
+
+
+/**
+ * Writer of one line of folded call stacks to the LOG session
+ *
+ * A line may exceed the maximum length of a LOG string. Hence, it is
+ * written in pieces, each ending at a frame boundary, and only the last
+ * piece is terminated by a newline.
+ */
+class Cpu_sampler::Folded_line
+{
+	private:
+
+		enum { MAX_LEN = Log_session::MAX_STRING_LEN - 1 };
+
+		Log_session &_log;
+
+		char   _buf[MAX_LEN + 1];
+		size_t _len = 0;
+
+	public:
+
+		Folded_line(Log_session &log) : _log(log) { _buf[0] = 0; }
+
+		void flush()
+		{
+			if (!_len)
+				return;
+
+			_log.write(Log_session::String(_buf, _len + 1));
+			_len = 0;
+		}
+
+		template <typename... ARGS>
+		void append(ARGS &&... args)
+		{
+			String<MAX_LEN + 1> const piece(args...);
+
+			if (_len + piece.length() - 1 > MAX_LEN)
+				flush();
+
+			memcpy(_buf + _len, piece.string(), piece.length());
+			_len += piece.length() - 1;
+		}
+};
+
+
+void Cpu_sampler::Cpu_thread_component::_flush_folded()
+{
+	if (!_call_graph.constructed())
+		return;
+
+	bool empty = true;
+	_call_graph->for_each([&] (Call_graph::Stack const &) { empty = false; });
+	if (empty)
+		return;
+
+	if (!_log.constructed())
+		_log.construct(_env, _log_session_label);
+
+	Symbolizer &symbolizer = _cpu_session_component.symbolizer(_config.binary);
+
+	struct Function
+	{
+		Symbolizer const &symbolizer;
+		addr_t     const  addr;
+
+		void print(Output &out) const { symbolizer.print_function(out, addr); }
+	};
+
+	Folded_line line(*_log);
+
+	_call_graph->for_each([&] (Call_graph::Stack const &stack) {
+
+		line.append(_label);
+
+		/* the outermost frame comes first */
+		for (unsigned i = stack.depth; i > 0; i--)
+			line.append(";", Function { symbolizer, stack.frames[i - 1] });
+
+		line.append(" ", stack.count, "\n");
+		line.flush();
+	});
+
+	if (_call_graph->dropped())
+		warning(_label, ": dropped ", _call_graph->dropped(), " samples, "
+		        "increase 'max_stacks'");
+
+	_call_graph->reset();
+}
+
+
 Dataspace_capability
 Cpu_sampler::Cpu_thread_component::utcb()
 {
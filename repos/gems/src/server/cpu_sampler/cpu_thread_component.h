@@ -18,16 +18,41 @@
 #include <base/thread.h>
 #include <cpu_thread/client.h>
 #include <log_session/connection.h>
+#include <util/reconstructible.h>
 
 /* local includes */
+#include "call_graph.h"
 #include "cpu_session_component.h"
+#include "symbols.h"
 
 namespace Cpu_sampler {
 	using namespace Genode;
+	struct Sample_config;
 	class Cpu_thread_component;
 	class Cpu_session_component;
 }
 
+
+/**
+ * Sampling parameters of a thread as selected by the session policy
+ */
+struct Cpu_sampler::Sample_config
+{
+	/*
+	 * In the 'RAW' format, each sampled instruction pointer is written as
+	 * is. In the 'FOLDED' format, the sampled call stacks are aggregated
+	 * and written as one line per distinct stack with the symbolized
+	 * frames separated by ';' followed by the sample count, as expected
+	 * by flame-graph tools.
+	 */
+	enum Format { RAW, FOLDED };
+
+	Format           format      = RAW;
+	unsigned         stack_depth = 1;
+	unsigned         max_stacks  = 0;
+	Elf_object::Name binary { };
+};
+
 class Cpu_sampler::Cpu_thread_component : public Rpc_object<Cpu_thread>
 {
 	private:
@@ -41,6 +66,8 @@ class Cpu_sampler::Cpu_thread_component : public Rpc_object<Cpu_thread>
 
 		Cpu_thread_client      _parent_cpu_thread;
 
+		Pd_session_capability  _pd;
+
 		bool                   _started = false;
 
 		Session_label          _label;
@@ -51,6 +78,26 @@ class Cpu_sampler::Cpu_thread_component : public Rpc_object<Cpu_thread>
 
 		Constructible<Log_connection> _log;
 
+		Sample_config             _config { };
+		Constructible<Call_graph> _call_graph;
+
+		/*
+		 * The frames of the call stack are read from the sampled thread's
+		 * stack, which is made locally accessible by attaching the thread's
+		 * slot of the stack area of the sampled component.
+		 */
+		Dataspace_capability _stack_area_ds { };
+		bool                 _stack_area_requested = false;
+		addr_t               _stack_slot    = 0;
+		char                *_stack_window  = nullptr;
+
+		char const *_stack_slot_local(addr_t sp);
+
+		unsigned _unwind(Thread_state const &, addr_t *frames, unsigned max);
+
+		void _flush_raw();
+		void _flush_folded();
+
 	public:
 
 		Cpu_thread_component(Cpu_session_component   &cpu_session_component,
@@ -72,7 +119,7 @@ class Cpu_sampler::Cpu_thread_component : public Rpc_object<Cpu_thread>
 		Session_label &label() { return _label; }
 
 		void take_sample();
-		void reset();
+		void reset(Sample_config const &);
 		void flush();
 
 		/**************************
@@ -110,6 +110,33 @@ struct Cpu_sampler::Main : Thread_list_change_handler
 		{ env.ep(), *this, &Main::handle_config_update};
 
 
+	/**
+	 * Determine sampling parameters of a selected thread
+	 */
+	Sample_config sample_config(Xml_node policy,
+	                            Cpu_thread_component const &cpu_thread)
+	{
+		Xml_node const xml = config.xml();
+
+		Sample_config result;
+
+		if (xml.attribute_value("format", String<16>("raw")) != "folded")
+			return result;
+
+		result.format      = Sample_config::FOLDED;
+		result.stack_depth = xml.attribute_value("stack_depth", 16U);
+		result.max_stacks  = xml.attribute_value("max_stacks", 1024U);
+
+		/* by default, the binary is named after the sampled component */
+		Session_label const component =
+			cpu_thread.cpu_session_component()->session_label().last_element();
+
+		result.binary = policy.attribute_value("binary",
+		                                       Elf_object::Name(component.string()));
+		return result;
+	}
+
+
 	void thread_list_changed() override
 	{
 		/* clear selected_thread_list */
@@ -140,7 +167,7 @@ struct Cpu_sampler::Main : Thread_list_change_handler
 			try {
 
 				Session_policy policy(cpu_thread->label(), config.xml());
-				cpu_thread->reset();
+				cpu_thread->reset(sample_config(policy, *cpu_thread));
 				selected_thread_list.insert(new (&alloc)
 				                            Thread_element(cpu_thread));
 
@@ -0,0 +1,526 @@
+/*
+ * \brief  Symbol resolution for sampled addresses
+ * \author Christian Prochaska
+ * \date   2017-11-29
+ *
+ * The symbolizer resolves addresses of a sampled component by using the
+ * ELF images of the binary and its shared libraries, which are requested
+ * as ROM modules. The load addresses of the shared libraries are obtained
+ * by reproducing the link map of the dynamic linker: ldso places the binary
+ * at its link address at the start of the linker area and loads the needed
+ * libraries in depth-first order of their 'DT_NEEDED' entries, each at the
+ * next free page-aligned address. Libraries loaded at runtime via 'dlopen'
+ * are not covered.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SYMBOLS_H_
+#define _SYMBOLS_H_
+
+/* Genode includes */
+#include <base/attached_dataspace.h>
+#include <base/output.h>
+#include <rom_session/connection.h>
+#include <util/list.h>
+
+namespace Cpu_sampler {
+
+	using namespace Genode;
+
+	namespace Elf {
+
+		struct Ehdr;
+		struct Phdr;
+		struct Shdr;
+		struct Sym;
+		struct Dyn;
+
+		enum {
+			PT_LOAD     = 1,
+			SHT_SYMTAB  = 2,
+			SHT_DYNAMIC = 6,
+			SHT_DYNSYM  = 11,
+			STT_FUNC    = 2,
+			DT_NULL     = 0,
+			DT_NEEDED   = 1,
+		};
+	}
+
+	class Elf_object;
+	class Symbolizer;
+}
+
+
+#if __SIZEOF_POINTER__ == 8
+
+struct Cpu_sampler::Elf::Ehdr
+{
+	unsigned char ident[16];
+	uint16_t type, machine;
+	uint32_t version;
+	uint64_t entry, phoff, shoff;
+	uint32_t flags;
+	uint16_t ehsize, phentsize, phnum, shentsize, shnum, shstrndx;
+};
+
+struct Cpu_sampler::Elf::Phdr
+{
+	uint32_t type, flags;
+	uint64_t offset, vaddr, paddr, filesz, memsz, align;
+};
+
+struct Cpu_sampler::Elf::Shdr
+{
+	uint32_t name, type;
+	uint64_t flags, addr, offset, size;
+	uint32_t link, info;
+	uint64_t addralign, entsize;
+};
+
+struct Cpu_sampler::Elf::Sym
+{
+	uint32_t      name;
+	unsigned char info, other;
+	uint16_t      shndx;
+	uint64_t      value, size;
+};
+
+struct Cpu_sampler::Elf::Dyn { int64_t tag; uint64_t val; };
+
+#else
+
+struct Cpu_sampler::Elf::Ehdr
+{
+	unsigned char ident[16];
+	uint16_t type, machine;
+	uint32_t version;
+	uint32_t entry, phoff, shoff;
+	uint32_t flags;
+	uint16_t ehsize, phentsize, phnum, shentsize, shnum, shstrndx;
+};
+
+struct Cpu_sampler::Elf::Phdr
+{
+	uint32_t type, offset, vaddr, paddr, filesz, memsz, flags, align;
+};
+
+struct Cpu_sampler::Elf::Shdr
+{
+	uint32_t name, type, flags, addr, offset, size, link, info, addralign, entsize;
+};
+
+struct Cpu_sampler::Elf::Sym
+{
+	uint32_t      name, value, size;
+	unsigned char info, other;
+	uint16_t      shndx;
+};
+
+struct Cpu_sampler::Elf::Dyn { int32_t tag; uint32_t val; };
+
+#endif
+
+
+/**
+ * ELF image with its function symbols sorted by address
+ */
+class Cpu_sampler::Elf_object : public List<Elf_object>::Element
+{
+	public:
+
+		typedef String<64> Name;
+
+		struct Invalid { };
+
+		struct Symbol
+		{
+			addr_t      addr;  /* link address */
+			size_t      size;
+			char const *name;
+		};
+
+	private:
+
+		enum { PAGE_SIZE = 4096 };
+
+		Name const _name;
+
+		Allocator &_alloc;
+
+		Rom_connection     _rom;
+		Attached_dataspace _ds;
+
+		char const * const _image = _ds.local_addr<char const>();
+		size_t       const _image_size = _ds.size();
+
+		addr_t _link_start = 0;  /* page-aligned start of loadable segments */
+		size_t _size       = 0;  /* page-aligned size of loadable segments */
+		addr_t _base       = 0;  /* load address of '_link_start' */
+
+		Elf::Shdr const *_dynamic = nullptr;
+
+		Symbol   *_symbols     = nullptr;
+		unsigned  _num_symbols = 0;
+
+		template <typename T>
+		T const *_at(addr_t offset, size_t count = 1) const
+		{
+			if (offset > _image_size || count*sizeof(T) > _image_size - offset)
+				throw Invalid();
+
+			return (T const *)(_image + offset);
+		}
+
+		Elf::Ehdr const &_ehdr() const { return *_at<Elf::Ehdr>(0); }
+
+		Elf::Shdr const &_shdr(unsigned i) const
+		{
+			if (i >= _ehdr().shnum)
+				throw Invalid();
+
+			return *_at<Elf::Shdr>(_ehdr().shoff + i*_ehdr().shentsize);
+		}
+
+		char const *_string(Elf::Shdr const &strtab, size_t offset) const
+		{
+			if (offset >= strtab.size)
+				return "";
+
+			char const *s = _at<char>(strtab.offset + offset);
+
+			/* make sure that the string is terminated within the image */
+			for (char const *c = s; c < _image + _image_size; c++)
+				if (!*c) return s;
+
+			return "";
+		}
+
+		void _parse_segments()
+		{
+			Elf::Ehdr const &ehdr = _ehdr();
+
+			if (ehdr.ident[0] != 0x7f || ehdr.ident[1] != 'E'
+			 || ehdr.ident[2] != 'L'  || ehdr.ident[3] != 'F')
+				throw Invalid();
+
+			bool   first = true;
+			addr_t end   = 0;
+			for (unsigned i = 0; i < ehdr.phnum; i++) {
+
+				Elf::Phdr const &ph = *_at<Elf::Phdr>(ehdr.phoff + i*ehdr.phentsize);
+				if (ph.type != Elf::PT_LOAD)
+					continue;
+
+				if (first)
+					_link_start = ph.vaddr & ~(addr_t)(PAGE_SIZE - 1);
+
+				end   = ph.vaddr + ph.memsz;
+				first = false;
+			}
+
+			if (first)
+				throw Invalid();
+
+			_size = align_addr(end, 12) - _link_start;
+		}
+
+		template <typename FN>
+		void _for_each_function(Elf::Shdr const &symtab, FN const &fn) const
+		{
+			unsigned const count = symtab.size / symtab.entsize;
+
+			for (unsigned i = 0; i < count; i++) {
+				Elf::Sym const &sym =
+					*_at<Elf::Sym>(symtab.offset + i*symtab.entsize);
+
+				if ((sym.info & 0xf) == Elf::STT_FUNC && sym.value && sym.shndx)
+					fn(sym);
+			}
+		}
+
+		void _parse_symbols()
+		{
+			Elf::Shdr const *symtab = nullptr;
+
+			for (unsigned i = 0; i < _ehdr().shnum; i++) {
+				Elf::Shdr const &sh = _shdr(i);
+
+				/* prefer the complete symbol table over the dynamic one */
+				if (sh.type == Elf::SHT_SYMTAB
+				 || (sh.type == Elf::SHT_DYNSYM && !symtab))
+					symtab = &sh;
+
+				if (sh.type == Elf::SHT_DYNAMIC)
+					_dynamic = &sh;
+			}
+
+			if (!symtab || !symtab->entsize)
+				return;
+
+			Elf::Shdr const &strtab = _shdr(symtab->link);
+
+			_for_each_function(*symtab, [&] (Elf::Sym const &) { _num_symbols++; });
+
+			if (!_num_symbols)
+				return;
+
+			_symbols = (Symbol *)_alloc.alloc(_num_symbols*sizeof(Symbol));
+
+			unsigned i = 0;
+			_for_each_function(*symtab, [&] (Elf::Sym const &sym) {
+				_symbols[i++] = Symbol { (addr_t)sym.value, (size_t)sym.size,
+				                         _string(strtab, sym.name) }; });
+
+			/* shell sort by address */
+			for (unsigned gap = _num_symbols/2; gap; gap /= 2)
+				for (unsigned j = gap; j < _num_symbols; j++) {
+					Symbol const s = _symbols[j];
+					unsigned k = j;
+					for (; k >= gap && _symbols[k - gap].addr > s.addr; k -= gap)
+						_symbols[k] = _symbols[k - gap];
+					_symbols[k] = s;
+				}
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \throw Invalid
+		 * \throw Rom_connection::Rom_connection_failed
+		 */
+		Elf_object(Env &env, Allocator &alloc, Name const &name)
+		:
+			_name(name), _alloc(alloc),
+			_rom(env, name.string()), _ds(env.rm(), _rom.dataspace())
+		{
+			_parse_segments();
+			_parse_symbols();
+
+			_base = _link_start;
+		}
+
+		~Elf_object()
+		{
+			if (_symbols)
+				_alloc.free(_symbols, _num_symbols*sizeof(Symbol));
+		}
+
+		Name const &name() const { return _name; }
+
+		/**
+		 * Return true if the object is linked to address 0
+		 */
+		bool relocatable() const { return _link_start == 0; }
+
+		size_t size() const { return _size; }
+		addr_t base() const { return _base; }
+
+		void base(addr_t base) { _base = base; }
+
+		bool contains(addr_t addr) const {
+			return addr >= _base && addr - _base < _size; }
+
+		/**
+		 * Call 'fn' with the name of each needed shared object
+		 */
+		template <typename FN>
+		void for_each_needed(FN const &fn) const
+		{
+			if (!_dynamic || !_dynamic->entsize)
+				return;
+
+			Elf::Shdr const &strtab = _shdr(_dynamic->link);
+			unsigned  const  count  = _dynamic->size / _dynamic->entsize;
+
+			for (unsigned i = 0; i < count; i++) {
+				Elf::Dyn const &dyn =
+					*_at<Elf::Dyn>(_dynamic->offset + i*_dynamic->entsize);
+
+				if (dyn.tag == Elf::DT_NULL)
+					break;
+
+				if (dyn.tag == Elf::DT_NEEDED)
+					fn(Name(_string(strtab, dyn.val)));
+			}
+		}
+
+		/**
+		 * Look up function containing the load address 'addr'
+		 *
+		 * \return symbol or nullptr
+		 */
+		Symbol const *lookup(addr_t addr) const
+		{
+			addr_t const link_addr = addr - _base + _link_start;
+
+			/* find last symbol starting at or below 'link_addr' */
+			unsigned lo = 0, hi = _num_symbols;
+			while (lo < hi) {
+				unsigned const mid = (lo + hi)/2;
+				if (_symbols[mid].addr <= link_addr) lo = mid + 1;
+				else                                 hi = mid;
+			}
+
+			if (!lo)
+				return nullptr;
+
+			Symbol const &sym = _symbols[lo - 1];
+			if (sym.size && link_addr - sym.addr >= sym.size)
+				return nullptr;
+
+			return &sym;
+		}
+
+		/**
+		 * Translate link address of symbol to load address
+		 */
+		addr_t load_addr(Symbol const &sym) const {
+			return sym.addr - _link_start + _base; }
+};
+
+
+/**
+ * Symbol resolution for all ELF objects of one component
+ */
+class Cpu_sampler::Symbolizer
+{
+	private:
+
+		Env       &_env;
+		Allocator &_alloc;
+
+		Elf_object::Name const _binary;
+
+		List<Elf_object> _objects { };
+
+		addr_t _next_base = 0;
+
+		Elf_object *_lookup(Elf_object::Name const &name)
+		{
+			for (Elf_object *o = _objects.first(); o; o = o->next())
+				if (o->name() == name)
+					return o;
+
+			return nullptr;
+		}
+
+		Elf_object *_load(Elf_object::Name const &name)
+		{
+			try {
+				Elf_object *obj = new (_alloc) Elf_object(_env, _alloc, name);
+				_objects.insert(obj);
+				return obj;
+			}
+			catch (Elf_object::Invalid) {
+				warning("invalid ELF image '", name, "'"); }
+			catch (...) {
+				warning("could not obtain ELF image '", name, "'"); }
+
+			return nullptr;
+		}
+
+		/**
+		 * Load shared objects needed by 'obj' in the order used by ldso
+		 */
+		void _load_needed(Elf_object const &obj)
+		{
+			obj.for_each_needed([&] (Elf_object::Name const &name) {
+
+				if (_lookup(name))
+					return;
+
+				Elf_object *lib = _load(name);
+				if (!lib)
+					return;
+
+				lib->base(_next_base);
+				_next_base += lib->size();
+
+				_load_needed(*lib);
+			});
+		}
+
+	public:
+
+		Symbolizer(Env &env, Allocator &alloc, Elf_object::Name const &binary)
+		:
+			_env(env), _alloc(alloc), _binary(binary)
+		{
+			Elf_object *bin = _load(binary);
+			if (!bin)
+				return;
+
+			/* the dynamic linker remains at its link address */
+			Elf_object *ld = _load("ld.lib.so");
+			if (ld && ld->relocatable()) {
+				_objects.remove(ld);
+				destroy(_alloc, ld);
+			}
+
+			if (bin->relocatable()) {
+				warning("relocatable binary '", binary, "' is not supported");
+				return;
+			}
+
+			_next_base = bin->base() + bin->size();
+			_load_needed(*bin);
+		}
+
+		~Symbolizer()
+		{
+			while (Elf_object *o = _objects.first()) {
+				_objects.remove(o);
+				destroy(_alloc, o);
+			}
+		}
+
+		Elf_object::Name const &binary() const { return _binary; }
+
+		/**
+		 * Return start address of the function containing 'addr'
+		 *
+		 * If no function is known for 'addr', the address is returned as is.
+		 */
+		addr_t function(addr_t addr) const
+		{
+			for (Elf_object const *o = _objects.first(); o; o = o->next())
+				if (o->contains(addr)) {
+					Elf_object::Symbol const *sym = o->lookup(addr);
+					return sym ? o->load_addr(*sym) : addr;
+				}
+
+			return addr;
+		}
+
+		/**
+		 * Print name of function containing 'addr'
+		 */
+		void print_function(Output &out, addr_t addr) const
+		{
+			for (Elf_object const *o = _objects.first(); o; o = o->next()) {
+
+				if (!o->contains(addr))
+					continue;
+
+				if (Elf_object::Symbol const *sym = o->lookup(addr)) {
+					print(out, Cstring(sym->name));
+					return;
+				}
+
+				print(out, o->name(), "+", Hex(addr - o->base()));
+				return;
+			}
+
+			print(out, Hex(addr));
+		}
+};
+
+#endif /* _SYMBOLS_H_ */
@@ -16,6 +16,7 @@
 #include <base/log.h>
 #include <base/heap.h>
 #include <framebuffer_session/connection.h>
+#include <framebuffer_session/damage_ring.h>
 #include <input_session/connection.h>
 #include <timer_session/connection.h>
 #include <root/component.h>
@@ -174,62 +175,239 @@ inline void draw_glyph(Color                fg_color,
 }
 
 
+/**
+ * Cache of pre-rendered glyph tiles
+ *
+ * Each tile holds the pixels of a complete character cell for a given
+ * font, foreground color, and background color. Rendering a character
+ * thereby becomes a plain copy of the tile to the framebuffer. The cache
+ * is direct mapped. A tile evicted by a colliding glyph is rendered again
+ * when needed.
+ */
 template <typename PT>
-static void convert_char_array_to_pixels(Cell_array<Char_cell> *cell_array,
-                                         PT                    *fb_base,
-                                         unsigned               fb_width,
-                                         unsigned               fb_height,
-                                         Font_family const     &font_family)
+class Glyph_cache
 {
-	Font const &regular_font = *font_family.font(Font_face::REGULAR);
-	unsigned glyph_height = regular_font.img_h,
-	         glyph_step_x = regular_font.wtab['m'];
+	private:
 
-	unsigned y = 0;
-	for (unsigned line = 0; line < cell_array->num_lines(); line++) {
+		enum { NUM_SLOTS = 512 };
 
-		if (cell_array->line_dirty(line)) {
+		struct Key
+		{
+			Font const    *font;
+			PT             fg, bg;
+			unsigned char  ascii;
 
-			if (verbose)
-				Genode::log("convert line ", line);
+			bool operator == (Key const &other) const
+			{
+				return font     == other.font
+				    && fg.pixel == other.fg.pixel
+				    && bg.pixel == other.bg.pixel
+				    && ascii    == other.ascii;
+			}
+		};
 
-			unsigned x = 0;
-			for (unsigned column = 0; column < cell_array->num_cols(); column++) {
+		struct Slot
+		{
+			Key  key;
+			bool valid;
+		};
 
-				Char_cell      cell  = cell_array->get_cell(column, line);
-				Font const    *font  = font_family.font(cell.font_face());
-				unsigned char  ascii = cell.ascii;
+		Genode::Allocator &_alloc;
 
-				if (ascii == 0)
-					ascii = ' ';
+		unsigned const _cell_width;
+		unsigned const _cell_height;
 
-				unsigned char const *glyph_base  = font->img + font->otab[ascii];
+		Slot *_slots;
+		PT   *_tiles;
 
-				unsigned glyph_width = regular_font.wtab[ascii];
+		static unsigned _index(Key const &key)
+		{
+			Genode::uint32_t hash = key.ascii;
+			hash = hash*31 + key.fg.pixel;
+			hash = hash*31 + key.bg.pixel;
+			hash = hash*31 + (Genode::uint32_t)(Genode::addr_t)key.font;
+			hash *= 2654435761u;
 
-				if (x + glyph_width > fb_width)	break;
+			return (hash >> 16) % NUM_SLOTS;
+		}
 
-				Color fg_color = foreground_color(cell);
-				Color bg_color = background_color(cell);
+		PT *_tile(unsigned index) {
+			return _tiles + index*_cell_width*_cell_height; }
 
-				if (cell.has_cursor()) {
-					fg_color = Color( 63,  63,  63);
-					bg_color = Color(255, 255, 255);
-				}
+	public:
+
+		Glyph_cache(Genode::Allocator &alloc,
+		            unsigned cell_width, unsigned cell_height)
+		:
+			_alloc(alloc), _cell_width(cell_width), _cell_height(cell_height),
+			_slots(new (alloc) Slot[NUM_SLOTS]),
+			_tiles((PT *)alloc.alloc(NUM_SLOTS*cell_width*cell_height*sizeof(PT)))
+		{
+			for (unsigned i = 0; i < NUM_SLOTS; i++)
+				_slots[i].valid = false;
+		}
+
+		~Glyph_cache()
+		{
+			_alloc.free(_tiles, NUM_SLOTS*_cell_width*_cell_height*sizeof(PT));
+			Genode::destroy(_alloc, _slots);
+		}
+
+		unsigned cell_width()  const { return _cell_width;  }
+		unsigned cell_height() const { return _cell_height; }
+
+		/**
+		 * Return tile of 'cell_width' x 'cell_height' pixels for the glyph
+		 */
+		PT const *tile(Font const &font, Color fg_color, Color bg_color,
+		               unsigned char ascii)
+		{
+			Key const key { &font, PT(fg_color.r, fg_color.g, fg_color.b),
+			                PT(bg_color.r, bg_color.g, bg_color.b), ascii };
+
+			unsigned const index = _index(key);
+			Slot          &slot  = _slots[index];
+			PT            *tile  = _tile(index);
+
+			if (slot.valid && slot.key == key)
+				return tile;
+
+			unsigned const glyph_width = Genode::min((unsigned)font.wtab[ascii],
+			                                         _cell_width);
+			unsigned const glyph_height = Genode::min((unsigned)font.img_h,
+			                                          _cell_height);
+
+			/* clear pixels not covered by the glyph image */
+			for (unsigned i = 0; i < _cell_width*_cell_height; i++)
+				tile[i] = key.bg;
+
+			draw_glyph<PT>(fg_color, bg_color,
+			               font.img + font.otab[ascii], glyph_width,
+			               (unsigned)font.img_w, glyph_height,
+			               _cell_width, tile, _cell_width);
+
+			slot.key   = key;
+			slot.valid = true;
+			return tile;
+		}
+};
 
-				draw_glyph<PT>(fg_color, bg_color,
-				               glyph_base, glyph_width,
-				               (unsigned)font->img_w, (unsigned)font->img_h,
-				               glyph_step_x, fb_base + x, fb_width);
 
-				x += glyph_step_x;
+/**
+ * Rectangle of character cells
+ */
+struct Cell_rect
+{
+	int x1 =  10000, y1 =  10000,
+	    x2 = -10000, y2 = -10000;
+
+	bool valid() const { return x1 <= x2 && y1 <= y2; }
+
+	void extend(int x1_, int y1_, int x2_, int y2_)
+	{
+		x1 = Genode::min(x1, x1_); y1 = Genode::min(y1, y1_);
+		x2 = Genode::max(x2, x2_); y2 = Genode::max(y2, y2_);
+	}
+};
+
+
+/**
+ * Move the rendered lines of a scroll region
+ *
+ * Instead of rendering all lines of the scroll region again, the pixels of
+ * the lines that remain visible are moved within the framebuffer. Only the
+ * lines exposed by the scroll operation are marked as dirty by the cell
+ * array.
+ */
+template <typename PT>
+static void scroll_pixels(Cell_array<Char_cell>::Scroll const &scroll,
+                          PT *fb_base, unsigned fb_width, unsigned cell_height)
+{
+	Genode::size_t const line_size = fb_width*cell_height;
+	unsigned       const moved     = Genode::abs(scroll.lines);
+	unsigned       const remaining = scroll.end - scroll.start + 1 - moved;
+
+	PT *start = fb_base + scroll.start*line_size;
+	PT *src   = scroll.lines > 0 ? start + moved*line_size : start;
+	PT *dst   = scroll.lines > 0 ? start : start + moved*line_size;
+
+	Genode::memmove(dst, src, remaining*line_size*sizeof(PT));
+}
+
+
+template <typename PT>
+static Cell_rect convert_char_array_to_pixels(Cell_array<Char_cell> *cell_array,
+                                              PT                    *fb_base,
+                                              unsigned               fb_width,
+                                              unsigned               fb_height,
+                                              Font_family const     &font_family,
+                                              Glyph_cache<PT>       &glyph_cache)
+{
+	unsigned const cell_width  = glyph_cache.cell_width(),
+	               cell_height = glyph_cache.cell_height();
+
+	Cell_rect dirty;
+
+	cell_array->apply_scroll([&] (Cell_array<Char_cell>::Scroll const &scroll) {
+
+		if (verbose)
+			Genode::log("scroll lines ", scroll.start, "..", scroll.end,
+			            " by ", scroll.lines);
+
+		scroll_pixels(scroll, fb_base, fb_width, cell_height);
+		dirty.extend(0, scroll.start, cell_array->num_cols() - 1, scroll.end);
+	});
+
+	unsigned const num_cols = Genode::min(cell_array->num_cols(),
+	                                      fb_width/cell_width);
+	unsigned const num_lines = Genode::min(cell_array->num_lines(),
+	                                       fb_height/cell_height);
+
+	for (unsigned line = 0; line < num_lines; line++) {
+
+		Cell_array<Char_cell>::Span const span = cell_array->dirty_span(line);
+		if (span.empty())
+			continue;
+
+		if (verbose)
+			Genode::log("convert line ", line, " columns ", span.first, "..", span.last);
+
+		unsigned const last = Genode::min((unsigned)span.last, num_cols - 1);
+
+		PT *line_base = fb_base + line*cell_height*fb_width;
+
+		for (unsigned column = span.first; column <= last; column++) {
+
+			Char_cell      cell  = cell_array->get_cell(column, line);
+			unsigned char  ascii = cell.ascii;
+
+			if (ascii == 0)
+				ascii = ' ';
+
+			Color fg_color = foreground_color(cell);
+			Color bg_color = background_color(cell);
+
+			if (cell.has_cursor()) {
+				fg_color = Color( 63,  63,  63);
+				bg_color = Color(255, 255, 255);
+			}
+
+			PT const *src = glyph_cache.tile(*font_family.font(cell.font_face()),
+			                                 fg_color, bg_color, ascii);
+			PT       *dst = line_base + column*cell_width;
+
+			for (unsigned y = 0; y < cell_height; y++) {
+				Genode::memcpy(dst, src, cell_width*sizeof(PT));
+				src += cell_width;
+				dst += fb_width;
 			}
 		}
-		y       += glyph_height;
-		fb_base += fb_width*glyph_height;
 
-		if (y + glyph_height > fb_height) break;
+		dirty.extend(span.first, line, last, line);
+		cell_array->mark_line_as_clean(line);
 	}
+
+	return dirty;
 }
 
 
@@ -281,6 +459,7 @@ namespace Terminal {
 
 			Read_buffer                   &_read_buffer;
 			Framebuffer::Session          &_framebuffer;
+			Framebuffer::Damage_reporter  &_damage_reporter;
 
 			Flush_callback_registry       &_flush_callback_registry;
 			Trigger_flush_callback        &_trigger_flush_callback;
@@ -305,6 +484,7 @@ namespace Terminal {
 			Terminal::Position               _last_cursor_pos;
 
 			Font_family const               &_font_family;
+			Glyph_cache<Pixel_rgb565>       &_glyph_cache;
 
 			/**
 			 * Initialize framebuffer-related attributes
@@ -328,12 +508,15 @@ namespace Terminal {
 			                  Genode::Allocator       &alloc,
 			                  Read_buffer             &read_buffer,
 			                  Framebuffer::Session    &framebuffer,
+			                  Framebuffer::Damage_reporter &damage_reporter,
 			                  Genode::size_t           io_buffer_size,
 			                  Flush_callback_registry &flush_callback_registry,
 			                  Trigger_flush_callback  &trigger_flush_callback,
-			                  Font_family const       &font_family)
+			                  Font_family const       &font_family,
+			                  Glyph_cache<Pixel_rgb565> &glyph_cache)
 			:
 				_read_buffer(read_buffer), _framebuffer(framebuffer),
+				_damage_reporter(damage_reporter),
 				_flush_callback_registry(flush_callback_registry),
 				_trigger_flush_callback(trigger_flush_callback),
 				_io_buffer(env.ram(), env.rm(), io_buffer_size),
@@ -353,16 +536,20 @@ namespace Terminal {
 				_char_cell_array_character_screen(_char_cell_array),
 				_decoder(_char_cell_array_character_screen),
 
-				_font_family(font_family)
+				_font_family(font_family),
+				_glyph_cache(glyph_cache)
 			{
 				using namespace Genode;
 
+				/* scroll by moving pixels within the framebuffer */
+				_char_cell_array.track_scrolling(true);
+
 				log("new terminal session:");
 				log("  framebuffer has mode ", _fb_mode);
 				log("  character size is ", _char_width, "x", _char_height, " pixels");
 				log("  terminal size is ", _columns, "x", _lines, " characters");
 
-				framebuffer.refresh(0, 0, _fb_mode.width(), _fb_mode.height());
+				_damage_reporter.refresh(0, 0, _fb_mode.width(), _fb_mode.height());
 
 				_flush_callback_registry.add(this);
 			}
@@ -376,30 +563,19 @@ namespace Terminal {
 			{
 				Genode::Lock::Guard guard(_lock);
 
-				convert_char_array_to_pixels<Pixel_rgb565>(&_char_cell_array,
-				                                           (Pixel_rgb565 *)_fb_addr,
-				                                           _fb_mode.width(),
-				                                           _fb_mode.height(),
-				                                           _font_family);
-
-				
-				int first_dirty_line =  10000,
-				    last_dirty_line  = -10000;
-
-				for (int line = 0; line < (int)_char_cell_array.num_lines(); line++) {
-					if (!_char_cell_array.line_dirty(line)) continue;
-
-					first_dirty_line = Genode::min(line, first_dirty_line);
-					last_dirty_line  = Genode::max(line, last_dirty_line);
-
-					_char_cell_array.mark_line_as_clean(line);
-				}
-
-				int num_dirty_lines = last_dirty_line - first_dirty_line + 1;
-				if (num_dirty_lines > 0)
-					_framebuffer.refresh(0, first_dirty_line*_char_height,
-					                     _fb_mode.width(),
-					                     num_dirty_lines*_char_height);
+				Cell_rect const dirty =
+					convert_char_array_to_pixels<Pixel_rgb565>(&_char_cell_array,
+					                                           (Pixel_rgb565 *)_fb_addr,
+					                                           _fb_mode.width(),
+					                                           _fb_mode.height(),
+					                                           _font_family,
+					                                           _glyph_cache);
+				if (!dirty.valid())
+					return;
+
+				_damage_reporter.refresh(dirty.x1*_char_width, dirty.y1*_char_height,
+				                         (dirty.x2 - dirty.x1 + 1)*_char_width,
+				                         (dirty.y2 - dirty.y1 + 1)*_char_height);
 			}
 
 
@@ -476,6 +652,12 @@ namespace Terminal {
 			Trigger_flush_callback  &_trigger_flush_callback;
 			Font_family const       &_font_family;
 
+			/* damaged regions are reported without RPC if supported */
+			Framebuffer::Damage_reporter _damage_reporter { _env.rm(), _framebuffer };
+
+			/* glyph tiles are shared by all sessions */
+			Glyph_cache<Pixel_rgb565> _glyph_cache;
+
 		protected:
 
 			Session_component *_create_session(const char *args)
@@ -491,10 +673,12 @@ namespace Terminal {
 					Session_component(_env, *md_alloc(),
 					                  _read_buffer,
 					                  _framebuffer,
+					                  _damage_reporter,
 					                  io_buffer_size,
 					                  _flush_callback_registry,
 					                  _trigger_flush_callback,
-					                  _font_family);
+					                  _font_family,
+					                  _glyph_cache);
 			}
 
 		public:
@@ -515,7 +699,9 @@ namespace Terminal {
 				_read_buffer(read_buffer), _framebuffer(framebuffer),
 				_flush_callback_registry(flush_callback_registry),
 				_trigger_flush_callback(trigger_flush_callback),
-				_font_family(font_family)
+				_font_family(font_family),
+				_glyph_cache(md_alloc, font_family.cell_width(),
+				             font_family.cell_height())
 			{ }
 	};
 }
@@ -1,3 +1,4 @@
 TARGET = test-cpu_sampler
 SRC_CC = main.cc
 LIBS   = base
+CC_OPT += -fno-omit-frame-pointer
@@ -0,0 +1,118 @@
+/*
+ * \brief  Throughput benchmark of a terminal session
+ * \author Norman Feske
+ * \date   2017-11-28
+ *
+ * The test writes lines of text to the terminal, which scrolls the
+ * screen once per line, and reports the throughput in MiB of text per
+ * second. With 'colored="yes"', each word is preceded by an escape
+ * sequence that changes the foreground color.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/log.h>
+#include <terminal_session/connection.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+	struct Main;
+	using namespace Genode;
+}
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Timer::Connection    _timer    { _env };
+	Terminal::Connection _terminal { _env };
+
+	size_t const _total { _config.xml().attribute_value("size",
+	                      Number_of_bytes(16*1024*1024)) };
+
+	unsigned const _line_length { max(_config.xml().attribute_value("line_length", 72U), 2U) };
+
+	bool const _colored { _config.xml().attribute_value("colored", false) };
+
+	enum { BUF_SIZE = 4096 };
+
+	char   _buf[BUF_SIZE];
+	size_t _buf_len = 0;
+
+	void _flush()
+	{
+		_terminal.write(_buf, _buf_len);
+		_buf_len = 0;
+	}
+
+	void _put(char c)
+	{
+		if (_buf_len == BUF_SIZE)
+			_flush();
+
+		_buf[_buf_len++] = c;
+	}
+
+	/**
+	 * Produce one line of text
+	 *
+	 * \return number of bytes written to the terminal
+	 */
+	size_t _line(unsigned n)
+	{
+		size_t bytes = 0;
+		auto put = [&] (char c) { _put(c); bytes++; };
+
+		for (unsigned col = 0; col < _line_length - 2; col++) {
+
+			unsigned const word = (n + col) / 8;
+
+			/* select foreground color at the start of each word */
+			if (_colored && (n + col) % 8 == 0) {
+				put('\033'); put('['); put('3'); put('0' + word % 8); put('m');
+			}
+
+			put((n + col) % 8 == 7 ? ' ' : 'a' + (n + col + word) % 26);
+		}
+		put('\r'); put('\n');
+		return bytes;
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- terminal throughput test ---");
+		log("size: ", _total, " bytes, line length: ", _line_length,
+		    _colored ? ", colored" : "");
+
+		unsigned long const start_ms = _timer.elapsed_ms();
+
+		size_t written = 0;
+		for (unsigned n = 0; written < _total; n++)
+			written += _line(n);
+		_flush();
+
+		unsigned long const duration_ms = max(_timer.elapsed_ms() - start_ms, 1UL);
+
+		/* report MiB/s with one decimal place */
+		unsigned long const kib_per_s = (unsigned long)((written / 1024) * 1000 / duration_ms);
+
+		log("wrote ", written, " bytes in ", duration_ms, " ms (",
+		    kib_per_s / 1024, ".", (kib_per_s % 1024) * 10 / 1024, " MiB/s)");
+		log("--- finished terminal throughput test ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
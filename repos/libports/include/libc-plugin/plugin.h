@@ -21,6 +21,7 @@
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <sys/mount.h>  /* for 'struct statfs' */
 
 namespace Genode { class Env; }
@@ -116,6 +117,14 @@ namespace Libc {
 			virtual File_descriptor *open(const char *pathname, int flags);
 			virtual int pipe(File_descriptor *pipefd[2]);
 			virtual ssize_t read(File_descriptor *, void *buf, ::size_t count);
+
+			/**
+			 * Read into sequence of buffers
+			 *
+			 * The default implementation calls 'read' for each buffer.
+			 */
+			virtual ssize_t readv(File_descriptor *, const struct iovec *iov,
+			                      int iovcnt);
 			virtual ssize_t readlink(const char *path, char *buf, ::size_t bufsiz);
 			virtual ssize_t recv(File_descriptor *, void *buf, ::size_t len, int flags);
 			virtual ssize_t recvfrom(File_descriptor *, void *buf, ::size_t len, int flags,
@@ -126,6 +135,7 @@ namespace Libc {
 			virtual int select(int nfds, fd_set *readfds, fd_set *writefds,
 			                   fd_set *exceptfds, struct timeval *timeout);
 			virtual ssize_t send(File_descriptor *, const void *buf, ::size_t len, int flags);
+			virtual ssize_t sendmsg(File_descriptor *, const struct msghdr *msg, int flags);
 			virtual ssize_t sendto(File_descriptor *, const void *buf,
 			                       ::size_t len, int flags,
 			                       const struct sockaddr *dest_addr,
@@ -139,6 +149,14 @@ namespace Libc {
 			virtual int symlink(const char *oldpath, const char *newpath);
 			virtual int unlink(const char *path);
 			virtual ssize_t write(File_descriptor *, const void *buf, ::size_t count);
+
+			/**
+			 * Write sequence of buffers
+			 *
+			 * The default implementation calls 'write' for each buffer.
+			 */
+			virtual ssize_t writev(File_descriptor *, const struct iovec *iov,
+			                       int iovcnt);
 	};
 }
 
@@ -0,0 +1,223 @@
+/*
+ * \brief  POSIX asynchronous I/O
+ * \author Christian Helmuth
+ * \date   2017-11-27
+ *
+ * Requests on files of the VFS are handed over to the VFS plugin, which
+ * queues reads at the VFS and completes them in the background. Requests
+ * on file descriptors of other plugins are completed synchronously.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* libc plugin interface */
+#include <libc-plugin/fd_alloc.h>
+#include <vfs_plugin.h>
+
+/* libc-internal includes */
+#include "libc_errno.h"
+#include "task.h"
+
+using namespace Libc;
+
+
+static Vfs_plugin *vfs_plugin(File_descriptor *fd)
+{
+	return dynamic_cast<Vfs_plugin *>(fd->plugin);
+}
+
+
+static void complete(struct aiocb *cb, ssize_t result)
+{
+	cb->_aiocb_private.status = result;
+	cb->_aiocb_private.error  = result < 0 ? errno : 0;
+}
+
+
+/**
+ * Return true if the request has not completed yet
+ */
+static bool in_progress(struct aiocb const *cb)
+{
+	if (cb->_aiocb_private.error != EINPROGRESS)
+		return false;
+
+	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(cb->aio_fildes);
+	if (fd && vfs_plugin(fd))
+		vfs_plugin(fd)->aio_progress(fd);
+
+	return cb->_aiocb_private.error == EINPROGRESS;
+}
+
+
+extern "C" int aio_read(struct aiocb *cb)
+{
+	if (cb->aio_sigevent.sigev_notify != SIGEV_NONE)
+		return Errno(EINVAL);
+
+	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(cb->aio_fildes);
+	if (!fd)
+		return Errno(EBADF);
+
+	if (vfs_plugin(fd))
+		return vfs_plugin(fd)->aio_read(fd, cb);
+
+	complete(cb, pread(cb->aio_fildes, (void *)cb->aio_buf, cb->aio_nbytes,
+	                   cb->aio_offset));
+	return 0;
+}
+
+
+extern "C" int aio_write(struct aiocb *cb)
+{
+	if (cb->aio_sigevent.sigev_notify != SIGEV_NONE)
+		return Errno(EINVAL);
+
+	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(cb->aio_fildes);
+	if (!fd)
+		return Errno(EBADF);
+
+	if (vfs_plugin(fd))
+		return vfs_plugin(fd)->aio_write(fd, cb);
+
+	complete(cb, pwrite(cb->aio_fildes, (void const *)cb->aio_buf,
+	                    cb->aio_nbytes, cb->aio_offset));
+	return 0;
+}
+
+
+extern "C" int aio_fsync(int op, struct aiocb *cb)
+{
+	if (op != O_SYNC)
+		return Errno(EINVAL);
+
+	/* writes are passed to the file system on submission */
+	complete(cb, fsync(cb->aio_fildes));
+	return 0;
+}
+
+
+extern "C" int aio_error(const struct aiocb *cb)
+{
+	return in_progress(cb) ? EINPROGRESS : cb->_aiocb_private.error;
+}
+
+
+extern "C" ssize_t aio_return(struct aiocb *cb)
+{
+	if (in_progress(cb))
+		return Errno(EINVAL);
+
+	return cb->_aiocb_private.status;
+}
+
+
+extern "C" int aio_cancel(int libc_fd, struct aiocb *cb)
+{
+	File_descriptor *fd = file_descriptor_allocator()->find_by_libc_fd(libc_fd);
+	if (!fd)
+		return Errno(EBADF);
+
+	return vfs_plugin(fd) ? vfs_plugin(fd)->aio_cancel(fd, cb) : AIO_ALLDONE;
+}
+
+
+extern "C" int aio_suspend(const struct aiocb * const list[], int nent,
+                           const struct timespec *timeout)
+{
+	struct Check : Suspend_functor
+	{
+		const struct aiocb * const *list;
+		int                         nent;
+
+		Check(const struct aiocb * const *list, int nent)
+		: list(list), nent(nent) { }
+
+		bool suspend() override
+		{
+			for (int i = 0; i < nent; i++)
+				if (list[i] && !in_progress(list[i]))
+					return false;
+
+			return true;
+		}
+	} check(list, nent);
+
+	unsigned long timeout_ms = timeout ? timeout->tv_sec*1000
+	                                   + timeout->tv_nsec/1000000 : 0;
+
+	/* poll only */
+	if (timeout && !timeout_ms)
+		return check.suspend() ? Errno(EAGAIN) : 0;
+
+	while (check.suspend()) {
+		timeout_ms = Libc::suspend(check, timeout_ms);
+
+		if (timeout && !timeout_ms && check.suspend())
+			return Errno(EAGAIN);
+	}
+	return 0;
+}
+
+
+extern "C" int lio_listio(int mode, struct aiocb * const list[], int nent,
+                          struct sigevent *sig)
+{
+	if (mode != LIO_WAIT && mode != LIO_NOWAIT)
+		return Errno(EINVAL);
+
+	if (mode == LIO_NOWAIT && sig && sig->sigev_notify != SIGEV_NONE)
+		return Errno(EINVAL);
+
+	bool failed = false;
+
+	for (int i = 0; i < nent; i++) {
+
+		if (!list[i])
+			continue;
+
+		switch (list[i]->aio_lio_opcode) {
+		case LIO_READ:  failed |= (aio_read(list[i])  == -1); break;
+		case LIO_WRITE: failed |= (aio_write(list[i]) == -1); break;
+		default:                                               break;
+		}
+	}
+
+	if (mode == LIO_WAIT) {
+
+		struct Check : Suspend_functor
+		{
+			struct aiocb * const *list;
+			int                   nent;
+
+			Check(struct aiocb * const *list, int nent)
+			: list(list), nent(nent) { }
+
+			bool suspend() override
+			{
+				for (int i = 0; i < nent; i++)
+					if (list[i] && list[i]->aio_lio_opcode != LIO_NOP
+					 && in_progress(list[i]))
+						return true;
+
+				return false;
+			}
+		} check(list, nent);
+
+		while (check.suspend())
+			Libc::suspend(check);
+	}
+
+	return failed ? Errno(EIO) : 0;
+}
@@ -443,7 +443,8 @@ extern "C" void *mmap(void *addr, ::size_t length, int prot, int flags,
 	}
 
 	void *start = fd->plugin->mmap(addr, length, prot, flags, fd, offset);
-	mmap_registry()->insert(start, length, fd->plugin);
+	if (start != MAP_FAILED)
+		mmap_registry()->insert(start, length, fd->plugin);
 	return start;
 }
 
@@ -480,9 +481,10 @@ extern "C" int munmap(void *start, ::size_t length)
 
 extern "C" int msync(void *start, ::size_t len, int flags)
 {
-	if (!mmap_registry()->registered(start)) {
-		Genode::warning("munmap: could not lookup plugin for address ", start);
-		errno = EINVAL;
+	/* the range to synchronize may start within a mapped region */
+	if (!mmap_registry()->registered_range(start)) {
+		Genode::warning("msync: could not lookup plugin for address ", start);
+		errno = ENOMEM;
 		return -1;
 	}
 
@@ -491,7 +493,7 @@ extern "C" int msync(void *start, ::size_t len, int flags)
 	 *
 	 * If the pointer is NULL, 'start' refers to an anonymous mmap.
 	 */
-	Plugin *plugin = mmap_registry()->lookup_plugin_by_addr(start);
+	Plugin *plugin = mmap_registry()->lookup_plugin_by_range(start);
 
 	int ret = 0;
 	if (plugin)
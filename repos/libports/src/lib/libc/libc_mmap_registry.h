@@ -36,11 +36,18 @@ class Libc::Mmap_registry
 
 		struct Entry : Genode::List<Entry>::Element
 		{
-			void   * const start;
-			Plugin * const plugin;
+			void          * const start;
+			Genode::size_t  const len;
+			Plugin        * const plugin;
 
-			Entry(void *start, Plugin *plugin)
-			: start(start), plugin(plugin) { }
+			Entry(void *start, Genode::size_t len, Plugin *plugin)
+			: start(start), len(len), plugin(plugin) { }
+
+			bool contains(void const *addr) const
+			{
+				return (char const *)addr >= (char const *)start
+				    && (char const *)addr -  (char const *)start < (long)len;
+			}
 		};
 
 	private:
@@ -64,6 +71,15 @@ class Libc::Mmap_registry
 			return 0;
 		}
 
+		Entry const *_lookup_by_range_unsynchronized(void const * const addr) const
+		{
+			for (Entry const *curr = _list.first(); curr; curr = curr->next())
+				if (curr->contains(addr))
+					return curr;
+
+			return 0;
+		}
+
 		Entry const *_lookup_by_addr_unsynchronized(void * const start) const
 		{
 			return _lookup_by_addr_unsynchronized(_list.first(), start);
@@ -86,7 +102,7 @@ class Libc::Mmap_registry
 				return;
 			}
 
-			_list.insert(new (&_md_alloc) Entry(start, plugin));
+			_list.insert(new (&_md_alloc) Entry(start, len, plugin));
 		}
 
 		Plugin *lookup_plugin_by_addr(void *start) const
@@ -104,6 +120,24 @@ class Libc::Mmap_registry
 			return _lookup_by_addr_unsynchronized(start) != 0;
 		}
 
+		/**
+		 * Return plugin of the region that contains 'addr'
+		 */
+		Plugin *lookup_plugin_by_range(void const *addr) const
+		{
+			Genode::Lock::Guard guard(_lock);
+
+			Entry const * const e = _lookup_by_range_unsynchronized(addr);
+			return e ? e->plugin : 0;
+		}
+
+		bool registered_range(void const *addr) const
+		{
+			Genode::Lock::Guard guard(_lock);
+
+			return _lookup_by_range_unsynchronized(addr) != 0;
+		}
+
 		void remove(void *start)
 		{
 			Genode::Lock::Guard guard(_lock);
@@ -172,12 +172,69 @@ DUMMY(ssize_t, -1, recv,          (File_descriptor *, void *, ::size_t, int));
 DUMMY(ssize_t, -1, recvfrom,      (File_descriptor *, void *, ::size_t, int, struct sockaddr *, socklen_t *));
 DUMMY(ssize_t, -1, recvmsg,       (File_descriptor *, struct msghdr *, int));
 DUMMY(ssize_t, -1, send,          (File_descriptor *, const void *, ::size_t, int));
+DUMMY(ssize_t, -1, sendmsg,       (File_descriptor *, const struct msghdr *, int));
 DUMMY(ssize_t, -1, sendto,        (File_descriptor *, const void *, ::size_t, int, const struct sockaddr *, socklen_t));
 DUMMY(int,     -1, setsockopt,    (File_descriptor *, int, int, const void *, socklen_t));
 DUMMY(int,     -1, shutdown,      (File_descriptor *, int));
 DUMMY(ssize_t, -1, write,         (File_descriptor *, const void *, ::size_t));
 
 
+ssize_t Plugin::readv(File_descriptor *fd, const struct iovec *iov, int iovcnt)
+{
+	ssize_t total = 0;
+
+	for (int i = 0; i < iovcnt; i++) {
+
+		char    *buf = static_cast<char *>(iov[i].iov_base);
+		::size_t len = iov[i].iov_len;
+
+		while (len > 0) {
+			ssize_t const n = read(fd, buf, len);
+
+			if (n == -1)
+				return total ? total : -1;
+
+			if (n == 0)
+				return total;
+
+			buf   += n;
+			len   -= n;
+			total += n;
+		}
+	}
+
+	return total;
+}
+
+
+ssize_t Plugin::writev(File_descriptor *fd, const struct iovec *iov, int iovcnt)
+{
+	ssize_t total = 0;
+
+	for (int i = 0; i < iovcnt; i++) {
+
+		char const *buf = static_cast<char const *>(iov[i].iov_base);
+		::size_t    len = iov[i].iov_len;
+
+		while (len > 0) {
+			ssize_t const n = write(fd, buf, len);
+
+			if (n == -1)
+				return total ? total : -1;
+
+			if (n == 0)
+				return total;
+
+			buf   += n;
+			len   -= n;
+			total += n;
+		}
+	}
+
+	return total;
+}
+
+
 /*
  * Misc
  */
@@ -20,82 +20,49 @@
 #include <limits.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 
+/* libc-internal includes */
+#include "libc_file.h"
 
-static Genode::Lock rw_lock;
-
+using namespace Libc;
 
-struct Read
-{
-     ssize_t operator()(int fd, void *buf, size_t count)
-     {
-    	 return read(fd, buf, count);
-     }
-};
 
-
-struct Write
-{
-     ssize_t operator()(int fd, const void *buf, size_t count)
-     {
-    	 return write(fd, buf, count);
-     }
-};
+static Genode::Lock rw_lock;
 
 
-template <typename Rw_func>
-static ssize_t readv_writev_impl(Rw_func rw_func, int fd, const struct iovec *iov, int iovcnt)
+/**
+ * Check I/O vector
+ *
+ * \return true if the vector is valid
+ */
+static bool valid_iov(const struct iovec *iov, int iovcnt)
 {
-	Genode::Lock_guard<Genode::Lock> rw_lock_guard(rw_lock);
-
-	char *v;
-	ssize_t bytes_transfered_total = 0;
-	size_t v_len = 0;
-	int i;
-
-	if (iovcnt < 1 || iovcnt > IOV_MAX) {
-		errno = EINVAL;
-		return -1;
+	if (iovcnt < 1 || iovcnt > IOV_MAX)
+		return false;
+
+	::size_t total = 0;
+	for (int i = 0; i < iovcnt; i++) {
+		if (iov[i].iov_len > SSIZE_MAX - total)
+			return false;
+		total += iov[i].iov_len;
 	}
 
-	for (i = 0; i < iovcnt; i++)
-		v_len += iov->iov_len;
+	return true;
+}
 
-	if (v_len > SSIZE_MAX) {
+
+extern "C" ssize_t _readv(int libc_fd, const struct iovec *iov, int iovcnt)
+{
+	if (!valid_iov(iov, iovcnt)) {
 		errno = EINVAL;
 		return -1;
 	}
 
-	while (iovcnt > 0) {
-		v = static_cast<char *>(iov->iov_base);
-		v_len = iov->iov_len;
-
-		while (v_len > 0) {
-			ssize_t bytes_transfered = rw_func(fd, v, v_len);
-
-			if (bytes_transfered == -1)
-				return -1;
-
-			if (bytes_transfered == 0)
-				return bytes_transfered_total;
-
-			v_len -= bytes_transfered;
-			v += bytes_transfered;
-			bytes_transfered_total += bytes_transfered;
-		}
-
-		iov++;
-		iovcnt--;
-	}
-
-	return bytes_transfered_total;
-}
-
+	Genode::Lock_guard<Genode::Lock> rw_lock_guard(rw_lock);
 
-extern "C" ssize_t _readv(int fd, const struct iovec *iov, int iovcnt)
-{
-	return readv_writev_impl(Read(), fd, iov, iovcnt);
+	FD_FUNC_WRAPPER(readv, libc_fd, iov, iovcnt);
 }
 
 
@@ -105,9 +72,21 @@ extern "C" ssize_t readv(int fd, const struct iovec *iov, int iovcnt)
 }
 
 
-extern "C" ssize_t _writev(int fd, const struct iovec *iov, int iovcnt)
+extern "C" ssize_t _writev(int libc_fd, const struct iovec *iov, int iovcnt)
 {
-	return readv_writev_impl(Write(), fd, iov, iovcnt);
+	if (!valid_iov(iov, iovcnt)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	int flags = fcntl(libc_fd, F_GETFL);
+
+	if ((flags != -1) && (flags & O_APPEND))
+		lseek(libc_fd, 0, SEEK_END);
+
+	Genode::Lock_guard<Genode::Lock> rw_lock_guard(rw_lock);
+
+	FD_FUNC_WRAPPER(writev, libc_fd, iov, iovcnt);
 }
 
 
@@ -27,6 +27,7 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <unistd.h>
 #include <ctype.h>
 #include <stdio.h>
@@ -180,6 +181,12 @@ struct Socket_fs::Context : Libc::Plugin_context
 		int local_fd()   { return _fd_for_type(Fd::LOCAL,   O_RDWR); }
 		int remote_fd()  { return _fd_for_type(Fd::REMOTE,  O_RDWR); }
 
+		Libc::File_descriptor &data_file()
+		{
+			data_fd();
+			return *_fd[Fd::DATA].file;
+		}
+
 		/* request the appropriate fd to ensure the file is open */
 		bool data_read_ready()   { data_fd();   return _fd_read_ready(Fd::DATA); }
 		bool accept_read_ready() { accept_fd(); return _fd_read_ready(Fd::ACCEPT); }
@@ -232,7 +239,9 @@ struct Socket_fs::Plugin : Libc::Plugin
 	bool supports_select(int, fd_set *, fd_set *, fd_set *, timeval *) override;
 
 	ssize_t read(Libc::File_descriptor *, void *, ::size_t) override;
+	ssize_t readv(Libc::File_descriptor *, const struct iovec *, int) override;
 	ssize_t write(Libc::File_descriptor *, const void *, ::size_t) override;
+	ssize_t writev(Libc::File_descriptor *, const struct iovec *, int) override;
 	int fcntl(Libc::File_descriptor *, int, long) override;
 	int close(Libc::File_descriptor *) override;
 	int select(int, fd_set *, fd_set *, fd_set *, timeval *) override;
@@ -604,10 +613,50 @@ extern "C" ssize_t socket_fs_recv(int libc_fd, void *buf, ::size_t len, int flag
 }
 
 
+/*
+ * The vectored functions pass all buffers to the VFS at once. They call
+ * the plugin of the data file directly because 'readv' and 'writev' are
+ * serialized by a lock, which is already taken when called via these
+ * functions.
+ */
+
+static ssize_t do_recvmsg(Libc::File_descriptor *fd, msghdr *msg, int flags)
+{
+	Socket_fs::Context *context = dynamic_cast<Socket_fs::Context *>(fd->context);
+	if (!context) return Errno(ENOTSOCK);
+	if (!msg)     return Errno(EFAULT);
+
+	if (msg->msg_iovlen < 1 || msg->msg_iovlen > IOV_MAX)
+		return Errno(EMSGSIZE);
+
+	if (msg->msg_name) {
+		Socket_fs::Remote_functor func(*context, context->fd_flags() & O_NONBLOCK);
+		int const res = read_sockaddr_in(func, (sockaddr_in *)msg->msg_name,
+		                                 &msg->msg_namelen);
+		if (res < 0) return res;
+	}
+
+	/* ancillary data is not supported */
+	msg->msg_controllen = 0;
+	msg->msg_flags      = 0;
+
+	try {
+		Libc::File_descriptor &data = context->data_file();
+
+		lseek(data.libc_fd, 0, 0);
+		return data.plugin->readv(&data, msg->msg_iov, msg->msg_iovlen);
+	} catch (Socket_fs::Context::Inaccessible) {
+		return Errno(EINVAL);
+	}
+}
+
+
 extern "C" ssize_t socket_fs_recvmsg(int libc_fd, msghdr *msg, int flags)
 {
-	Genode::warning("##########  TODO  ########## ", __func__);
-	return 0;
+	Libc::File_descriptor *fd = Libc::file_descriptor_allocator()->find_by_libc_fd(libc_fd);
+	if (!fd) return Errno(EBADF);
+
+	return do_recvmsg(fd, msg, flags);
 }
 
 
@@ -665,6 +714,55 @@ extern "C" ssize_t socket_fs_send(int libc_fd, void const *buf, ::size_t len, in
 }
 
 
+static ssize_t do_sendmsg(Libc::File_descriptor *fd, msghdr const *msg, int flags)
+{
+	Socket_fs::Context *context = dynamic_cast<Socket_fs::Context *>(fd->context);
+	if (!context) return Errno(ENOTSOCK);
+	if (!msg)     return Errno(EFAULT);
+
+	if (msg->msg_iovlen < 1 || msg->msg_iovlen > IOV_MAX)
+		return Errno(EMSGSIZE);
+
+	/* ancillary data is not supported */
+	if (msg->msg_controllen) return Errno(EOPNOTSUPP);
+
+	try {
+		if (msg->msg_name) {
+			sockaddr_in const *dest_addr = (sockaddr_in const *)msg->msg_name;
+			Sockaddr_string addr_string(host_string(*dest_addr),
+			                            port_string(*dest_addr));
+
+			int const len = strlen(addr_string.base());
+			int const n   = write(context->remote_fd(), addr_string.base(), len);
+			if (n != len) return Errno(EIO);
+		}
+
+		Libc::File_descriptor &data = context->data_file();
+
+		lseek(data.libc_fd, 0, 0);
+		ssize_t out_len = data.plugin->writev(&data, msg->msg_iov, msg->msg_iovlen);
+		if (out_len == 0) {
+			switch (context->proto()) {
+				case Socket_fs::Context::Proto::UDP: return Errno(ENETDOWN);
+				case Socket_fs::Context::Proto::TCP: return Errno(EAGAIN);
+			}
+		}
+		return out_len;
+	} catch (Socket_fs::Context::Inaccessible) {
+		return Errno(EINVAL);
+	}
+}
+
+
+extern "C" ssize_t socket_fs_sendmsg(int libc_fd, msghdr const *msg, int flags)
+{
+	Libc::File_descriptor *fd = Libc::file_descriptor_allocator()->find_by_libc_fd(libc_fd);
+	if (!fd) return Errno(EBADF);
+
+	return do_sendmsg(fd, msg, flags);
+}
+
+
 extern "C" int socket_fs_getsockopt(int libc_fd, int level, int optname,
                                     void *optval, socklen_t *optlen)
 {
@@ -836,6 +934,28 @@ ssize_t Socket_fs::Plugin::read(Libc::File_descriptor *fd, void *buf, ::size_t c
 }
 
 
+ssize_t Socket_fs::Plugin::readv(Libc::File_descriptor *fd,
+                                 const struct iovec *iov, int iovcnt)
+{
+	msghdr msg { };
+	msg.msg_iov    = const_cast<struct iovec *>(iov);
+	msg.msg_iovlen = iovcnt;
+
+	return do_recvmsg(fd, &msg, 0);
+}
+
+
+ssize_t Socket_fs::Plugin::writev(Libc::File_descriptor *fd,
+                                  const struct iovec *iov, int iovcnt)
+{
+	msghdr msg { };
+	msg.msg_iov    = const_cast<struct iovec *>(iov);
+	msg.msg_iovlen = iovcnt;
+
+	return do_sendmsg(fd, &msg, 0);
+}
+
+
 ssize_t Socket_fs::Plugin::write(Libc::File_descriptor *fd, const void *buf, ::size_t count)
 {
 
@@ -30,6 +30,7 @@ extern "C" ssize_t socket_fs_recv(int, void *, ::size_t, int);
 extern "C" ssize_t socket_fs_recvmsg(int, msghdr *, int);
 extern "C" ssize_t socket_fs_sendto(int, void const *, ::size_t, int, sockaddr const *, socklen_t);
 extern "C" ssize_t socket_fs_send(int, void const *, ::size_t, int);
+extern "C" ssize_t socket_fs_sendmsg(int, msghdr const *, int);
 extern "C" int socket_fs_getsockopt(int, int, int, void *, socklen_t *);
 extern "C" int socket_fs_setsockopt(int, int, int, void const *, socklen_t);
 extern "C" int socket_fs_shutdown(int, int);
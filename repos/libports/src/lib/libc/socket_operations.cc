@@ -197,6 +197,21 @@ extern "C" ssize_t send(int libc_fd, void const *buf, ::size_t len, int flags)
 }
 
 
+extern "C" ssize_t _sendmsg(int libc_fd, msghdr const *msg, int flags)
+{
+	if (*Libc::config_socket())
+		return socket_fs_sendmsg(libc_fd, msg, flags);
+
+	FD_FUNC_WRAPPER(sendmsg, libc_fd, msg, flags);
+}
+
+
+extern "C" ssize_t sendmsg(int libc_fd, msghdr const *msg, int flags)
+{
+	return _sendmsg(libc_fd, msg, flags);
+}
+
+
 extern "C" int _getsockopt(int libc_fd, int level, int optname,
                           void *optval, socklen_t *optlen)
 {
@@ -16,9 +16,12 @@
 /* Genode includes */
 #include <base/env.h>
 #include <base/log.h>
+#include <dataspace/client.h>
+#include <util/fifo.h>
 #include <vfs/dir_file_system.h>
 
 /* libc includes */
+#include <aio.h>
 #include <errno.h>
 #include <dirent.h>
 #include <fcntl.h>
@@ -77,6 +80,372 @@ static void vfs_stat_to_libc_stat_struct(Vfs::Directory_service::Stat const &src
 }
 
 
+/**
+ * Write to the VFS at the seek offset of the handle
+ *
+ * Code shared between 'write' and the flushing of write-behind buffers.
+ */
+static int write_result_errno(Vfs::File_io_service::Write_result result)
+{
+	typedef Vfs::File_io_service::Write_result Result;
+
+	switch (result) {
+	case Result::WRITE_ERR_AGAIN:       return EAGAIN;
+	case Result::WRITE_ERR_WOULD_BLOCK: return EWOULDBLOCK;
+	case Result::WRITE_ERR_INVALID:     return EINVAL;
+	case Result::WRITE_ERR_IO:          return EIO;
+	case Result::WRITE_ERR_INTERRUPT:   return EINTR;
+	case Result::WRITE_OK:              break;
+	}
+
+	return 0;
+}
+
+
+static ssize_t vfs_write(Vfs::Vfs_handle *handle, bool nonblocking,
+                         void const *buf, ::size_t count)
+{
+	typedef Vfs::File_io_service::Write_result Result;
+
+	Vfs::file_size out_count  = 0;
+	Result         out_result = Result::WRITE_OK;
+
+	if (nonblocking) {
+
+		try {
+			out_result = handle->fs().write(handle, (char const *)buf, count, out_count);
+		} catch (Vfs::File_io_service::Insufficient_buffer) { }
+
+	} else {
+
+		struct Check : Libc::Suspend_functor
+		{
+			bool             retry { false };
+
+			Vfs::Vfs_handle *handle;
+			void const      *buf;
+			::size_t         count;
+			Vfs::file_size  &out_count;
+			Result          &out_result;
+
+			Check(Vfs::Vfs_handle *handle, void const *buf,
+			      ::size_t count, Vfs::file_size &out_count,
+			      Result &out_result)
+			: handle(handle), buf(buf), count(count), out_count(out_count),
+			  out_result(out_result)
+			{ }
+
+			bool suspend() override
+			{
+				try {
+					out_result = handle->fs().write(handle, (char const *)buf,
+						                            count, out_count);
+					retry = false;
+				} catch (Vfs::File_io_service::Insufficient_buffer) {
+					retry = true;
+				}
+
+				return retry;
+			}
+		} check(handle, buf, count, out_count, out_result);
+
+		do {
+			Libc::suspend(check);
+		} while (check.retry);
+	}
+
+	if (int const error = write_result_errno(out_result))
+		return Libc::Errno(error);
+
+	handle->advance_seek(out_count);
+
+	return out_count;
+}
+
+
+/**
+ * Write sequence of buffers to the VFS with a single request
+ */
+static ssize_t vfs_writev(Vfs::Vfs_handle *handle, bool nonblocking,
+                          Vfs::File_io_service::Io_vector const *vec,
+                          unsigned vec_count)
+{
+	typedef Vfs::File_io_service::Write_result Result;
+
+	Vfs::file_size out_count  = 0;
+	Result         out_result = Result::WRITE_OK;
+
+	struct Check : Libc::Suspend_functor
+	{
+		bool             retry { false };
+
+		Vfs::Vfs_handle                          *handle;
+		Vfs::File_io_service::Io_vector const    *vec;
+		unsigned                                  vec_count;
+		Vfs::file_size                           &out_count;
+		Result                                   &out_result;
+
+		Check(Vfs::Vfs_handle *handle,
+		      Vfs::File_io_service::Io_vector const *vec, unsigned vec_count,
+		      Vfs::file_size &out_count, Result &out_result)
+		: handle(handle), vec(vec), vec_count(vec_count),
+		  out_count(out_count), out_result(out_result)
+		{ }
+
+		bool suspend() override
+		{
+			try {
+				out_result = handle->fs().writev(handle, vec, vec_count, out_count);
+				retry = false;
+			} catch (Vfs::File_io_service::Insufficient_buffer) {
+				retry = true;
+			}
+
+			return retry;
+		}
+	} check(handle, vec, vec_count, out_count, out_result);
+
+	if (nonblocking)
+		check.suspend();
+	else
+		do {
+			Libc::suspend(check);
+		} while (check.retry);
+
+	if (int const error = write_result_errno(out_result))
+		return Libc::Errno(error);
+
+	handle->advance_seek(out_count);
+
+	return out_count;
+}
+
+
+static int read_result_errno(Vfs::File_io_service::Read_result result)
+{
+	typedef Vfs::File_io_service::Read_result Result;
+
+	switch (result) {
+	case Result::READ_ERR_AGAIN:       return EAGAIN;
+	case Result::READ_ERR_WOULD_BLOCK: return EWOULDBLOCK;
+	case Result::READ_ERR_INVALID:     return EINVAL;
+	case Result::READ_ERR_IO:          return EIO;
+	case Result::READ_ERR_INTERRUPT:   return EINTR;
+	case Result::READ_OK:              break;
+
+	case Result::READ_QUEUED: /* handled by the caller, so never reached */ break;
+	}
+	return 0;
+}
+
+
+/**
+ * Queue read at 'offset' while retaining the seek offset of the handle
+ *
+ * Some file systems capture the offset when the read is queued, others
+ * when it is completed. Hence, 'complete_read_at' must be called with the
+ * same offset.
+ */
+static bool queue_read_at(Vfs::Vfs_handle *handle, Vfs::file_size offset,
+                          Vfs::file_size count)
+{
+	Vfs::file_size const seek = handle->seek();
+
+	handle->seek(offset);
+	bool const queued = handle->fs().queue_read(handle, count);
+	handle->seek(seek);
+
+	return queued;
+}
+
+
+typedef Vfs::File_io_service::Io_vector Io_vector;
+
+
+/**
+ * Queue read of a sequence of buffers at 'offset'
+ *
+ * The read must be completed via 'complete_readv_at' with the same buffers.
+ */
+static bool queue_readv_at(Vfs::Vfs_handle *handle, Vfs::file_size offset,
+                           Io_vector const *vec, unsigned vec_count)
+{
+	if (vec_count == 1)
+		return queue_read_at(handle, offset, vec[0].size);
+
+	Vfs::file_size const seek = handle->seek();
+
+	handle->seek(offset);
+	bool const queued = handle->fs().queue_readv(handle, vec, vec_count);
+	handle->seek(seek);
+
+	return queued;
+}
+
+
+static Vfs::File_io_service::Read_result
+complete_readv_at(Vfs::Vfs_handle *handle, Vfs::file_size offset,
+                  Io_vector const *vec, unsigned vec_count,
+                  Vfs::file_size &out_count)
+{
+	Vfs::file_size const seek = handle->seek();
+
+	handle->seek(offset);
+	Vfs::File_io_service::Read_result const result = (vec_count == 1)
+		? handle->fs().complete_read(handle, vec[0].base, vec[0].size, out_count)
+		: handle->fs().complete_readv(handle, vec, vec_count, out_count);
+	handle->seek(seek);
+
+	return result;
+}
+
+
+static Vfs::File_io_service::Read_result
+complete_read_at(Vfs::Vfs_handle *handle, Vfs::file_size offset, char *dst,
+                 Vfs::file_size count, Vfs::file_size &out_count)
+{
+	Io_vector const vec { dst, count };
+	return complete_readv_at(handle, offset, &vec, 1, out_count);
+}
+
+
+static void wait_queue_readv_at(Vfs::Vfs_handle *handle, Vfs::file_size offset,
+                                Io_vector const *vec, unsigned vec_count)
+{
+	struct Check : Libc::Suspend_functor
+	{
+		bool             retry { false };
+
+		Vfs::Vfs_handle *handle;
+		Vfs::file_size   offset;
+		Io_vector const *vec;
+		unsigned         vec_count;
+
+		Check(Vfs::Vfs_handle *handle, Vfs::file_size offset,
+		      Io_vector const *vec, unsigned vec_count)
+		: handle(handle), offset(offset), vec(vec), vec_count(vec_count) { }
+
+		bool suspend() override
+		{
+			retry = !queue_readv_at(handle, offset, vec, vec_count);
+			return retry;
+		}
+	} check(handle, offset, vec, vec_count);
+
+	do {
+		Libc::suspend(check);
+	} while (check.retry);
+}
+
+
+static void wait_queue_read_at(Vfs::Vfs_handle *handle, Vfs::file_size offset,
+                               Vfs::file_size count)
+{
+	Io_vector const vec { nullptr, count };
+	wait_queue_readv_at(handle, offset, &vec, 1);
+}
+
+
+static Vfs::File_io_service::Read_result
+wait_complete_readv_at(Vfs::Vfs_handle *handle, Vfs::file_size offset,
+                       Io_vector const *vec, unsigned vec_count,
+                       Vfs::file_size &out_count)
+{
+	typedef Vfs::File_io_service::Read_result Result;
+
+	struct Check : Libc::Suspend_functor
+	{
+		bool             retry { false };
+
+		Vfs::Vfs_handle *handle;
+		Vfs::file_size   offset;
+		Io_vector const *vec;
+		unsigned         vec_count;
+		Vfs::file_size  &out_count;
+		Result           out_result { Result::READ_QUEUED };
+
+		Check(Vfs::Vfs_handle *handle, Vfs::file_size offset,
+		      Io_vector const *vec, unsigned vec_count,
+		      Vfs::file_size &out_count)
+		: handle(handle), offset(offset), vec(vec), vec_count(vec_count),
+		  out_count(out_count)
+		{ }
+
+		bool suspend() override
+		{
+			out_result = complete_readv_at(handle, offset, vec, vec_count,
+			                               out_count);
+
+			/* suspend me if read is still queued */
+			retry = (out_result == Result::READ_QUEUED);
+
+			return retry;
+		}
+	} check(handle, offset, vec, vec_count, out_count);
+
+	do {
+		Libc::suspend(check);
+	} while (check.retry);
+
+	return check.out_result;
+}
+
+
+static Vfs::File_io_service::Read_result
+wait_complete_read_at(Vfs::Vfs_handle *handle, Vfs::file_size offset,
+                      char *dst, Vfs::file_size count,
+                      Vfs::file_size &out_count)
+{
+	Io_vector const vec { dst, count };
+	return wait_complete_readv_at(handle, offset, &vec, 1, out_count);
+}
+
+
+/**
+ * Read from the VFS at the seek offset of the handle
+ */
+static ssize_t vfs_read(Vfs::Vfs_handle *handle, void *buf, ::size_t count)
+{
+	Vfs::file_size const offset = handle->seek();
+	Vfs::file_size out_count = 0;
+
+	wait_queue_read_at(handle, offset, count);
+
+	int const error = read_result_errno(
+		wait_complete_read_at(handle, offset, (char *)buf, count, out_count));
+
+	if (error)
+		return Libc::Errno(error);
+
+	handle->advance_seek(out_count);
+
+	return out_count;
+}
+
+
+/**
+ * Read from the VFS into a sequence of buffers with a single request
+ */
+static ssize_t vfs_readv(Vfs::Vfs_handle *handle, Io_vector const *vec,
+                         unsigned vec_count)
+{
+	Vfs::file_size const offset = handle->seek();
+	Vfs::file_size out_count = 0;
+
+	wait_queue_readv_at(handle, offset, vec, vec_count);
+
+	int const error = read_result_errno(
+		wait_complete_readv_at(handle, offset, vec, vec_count, out_count));
+
+	if (error)
+		return Libc::Errno(error);
+
+	handle->advance_seek(out_count);
+
+	return out_count;
+}
+
+
 static Genode::Xml_node *_config_node;
 
 
@@ -144,18 +513,461 @@ namespace Libc {
 			Libc::suspend(check);
 	}
 
-	bool read_ready(Libc::File_descriptor *fd)
-	{
-		Vfs::Vfs_handle *handle = vfs_handle(fd);
-		if (!handle) return false;
+	bool read_ready(Libc::File_descriptor *fd)
+	{
+		Vfs::Vfs_handle *handle = vfs_handle(fd);
+		if (!handle) return false;
+
+		notify_read_ready(handle);
+
+		return handle->fs().read_ready(handle);
+	}
+
+}
+
+struct Libc::Vfs_plugin::Aio_request : Genode::Fifo<Aio_request>::Element
+{
+	struct aiocb &cb;
+
+	Aio_request(struct aiocb &cb) : cb(cb) { }
+};
+
+
+/**
+ * Read-ahead, write-behind, and AIO state of a VFS handle
+ *
+ * File descriptors duplicated via 'dup2' share the handle and, thereby,
+ * the I/O context.
+ */
+struct Libc::Vfs_plugin::Io_context : Genode::List<Io_context>::Element
+{
+	Vfs::Vfs_handle &handle;
+
+	/* read-ahead window covering [ra_offset, ra_offset + ra_length) */
+	char           *ra_buf    = nullptr;
+	Vfs::file_size  ra_offset = 0;
+	Vfs::file_size  ra_length = 0;
+	bool            ra_eof    = false;
+	int             ra_errno  = 0;
+
+	/* end of the previous read, used to detect sequential access */
+	Vfs::file_size next_read = 0;
+
+	/* written data not yet passed to the VFS, destined for 'wb_offset' */
+	char           *wb_buf    = nullptr;
+	Vfs::file_size  wb_offset = 0;
+	Vfs::file_size  wb_length = 0;
+
+	/*
+	 * The VFS supports only one queued read per handle, which is used
+	 * either for reading ahead or for the oldest pending AIO request.
+	 */
+	enum class Queued { NONE, READ_AHEAD, AIO } queued = Queued::NONE;
+
+	Vfs::file_size queued_offset = 0;
+	Vfs::file_size queued_count  = 0;
+
+	Genode::Fifo<Aio_request> aio_requests;
+
+	Io_context(Vfs::Vfs_handle &handle) : handle(handle) { }
+
+	char *queued_dst()
+	{
+		return queued == Queued::AIO ? (char *)aio_requests.head()->cb.aio_buf
+		                             : ra_buf;
+	}
+};
+
+
+Libc::Vfs_plugin::Io_context *
+Libc::Vfs_plugin::_lookup_io_context(Vfs::Vfs_handle *handle)
+{
+	for (Io_context *io = _io_contexts.first(); io; io = io->next())
+		if (&io->handle == handle)
+			return io;
+
+	return nullptr;
+}
+
+
+Libc::Vfs_plugin::Io_context &
+Libc::Vfs_plugin::_io_context(Vfs::Vfs_handle *handle)
+{
+	if (Io_context *io = _lookup_io_context(handle))
+		return *io;
+
+	Io_context *io = new (_alloc) Io_context(*handle);
+	_io_contexts.insert(io);
+	return *io;
+}
+
+
+void Libc::Vfs_plugin::_destroy_io_context(Io_context &io)
+{
+	_complete_queued_read(io);
+
+	/* requests that are still pending get canceled by closing the file */
+	while (Aio_request *request = io.aio_requests.dequeue()) {
+		request->cb._aiocb_private.status = -1;
+		request->cb._aiocb_private.error  = ECANCELED;
+		destroy(_alloc, request);
+	}
+
+	if (io.ra_buf) _alloc.free(io.ra_buf, _read_ahead);
+	if (io.wb_buf) _alloc.free(io.wb_buf, _write_behind);
+
+	_io_contexts.remove(&io);
+	destroy(_alloc, &io);
+}
+
+
+void Libc::Vfs_plugin::_queued_read_completed(Io_context &io,
+                                              Vfs::File_io_service::Read_result result,
+                                              Vfs::file_size out_count)
+{
+	int const error = read_result_errno(result);
+
+	switch (io.queued) {
+	case Io_context::Queued::NONE:
+		break;
+
+	case Io_context::Queued::READ_AHEAD:
+		io.ra_offset = io.queued_offset;
+		io.ra_length = error ? 0 : out_count;
+		io.ra_eof    = error || !out_count;
+		io.ra_errno  = error;
+		break;
+
+	case Io_context::Queued::AIO:
+		{
+			Aio_request *request = io.aio_requests.dequeue();
+			request->cb._aiocb_private.status = error ? -1 : (long)out_count;
+			request->cb._aiocb_private.error  = error;
+			destroy(_alloc, request);
+		}
+		break;
+	}
+
+	io.queued = Io_context::Queued::NONE;
+}
+
+
+void Libc::Vfs_plugin::_complete_queued_read(Io_context &io)
+{
+	if (io.queued == Io_context::Queued::NONE)
+		return;
+
+	Vfs::file_size out_count = 0;
+	_queued_read_completed(io,
+		wait_complete_read_at(&io.handle, io.queued_offset, io.queued_dst(),
+		                      io.queued_count, out_count), out_count);
+}
+
+
+bool Libc::Vfs_plugin::_try_complete_queued_read(Io_context &io)
+{
+	if (io.queued == Io_context::Queued::NONE)
+		return true;
+
+	Vfs::file_size out_count = 0;
+	Vfs::File_io_service::Read_result const result =
+		complete_read_at(&io.handle, io.queued_offset, io.queued_dst(),
+		                 io.queued_count, out_count);
+
+	if (result == Vfs::File_io_service::READ_QUEUED)
+		return false;
+
+	_queued_read_completed(io, result, out_count);
+	return true;
+}
+
+
+void Libc::Vfs_plugin::_invalidate_read_ahead(Io_context &io)
+{
+	if (io.queued == Io_context::Queued::READ_AHEAD)
+		_complete_queued_read(io);
+
+	io.ra_length = 0;
+	io.ra_eof    = false;
+}
+
+
+void Libc::Vfs_plugin::_queue_read_ahead(Io_context &io)
+{
+	if (io.queued != Io_context::Queued::NONE || io.ra_eof
+	 || !io.aio_requests.empty())
+		return;
+
+	Vfs::file_size const offset = io.ra_offset + io.ra_length;
+
+	/* the read-ahead is merely an optimization, so don't wait for the VFS */
+	if (!queue_read_at(&io.handle, offset, _read_ahead))
+		return;
+
+	io.queued        = Io_context::Queued::READ_AHEAD;
+	io.queued_offset = offset;
+	io.queued_count  = _read_ahead;
+}
+
+
+ssize_t Libc::Vfs_plugin::_buffered_read(Io_context &io, void *buf, ::size_t count)
+{
+	Vfs::Vfs_handle &handle = io.handle;
+
+	char     *dst  = (char *)buf;
+	::size_t  done = 0;
+
+	while (done < count) {
+
+		Vfs::file_size const pos = handle.seek();
+
+		/* serve request from the read-ahead window */
+		if (pos >= io.ra_offset && pos < io.ra_offset + io.ra_length) {
+
+			::size_t const n = Genode::min((Vfs::file_size)(count - done),
+			                               io.ra_offset + io.ra_length - pos);
+
+			Genode::memcpy(dst + done, io.ra_buf + (pos - io.ra_offset), n);
+			handle.advance_seek(n);
+			done        += n;
+			io.next_read = handle.seek();
+			continue;
+		}
+
+		/* the window in flight starts at the requested position */
+		if (io.queued == Io_context::Queued::READ_AHEAD && io.queued_offset == pos) {
+
+			_complete_queued_read(io);
+			if (!io.ra_length) {
+				if (!done && io.ra_errno)
+					return Errno(io.ra_errno);
+				break;
+			}
+
+			/* keep the VFS busy while the application consumes the window */
+			_queue_read_ahead(io);
+			continue;
+		}
+
+		/* the VFS read slot is needed below */
+		if (io.queued != Io_context::Queued::NONE) {
+			_complete_queued_read(io);
+			continue;
+		}
+
+		/* random accesses and large reads bypass the read-ahead window */
+		if (pos != io.next_read || count - done >= _read_ahead) {
+
+			ssize_t const n = vfs_read(&handle, dst + done, count - done);
+			if (n < 0)
+				return done ? done : n;
+
+			done        += n;
+			io.next_read = handle.seek();
+			break;
+		}
+
+		/* start reading ahead at the current position */
+		wait_queue_read_at(&handle, pos, _read_ahead);
+
+		io.queued        = Io_context::Queued::READ_AHEAD;
+		io.queued_offset = pos;
+		io.queued_count  = _read_ahead;
+	}
+
+	return done;
+}
+
+
+ssize_t Libc::Vfs_plugin::_buffered_write(Io_context &io, void const *buf,
+                                          ::size_t count)
+{
+	Vfs::file_size const pos = io.handle.seek();
+
+	/* keep the buffered data contiguous */
+	if (io.wb_length && (pos != io.wb_offset + io.wb_length
+	                  || io.wb_length + count > _write_behind))
+		if (_flush_write_behind(io) == -1)
+			return -1;
+
+	if (count >= _write_behind)
+		return vfs_write(&io.handle, false, buf, count);
+
+	if (!io.wb_length)
+		io.wb_offset = pos;
+
+	Genode::memcpy(io.wb_buf + io.wb_length, buf, count);
+	io.wb_length += count;
+	io.handle.advance_seek(count);
+
+	return count;
+}
+
+
+int Libc::Vfs_plugin::_flush_write_behind(Io_context &io)
+{
+	if (!io.wb_length)
+		return 0;
+
+	Vfs::file_size const seek = io.handle.seek();
+
+	int result = 0;
+
+	io.handle.seek(io.wb_offset);
+	for (Vfs::file_size done = 0; done < io.wb_length; ) {
+
+		ssize_t const n = vfs_write(&io.handle, false, io.wb_buf + done,
+		                            io.wb_length - done);
+		if (n <= 0) {
+			if (!n) errno = EIO;
+			result = -1;
+			break;
+		}
+		done += n;
+	}
+	io.handle.seek(seek);
+
+	/* like a page cache, the buffered data is dropped on error */
+	io.wb_length = 0;
+
+	return result;
+}
+
+
+int Libc::Vfs_plugin::_flush_write_behind(Libc::File_descriptor *fd)
+{
+	Io_context *io = _lookup_io_context(vfs_handle(fd));
+
+	return io ? _flush_write_behind(*io) : 0;
+}
+
+
+void Libc::Vfs_plugin::_aio_progress(Io_context &io)
+{
+	for (;;) {
+
+		if (!_try_complete_queued_read(io))
+			return;
+
+		Aio_request *request = io.aio_requests.head();
+		if (!request)
+			return;
+
+		struct aiocb &cb = request->cb;
+
+		if (!queue_read_at(&io.handle, cb.aio_offset, cb.aio_nbytes))
+			return;
+
+		io.queued        = Io_context::Queued::AIO;
+		io.queued_offset = cb.aio_offset;
+		io.queued_count  = cb.aio_nbytes;
+	}
+}
+
+
+void Libc::Vfs_plugin::aio_progress(Libc::File_descriptor *fd)
+{
+	if (Io_context *io = _lookup_io_context(vfs_handle(fd)))
+		_aio_progress(*io);
+}
+
+
+int Libc::Vfs_plugin::aio_read(Libc::File_descriptor *fd, struct aiocb *cb)
+{
+	Io_context &io = _io_context(vfs_handle(fd));
+
+	/* the request may cover data that is still held back */
+	if (_flush_write_behind(io) == -1)
+		return -1;
+
+	cb->_aiocb_private.status = 0;
+	cb->_aiocb_private.error  = EINPROGRESS;
+
+	io.aio_requests.enqueue(new (_alloc) Aio_request(*cb));
+
+	_aio_progress(io);
+	return 0;
+}
+
+
+int Libc::Vfs_plugin::aio_write(Libc::File_descriptor *fd, struct aiocb *cb)
+{
+	Vfs::Vfs_handle *handle = vfs_handle(fd);
+
+	if (Io_context *io = _lookup_io_context(handle)) {
+		_invalidate_read_ahead(*io);
+		if (_flush_write_behind(*io) == -1)
+			return -1;
+	}
+
+	/*
+	 * VFS writes are not acknowledged to the writer, so the request is
+	 * complete once the data is passed to the VFS.
+	 */
+	Vfs::file_size const seek = handle->seek();
+
+	handle->seek(cb->aio_offset);
+
+	char const *src  = (char const *)cb->aio_buf;
+	ssize_t     done = 0;
+	int         error = 0;
+
+	while ((::size_t)done < cb->aio_nbytes) {
+		ssize_t const n = vfs_write(handle, false, src + done,
+		                            cb->aio_nbytes - done);
+		if (n <= 0) {
+			error = n ? errno : EIO;
+			break;
+		}
+		done += n;
+	}
+
+	handle->seek(seek);
+
+	cb->_aiocb_private.status = error ? -1 : done;
+	cb->_aiocb_private.error  = error;
+	return 0;
+}
+
+
+int Libc::Vfs_plugin::aio_cancel(Libc::File_descriptor *fd, struct aiocb *cb)
+{
+	Io_context *io = _lookup_io_context(vfs_handle(fd));
+	if (!io)
+		return AIO_ALLDONE;
+
+	_aio_progress(*io);
+
+	int result = AIO_ALLDONE;
+
+	for (Aio_request *request = io->aio_requests.head(), *next = nullptr;
+	     request; request = next) {
+
+		next = request->next();
+
+		if (cb && &request->cb != cb)
+			continue;
+
+		/* a read queued at the VFS cannot be taken back */
+		if (io->queued == Io_context::Queued::AIO
+		 && request == io->aio_requests.head()) {
+			result = AIO_NOTCANCELED;
+			continue;
+		}
 
-		notify_read_ready(handle);
+		io->aio_requests.remove(request);
+		request->cb._aiocb_private.status = -1;
+		request->cb._aiocb_private.error  = ECANCELED;
+		destroy(_alloc, request);
 
-		return handle->fs().read_ready(handle);
+		if (result == AIO_ALLDONE)
+			result = AIO_CANCELED;
 	}
 
+	return result;
 }
 
+
 int Libc::Vfs_plugin::access(const char *path, int amode)
 {
 	if (_root_dir.leaf_path(path))
@@ -279,6 +1091,21 @@ Libc::File_descriptor *Libc::Vfs_plugin::open(char const *path, int flags,
 
 	fd->flags = flags & (O_ACCMODE|O_NONBLOCK|O_APPEND);
 
+	/* buffer I/O of regular files only */
+	Vfs::Directory_service::Stat stat;
+	if ((_read_ahead || _write_behind)
+	 && _root_dir.stat(path, stat) == Vfs::Directory_service::STAT_OK
+	 && S_ISREG(stat.mode)) {
+
+		Io_context &io = _io_context(handle);
+
+		if (_read_ahead && (flags & O_ACCMODE) != O_WRONLY)
+			io.ra_buf = (char *)_alloc.alloc(_read_ahead);
+
+		if (_write_behind && (flags & O_ACCMODE) != O_RDONLY)
+			io.wb_buf = (char *)_alloc.alloc(_write_behind);
+	}
+
 	if ((flags & O_TRUNC) && (ftruncate(fd, 0) == -1)) {
 		errno = EINVAL; /* XXX which error code fits best ? */
 		return nullptr;
@@ -291,10 +1118,17 @@ Libc::File_descriptor *Libc::Vfs_plugin::open(char const *path, int flags,
 int Libc::Vfs_plugin::close(Libc::File_descriptor *fd)
 {
 	Vfs::Vfs_handle *handle = vfs_handle(fd);
+
+	int result = 0;
+	if (Io_context *io = _lookup_io_context(handle)) {
+		result = _flush_write_behind(*io);
+		_destroy_io_context(*io);
+	}
+
 	_vfs_sync(handle);
 	handle->ds().close(handle);
 	Libc::file_descriptor_allocator()->free(fd);
-	return 0;
+	return result;
 }
 
 
@@ -308,6 +1142,7 @@ int Libc::Vfs_plugin::dup2(Libc::File_descriptor *fd,
 
 int Libc::Vfs_plugin::fstat(Libc::File_descriptor *fd, struct stat *buf)
 {
+	/* 'stat' accounts buffered data in the file size */
 	return stat(fd->fd_path, buf);
 }
 
@@ -359,6 +1194,15 @@ int Libc::Vfs_plugin::stat(char const *path, struct stat *buf)
 		return -1;
 	}
 
+	/*
+	 * Account buffered data in the file size. The I/O contexts do not
+	 * know the path of their file, so all pending data gets flushed,
+	 * which is rare as write-behind data is flushed early anyway.
+	 */
+	for (Io_context *io = _io_contexts.first(); io; io = io->next())
+		if (_flush_write_behind(*io) == -1)
+			return -1;
+
 	typedef Vfs::Directory_service::Stat_result Result;
 
 	Vfs::Directory_service::Stat stat;
@@ -377,69 +1221,20 @@ int Libc::Vfs_plugin::stat(char const *path, struct stat *buf)
 ssize_t Libc::Vfs_plugin::write(Libc::File_descriptor *fd, const void *buf,
                                 ::size_t count)
 {
-	typedef Vfs::File_io_service::Write_result Result;
-
 	Vfs::Vfs_handle *handle = vfs_handle(fd);
 
-	Vfs::file_size out_count  = 0;
-	Result         out_result = Result::WRITE_OK;
-
-	if (fd->flags & O_NONBLOCK) {
-
-		try {
-			out_result = handle->fs().write(handle, (char const *)buf, count, out_count);
-		} catch (Vfs::File_io_service::Insufficient_buffer) { }
-
-	} else {
-
-		struct Check : Libc::Suspend_functor
-		{
-			bool             retry { false };
-
-			Vfs::Vfs_handle *handle;
-			void const      *buf;
-			::size_t         count;
-			Vfs::file_size  &out_count;
-			Result          &out_result;
-
-			Check(Vfs::Vfs_handle *handle, void const *buf,
-			      ::size_t count, Vfs::file_size &out_count,
-			      Result &out_result)
-			: handle(handle), buf(buf), count(count), out_count(out_count),
-			  out_result(out_result)
-			{ }
-
-			bool suspend() override
-			{
-				try {
-					out_result = handle->fs().write(handle, (char const *)buf,
-						                            count, out_count);
-					retry = false;
-				} catch (Vfs::File_io_service::Insufficient_buffer) {
-					retry = true;
-				}
+	if (Io_context *io = _lookup_io_context(handle)) {
 
-				return retry;
-			}
-		} check(handle, buf, count, out_count, out_result);
+		_invalidate_read_ahead(*io);
 
-		do {
-			Libc::suspend(check);
-		} while (check.retry);
-	}
+		if (io->wb_buf && !(fd->flags & (O_NONBLOCK | O_APPEND)))
+			return _buffered_write(*io, buf, count);
 
-	switch (out_result) {
-	case Result::WRITE_ERR_AGAIN:       return Errno(EAGAIN);
-	case Result::WRITE_ERR_WOULD_BLOCK: return Errno(EWOULDBLOCK);
-	case Result::WRITE_ERR_INVALID:     return Errno(EINVAL);
-	case Result::WRITE_ERR_IO:          return Errno(EIO);
-	case Result::WRITE_ERR_INTERRUPT:   return Errno(EINTR);
-	case Result::WRITE_OK:              break;
+		if (_flush_write_behind(*io) == -1)
+			return -1;
 	}
 
-	handle->advance_seek(out_count);
-
-	return out_count;
+	return vfs_write(handle, fd->flags & O_NONBLOCK, buf, count);
 }
 
 
@@ -448,87 +1243,166 @@ ssize_t Libc::Vfs_plugin::read(Libc::File_descriptor *fd, void *buf,
 {
 	Libc::dispatch_pending_io_signals();
 
-	typedef Vfs::File_io_service::Read_result Result;
-
 	Vfs::Vfs_handle *handle = vfs_handle(fd);
 
 	if (fd->flags & O_NONBLOCK && !Libc::read_ready(fd))
 		return Errno(EAGAIN);
 
+	if (Io_context *io = _lookup_io_context(handle)) {
+
+		/* the read may cover data that is still held back */
+		if (_flush_write_behind(*io) == -1)
+			return -1;
+
+		if (io->ra_buf && !(fd->flags & O_NONBLOCK))
+			return _buffered_read(*io, buf, count);
+
+		/* the VFS supports only one queued read per handle */
+		_complete_queued_read(*io);
+	}
+
+	return vfs_read(handle, buf, count);
+}
+
+
+namespace {
+
+	/**
+	 * Cursor into the I/O vector of a 'readv' or 'writev' call
+	 *
+	 * The VFS is asked for at most 'MAX_VEC' buffers per request.
+	 */
+	struct Iov_cursor
 	{
-		struct Check : Libc::Suspend_functor
-		{
-			bool             retry { false };
+		enum { MAX_VEC = 64 };
 
-			Vfs::Vfs_handle *handle;
-			::size_t         count;
+		struct iovec const * const iov;
+		int                  const iovcnt;
 
-			Check(Vfs::Vfs_handle *handle, ::size_t count)
-			: handle(handle), count(count) { }
+		int      index  = 0;
+		::size_t offset = 0;
 
-			bool suspend() override
-			{
-				retry = !handle->fs().queue_read(handle, count);
-				return retry;
+		Iov_cursor(struct iovec const *iov, int iovcnt)
+		: iov(iov), iovcnt(iovcnt) { skip_empty(); }
+
+		void skip_empty()
+		{
+			while (index < iovcnt && offset == iov[index].iov_len) {
+				index++;
+				offset = 0;
 			}
-		} check ( handle, count);
+		}
 
-		do {
-			Libc::suspend(check);
-		} while (check.retry);
-	}
+		bool done() const { return index == iovcnt; }
 
-	Vfs::file_size out_count = 0;
-	Result         out_result;
+		/**
+		 * Fill 'vec' with the remaining buffers
+		 *
+		 * \return  number of used 'vec' elements
+		 */
+		unsigned fill(Io_vector *vec, ::size_t &total) const
+		{
+			unsigned n = 0;
+			total = 0;
+
+			for (int i = index; i < iovcnt && n < MAX_VEC; i++) {
+				::size_t const skip = (i == index) ? offset : 0;
+				if (iov[i].iov_len == skip)
+					continue;
+
+				vec[n].base = (char *)iov[i].iov_base + skip;
+				vec[n].size = iov[i].iov_len - skip;
+				total += vec[n].size;
+				n++;
+			}
+			return n;
+		}
 
-	{
-		struct Check : Libc::Suspend_functor
+		void advance(::size_t len)
 		{
-			bool             retry { false };
+			while (len && index < iovcnt) {
+				::size_t const curr = Genode::min(len, iov[index].iov_len - offset);
+				offset += curr;
+				len    -= curr;
+				skip_empty();
+			}
+		}
+	};
+}
 
-			Vfs::Vfs_handle *handle;
-			void            *buf;
-			::size_t         count;
-			Vfs::file_size  &out_count;
-			Result          &out_result;
 
-			Check(Vfs::Vfs_handle *handle, void *buf, ::size_t count,
-			      Vfs::file_size &out_count, Result &out_result)
-			: handle(handle), buf(buf), count(count), out_count(out_count),
-			  out_result(out_result)
-			{ }
+ssize_t Libc::Vfs_plugin::writev(Libc::File_descriptor *fd,
+                                 const struct iovec *iov, int iovcnt)
+{
+	Vfs::Vfs_handle *handle = vfs_handle(fd);
 
-			bool suspend() override
-			{
-				out_result = handle->fs().complete_read(handle, (char *)buf,
-				                                        count, out_count);
-				/* suspend me if read is still queued */
+	/* keep the order of data held back by the write-behind buffer */
+	if (_lookup_io_context(handle))
+		return Plugin::writev(fd, iov, iovcnt);
 
-				retry = (out_result == Result::READ_QUEUED);
+	Iov_cursor cursor(iov, iovcnt);
+	ssize_t    total = 0;
 
-				return retry;
-			}
-		} check ( handle, buf, count, out_count, out_result);
+	while (!cursor.done()) {
 
-		do {
-			Libc::suspend(check);
-		} while (check.retry);
-	}
+		Io_vector vec[Iov_cursor::MAX_VEC];
+		::size_t  count = 0;
+		unsigned const n = cursor.fill(vec, count);
 
-	switch (out_result) {
-	case Result::READ_ERR_AGAIN:       return Errno(EAGAIN);
-	case Result::READ_ERR_WOULD_BLOCK: return Errno(EWOULDBLOCK);
-	case Result::READ_ERR_INVALID:     return Errno(EINVAL);
-	case Result::READ_ERR_IO:          return Errno(EIO);
-	case Result::READ_ERR_INTERRUPT:   return Errno(EINTR);
-	case Result::READ_OK:              break;
+		ssize_t const res = vfs_writev(handle, fd->flags & O_NONBLOCK, vec, n);
+		if (res == -1)
+			return total ? total : -1;
 
-	case Result::READ_QUEUED: /* handled above, so never reached */ break;
+		total += res;
+		cursor.advance(res);
+
+		if ((::size_t)res < count)
+			break;
 	}
 
-	handle->advance_seek(out_count);
+	return total;
+}
 
-	return out_count;
+
+ssize_t Libc::Vfs_plugin::readv(Libc::File_descriptor *fd,
+                                const struct iovec *iov, int iovcnt)
+{
+	Libc::dispatch_pending_io_signals();
+
+	Vfs::Vfs_handle *handle = vfs_handle(fd);
+
+	if (fd->flags & O_NONBLOCK && !Libc::read_ready(fd))
+		return Errno(EAGAIN);
+
+	/* read-ahead and queued reads are handled by 'read' */
+	if (_lookup_io_context(handle))
+		return Plugin::readv(fd, iov, iovcnt);
+
+	Iov_cursor cursor(iov, iovcnt);
+	ssize_t    total = 0;
+
+	/*
+	 * Continue only as long as data is available to not block on a
+	 * stream that already delivered a part of the requested data.
+	 */
+	while (!cursor.done() && (total == 0 || Libc::read_ready(fd))) {
+
+		Io_vector vec[Iov_cursor::MAX_VEC];
+		::size_t  count = 0;
+		unsigned const n = cursor.fill(vec, count);
+
+		ssize_t const res = vfs_readv(handle, vec, n);
+		if (res == -1)
+			return total ? total : -1;
+
+		if (res == 0)
+			break;
+
+		total += res;
+		cursor.advance(res);
+	}
+
+	return total;
 }
 
 
@@ -804,6 +1678,10 @@ int Libc::Vfs_plugin::ioctl(Libc::File_descriptor *fd, int request, char *argp)
 	case SEEK_CUR: handle->advance_seek(offset); break;
 	case SEEK_END:
 		{
+			/* the file size must include the buffered data */
+			if (_flush_write_behind(fd) == -1)
+				return -1;
+
 			struct stat stat;
 			::memset(&stat, 0, sizeof(stat));
 			fstat(fd, &stat);
@@ -819,6 +1697,12 @@ int Libc::Vfs_plugin::ftruncate(Libc::File_descriptor *fd, ::off_t length)
 {
 	Vfs::Vfs_handle *handle = vfs_handle(fd);
 
+	if (Io_context *io = _lookup_io_context(handle)) {
+		_invalidate_read_ahead(*io);
+		if (_flush_write_behind(*io) == -1)
+			return -1;
+	}
+
 	typedef Vfs::File_io_service::Ftruncate_result Result;
 
 	switch (handle->fs().ftruncate(handle, length)) {
@@ -874,6 +1758,11 @@ int Libc::Vfs_plugin::fcntl(Libc::File_descriptor *fd, int cmd, long arg)
 int Libc::Vfs_plugin::fsync(Libc::File_descriptor *fd)
 {
 	Vfs::Vfs_handle *handle = vfs_handle(fd);
+
+	/* buffered data must reach the file system before the sync barrier */
+	if (_flush_write_behind(fd) == -1)
+		return -1;
+
 	_vfs_sync(handle);
 	return 0;
 }
@@ -1110,47 +1999,240 @@ int Libc::Vfs_plugin::rename(char const *from_path, char const *to_path)
 }
 
 
+/**
+ * File region mapped via 'mmap'
+ *
+ * If the file system provides the file content as dataspace, the dataspace
+ * is attached directly and its pages are populated on access. Otherwise,
+ * the region is backed by a RAM dataspace filled with a copy of the file.
+ */
+struct Libc::Vfs_plugin::Mapping : Genode::List<Mapping>::Element
+{
+	Genode::addr_t const addr;
+	::size_t       const size;
+	::off_t        const offset;   /* file offset of the region */
+
+	Genode::Dataspace_capability const ds;
+
+	/* dataspace obtained from the VFS, to be released at 'path' */
+	bool const vfs_ds;
+
+	/* handle used for writing back a shared writable mapping */
+	Vfs::Vfs_handle * const write_back_handle;
+
+	Genode::String<Vfs::MAX_PATH_LEN> const path;
+
+	Mapping(Genode::addr_t addr, ::size_t size, ::off_t offset,
+	        Genode::Dataspace_capability ds, bool vfs_ds,
+	        Vfs::Vfs_handle *write_back_handle, char const *path)
+	:
+		addr(addr), size(size), offset(offset), ds(ds), vfs_ds(vfs_ds),
+		write_back_handle(write_back_handle), path(path)
+	{ }
+
+	bool contains(void const *ptr) const
+	{
+		return (Genode::addr_t)ptr >= addr && (Genode::addr_t)ptr - addr < size;
+	}
+};
+
+
+Libc::Vfs_plugin::Mapping *Libc::Vfs_plugin::_lookup_mapping(void const *addr)
+{
+	for (Mapping *m = _mappings.first(); m; m = m->next())
+		if (m->contains(addr))
+			return m;
+
+	return nullptr;
+}
+
+
+int Libc::Vfs_plugin::_write_back(Mapping &mapping, Genode::addr_t offset,
+                                  ::size_t length)
+{
+	/* do not extend the file by the page-granular tail of the region */
+	Vfs::Directory_service::Stat stat;
+	if (_root_dir.stat(mapping.path.string(), stat) != Vfs::Directory_service::STAT_OK)
+		return Libc::Errno(EIO);
+
+	Vfs::file_size const file_offset = mapping.offset + offset;
+	if (file_offset >= stat.size)
+		return 0;
+
+	length = Genode::min((Vfs::file_size)length, stat.size - file_offset);
+
+	Vfs::Vfs_handle *handle = mapping.write_back_handle;
+	handle->seek(file_offset);
+
+	char const *src = (char const *)(mapping.addr + offset);
+	for (::size_t written = 0; written < length; ) {
+		ssize_t const n = vfs_write(handle, false, src + written, length - written);
+		if (n < 0)
+			return -1;
+		if (n == 0)
+			return Libc::Errno(EIO);
+		written += n;
+	}
+
+	_vfs_sync(handle);
+	return 0;
+}
+
+
 void *Libc::Vfs_plugin::mmap(void *addr_in, ::size_t length, int prot, int flags,
                              Libc::File_descriptor *fd, ::off_t offset)
 {
-	if (prot != PROT_READ) {
-		Genode::error("mmap for prot=", Genode::Hex(prot), " not supported");
+	using namespace Genode;
+
+	if (length == 0 || offset < 0 || (offset & ((1 << PAGE_SHIFT) - 1))) {
+		errno = EINVAL;
+		return MAP_FAILED;
+	}
+
+	bool const shared     = flags & MAP_SHARED;
+	bool const fixed      = flags & MAP_FIXED;
+	bool const writeable  = prot  & PROT_WRITE;
+	bool const executable = prot  & PROT_EXEC;
+
+	int const mode = fd->flags & O_ACCMODE;
+	if (mode == O_WRONLY || (shared && writeable && mode != O_RDWR)) {
 		errno = EACCES;
-		return (void *)-1;
+		return MAP_FAILED;
 	}
 
-	if (addr_in != 0) {
-		Genode::error("mmap for predefined address not supported");
-		errno = EINVAL;
-		return (void *)-1;
+	::size_t const size = align_addr(length, PAGE_SHIFT);
+
+	/* obtain the file content as dataspace if supported by the file system */
+	Dataspace_capability vfs_ds;
+	if (fd->fd_path)
+		vfs_ds = _root_dir.dataspace(fd->fd_path);
+
+	if (vfs_ds.valid()) {
+		Dataspace_client client(vfs_ds);
+
+		/*
+		 * A read-only dataspace, e.g., a ROM module, cannot back a writeable
+		 * mapping. The region must also lie within the dataspace.
+		 */
+		if ((writeable && !client.writable()) || offset + size > client.size()) {
+			_root_dir.release(fd->fd_path, vfs_ds);
+			vfs_ds = Dataspace_capability();
+		}
 	}
 
-	/*
-	 * XXX attempt to obtain memory mapping via
-	 *     'Vfs::Directory_service::dataspace'.
-	 */
+	Ram_dataspace_capability ram_ds;
+	if (!vfs_ds.valid()) {
+		try { ram_ds = _env.ram().alloc(size); }
+		catch (...) {
+			errno = ENOMEM;
+			return MAP_FAILED;
+		}
+	}
 
-	void *addr = Libc::mem_alloc()->alloc(length, PAGE_SHIFT);
-	if (addr == (void *)-1) {
-		errno = ENOMEM;
-		return (void *)-1;
+	Dataspace_capability const ds = vfs_ds.valid()
+	                              ? vfs_ds : Dataspace_capability(ram_ds);
+
+	addr_t           addr   = 0;
+	Vfs::Vfs_handle *handle = nullptr;
+
+	auto failed = [&] (int err) -> void *
+	{
+		if (handle) handle->ds().close(handle);
+		if (addr)   _env.rm().detach(addr);
+
+		if (vfs_ds.valid()) _root_dir.release(fd->fd_path, vfs_ds);
+		if (ram_ds.valid()) _env.ram().free(ram_ds);
+
+		errno = err;
+		return MAP_FAILED;
+	};
+
+	try {
+		addr = _env.rm().attach(ds, size, vfs_ds.valid() ? offset : 0,
+		                        fixed, (addr_t)addr_in, executable);
 	}
+	catch (Region_map::Region_conflict) { return failed(fixed ? EINVAL : ENOMEM); }
+	catch (...)                         { return failed(ENOMEM); }
+
+	/* copy the file content if the file system lacks dataspace support */
+	if (ram_ds.valid()) {
+		for (::size_t copied = 0; copied < length; ) {
+			ssize_t const n = ::pread(fd->libc_fd, (char *)addr + copied,
+			                          length - copied, offset + copied);
+			if (n < 0) {
+				error("mmap could not obtain file content");
+				return failed(EACCES);
+			}
 
-	if (::pread(fd->libc_fd, addr, length, offset) < 0) {
-		Genode::error("mmap could not obtain file content");
-		::munmap(addr, length);
-		errno = EACCES;
-		return (void *)-1;
+			/* the part beyond the end of the file remains zeroed */
+			if (n == 0)
+				break;
+
+			copied += n;
+		}
+	}
+
+	/* shared writeable mappings are written back via a dedicated handle */
+	if (shared && writeable) {
+		typedef Vfs::Directory_service::Open_result Open_result;
+
+		if (!fd->fd_path
+		 || _root_dir.open(fd->fd_path, Vfs::Directory_service::OPEN_MODE_WRONLY,
+		                   &handle, _alloc) != Open_result::OPEN_OK) {
+			handle = nullptr;
+			return failed(EACCES);
+		}
 	}
 
-	return addr;
+	_mappings.insert(new (_alloc) Mapping(addr, size, offset, ds, vfs_ds.valid(),
+	                                      handle, fd->fd_path ? fd->fd_path : ""));
+	return (void *)addr;
 }
 
 
 int Libc::Vfs_plugin::munmap(void *addr, ::size_t)
 {
-	Libc::mem_alloc()->free(addr);
-	return 0;
+	Mapping *mapping = _lookup_mapping(addr);
+	if (!mapping || mapping->addr != (Genode::addr_t)addr) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	int result = 0;
+
+	if (mapping->write_back_handle) {
+		result = _write_back(*mapping, 0, mapping->size);
+		mapping->write_back_handle->ds().close(mapping->write_back_handle);
+	}
+
+	_mappings.remove(mapping);
+	_env.rm().detach(mapping->addr);
+
+	if (mapping->vfs_ds)
+		_root_dir.release(mapping->path.string(), mapping->ds);
+	else
+		_env.ram().free(Genode::static_cap_cast<Genode::Ram_dataspace>(mapping->ds));
+
+	destroy(_alloc, mapping);
+	return result;
+}
+
+
+int Libc::Vfs_plugin::msync(void *addr, ::size_t length, int)
+{
+	Mapping *mapping = _lookup_mapping(addr);
+	if (!mapping) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	/* private and read-only mappings have nothing to write back */
+	if (!mapping->write_back_handle)
+		return 0;
+
+	Genode::addr_t const offset = (Genode::addr_t)addr - mapping->addr;
+
+	return _write_back(*mapping, offset, Genode::min(length, mapping->size - offset));
 }
 
 
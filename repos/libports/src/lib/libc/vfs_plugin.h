@@ -28,6 +28,8 @@
 #include <libc-plugin/plugin.h>
 #include <libc-plugin/fd_alloc.h>
 
+struct aiocb;
+
 namespace Libc { class Vfs_plugin; }
 
 
@@ -35,10 +37,54 @@ class Libc::Vfs_plugin : public Libc::Plugin
 {
 	private:
 
+		Genode::Env       &_env;
 		Genode::Allocator &_alloc;
 
 		Vfs::File_system &_root_dir;
 
+		/*
+		 * Sizes of the per-file read-ahead and write-behind buffers,
+		 * configured via the 'read_ahead' and 'write_behind' attributes
+		 * of the '<libc>' node, zero disables the buffering
+		 */
+		Genode::size_t _read_ahead   = 0;
+		Genode::size_t _write_behind = 0;
+
+		/**
+		 * Per-handle state of buffered and asynchronous I/O
+		 */
+		struct Io_context;
+		struct Aio_request;
+
+		Genode::List<Io_context> _io_contexts;
+
+		Io_context *_lookup_io_context(Vfs::Vfs_handle *);
+		Io_context &_io_context(Vfs::Vfs_handle *);
+		void        _destroy_io_context(Io_context &);
+
+		void    _queued_read_completed(Io_context &,
+		                               Vfs::File_io_service::Read_result,
+		                               Vfs::file_size);
+		void    _complete_queued_read(Io_context &);
+		bool    _try_complete_queued_read(Io_context &);
+		void    _invalidate_read_ahead(Io_context &);
+		void    _queue_read_ahead(Io_context &);
+		ssize_t _buffered_read(Io_context &, void *, ::size_t);
+		ssize_t _buffered_write(Io_context &, void const *, ::size_t);
+		int     _flush_write_behind(Io_context &);
+		int     _flush_write_behind(Libc::File_descriptor *);
+		void    _aio_progress(Io_context &);
+
+		/**
+		 * File region mapped via 'mmap'
+		 */
+		struct Mapping;
+
+		Genode::List<Mapping> _mappings;
+
+		Mapping *_lookup_mapping(void const *);
+		int      _write_back(Mapping &, Genode::addr_t, ::size_t);
+
 		void _open_stdio(Genode::Xml_node const &node, char const *attr,
 		                 int libc_fd, unsigned flags)
 		{
@@ -138,7 +184,7 @@ class Libc::Vfs_plugin : public Libc::Plugin
 
 		Vfs_plugin(Libc::Env &env, Genode::Allocator &alloc)
 		:
-			_alloc(alloc), _root_dir(env.vfs())
+			_env(env), _alloc(alloc), _root_dir(env.vfs())
 		{
 			using Genode::Xml_node;
 
@@ -153,6 +199,11 @@ class Libc::Vfs_plugin : public Libc::Plugin
 							chdir(path.string());
 						} catch (Xml_node::Nonexistent_attribute) { }
 
+						_read_ahead = node.attribute_value("read_ahead",
+						                                   Genode::Number_of_bytes(0));
+						_write_behind = node.attribute_value("write_behind",
+						                                     Genode::Number_of_bytes(0));
+
 						_open_stdio(node, "stdin",  0, O_RDONLY);
 						_open_stdio(node, "stdout", 1, O_WRONLY);
 						_open_stdio(node, "stderr", 2, O_WRONLY);
@@ -197,6 +248,7 @@ class Libc::Vfs_plugin : public Libc::Plugin
 		::off_t lseek(Libc::File_descriptor *fd, ::off_t offset, int whence) override;
 		int     mkdir(const char *, mode_t) override;
 		ssize_t read(Libc::File_descriptor *, void *, ::size_t) override;
+		ssize_t readv(Libc::File_descriptor *, const struct iovec *, int) override;
 		ssize_t readlink(const char *, char *, ::size_t) override;
 		int     rename(const char *, const char *) override;
 		int     rmdir(const char *) override;
@@ -204,9 +256,23 @@ class Libc::Vfs_plugin : public Libc::Plugin
 		int     symlink(const char *, const char *) override;
 		int     unlink(const char *) override;
 		ssize_t write(Libc::File_descriptor *, const void *, ::size_t ) override;
+		ssize_t writev(Libc::File_descriptor *, const struct iovec *, int) override;
 		void   *mmap(void *, ::size_t, int, int, Libc::File_descriptor *, ::off_t) override;
 		int     munmap(void *, ::size_t) override;
+		int     msync(void *, ::size_t, int) override;
 		int     select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout) override;
+
+		/*
+		 * Back end of the POSIX AIO functions
+		 *
+		 * Read requests are queued at the VFS and complete asynchronously.
+		 * The completion state is kept in the 'aiocb', which is updated by
+		 * 'aio_progress'.
+		 */
+		int  aio_read(Libc::File_descriptor *, struct aiocb *);
+		int  aio_write(Libc::File_descriptor *, struct aiocb *);
+		int  aio_cancel(Libc::File_descriptor *, struct aiocb *);
+		void aio_progress(Libc::File_descriptor *);
 };
 
 #endif
@@ -14,7 +14,10 @@
 
 #include <base/log.h>
 #include <base/thread.h>
+#include <cpu/atomic.h>
+#include <cpu/memory_barrier.h>
 #include <os/timed_semaphore.h>
+#include <util/fifo.h>
 #include <util/list.h>
 
 #include <errno.h>
@@ -60,28 +63,36 @@ static __attribute__((constructor)) Thread * main_thread()
 }
 
 
-void Pthread_registry::insert(pthread_t thread)
+void Pthread_registry::insert(Thread const &thread, pthread_t pthread)
 {
-	/* prevent multiple insertions at the same location */
-	static Genode::Lock insert_lock;
-	Genode::Lock::Guard insert_lock_guard(insert_lock);
+	Genode::Lock::Guard guard(_lock);
 
-	for (unsigned int i = 0; i < MAX_NUM_PTHREADS; i++) {
-		if (_array[i] == 0) {
-			_array[i] = thread;
-			return;
-		}
+	if (_count == MAX_NUM_PTHREADS) {
+		Genode::error("pthread registry overflow, pthread_self() might fail");
+		return;
 	}
 
-	Genode::error("pthread registry overflow, pthread_self() might fail");
+	unsigned i = _home(&thread);
+	while (_slots[i].thread && _slots[i].thread != _deleted())
+		i = (i + 1) & MASK;
+
+	/* make the slot visible to lookups only after it is complete */
+	_slots[i].pthread = pthread;
+	Genode::memory_barrier();
+	_slots[i].thread  = &thread;
+	_count++;
 }
 
 
 void Pthread_registry::remove(pthread_t thread)
 {
-	for (unsigned int i = 0; i < MAX_NUM_PTHREADS; i++) {
-		if (_array[i] == thread) {
-			_array[i] = 0;
+	Genode::Lock::Guard guard(_lock);
+
+	for (unsigned int i = 0; i < SLOTS; i++) {
+		if (_slots[i].thread && _slots[i].thread != _deleted()
+		 && _slots[i].pthread == thread) {
+			_slots[i].thread = _deleted();
+			_count--;
 			return;
 		}
 	}
@@ -92,8 +103,11 @@ void Pthread_registry::remove(pthread_t thread)
 
 bool Pthread_registry::contains(pthread_t thread)
 {
-	for (unsigned int i = 0; i < MAX_NUM_PTHREADS; i++)
-		if (_array[i] == thread)
+	Genode::Lock::Guard guard(_lock);
+
+	for (unsigned int i = 0; i < SLOTS; i++)
+		if (_slots[i].thread && _slots[i].thread != _deleted()
+		 && _slots[i].pthread == thread)
 			return true;
 
 	return false;
@@ -181,9 +195,7 @@ extern "C" {
 	{
 		Thread *myself = Thread::myself();
 
-		pthread_t pthread_myself = static_cast<pthread_t>(myself);
-
-		if (pthread_registry().contains(pthread_myself))
+		if (pthread_t pthread_myself = pthread_registry().lookup(myself))
 			return pthread_myself;
 
 		/*
@@ -275,155 +287,133 @@ extern "C" {
 	};
 
 
+	/*
+	 * The mutex is a lock word modified by atomic operations. In the
+	 * uncontended case, locking and unlocking take a single atomic
+	 * operation each. Only contended threads block at the semaphore, like
+	 * at a futex.
+	 */
 	struct pthread_mutex
 	{
+		enum { UNLOCKED = 0, LOCKED = 1, CONTENDED = 2 };
+
 		pthread_mutex_attr mutexattr;
 
-		Lock mutex_lock;
+		volatile int state = UNLOCKED;
+		Semaphore    waiters;
 
-		pthread_t owner;
-		int       lock_count;
-		Lock      owner_and_counter_lock;
+		/* owner is valid while the lock count is non-zero */
+		Thread const *owner      = nullptr;
+		int           lock_count = 0;
 
 		pthread_mutex(const pthread_mutexattr_t *__restrict attr)
-		: owner(0),
-		  lock_count(0)
 		{
 			if (attr && *attr)
 				mutexattr = **attr;
 		}
 
-		int lock()
+		int _swap(int value)
 		{
-			if (mutexattr.type == PTHREAD_MUTEX_RECURSIVE) {
-
-				Lock::Guard lock_guard(owner_and_counter_lock);
-
-				if (lock_count == 0) {
-					owner = pthread_self();
-					lock_count++;
-					mutex_lock.lock();
-					return 0;
-				}
-
-				/* the mutex is already locked */
-				if (pthread_self() == owner) {
-					lock_count++;
-					return 0;
-				} else {
-					mutex_lock.lock();
-					return 0;
-				}
+			for (;;) {
+				int const old = state;
+				if (cmpxchg(&state, old, value))
+					return old;
 			}
+		}
 
-			if (mutexattr.type == PTHREAD_MUTEX_ERRORCHECK) {
+		bool _try_acquire() { return cmpxchg(&state, UNLOCKED, LOCKED); }
 
-				Lock::Guard lock_guard(owner_and_counter_lock);
+		void _acquire()
+		{
+			if (_try_acquire())
+				return;
 
-				if (lock_count == 0) {
-					owner = pthread_self();
-					mutex_lock.lock();
-					return 0;
-				}
+			/*
+			 * Mark the mutex as contended and block until it is released.
+			 * A wake-up may be spurious, in which case we block again.
+			 */
+			while (_swap(CONTENDED) != UNLOCKED)
+				waiters.down();
+		}
 
-				/* the mutex is already locked */
-				if (pthread_self() != owner) {
-					mutex_lock.lock();
-					return 0;
-				} else
-					return EDEADLK;
-			}
+		void _release()
+		{
+			if (_swap(UNLOCKED) == CONTENDED)
+				waiters.up();
+		}
 
-			/* PTHREAD_MUTEX_NORMAL or PTHREAD_MUTEX_DEFAULT */
-			mutex_lock.lock();
-			return 0;
+		bool _owner_checked() const
+		{
+			return mutexattr.type == PTHREAD_MUTEX_RECURSIVE
+			    || mutexattr.type == PTHREAD_MUTEX_ERRORCHECK;
 		}
 
-		int trylock()
+		int lock()
 		{
-			if (mutexattr.type == PTHREAD_MUTEX_RECURSIVE) {
-
-				Lock::Guard lock_guard(owner_and_counter_lock);
-
-				if (lock_count == 0) {
-					owner = pthread_self();
-					lock_count++;
-					mutex_lock.lock();
-					return 0;
-				}
-
-				/* the mutex is already locked */
-				if (pthread_self() == owner) {
-					lock_count++;
-					return 0;
-				} else {
-					return EBUSY;
-				}
+			/* PTHREAD_MUTEX_NORMAL or PTHREAD_MUTEX_DEFAULT */
+			if (!_owner_checked()) {
+				_acquire();
+				return 0;
 			}
 
-			if (mutexattr.type == PTHREAD_MUTEX_ERRORCHECK) {
-
-				Lock::Guard lock_guard(owner_and_counter_lock);
-
-				if (lock_count == 0) {
-					owner = pthread_self();
-					mutex_lock.lock();
-					return 0;
-				}
+			Thread const * const myself = Thread::myself();
 
-				/* the mutex is already locked */
-				if (pthread_self() != owner) {
-					return EBUSY;
-				} else
+			/* the mutex is already locked by us */
+			if (lock_count && owner == myself) {
+				if (mutexattr.type == PTHREAD_MUTEX_ERRORCHECK)
 					return EDEADLK;
-			}
-
-			/* PTHREAD_MUTEX_NORMAL or PTHREAD_MUTEX_DEFAULT */
-			Lock::Guard lock_guard(owner_and_counter_lock);
 
-			if (lock_count == 0) {
-				owner = pthread_self();
-				mutex_lock.lock();
+				lock_count++;
 				return 0;
 			}
 
-			return EBUSY;
+			_acquire();
+			owner      = myself;
+			lock_count = 1;
+			return 0;
 		}
 
-		int unlock()
+		int trylock()
 		{
+			/* PTHREAD_MUTEX_NORMAL or PTHREAD_MUTEX_DEFAULT */
+			if (!_owner_checked())
+				return _try_acquire() ? 0 : EBUSY;
 
-			if (mutexattr.type == PTHREAD_MUTEX_RECURSIVE) {
+			Thread const * const myself = Thread::myself();
 
-				Lock::Guard lock_guard(owner_and_counter_lock);
+			/* the mutex is already locked by us */
+			if (lock_count && owner == myself) {
+				if (mutexattr.type == PTHREAD_MUTEX_ERRORCHECK)
+					return EDEADLK;
 
-				if (pthread_self() != owner)
-					return EPERM;
+				lock_count++;
+				return 0;
+			}
 
-				lock_count--;
+			if (!_try_acquire())
+				return EBUSY;
 
-				if (lock_count == 0) {
-					owner = 0;
-					mutex_lock.unlock();
-				}
+			owner      = myself;
+			lock_count = 1;
+			return 0;
+		}
 
+		int unlock()
+		{
+			/* PTHREAD_MUTEX_NORMAL or PTHREAD_MUTEX_DEFAULT */
+			if (!_owner_checked()) {
+				_release();
 				return 0;
 			}
 
-			if (mutexattr.type == PTHREAD_MUTEX_ERRORCHECK) {
-
-				Lock::Guard lock_guard(owner_and_counter_lock);
+			if (!lock_count || owner != Thread::myself())
+				return EPERM;
 
-				if (pthread_self() != owner)
-					return EPERM;
-
-				owner = 0;
-				mutex_lock.unlock();
-				return 0;
+			if (--lock_count == 0) {
+				owner = nullptr;
+				_release();
 			}
 
-			/* PTHREAD_MUTEX_NORMAL or PTHREAD_MUTEX_DEFAULT */
-			mutex_lock.unlock();
 			return 0;
 		}
 	};
@@ -495,9 +485,7 @@ extern "C" {
 		if (*mutex == PTHREAD_MUTEX_INITIALIZER)
 			pthread_mutex_init(mutex, 0);
 
-		(*mutex)->lock();
-
-		return 0;
+		return (*mutex)->lock();
 	}
 
 
@@ -521,9 +509,7 @@ extern "C" {
 		if (*mutex == PTHREAD_MUTEX_INITIALIZER)
 			pthread_mutex_init(mutex, 0);
 
-		(*mutex)->unlock();
-
-		return 0;
+		return (*mutex)->unlock();
 	}
 
 
@@ -531,19 +517,86 @@ extern "C" {
 
 
 	/*
-	 * Implementation based on
-	 * http://web.archive.org/web/20010914175514/http://www-classic.be.com/aboutbe/benewsletter/volume_III/Issue40.html#Workshop
+	 * Each waiter blocks at a lock of its own, which is released by the
+	 * signalling thread. Hence, signalling never blocks and a waiter is
+	 * woken up directly instead of via a semaphore hand-shake. Only timed
+	 * waits involve the alarm thread, which aborts the wait on timeout.
 	 */
-
 	struct pthread_cond
 	{
-		int num_waiters;
-		int num_signallers;
-		Lock counter_lock;
-		Timed_semaphore signal_sem;
-		Semaphore handshake_sem;
+		struct Waiter : Fifo<Waiter>::Element
+		{
+			Lock lock { Lock::LOCKED };
+			bool woken { false };
+		};
+
+		struct Timeout : Alarm
+		{
+			pthread_cond &cond;
+			Waiter       &waiter;
+			bool          triggered { false };
+
+			Timeout(pthread_cond &cond, Waiter &waiter, Alarm::Time duration)
+			: cond(cond), waiter(waiter)
+			{
+				Timeout_thread *tt = Timeout_thread::alarm_timer();
+				tt->schedule_absolute(this, tt->time() + duration);
+			}
 
-		pthread_cond() : num_waiters(0), num_signallers(0) { }
+			~Timeout() { Timeout_thread::alarm_timer()->discard(this); }
+
+			bool on_alarm(unsigned) override
+			{
+				triggered = cond.abort(waiter);
+				return false;
+			}
+		};
+
+		Lock         meta_lock;
+		Fifo<Waiter> waiters;
+
+		void wait(Waiter &waiter)
+		{
+			waiter.lock.lock();
+		}
+
+		/**
+		 * Wake up waiter if not already done, called on timeout
+		 *
+		 * \return true if the waiter was woken up by the timeout
+		 */
+		bool abort(Waiter &waiter)
+		{
+			Lock::Guard guard(meta_lock);
+
+			if (waiter.woken)
+				return false;
+
+			waiters.remove(&waiter);
+			waiter.woken = true;
+			waiter.lock.unlock();
+			return true;
+		}
+
+		void signal()
+		{
+			Lock::Guard guard(meta_lock);
+
+			if (Waiter *waiter = waiters.dequeue()) {
+				waiter->woken = true;
+				waiter->lock.unlock();
+			}
+		}
+
+		void broadcast()
+		{
+			Lock::Guard guard(meta_lock);
+
+			while (Waiter *waiter = waiters.dequeue()) {
+				waiter->woken = true;
+				waiter->lock.unlock();
+			}
+		}
 	};
 
 
@@ -657,40 +710,36 @@ extern "C" {
 
 		pthread_cond *c = *cond;
 
-		c->counter_lock.lock();
-		c->num_waiters++;
-		c->counter_lock.unlock();
+		pthread_cond::Waiter waiter;
+		{
+			Lock::Guard guard(c->meta_lock);
+			c->waiters.enqueue(&waiter);
+		}
 
 		pthread_mutex_unlock(mutex);
 
 		if (!abstime)
-			c->signal_sem.down();
+			c->wait(waiter);
 		else {
 			struct timespec currtime;
 			clock_gettime(CLOCK_REALTIME, &currtime);
 
 			Alarm::Time timeout = timeout_ms(currtime, *abstime);
 
-			try {
-				c->signal_sem.down(timeout);
-			} catch (Timeout_exception) {
-				result = ETIMEDOUT;
-			} catch (Genode::Nonblocking_exception) {
-				errno  = ETIMEDOUT;
-				result = ETIMEDOUT;
+			if (timeout == 0) {
+				if (c->abort(waiter))
+					result = ETIMEDOUT;
+
+				/* consume wake-up of a concurrent signal */
+				c->wait(waiter);
+			} else {
+				pthread_cond::Timeout to(*c, waiter, timeout);
+				c->wait(waiter);
+				if (to.triggered)
+					result = ETIMEDOUT;
 			}
 		}
 
-		c->counter_lock.lock();
-		if (c->num_signallers > 0) {
-			if (result == ETIMEDOUT) /* timeout occured */
-				c->signal_sem.down();
-			c->handshake_sem.up();
-			--c->num_signallers;
-		}
-		c->num_waiters--;
-		c->counter_lock.unlock();
-
 		pthread_mutex_lock(mutex);
 
 		return result;
@@ -709,18 +758,9 @@ extern "C" {
 		if (!cond || !*cond)
 			return EINVAL;
 
-		pthread_cond *c = *cond;
-
-		c->counter_lock.lock();
-		if (c->num_waiters > c->num_signallers) {
-		  ++c->num_signallers;
-		  c->signal_sem.up();
-		  c->counter_lock.unlock();
-		  c->handshake_sem.down();
-		} else
-		  c->counter_lock.unlock();
+		(*cond)->signal();
 
-	   return 0;
+		return 0;
 	}
 
 
@@ -729,19 +769,7 @@ extern "C" {
 		if (!cond || !*cond)
 			return EINVAL;
 
-		pthread_cond *c = *cond;
-
-		c->counter_lock.lock();
-		if (c->num_waiters > c->num_signallers) {
-			int still_waiting = c->num_waiters - c->num_signallers;
-			c->num_signallers = c->num_waiters;
-			for (int i = 0; i < still_waiting; i++)
-				c->signal_sem.up();
-			c->counter_lock.unlock();
-			for (int i = 0; i < still_waiting; i++)
-				c->handshake_sem.down();
-		} else
-			c->counter_lock.unlock();
+		(*cond)->broadcast();
 
 		return 0;
 	}
@@ -749,6 +777,11 @@ extern "C" {
 	/* TLS */
 
 
+	/*
+	 * The values of pthreads are stored in their pthread objects. Values of
+	 * alien threads, which have no pthread object, are kept in a list per
+	 * key.
+	 */
 	struct Key_element : List<Key_element>::Element
 	{
 		const void *thread_base;
@@ -763,6 +796,25 @@ extern "C" {
 	static Lock key_list_lock;
 	List<Key_element> key_list[PTHREAD_KEYS_MAX];
 
+	static bool          key_used[PTHREAD_KEYS_MAX];
+	static unsigned long key_generation[PTHREAD_KEYS_MAX];
+
+
+	/**
+	 * Return pthread object of the current thread, or nullptr for aliens
+	 */
+	static pthread_t tls_pthread()
+	{
+		Thread *myself = Thread::myself();
+
+		if (pthread_t pthread = pthread_registry().lookup(myself))
+			return pthread;
+
+		/* the pthread object of the main thread is created on demand */
+		return _pthread_main_np() ? pthread_self() : nullptr;
+	}
+
+
 	int pthread_key_create(pthread_key_t *key, void (*destructor)(void*))
 	{
 		if (!key)
@@ -771,13 +823,12 @@ extern "C" {
 		Lock_guard<Lock> key_list_lock_guard(key_list_lock);
 
 		for (int k = 0; k < PTHREAD_KEYS_MAX; k++) {
-			/*
-			 * Find an empty key slot and insert an element for the current
-			 * thread to mark the key slot as used.
-			 */
-			if (!key_list[k].first()) {
-				Key_element *key_element = new Key_element(Thread::myself(), 0);
-				key_list[k].insert(key_element);
+			if (!key_used[k]) {
+				key_used[k] = true;
+
+				/* invalidate values stored for a former use of the key */
+				key_generation[k]++;
+
 				*key = k;
 				return 0;
 			}
@@ -789,11 +840,14 @@ extern "C" {
 
 	int pthread_key_delete(pthread_key_t key)
 	{
-		if (key < 0 || key >= PTHREAD_KEYS_MAX || !key_list[key].first())
+		if (key < 0 || key >= PTHREAD_KEYS_MAX || !key_used[key])
 			return EINVAL;
 
 		Lock_guard<Lock> key_list_lock_guard(key_list_lock);
 
+		key_used[key] = false;
+		key_generation[key]++;
+
 		while (Key_element * element = key_list[key].first()) {
 			key_list[key].remove(element);
 			delete element;
@@ -808,6 +862,12 @@ extern "C" {
 		if (key < 0 || key >= PTHREAD_KEYS_MAX)
 			return EINVAL;
 
+		if (pthread_t pthread = tls_pthread()) {
+			pthread->_tls[key].value      = value;
+			pthread->_tls[key].generation = key_generation[key];
+			return 0;
+		}
+
 		void *myself = Thread::myself();
 
 		Lock_guard<Lock> key_list_lock_guard(key_list_lock);
@@ -831,6 +891,12 @@ extern "C" {
 		if (key < 0 || key >= PTHREAD_KEYS_MAX)
 			return nullptr;
 
+		if (pthread_t pthread = tls_pthread()) {
+			pthread::Tls_slot const &slot = pthread->_tls[key];
+			return slot.generation == key_generation[key]
+			       ? (void *)slot.value : nullptr;
+		}
+
 		void *myself = Thread::myself();
 
 		Lock_guard<Lock> key_list_lock_guard(key_list_lock);
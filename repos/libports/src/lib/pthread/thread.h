@@ -16,27 +16,77 @@
 #ifndef _INCLUDE__SRC_LIB_PTHREAD_THREAD_H_
 #define _INCLUDE__SRC_LIB_PTHREAD_THREAD_H_
 
+#include <base/lock.h>
+#include <base/thread.h>
+
 #include <pthread.h>
 
 /*
- * Used by 'pthread_self()' to find out if the current thread is an alien
- * thread.
+ * Used by 'pthread_self()' to find the pthread object of the current thread
+ * and to find out if the current thread is an alien thread.
+ *
+ * The registry is a hash table indexed by the Genode thread. Lookups do not
+ * take a lock because every access to thread-specific data performs one.
+ * This is safe because a thread only looks up itself, and slots of removed
+ * threads are marked as deleted instead of emptied, which keeps the probe
+ * sequences of the remaining threads intact.
  */
 class Pthread_registry
 {
 	private:
 
-		enum { MAX_NUM_PTHREADS = 128 };
+		enum {
+			MAX_NUM_PTHREADS = 128,
+			SLOTS_LOG2       = 8,
+			SLOTS            = 1 << SLOTS_LOG2,
+			MASK             = SLOTS - 1,
+		};
+
+		struct Slot
+		{
+			Genode::Thread const * volatile thread;
+			pthread_t                       pthread;
+		};
+
+		Genode::Lock _lock;
+		Slot         _slots[SLOTS] { };
+		unsigned     _count = 0;
 
-		pthread_t _array[MAX_NUM_PTHREADS] = { 0 };
+		static Genode::Thread const *_deleted() {
+			return reinterpret_cast<Genode::Thread const *>(~0UL); }
+
+		static unsigned _home(Genode::Thread const *thread)
+		{
+			/* Fibonacci hashing of the object address */
+			Genode::uint32_t const key = (Genode::addr_t)thread >> 4;
+			return (key * 2654435769u) >> (32 - SLOTS_LOG2);
+		}
 
 	public:
 
-		void insert(pthread_t thread);
+		void insert(Genode::Thread const &thread, pthread_t pthread);
 
 		void remove(pthread_t thread);
 
 		bool contains(pthread_t thread);
+
+		/**
+		 * Return pthread object of Genode thread, or nullptr for aliens
+		 */
+		pthread_t lookup(Genode::Thread const *thread) const
+		{
+			unsigned i = _home(thread);
+			for (unsigned n = 0; n < SLOTS; n++, i = (i + 1) & MASK) {
+
+				Genode::Thread const *t = _slots[i].thread;
+				if (!t)
+					return nullptr;
+
+				if (t == thread)
+					return _slots[i].pthread;
+			}
+			return nullptr;
+		}
 };
 
 
@@ -60,10 +110,25 @@ extern "C" {
 	 */
 	struct pthread : Genode::Thread
 	{
+		/*
+		 * Value of a thread-specific data key
+		 *
+		 * The value is valid only if the generation matches the current
+		 * generation of the key, which changes whenever the key is created
+		 * or deleted.
+		 */
+		struct Tls_slot
+		{
+			void const    *value;
+			unsigned long  generation;
+		};
+
 		pthread_attr_t _attr;
 		void *(*_start_routine) (void *);
 		void *_arg;
 
+		Tls_slot _tls[PTHREAD_KEYS_MAX] { };
+
 		enum { WEIGHT = Genode::Cpu_session::Weight::DEFAULT_WEIGHT };
 
 		pthread(pthread_attr_t attr, void *(*start_routine) (void *),
@@ -77,7 +142,7 @@ extern "C" {
 			if (_attr)
 				_attr->pthread = this;
 
-			pthread_registry().insert(this);
+			pthread_registry().insert(*this, this);
 		}
 
 		/**
@@ -91,7 +156,7 @@ extern "C" {
 			if (_attr)
 				_attr->pthread = this;
 
-			pthread_registry().insert(this);
+			pthread_registry().insert(myself, this);
 		}
 
 		virtual ~pthread()
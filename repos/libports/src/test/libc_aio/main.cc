@@ -0,0 +1,254 @@
+/*
+ * \brief  Test for buffered and asynchronous file I/O of the libc
+ * \author Christian Helmuth
+ * \date   2017-11-27
+ *
+ * The test writes a file in small chunks, reads it back sequentially, and
+ * finally reads and rewrites it via the POSIX AIO interface. The first two
+ * phases exercise the write-behind and read-ahead buffers of the VFS
+ * plugin if enabled by the '<libc>' configuration.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+enum {
+	FILE_SIZE  = 4*1024*1024,
+	CHUNK_SIZE = 512,
+	AIO_SIZE   = 16*1024,
+	AIO_DEPTH  = 8,
+};
+
+
+static char const *file_name = "aio.tst";
+
+
+static unsigned long now_ms()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec*1000 + tv.tv_usec/1000;
+}
+
+
+static char pattern(off_t offset, unsigned round) { return (char)(offset/7 + round); }
+
+
+static void fill(char *buf, off_t offset, size_t size, unsigned round)
+{
+	for (size_t i = 0; i < size; i++)
+		buf[i] = pattern(offset + i, round);
+}
+
+
+static bool check(char const *buf, off_t offset, size_t size, unsigned round)
+{
+	for (size_t i = 0; i < size; i++)
+		if (buf[i] != pattern(offset + i, round)) {
+			printf("unexpected content at offset %lld\n", (long long)(offset + i));
+			return false;
+		}
+	return true;
+}
+
+
+static void report(char const *phase, unsigned long start_ms)
+{
+	unsigned long const ms = now_ms() - start_ms;
+	printf("%s: %lu ms (%lu KiB/s)\n", phase, ms,
+	       ms ? (unsigned long)FILE_SIZE / ms * 1000 / 1024 : 0);
+}
+
+
+static bool test_sequential()
+{
+	static char buf[CHUNK_SIZE];
+
+	int fd = open(file_name, O_CREAT | O_TRUNC | O_RDWR, 0644);
+	if (fd < 0) { printf("open failed, errno=%d\n", errno); return false; }
+
+	unsigned long start_ms = now_ms();
+	for (off_t offset = 0; offset < FILE_SIZE; offset += CHUNK_SIZE) {
+		fill(buf, offset, CHUNK_SIZE, 0);
+		if (write(fd, buf, CHUNK_SIZE) != CHUNK_SIZE) {
+			printf("write failed, errno=%d\n", errno);
+			return false;
+		}
+	}
+	if (fsync(fd) != 0) { printf("fsync failed, errno=%d\n", errno); return false; }
+	report("sequential write", start_ms);
+
+	lseek(fd, 0, SEEK_SET);
+
+	start_ms = now_ms();
+	for (off_t offset = 0; offset < FILE_SIZE; offset += CHUNK_SIZE) {
+		if (read(fd, buf, CHUNK_SIZE) != CHUNK_SIZE) {
+			printf("read failed, errno=%d\n", errno);
+			return false;
+		}
+		if (!check(buf, offset, CHUNK_SIZE, 0))
+			return false;
+	}
+	report("sequential read", start_ms);
+
+	if (read(fd, buf, CHUNK_SIZE) != 0) {
+		printf("read beyond end of file succeeded\n");
+		return false;
+	}
+
+	/* random access in the middle of the file must not be served stale */
+	off_t const offset = FILE_SIZE/2 + 3;
+	fill(buf, offset, CHUNK_SIZE, 1);
+	if (pwrite(fd, buf, CHUNK_SIZE, offset) != CHUNK_SIZE
+	 || pread(fd, buf, CHUNK_SIZE, offset) != CHUNK_SIZE
+	 || !check(buf, offset, CHUNK_SIZE, 1)) {
+		printf("read after write failed\n");
+		return false;
+	}
+
+	/* the file size must account data still held back by write-behind */
+	lseek(fd, 0, SEEK_END);
+	if (write(fd, buf, CHUNK_SIZE) != CHUNK_SIZE) {
+		printf("write failed, errno=%d\n", errno);
+		return false;
+	}
+	struct stat st;
+	off_t const size = FILE_SIZE + CHUNK_SIZE;
+	if (stat(file_name, &st) != 0 || st.st_size != size
+	 || fstat(fd, &st) != 0 || st.st_size != size
+	 || lseek(fd, 0, SEEK_END) != size) {
+		printf("stale file size after write\n");
+		return false;
+	}
+	if (ftruncate(fd, FILE_SIZE) != 0) {
+		printf("ftruncate failed, errno=%d\n", errno);
+		return false;
+	}
+
+	return close(fd) == 0;
+}
+
+
+static bool test_aio()
+{
+	static char bufs[AIO_DEPTH][AIO_SIZE];
+	static struct aiocb cbs[AIO_DEPTH];
+	struct aiocb *list[AIO_DEPTH];
+
+	int fd = open(file_name, O_RDWR);
+	if (fd < 0) { printf("open failed, errno=%d\n", errno); return false; }
+
+	/* rewrite the file in batches of requests */
+	unsigned long start_ms = now_ms();
+	for (off_t offset = 0; offset < FILE_SIZE; offset += AIO_DEPTH*AIO_SIZE) {
+		for (unsigned i = 0; i < AIO_DEPTH; i++) {
+			memset(&cbs[i], 0, sizeof(cbs[i]));
+			cbs[i].aio_fildes     = fd;
+			cbs[i].aio_offset     = offset + i*AIO_SIZE;
+			cbs[i].aio_buf        = bufs[i];
+			cbs[i].aio_nbytes     = AIO_SIZE;
+			cbs[i].aio_lio_opcode = LIO_WRITE;
+			fill(bufs[i], cbs[i].aio_offset, AIO_SIZE, 2);
+			list[i] = &cbs[i];
+		}
+		if (lio_listio(LIO_WAIT, list, AIO_DEPTH, 0) != 0) {
+			printf("lio_listio failed, errno=%d\n", errno);
+			return false;
+		}
+		for (unsigned i = 0; i < AIO_DEPTH; i++)
+			if (aio_return(&cbs[i]) != AIO_SIZE) {
+				printf("aio_write failed, error=%d\n", aio_error(&cbs[i]));
+				return false;
+			}
+	}
+	report("aio write", start_ms);
+
+	/* read the file with up to AIO_DEPTH outstanding requests */
+	start_ms = now_ms();
+	off_t    next    = 0;
+	unsigned pending = 0;
+
+	for (unsigned i = 0; i < AIO_DEPTH; i++) list[i] = 0;
+
+	while (next < FILE_SIZE || pending) {
+
+		for (unsigned i = 0; i < AIO_DEPTH && next < FILE_SIZE; i++) {
+			if (list[i]) continue;
+
+			memset(&cbs[i], 0, sizeof(cbs[i]));
+			cbs[i].aio_fildes = fd;
+			cbs[i].aio_offset = next;
+			cbs[i].aio_buf    = bufs[i];
+			cbs[i].aio_nbytes = AIO_SIZE;
+
+			if (aio_read(&cbs[i]) != 0) {
+				printf("aio_read failed, errno=%d\n", errno);
+				return false;
+			}
+			list[i] = &cbs[i];
+			next   += AIO_SIZE;
+			pending++;
+		}
+
+		if (aio_suspend(list, AIO_DEPTH, 0) != 0) {
+			printf("aio_suspend failed, errno=%d\n", errno);
+			return false;
+		}
+
+		for (unsigned i = 0; i < AIO_DEPTH; i++) {
+			if (!list[i] || aio_error(list[i]) == EINPROGRESS) continue;
+
+			char const *buf = (char const *)cbs[i].aio_buf;
+
+			ssize_t const n = aio_return(list[i]);
+			if (n <= 0 || !check(buf, cbs[i].aio_offset, n, 2)) {
+				printf("aio_read returned %zd, error=%d\n", n, aio_error(list[i]));
+				return false;
+			}
+
+			/* re-request the remainder of short reads */
+			if ((size_t)n < cbs[i].aio_nbytes) {
+				cbs[i].aio_offset += n;
+				cbs[i].aio_nbytes -= n;
+				cbs[i].aio_buf     = (char *)buf + n;
+				if (aio_read(&cbs[i]) != 0) return false;
+				continue;
+			}
+
+			list[i] = 0;
+			pending--;
+		}
+	}
+	report("aio read", start_ms);
+
+	return close(fd) == 0;
+}
+
+
+int main(int argc, char **argv)
+{
+	printf("--- libc AIO test ---\n");
+
+	bool const ok = test_sequential() && test_aio();
+
+	unlink(file_name);
+
+	printf("--- libc AIO test %s ---\n", ok ? "finished" : "failed");
+	return ok ? 0 : -1;
+}
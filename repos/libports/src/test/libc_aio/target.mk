@@ -0,0 +1,3 @@
+TARGET = test-libc_aio
+LIBS   = libc
+SRC_CC = main.cc
@@ -0,0 +1,144 @@
+/*
+ * \brief  File-copy benchmark
+ * \author Sebastian Sumpf
+ * \date   2017-11-28
+ *
+ * The benchmark writes a file, copies it to a second file, and reads the
+ * copy back for verification. The throughput of each phase is reported.
+ *
+ * Usage: test-libc_copy [<file size in MiB> [<buffer size in KiB>]]
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+static unsigned long now_ms()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec*1000 + tv.tv_usec/1000;
+}
+
+
+static void fill(unsigned *buf, off_t offset, size_t size)
+{
+	for (size_t i = 0; i < size/sizeof(unsigned); i++)
+		buf[i] = (unsigned)(offset/sizeof(unsigned) + i);
+}
+
+
+static bool check(unsigned const *buf, off_t offset, size_t size)
+{
+	for (size_t i = 0; i < size/sizeof(unsigned); i++)
+		if (buf[i] != (unsigned)(offset/sizeof(unsigned) + i))
+			return false;
+
+	return true;
+}
+
+
+static void report(char const *phase, size_t bytes, unsigned long ms)
+{
+	if (!ms) ms = 1;
+
+	printf("%s %zu KiB in %lu ms (%lu KiB/s)\n", phase, bytes/1024, ms,
+	       (unsigned long)(bytes/1024*1000/ms));
+}
+
+
+static int fail(char const *msg)
+{
+	perror(msg);
+	return -1;
+}
+
+
+int main(int argc, char **argv)
+{
+	size_t const file_size = (argc > 1 ? atol(argv[1]) : 16) * 1024 * 1024;
+	size_t const buf_size  = (argc > 2 ? atol(argv[2]) : 64) * 1024;
+
+	if (!file_size || !buf_size || buf_size % sizeof(unsigned))
+		return fail("invalid arguments");
+
+	printf("--- file-copy benchmark: %zu KiB file, %zu KiB buffer ---\n",
+	       file_size/1024, buf_size/1024);
+
+	unsigned *buf = (unsigned *)malloc(buf_size);
+	if (!buf)
+		return fail("malloc");
+
+	/* write source file */
+	unsigned long start = now_ms();
+
+	int src = open("copy_src.tst", O_CREAT | O_TRUNC | O_RDWR, 0644);
+	if (src < 0)
+		return fail("open source");
+
+	for (size_t offset = 0; offset < file_size; offset += buf_size) {
+		fill(buf, offset, buf_size);
+		if (write(src, buf, buf_size) != (ssize_t)buf_size)
+			return fail("write source");
+	}
+	fsync(src);
+
+	report("write", file_size, now_ms() - start);
+
+	/* copy */
+	start = now_ms();
+
+	int dst = open("copy_dst.tst", O_CREAT | O_TRUNC | O_RDWR, 0644);
+	if (dst < 0)
+		return fail("open destination");
+
+	lseek(src, 0, SEEK_SET);
+	for (;;) {
+		ssize_t n = read(src, buf, buf_size);
+		if (n < 0)
+			return fail("read source");
+		if (n == 0)
+			break;
+		if (write(dst, buf, n) != n)
+			return fail("write destination");
+	}
+	fsync(dst);
+
+	report("copy ", file_size, now_ms() - start);
+
+	/* read back copy */
+	start = now_ms();
+
+	lseek(dst, 0, SEEK_SET);
+	for (size_t offset = 0; offset < file_size; offset += buf_size) {
+		if (read(dst, buf, buf_size) != (ssize_t)buf_size)
+			return fail("read destination");
+		if (!check(buf, offset, buf_size)) {
+			printf("Error: unexpected content at offset %zu\n", offset);
+			return -1;
+		}
+	}
+
+	report("read ", file_size, now_ms() - start);
+
+	close(src);
+	close(dst);
+	unlink("copy_src.tst");
+	unlink("copy_dst.tst");
+	free(buf);
+
+	printf("--- file-copy benchmark finished ---\n");
+	return 0;
+}
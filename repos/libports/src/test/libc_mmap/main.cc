@@ -0,0 +1,176 @@
+/*
+ * \brief  Test and benchmark of file-backed mmap in the libc
+ * \author Christian Helmuth
+ * \date   2017-12-07
+ *
+ * The test maps a large ROM module and touches a few pages of it, which
+ * is compared to reading the whole file as done by the former 'mmap'
+ * implementation. It then modifies a file of the RAM file system via a
+ * shared mapping and checks that 'msync' writes the data back.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+enum {
+	PAGE_SIZE    = 4096,
+	TOUCH_PAGES  = 16,
+	RAM_SIZE     = 1024*1024,
+	SYNC_OFFSET  = 3*PAGE_SIZE + 100,
+	SYNC_SIZE    = 2*PAGE_SIZE,
+};
+
+
+static char const *rom_file = "/rom/mmap_data";
+static char const *ram_file = "/ram/mmap.tst";
+
+
+static unsigned long long now_us()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec*1000000ULL + tv.tv_usec;
+}
+
+
+static int fail(char const *what)
+{
+	printf("Error: %s failed, errno=%d\n", what, errno);
+	exit(1);
+}
+
+
+/**
+ * Sum up a few pages spread over the buffer
+ */
+static unsigned touch(char const *buf, size_t size)
+{
+	unsigned sum = 0;
+	for (unsigned i = 0; i < TOUCH_PAGES; i++)
+		sum += buf[(size/TOUCH_PAGES)*i];
+
+	return sum;
+}
+
+
+static void bench_rom()
+{
+	int const fd = open(rom_file, O_RDONLY);
+	if (fd < 0) fail("open ROM file");
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) fail("fstat");
+
+	size_t const size = st.st_size;
+
+	/* read the whole file, as the former 'mmap' implementation did */
+	unsigned long long start = now_us();
+
+	char *buf = (char *)malloc(size);
+	if (!buf) fail("malloc");
+
+	for (size_t done = 0; done < size; ) {
+		ssize_t const n = pread(fd, buf + done, size - done, done);
+		if (n <= 0) fail("pread");
+		done += n;
+	}
+	unsigned const read_sum = touch(buf, size);
+	free(buf);
+
+	unsigned long long const read_us = now_us() - start;
+
+	/* map the file and touch a few pages only */
+	start = now_us();
+
+	char *map = (char *)mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) fail("mmap ROM file");
+
+	unsigned const map_sum = touch(map, size);
+	munmap(map, size);
+
+	unsigned long long const map_us = now_us() - start;
+
+	close(fd);
+
+	if (read_sum != map_sum) {
+		printf("Error: mapped content differs from read content\n");
+		exit(1);
+	}
+
+	printf("file size:             %zu KiB\n", size/1024);
+	printf("read whole file:       %llu us\n", read_us);
+	printf("mmap + touch %2d pages: %llu us\n", TOUCH_PAGES, map_us);
+}
+
+
+static void test_shared_write_back()
+{
+	int const fd = open(ram_file, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) fail("open RAM file");
+
+	static char buf[RAM_SIZE];
+	memset(buf, 'a', sizeof(buf));
+	if (write(fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) fail("write");
+
+	char *map = (char *)mmap(0, RAM_SIZE, PROT_READ | PROT_WRITE,
+	                         MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) fail("mmap RAM file");
+
+	memset(map + SYNC_OFFSET, 'b', SYNC_SIZE);
+
+	if (msync(map + SYNC_OFFSET, SYNC_SIZE, MS_SYNC) != 0) fail("msync");
+
+	/* a private mapping must not be written back */
+	char *priv = (char *)mmap(0, RAM_SIZE, PROT_READ | PROT_WRITE,
+	                          MAP_PRIVATE, fd, 0);
+	if (priv == MAP_FAILED) fail("mmap private");
+
+	memset(priv, 'c', PAGE_SIZE);
+	munmap(priv, RAM_SIZE);
+	munmap(map, RAM_SIZE);
+
+	if (pread(fd, buf, sizeof(buf), 0) != (ssize_t)sizeof(buf)) fail("pread");
+
+	for (size_t i = 0; i < sizeof(buf); i++) {
+		bool const synced = (i >= SYNC_OFFSET && i < SYNC_OFFSET + SYNC_SIZE);
+		if (buf[i] != (synced ? 'b' : 'a')) {
+			printf("Error: unexpected content at offset %zu\n", i);
+			exit(1);
+		}
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size != RAM_SIZE) {
+		printf("Error: file size changed by write back\n");
+		exit(1);
+	}
+
+	close(fd);
+	printf("shared mapping written back\n");
+}
+
+
+int main(int argc, char **argv)
+{
+	bench_rom();
+	test_shared_write_back();
+
+	printf("--- test-libc_mmap finished ---\n");
+	return 0;
+}
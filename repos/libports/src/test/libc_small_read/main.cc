@@ -0,0 +1,157 @@
+/*
+ * \brief  Benchmark of small sequential reads
+ * \author Christian Helmuth
+ * \date   2017-11-28
+ *
+ * The benchmark writes a file with small writes and reads it back with
+ * small reads, like interpreters and shell tools do. The file is accessed
+ * via each of the given directories, which are expected to refer to the
+ * same file system with different VFS configurations.
+ *
+ * Usage: test-libc_small_read <file size in KiB> <I/O size in bytes> <dir>...
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+static unsigned long now_ms()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec*1000 + tv.tv_usec/1000;
+}
+
+
+static void report(char const *phase, char const *dir, size_t bytes,
+                   size_t calls, unsigned long ms)
+{
+	if (!ms) ms = 1;
+
+	printf("%s %s: %zu KiB in %lu ms (%lu KiB/s, %lu calls/s)\n",
+	       phase, dir, bytes/1024, ms, (unsigned long)(bytes/1024*1000/ms),
+	       (unsigned long)(calls*1000/ms));
+}
+
+
+static int fail(char const *msg)
+{
+	perror(msg);
+	return -1;
+}
+
+
+static int write_file(char const *dir, size_t file_size, char *buf, size_t io_size)
+{
+	char path[256];
+	snprintf(path, sizeof(path), "%s/small_read.dat", dir);
+
+	int const fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+	if (fd < 0)
+		return fail("open for writing");
+
+	unsigned long const start = now_ms();
+	size_t calls = 0;
+
+	for (size_t pos = 0; pos < file_size; pos += io_size, calls++) {
+		for (size_t i = 0; i < io_size; i++)
+			buf[i] = (char)(pos + i);
+
+		if (write(fd, buf, io_size) != (ssize_t)io_size)
+			return fail("write");
+	}
+
+	if (close(fd) < 0)
+		return fail("close");
+
+	report("write", dir, file_size, calls, now_ms() - start);
+	return 0;
+}
+
+
+static int read_file(char const *dir, size_t file_size, char *buf, size_t io_size)
+{
+	char path[256];
+	snprintf(path, sizeof(path), "%s/small_read.dat", dir);
+
+	int const fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return fail("open for reading");
+
+	unsigned long const start = now_ms();
+	size_t calls = 0, total = 0;
+
+	for (;;) {
+		ssize_t const n = read(fd, buf, io_size);
+		if (n < 0)
+			return fail("read");
+		if (n == 0)
+			break;
+
+		for (ssize_t i = 0; i < n; i++)
+			if (buf[i] != (char)(total + i)) {
+				fprintf(stderr, "data mismatch at offset %zu\n", total + i);
+				return -1;
+			}
+
+		total += n;
+		calls++;
+	}
+
+	close(fd);
+
+	if (total != file_size) {
+		fprintf(stderr, "read %zu bytes, expected %zu\n", total, file_size);
+		return -1;
+	}
+
+	report("read", dir, total, calls, now_ms() - start);
+	return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+	if (argc < 4) {
+		fprintf(stderr, "usage: %s <file KiB> <I/O bytes> <dir>...\n", argv[0]);
+		return -1;
+	}
+
+	size_t const file_size = atol(argv[1]) * 1024;
+	size_t const io_size   = atol(argv[2]);
+
+	if (!file_size || !io_size)
+		return fail("invalid arguments");
+
+	printf("--- small-read benchmark: %zu KiB file, %zu byte I/O ---\n",
+	       file_size/1024, io_size);
+
+	char *buf = (char *)malloc(io_size);
+	if (!buf)
+		return fail("malloc");
+
+	for (int i = 3; i < argc; i++)
+		if (write_file(argv[i], file_size, buf, io_size))
+			return -1;
+
+	for (int i = 3; i < argc; i++)
+		if (read_file(argv[i], file_size, buf, io_size))
+			return -1;
+
+	free(buf);
+
+	printf("--- small-read benchmark finished ---\n");
+	return 0;
+}
@@ -0,0 +1,3 @@
+TARGET = test-libc_small_read
+LIBS   = posix
+SRC_CC = main.cc
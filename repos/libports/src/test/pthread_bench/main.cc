@@ -0,0 +1,225 @@
+/*
+ * \brief  Micro benchmarks of thread-specific data, mutexes, and condition
+ *         variables
+ * \author Christian Prochaska
+ * \date   2017-11-29
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+
+enum {
+	TLS_ROUNDS       = 1000*1000,
+	MUTEX_ROUNDS     = 1000*1000,
+	PING_PONG_ROUNDS = 20*1000,
+	NUM_IDLE_THREADS = 16,
+	TIMEOUT_MS       = 50,
+};
+
+
+static unsigned long now_ms()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec*1000 + tv.tv_usec/1000;
+}
+
+
+static void report(char const *what, unsigned long rounds, unsigned long ms)
+{
+	printf("%-32s %8lu rounds in %5lu ms (%lu ns/round)\n", what, rounds, ms,
+	       ms ? (unsigned long)((unsigned long long)ms*1000*1000/rounds) : 0);
+}
+
+
+static void fail(char const *msg)
+{
+	printf("Error: %s\n", msg);
+	exit(-1);
+}
+
+
+/*
+ * Threads that merely exist, and use thread-specific data, to populate
+ * the data structures of the pthread library
+ */
+static pthread_key_t   key;
+static pthread_mutex_t idle_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  idle_cond;
+static bool            idle_done = false;
+
+static void *idle_thread(void *arg)
+{
+	pthread_setspecific(key, arg);
+
+	pthread_mutex_lock(&idle_mutex);
+	while (!idle_done)
+		pthread_cond_wait(&idle_cond, &idle_mutex);
+	pthread_mutex_unlock(&idle_mutex);
+
+	if (pthread_getspecific(key) != arg)
+		fail("thread-specific data of idle thread changed");
+
+	return nullptr;
+}
+
+
+static void bench_tls()
+{
+	int value = 0;
+	pthread_setspecific(key, &value);
+
+	unsigned long start = now_ms();
+	for (unsigned i = 0; i < TLS_ROUNDS; i++)
+		if (pthread_getspecific(key) != &value)
+			fail("unexpected thread-specific data");
+	report("pthread_getspecific", TLS_ROUNDS, now_ms() - start);
+
+	start = now_ms();
+	for (unsigned i = 0; i < TLS_ROUNDS; i++)
+		pthread_setspecific(key, &value);
+	report("pthread_setspecific", TLS_ROUNDS, now_ms() - start);
+}
+
+
+static void bench_mutex(char const *name, int type)
+{
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, type);
+
+	pthread_mutex_t mutex;
+	pthread_mutex_init(&mutex, &attr);
+
+	unsigned long start = now_ms();
+	for (unsigned i = 0; i < MUTEX_ROUNDS; i++) {
+		pthread_mutex_lock(&mutex);
+		pthread_mutex_unlock(&mutex);
+	}
+	report(name, MUTEX_ROUNDS, now_ms() - start);
+
+	pthread_mutex_destroy(&mutex);
+	pthread_mutexattr_destroy(&attr);
+}
+
+
+/*
+ * Two threads pass a token back and forth via a condition variable
+ */
+struct Ping_pong
+{
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	pthread_cond_t  cond;
+	unsigned        token = 0;
+};
+
+static void *pong_thread(void *arg)
+{
+	Ping_pong &pp = *(Ping_pong *)arg;
+
+	pthread_mutex_lock(&pp.mutex);
+	for (unsigned i = 0; i < PING_PONG_ROUNDS; i++) {
+		while (pp.token % 2 == 0)
+			pthread_cond_wait(&pp.cond, &pp.mutex);
+		pp.token++;
+		pthread_cond_signal(&pp.cond);
+	}
+	pthread_mutex_unlock(&pp.mutex);
+
+	return nullptr;
+}
+
+static void bench_cond()
+{
+	/* static because the pong thread may still release the mutex on return */
+	static Ping_pong pp;
+	pthread_cond_init(&pp.cond, nullptr);
+
+	pthread_t pong;
+	pthread_create(&pong, nullptr, pong_thread, &pp);
+
+	unsigned long start = now_ms();
+
+	pthread_mutex_lock(&pp.mutex);
+	for (unsigned i = 0; i < PING_PONG_ROUNDS; i++) {
+		pp.token++;
+		pthread_cond_signal(&pp.cond);
+		while (pp.token % 2 == 1)
+			pthread_cond_wait(&pp.cond, &pp.mutex);
+	}
+	pthread_mutex_unlock(&pp.mutex);
+
+	report("condition-variable ping-pong", PING_PONG_ROUNDS, now_ms() - start);
+}
+
+
+static void test_timedwait()
+{
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	pthread_cond_t  cond;
+	pthread_cond_init(&cond, nullptr);
+
+	struct timespec abstime;
+	clock_gettime(CLOCK_REALTIME, &abstime);
+	abstime.tv_nsec += TIMEOUT_MS*1000*1000;
+	if (abstime.tv_nsec >= 1000*1000*1000) {
+		abstime.tv_sec  += 1;
+		abstime.tv_nsec -= 1000*1000*1000;
+	}
+
+	unsigned long const start = now_ms();
+
+	pthread_mutex_lock(&mutex);
+	int const result = pthread_cond_timedwait(&cond, &mutex, &abstime);
+	pthread_mutex_unlock(&mutex);
+
+	unsigned long const ms = now_ms() - start;
+
+	if (result != ETIMEDOUT)
+		fail("pthread_cond_timedwait did not time out");
+
+	printf("pthread_cond_timedwait timed out after %lu ms (expected %u ms)\n",
+	       ms, (unsigned)TIMEOUT_MS);
+
+	pthread_cond_destroy(&cond);
+}
+
+
+int main(int argc, char **argv)
+{
+	printf("--- pthread benchmark ---\n");
+
+	pthread_key_create(&key, nullptr);
+	pthread_cond_init(&idle_cond, nullptr);
+
+	static pthread_t idle[NUM_IDLE_THREADS];
+	static unsigned  idle_value[NUM_IDLE_THREADS];
+	for (unsigned i = 0; i < NUM_IDLE_THREADS; i++)
+		pthread_create(&idle[i], nullptr, idle_thread, &idle_value[i]);
+
+	bench_tls();
+	bench_mutex("mutex (normal)",    PTHREAD_MUTEX_NORMAL);
+	bench_mutex("mutex (recursive)", PTHREAD_MUTEX_RECURSIVE);
+	bench_mutex("mutex (errorcheck)", PTHREAD_MUTEX_ERRORCHECK);
+	bench_cond();
+	test_timedwait();
+
+	pthread_mutex_lock(&idle_mutex);
+	idle_done = true;
+	pthread_cond_broadcast(&idle_cond);
+	pthread_mutex_unlock(&idle_mutex);
+
+	printf("--- pthread benchmark finished ---\n");
+	return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * \brief  Ring of damaged framebuffer regions shared between client and server
+ * \author Norman Feske
+ * \date   2017-11-30
+ *
+ * Instead of issuing a 'refresh' RPC for each updated region, a client may
+ * append the regions to a ring located in a dataspace shared with the
+ * framebuffer server. The server consumes the ring once per frame. The
+ * client is the only writer of the head index, the server is the only
+ * writer of the tail index. If the ring is full, the client sets the
+ * overflow flag, which prompts the server to refresh the whole buffer.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__FRAMEBUFFER_SESSION__DAMAGE_RING_H_
+#define _INCLUDE__FRAMEBUFFER_SESSION__DAMAGE_RING_H_
+
+#include <base/attached_dataspace.h>
+#include <cpu/memory_barrier.h>
+#include <framebuffer_session/framebuffer_session.h>
+#include <util/reconstructible.h>
+
+namespace Framebuffer {
+
+	class Damage_ring;
+	class Damage_reporter;
+}
+
+
+class Framebuffer::Damage_ring
+{
+	public:
+
+		enum { CAPACITY = 64 };
+
+		struct Rect { int x, y, w, h; };
+
+	private:
+
+		unsigned volatile _head     = 0;  /* written by the client */
+		unsigned volatile _tail     = 0;  /* written by the server */
+		unsigned volatile _overflow = 0;
+
+		Rect _entries[CAPACITY];
+
+	public:
+
+		/**
+		 * Append damaged region, to be called by the client
+		 */
+		void submit(int x, int y, int w, int h)
+		{
+			unsigned const head = _head;
+
+			if (head - _tail >= CAPACITY) {
+				_overflow = 1;
+				return;
+			}
+
+			_entries[head % CAPACITY] = Rect { x, y, w, h };
+
+			/* make the entry visible before advancing the head */
+			Genode::memory_barrier();
+			_head = head + 1;
+		}
+
+		/**
+		 * Consume all damaged regions, to be called by the server
+		 *
+		 * \return true if the whole buffer must be considered as damaged
+		 *
+		 * The entries are located in memory shared with the client. Hence,
+		 * 'fn' must sanitize the coordinates.
+		 */
+		template <typename FN>
+		bool consume(FN const &fn)
+		{
+			bool const overflow = _overflow;
+			if (overflow)
+				_overflow = 0;
+
+			unsigned const head = _head;
+			unsigned       tail = _tail;
+
+			/* the client corrupted the indices, discard the entries */
+			if (head - tail > CAPACITY) {
+				_tail = head;
+				return true;
+			}
+
+			Genode::memory_barrier();
+
+			for (; tail != head; tail++) {
+				Rect const r = _entries[tail % CAPACITY];
+				if (!overflow)
+					fn(r.x, r.y, r.w, r.h);
+			}
+
+			/* release the entries to the client */
+			Genode::memory_barrier();
+			_tail = tail;
+
+			return overflow;
+		}
+};
+
+
+/**
+ * Client-side helper for reporting damaged regions
+ *
+ * The reporter uses the damage ring if provided by the server and falls
+ * back to the 'refresh' RPC otherwise.
+ */
+class Framebuffer::Damage_reporter
+{
+	private:
+
+		Session &_framebuffer;
+
+		Genode::Constructible<Genode::Attached_dataspace> _ds;
+
+		Damage_ring *_ring = nullptr;
+
+	public:
+
+		Damage_reporter(Genode::Region_map &rm, Session &framebuffer)
+		:
+			_framebuffer(framebuffer)
+		{
+			Genode::Dataspace_capability ds_cap = _framebuffer.damage_ring();
+			if (!ds_cap.valid())
+				return;
+
+			_ds.construct(rm, ds_cap);
+
+			if (_ds->size() >= sizeof(Damage_ring))
+				_ring = _ds->local_addr<Damage_ring>();
+		}
+
+		void refresh(int x, int y, int w, int h)
+		{
+			if (_ring)
+				_ring->submit(x, y, w, h);
+			else
+				_framebuffer.refresh(x, y, w, h);
+		}
+};
+
+#endif /* _INCLUDE__FRAMEBUFFER_SESSION__DAMAGE_RING_H_ */
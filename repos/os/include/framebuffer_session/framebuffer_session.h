@@ -135,9 +135,26 @@ struct Framebuffer::Session : Genode::Session
 
 	/**
 	 * Register signal handler for refresh synchronization
+	 *
+	 * The signal is delivered whenever the server completed the update of
+	 * the physical frame buffer. A client that renders in response to this
+	 * signal renders exactly once per display refresh.
 	 */
 	virtual void sync_sigh(Genode::Signal_context_capability) = 0;
 
+	/**
+	 * Request dataspace containing a 'Damage_ring'
+	 *
+	 * By appending damaged regions to the ring, a client can flush pixels
+	 * without issuing a 'refresh' RPC for each region. The server processes
+	 * the ring entries once per frame.
+	 *
+	 * \return  invalid capability if the ring is not supported by the
+	 *          server, in which case the client must use 'refresh'
+	 */
+	virtual Genode::Dataspace_capability damage_ring() {
+		return Genode::Dataspace_capability(); }
+
 
 	/*********************
 	 ** RPC declaration **
@@ -148,9 +165,10 @@ struct Framebuffer::Session : Genode::Session
 	GENODE_RPC(Rpc_refresh, void, refresh, int, int, int, int);
 	GENODE_RPC(Rpc_mode_sigh, void, mode_sigh, Genode::Signal_context_capability);
 	GENODE_RPC(Rpc_sync_sigh, void, sync_sigh, Genode::Signal_context_capability);
+	GENODE_RPC(Rpc_damage_ring, Genode::Dataspace_capability, damage_ring);
 
 	GENODE_RPC_INTERFACE(Rpc_dataspace, Rpc_mode, Rpc_mode_sigh, Rpc_refresh,
-	                     Rpc_sync_sigh);
+	                     Rpc_sync_sigh, Rpc_damage_ring);
 };
 
 #endif /* _INCLUDE__FRAMEBUFFER_SESSION__FRAMEBUFFER_SESSION_H_ */
@@ -0,0 +1,95 @@
+/*
+ * \brief  Internet checksum (RFC 1071)
+ * \author Martin Stein
+ * \date   2017-12-19
+ *
+ * The one's-complement sum does not depend on the byte order in which the
+ * 16-bit words are added as long as the result is stored in the same byte
+ * order (RFC 1071, section 2 B). Thus, the data is summed up in host byte
+ * order, 32 bits at a time, in a 64-bit accumulator that defers the carry
+ * handling to a single fold at the end. This processes a machine word per
+ * addition instead of a byte-swapped 16-bit word and needs no SIMD
+ * registers, which makes it usable in any execution context.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _NET__INTERNET_CHECKSUM_H_
+#define _NET__INTERNET_CHECKSUM_H_
+
+/* Genode includes */
+#include <base/stdint.h>
+#include <util/endian.h>
+
+namespace Net {
+
+	/**
+	 * Add data to an unfolded one's-complement sum in host byte order
+	 *
+	 * Data of odd size must only be added as last part of a checksum.
+	 */
+	inline Genode::uint64_t checksum_add(Genode::uint64_t  sum,
+	                                     void const       *data,
+	                                     Genode::size_t    size)
+	{
+		using namespace Genode;
+
+		uint8_t const *p = (uint8_t const *)data;
+
+		/*
+		 * Unaligned data, e.g., an address in a packed structure, is summed
+		 * up bytewise. The bytes of a word are composed in network byte
+		 * order and converted to the host byte order of the sum.
+		 */
+		if ((addr_t)p & 1) {
+			for (; size > 1; size -= 2, p += 2)
+				sum += host_to_big_endian((uint16_t)(p[0] << 8 | p[1]));
+
+		} else {
+
+			/* headers are usually 2-byte aligned, align to 4 bytes */
+			if (((addr_t)p & 2) && size > 1) {
+				sum += *(uint16_t const *)p;
+				p += 2; size -= 2;
+			}
+			uint32_t const *w = (uint32_t const *)p;
+			for (; size >= 16; size -= 16, w += 4)
+				sum += (uint64_t)w[0] + w[1] + w[2] + w[3];
+
+			for (; size >= 4; size -= 4, w++)
+				sum += *w;
+
+			p = (uint8_t const *)w;
+			if (size > 1) {
+				sum += *(uint16_t const *)p;
+				p += 2; size -= 2;
+			}
+		}
+		/* an odd last byte is padded with a zero byte */
+		if (size)
+			sum += host_to_big_endian((uint16_t)(p[0] << 8));
+
+		return sum;
+	}
+
+	/**
+	 * Return checksum field value of a sum built with 'checksum_add'
+	 *
+	 * The result is in network byte order and can be stored directly to the
+	 * checksum field of a header.
+	 */
+	inline Genode::uint16_t checksum_finish(Genode::uint64_t sum)
+	{
+		while (sum >> 16)
+			sum = (sum & 0xffff) + (sum >> 16);
+
+		return (Genode::uint16_t)~sum;
+	}
+}
+
+#endif /* _NET__INTERNET_CHECKSUM_H_ */
@@ -20,6 +20,7 @@
 #include <util/endian.h>
 #include <net/ethernet.h>
 #include <net/ipv4.h>
+#include <net/internet_checksum.h>
 #include <util/register.h>
 #include <net/port.h>
 
@@ -39,6 +40,7 @@ class Net::Tcp_packet
 		using uint8_t      = Genode::uint8_t;
 		using uint16_t     = Genode::uint16_t;
 		using uint32_t     = Genode::uint32_t;
+		using uint64_t     = Genode::uint64_t;
 		using size_t       = Genode::size_t;
 		using Exception    = Genode::Exception;
 
@@ -123,31 +125,13 @@ class Net::Tcp_packet
 			_checksum = 0;
 
 			/* sum up pseudo header */
-			uint32_t sum = 0;
-			for (size_t i = 0; i < Ipv4_packet::ADDR_LEN; i += sizeof(uint16_t)) {
-				uint16_t s = ip_src.addr[i] << 8 | ip_src.addr[i + 1];
-				uint16_t d = ip_dst.addr[i] << 8 | ip_dst.addr[i + 1];
-				sum += s + d;
-			}
-			uint8_t prot[] = { 0, (uint8_t)Ipv4_packet::Protocol::TCP };
-			sum += host_to_big_endian(*(uint16_t *)&prot) + tcp_size;
+			uint64_t sum = checksum_add(0, ip_src.addr, Ipv4_packet::ADDR_LEN);
+			sum = checksum_add(sum, ip_dst.addr, Ipv4_packet::ADDR_LEN);
+			sum += host_to_big_endian((uint16_t)Ipv4_packet::Protocol::TCP);
+			sum += host_to_big_endian((uint16_t)tcp_size);
 
 			/* sum up TCP packet itself */
-			size_t max = (tcp_size & 1) ? (tcp_size - 1) : tcp_size;
-			uint16_t * tcp = (uint16_t *)this;
-			for (size_t i = 0; i < max; i = i + sizeof(*tcp)) {
-				sum += host_to_big_endian(*tcp++); }
-
-			/* if TCP size is odd, append a zero byte */
-			if (tcp_size & 1) {
-				uint8_t last[] = { *((uint8_t *)this + (tcp_size - 1)), 0 };
-				sum += host_to_big_endian(*(uint16_t *)&last);
-			}
-			/* keep the last 16 bits of the 32 bit sum and add the carries */
-			while (sum >> 16) { sum = (sum & 0xffff) + (sum >> 16); }
-
-			/* one's complement of sum */
-			_checksum = host_to_big_endian((uint16_t)~sum);
+			_checksum = checksum_finish(checksum_add(sum, this, tcp_size));
 		}
 
 		/**
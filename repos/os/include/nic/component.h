@@ -17,12 +17,14 @@
 
 #include <base/attached_ram_dataspace.h>
 #include <base/env.h>
+#include <nic/flow_hash.h>
 #include <nic/packet_allocator.h>
 #include <nic_session/rpc_object.h>
 
 namespace Nic {
 
 	class Communication_buffers;
+	class Queue;
 	class Session_component;
 }
 
@@ -47,13 +49,82 @@ class Nic::Communication_buffers
 };
 
 
+/**
+ * Additional queue pair of a session
+ */
+class Nic::Queue : Communication_buffers
+{
+	public:
+
+		Packet_stream_tx::Rpc_object<Session::Tx> tx;
+		Packet_stream_rx::Rpc_object<Session::Rx> rx;
+
+		Queue(Genode::size_t const tx_buf_size,
+		      Genode::size_t const rx_buf_size,
+		      Genode::Allocator   &rx_block_md_alloc,
+		      Genode::Env         &env)
+		:
+			Communication_buffers(rx_block_md_alloc, env.ram(), env.rm(),
+			                      tx_buf_size, rx_buf_size),
+			tx(_tx_ds.cap(), env.rm(), env.ep().rpc_ep()),
+			rx(_rx_ds.cap(), env.rm(), _rx_packet_alloc, env.ep().rpc_ep())
+		{ }
+};
+
+
 class Nic::Session_component : Communication_buffers, public Session_rpc_object
 {
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Session_component(Session_component const &);
+		Session_component &operator = (Session_component const &);
+
+		Genode::Allocator &_queue_alloc;
+
+		Queue *_queues[MAX_QUEUES] { };
+
+		void _destroy_queues()
+		{
+			for (unsigned i = 1; i < MAX_QUEUES; i++)
+				if (_queues[i])
+					Genode::destroy(_queue_alloc, _queues[i]);
+		}
+
 	protected:
 
 		Genode::Entrypoint               &_ep;
 		Genode::Signal_context_capability _link_state_sigh;
 
+		unsigned const _num_queues;
+
+		/**
+		 * Return tx channel of queue, queue 0 is the primary channel
+		 */
+		Packet_stream_tx::Rpc_object<Tx> &_queue_tx(unsigned queue) {
+			return queue ? _queues[queue]->tx : _tx; }
+
+		/**
+		 * Return rx channel of queue, queue 0 is the primary channel
+		 */
+		Packet_stream_rx::Rpc_object<Rx> &_queue_rx(unsigned queue) {
+			return queue ? _queues[queue]->rx : _rx; }
+
+		/**
+		 * Select queue for a packet received by the server
+		 *
+		 * Packets of the same flow are steered to the same queue.
+		 */
+		unsigned _steer(char const *data, Genode::size_t size) const
+		{
+			if (_num_queues == 1)
+				return 0;
+
+			return flow_hash(data, size) % _num_queues;
+		}
+
 
 		/**
 		 * Signal link-state change to client
@@ -87,11 +158,14 @@ class Nic::Session_component : Communication_buffers, public Session_rpc_object
 		 * \param env                Genode environment needed to access
 		 *                           resources and open connections from
 		 *                           within the Session_component
+		 * \param queues             number of queue pairs, each with
+		 *                           buffers of the given sizes
 		 */
 		Session_component(Genode::size_t const tx_buf_size,
 		                  Genode::size_t const rx_buf_size,
 		                  Genode::Allocator   &rx_block_md_alloc,
-		                  Genode::Env         &env)
+		                  Genode::Env         &env,
+		                  unsigned             queues = 1)
 		:
 			Communication_buffers(rx_block_md_alloc, env.ram(), env.rm(),
 			                      tx_buf_size, rx_buf_size),
@@ -99,15 +173,27 @@ class Nic::Session_component : Communication_buffers, public Session_rpc_object
 			                   _tx_ds.cap(),
 			                   _rx_ds.cap(),
 			                  &_rx_packet_alloc, env.ep().rpc_ep()),
-			_ep(env.ep())
+			_queue_alloc(rx_block_md_alloc),
+			_ep(env.ep()),
+			_num_queues(Genode::max(1U, Genode::min(queues, (unsigned)MAX_QUEUES)))
 		{
-			/* install data-flow signal handlers for both packet streams */
-			_tx.sigh_ready_to_ack(_packet_stream_dispatcher);
-			_tx.sigh_packet_avail(_packet_stream_dispatcher);
-			_rx.sigh_ready_to_submit(_packet_stream_dispatcher);
-			_rx.sigh_ack_avail(_packet_stream_dispatcher);
+			try {
+				for (unsigned i = 1; i < _num_queues; i++)
+					_queues[i] = new (_queue_alloc)
+						Queue(tx_buf_size, rx_buf_size, rx_block_md_alloc, env);
+			} catch (...) { _destroy_queues(); throw; }
+
+			/* install data-flow signal handlers for all packet streams */
+			for (unsigned i = 0; i < _num_queues; i++) {
+				_queue_tx(i).sigh_ready_to_ack(_packet_stream_dispatcher);
+				_queue_tx(i).sigh_packet_avail(_packet_stream_dispatcher);
+				_queue_rx(i).sigh_ready_to_submit(_packet_stream_dispatcher);
+				_queue_rx(i).sigh_ack_avail(_packet_stream_dispatcher);
+			}
 		}
 
+		~Session_component() { _destroy_queues(); }
+
 		void link_state_sigh(Genode::Signal_context_capability sigh)
 		{
 			_link_state_sigh = sigh;
@@ -122,6 +208,20 @@ class Nic::Session_component : Communication_buffers, public Session_rpc_object
 		 * Return the MAC address of the device
 		 */
 		virtual Mac_address mac_address() = 0;
+
+		unsigned queues() override { return _num_queues; }
+
+		Genode::Capability<Tx> _queue_tx_cap(unsigned queue) override
+		{
+			return queue < _num_queues ? _queue_tx(queue).cap()
+			                           : Genode::Capability<Tx>();
+		}
+
+		Genode::Capability<Rx> _queue_rx_cap(unsigned queue) override
+		{
+			return queue < _num_queues ? _queue_rx(queue).cap()
+			                           : Genode::Capability<Rx>();
+		}
 };
 
 
@@ -0,0 +1,75 @@
+/*
+ * \brief  Hash function for steering packets of a flow to one queue
+ * \author Stefan Kalkowski
+ * \date   2017-12-13
+ *
+ * The hash covers the IPv4 source and destination address and, for TCP
+ * and UDP, the ports. Fragments are hashed by their addresses only because
+ * only the first fragment carries the ports. All other packets yield a
+ * hash of 0. Hence, packets of one flow are always steered to the same
+ * queue, which preserves their order.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__NIC__FLOW_HASH_H_
+#define _INCLUDE__NIC__FLOW_HASH_H_
+
+#include <base/stdint.h>
+
+namespace Nic {
+
+	/**
+	 * Calculate flow hash of an Ethernet frame
+	 */
+	inline Genode::uint32_t flow_hash(char const *frame, Genode::size_t size)
+	{
+		using Genode::uint32_t;
+
+		enum {
+			ETH_HEADER  = 14,
+			ETH_TYPE    = 12,
+			IPV4_HEADER = 20,
+			IPV4_FRAG   = 6,
+			IPV4_PROTO  = 9,
+			IPV4_ADDRS  = 12,
+			TCP         = 6,
+			UDP         = 17,
+		};
+
+		unsigned char const *eth = (unsigned char const *)frame;
+
+		if (size < ETH_HEADER + IPV4_HEADER)
+			return 0;
+
+		if (eth[ETH_TYPE] != 0x08 || eth[ETH_TYPE + 1] != 0x00)
+			return 0;
+
+		unsigned char const *ip = eth + ETH_HEADER;
+
+		/* FNV-1a over a byte range */
+		uint32_t hash = 2166136261u;
+		auto hash_bytes = [&] (unsigned char const *p, unsigned len) {
+			for (unsigned i = 0; i < len; i++)
+				hash = (hash ^ p[i]) * 16777619u; };
+
+		hash_bytes(ip + IPV4_ADDRS, 8);
+
+		Genode::size_t const ihl      = (ip[0] & 0xf)*4;
+		bool           const fragment = ((ip[IPV4_FRAG] << 8) | ip[IPV4_FRAG + 1]) & 0x3fff;
+		unsigned char  const proto    = ip[IPV4_PROTO];
+
+		if (!fragment && (proto == TCP || proto == UDP)
+		 && ihl >= IPV4_HEADER && size >= ETH_HEADER + ihl + 4)
+			hash_bytes(ip + ihl, 4);
+
+		return hash;
+	}
+}
+
+#endif /* _INCLUDE__NIC__FLOW_HASH_H_ */
@@ -16,15 +16,23 @@
 
 #include <nic/component.h>
 #include <root/component.h>
+#include <util/meta.h>
 
 namespace Nic {
 	using namespace Genode;
 
-	template <class SESSION_COMPONENT> class Root;
+	template <class SESSION_COMPONENT, bool MULTI_QUEUE = false> class Root;
 };
 
 
-template <class SESSION_COMPONENT>
+/**
+ * Root component of a NIC driver
+ *
+ * \param MULTI_QUEUE  if true, the session component is constructed with
+ *                     the number of queue pairs requested by the client
+ *                     as additional constructor argument
+ */
+template <class SESSION_COMPONENT, bool MULTI_QUEUE>
 class Nic::Root : public Genode::Root_component<SESSION_COMPONENT,
                                                 Genode::Single_client>
 {
@@ -33,6 +41,22 @@ class Nic::Root : public Genode::Root_component<SESSION_COMPONENT,
 		Env       &_env;
 		Allocator &_md_alloc;
 
+		SESSION_COMPONENT *_new_session(size_t tx_buf_size, size_t rx_buf_size,
+		                                unsigned, Meta::Bool_to_type<false>)
+		{
+			return new (Root::md_alloc())
+			            SESSION_COMPONENT(tx_buf_size, rx_buf_size,
+			                             _md_alloc, _env);
+		}
+
+		SESSION_COMPONENT *_new_session(size_t tx_buf_size, size_t rx_buf_size,
+		                                unsigned queues, Meta::Bool_to_type<true>)
+		{
+			return new (Root::md_alloc())
+			            SESSION_COMPONENT(tx_buf_size, rx_buf_size,
+			                             _md_alloc, _env, queues);
+		}
+
 	protected:
 
 		SESSION_COMPONENT *_create_session(const char *args)
@@ -42,6 +66,9 @@ class Nic::Root : public Genode::Root_component<SESSION_COMPONENT,
 			size_t ram_quota   = Arg_string::find_arg(args, "ram_quota"  ).ulong_value(0);
 			size_t tx_buf_size = Arg_string::find_arg(args, "tx_buf_size").ulong_value(0);
 			size_t rx_buf_size = Arg_string::find_arg(args, "rx_buf_size").ulong_value(0);
+			unsigned queues    = Arg_string::find_arg(args, "queues"     ).ulong_value(1);
+
+			queues = MULTI_QUEUE ? max(1U, min(queues, (unsigned)Session::MAX_QUEUES)) : 1;
 
 			/* deplete ram quota by the memory needed for the session structure */
 			size_t session_size = max(4096UL, (unsigned long)sizeof(SESSION_COMPONENT));
@@ -49,19 +76,19 @@ class Nic::Root : public Genode::Root_component<SESSION_COMPONENT,
 				throw Genode::Insufficient_ram_quota();
 
 			/*
-			 * Check if donated ram quota suffices for both communication
-			 * buffers and check for overflow
+			 * Check if donated ram quota suffices for the communication
+			 * buffers of all queues and check for overflow
 			 */
-			if (tx_buf_size + rx_buf_size < tx_buf_size ||
-			    tx_buf_size + rx_buf_size > ram_quota - session_size) {
+			size_t const queue_size = tx_buf_size + rx_buf_size;
+			if (queue_size < tx_buf_size ||
+			    queue_size > (ram_quota - session_size) / queues) {
 				Genode::error("insufficient 'ram_quota', got ", ram_quota, ", "
-				              "need ", tx_buf_size + rx_buf_size + session_size);
+				              "need ", queue_size*queues + session_size);
 				throw Genode::Insufficient_ram_quota();
 			}
 
-			return new (Root::md_alloc())
-			            SESSION_COMPONENT(tx_buf_size, rx_buf_size,
-			                             _md_alloc, _env);
+			return _new_session(tx_buf_size, rx_buf_size, queues,
+			                    Meta::Bool_to_type<MULTI_QUEUE>());
 		}
 
 	public:
@@ -19,7 +19,11 @@
 #include <packet_stream_tx/client.h>
 #include <packet_stream_rx/client.h>
 
-namespace Nic { class Session_client; }
+namespace Nic {
+
+	class Session_client;
+	class Queue_client;
+}
 
 
 class Nic::Session_client : public Genode::Rpc_client<Session>
@@ -64,6 +68,58 @@ class Nic::Session_client : public Genode::Rpc_client<Session>
 		}
 
 		bool link_state() override { return call<Rpc_link_state>(); }
+
+		unsigned queues() override { return call<Rpc_queues>(); }
+
+		/**
+		 * Request channel capabilities of an additional queue pair
+		 *
+		 * \noapi
+		 */
+		Genode::Capability<Tx> queue_tx_cap(unsigned queue) {
+			return call<Rpc_queue_tx_cap>(queue); }
+
+		Genode::Capability<Rx> queue_rx_cap(unsigned queue) {
+			return call<Rpc_queue_rx_cap>(queue); }
+};
+
+
+/**
+ * Client-side interface of an additional queue pair of a NIC session
+ *
+ * The primary queue pair is accessed via the session client. The channels
+ * of each additional queue pair may be used by a dedicated thread.
+ */
+class Nic::Queue_client
+{
+	private:
+
+		Packet_stream_tx::Client<Session::Tx> _tx;
+		Packet_stream_rx::Client<Session::Rx> _rx;
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param queue            queue index, must be in the range of
+		 *                         1 to 'session.queues()' - 1
+		 * \param tx_buffer_alloc  allocator used for managing the
+		 *                         transmission buffer of the queue
+		 */
+		Queue_client(Session_client          &session,
+		             unsigned                 queue,
+		             Genode::Range_allocator &tx_buffer_alloc,
+		             Genode::Region_map      &rm)
+		:
+			_tx(session.queue_tx_cap(queue), rm, tx_buffer_alloc),
+			_rx(session.queue_rx_cap(queue), rm)
+		{ }
+
+		Session::Tx         *tx_channel() { return &_tx; }
+		Session::Rx         *rx_channel() { return &_rx; }
+		Session::Tx::Source *tx()         { return _tx.source(); }
+		Session::Rx::Sink   *rx()         { return _rx.sink(); }
 };
 
 #endif /* _INCLUDE__NIC_SESSION__CLIENT_H_ */
@@ -17,6 +17,7 @@
 #include <nic_session/client.h>
 #include <base/connection.h>
 #include <base/allocator.h>
+#include <util/misc_math.h>
 
 namespace Nic { struct Connection; }
 
@@ -31,12 +32,16 @@ struct Nic::Connection : Genode::Connection<Session>, Session_client
 	Capability<Nic::Session> _session(Genode::Parent &parent,
 	                                  char const *label,
 	                                  Genode::size_t tx_buf_size,
-	                                  Genode::size_t rx_buf_size)
+	                                  Genode::size_t rx_buf_size,
+	                                  unsigned queues = 1)
 	{
+		queues = Genode::max(1U, Genode::min(queues, (unsigned)MAX_QUEUES));
+
 		return session(parent,
-		               "ram_quota=%ld, cap_quota=%ld, tx_buf_size=%ld, rx_buf_size=%ld, label=\"%s\"",
-		               32*1024*sizeof(long) + tx_buf_size + rx_buf_size,
-		               CAP_QUOTA, tx_buf_size, rx_buf_size, label);
+		               "ram_quota=%ld, cap_quota=%ld, tx_buf_size=%ld, rx_buf_size=%ld, queues=%u, label=\"%s\"",
+		               32*1024*sizeof(long) + (tx_buf_size + rx_buf_size)*queues,
+		               CAP_QUOTA + QUEUE_CAP_QUOTA*(queues - 1),
+		               tx_buf_size, rx_buf_size, queues, label);
 	}
 
 	/**
@@ -46,15 +51,22 @@ struct Nic::Connection : Genode::Connection<Session>, Session_client
 	 *                         transmission buffer
 	 * \param tx_buf_size      size of transmission buffer in bytes
 	 * \param rx_buf_size      size of reception buffer in bytes
+	 * \param queues           number of requested queue pairs, each
+	 *                         with buffers of the given sizes
+	 *
+	 * The server may provide less queue pairs than requested, which can
+	 * be checked via 'queues()'.
 	 */
 	Connection(Genode::Env             &env,
 	           Genode::Range_allocator *tx_block_alloc,
 	           Genode::size_t           tx_buf_size,
 	           Genode::size_t           rx_buf_size,
-	           char const              *label = "")
+	           char const              *label  = "",
+	           unsigned                 queues = 1)
 	:
 		Genode::Connection<Session>(env, _session(env.parent(), label,
-		                                          tx_buf_size, rx_buf_size)),
+		                                          tx_buf_size, rx_buf_size,
+		                                          queues)),
 		Session_client(cap(), *tx_block_alloc, env.rm())
 	{ }
 
@@ -54,6 +54,18 @@ struct Nic::Session : Genode::Session
 {
 	enum { QUEUE_SIZE = 1024 };
 
+	/*
+	 * Maximum number of queue pairs per session
+	 *
+	 * A session may provide multiple pairs of tx and rx channels, which
+	 * allows a client to process the traffic of the session with multiple
+	 * threads. The number of queues is requested via the 'queues' session
+	 * argument. Queue 0 is the primary pair, which is accessible via
+	 * 'tx_channel' and 'rx_channel'. The server steers received packets
+	 * of one flow always to the same queue.
+	 */
+	enum { MAX_QUEUES = 8 };
+
 	/*
 	 * Types used by the client stub code and server implementation
 	 *
@@ -79,6 +91,12 @@ struct Nic::Session : Genode::Session
 	 */
 	enum { CAP_QUOTA = 8 };
 
+	/*
+	 * Each additional queue pair consumes two packet-stream dataspaces, two
+	 * channel capabilities, and four signal context capabilities.
+	 */
+	enum { QUEUE_CAP_QUOTA = 8 };
+
 	virtual ~Session() { }
 
 	/**
@@ -116,6 +134,11 @@ struct Nic::Session : Genode::Session
 	 */
 	virtual void link_state_sigh(Genode::Signal_context_capability sigh) = 0;
 
+	/**
+	 * Request number of queue pairs provided by the session
+	 */
+	virtual unsigned queues() = 0;
+
 	/*******************
 	 ** RPC interface **
 	 *******************/
@@ -126,9 +149,13 @@ struct Nic::Session : Genode::Session
 	GENODE_RPC(Rpc_link_state, bool, link_state);
 	GENODE_RPC(Rpc_link_state_sigh, void, link_state_sigh,
 	           Genode::Signal_context_capability);
+	GENODE_RPC(Rpc_queues, unsigned, queues);
+	GENODE_RPC(Rpc_queue_tx_cap, Genode::Capability<Tx>, _queue_tx_cap, unsigned);
+	GENODE_RPC(Rpc_queue_rx_cap, Genode::Capability<Rx>, _queue_rx_cap, unsigned);
 
 	GENODE_RPC_INTERFACE(Rpc_mac_address, Rpc_link_state,
-	                     Rpc_link_state_sigh, Rpc_tx_cap, Rpc_rx_cap);
+	                     Rpc_link_state_sigh, Rpc_tx_cap, Rpc_rx_cap,
+	                     Rpc_queues, Rpc_queue_tx_cap, Rpc_queue_rx_cap);
 };
 
 #endif /* _INCLUDE__NIC_SESSION__NIC_SESSION_H_ */
@@ -66,6 +66,18 @@ class Nic::Session_rpc_object : public Genode::Rpc_object<Session, Session_rpc_o
 
 		Genode::Capability<Tx> _tx_cap() { return _tx.cap(); }
 		Genode::Capability<Rx> _rx_cap() { return _rx.cap(); }
+
+		/*
+		 * By default, a session provides the primary queue pair only.
+		 */
+
+		unsigned queues() override { return 1; }
+
+		virtual Genode::Capability<Tx> _queue_tx_cap(unsigned queue) {
+			return queue ? Genode::Capability<Tx>() : _tx.cap(); }
+
+		virtual Genode::Capability<Rx> _queue_rx_cap(unsigned queue) {
+			return queue ? Genode::Capability<Rx>() : _rx.cap(); }
 };
 
 #endif /* _INCLUDE__NIC_SESSION__RPC_OBJECT_H_ */
@@ -16,6 +16,7 @@
 
 /* Genode includes */
 #include <base/allocator.h>
+#include <util/misc_math.h>
 
 
 /**
@@ -24,20 +25,65 @@
  *
  * The 'CELL' type must have a default constructor and has to provide the
  * methods 'set_cursor()' and 'clear_cursor'.
+ *
+ * Modifications are tracked per cell as a span of dirty columns per line.
+ * If scroll tracking is enabled, scrolling does not mark the whole scroll
+ * region as dirty. Instead, the scroll operation is recorded such that the
+ * user of the cell array can move the already rendered content and has to
+ * render the newly exposed line only.
  */
 template <typename CELL>
 class Cell_array
 {
+	public:
+
+		/**
+		 * Range of dirty columns of a line, empty if 'first > last'
+		 */
+		struct Span
+		{
+			int first, last;
+
+			bool empty() const { return first > last; }
+		};
+
+		/**
+		 * Scroll operation not yet applied to the rendered content
+		 *
+		 * The lines of the region 'start' to 'end' moved by 'lines', with
+		 * positive values for moving up and negative values for moving down.
+		 */
+		struct Scroll
+		{
+			int start, end, lines;
+		};
+
 	private:
 
 		unsigned           _num_cols;
 		unsigned           _num_lines;
 		Genode::Allocator *_alloc;
 		CELL             **_array;
-		bool              *_line_dirty;
+		Span              *_dirty;
+
+		bool   _track_scrolling = false;
+		Scroll _scroll { 0, 0, 0 };
+
+		/* position where the cursor was enabled the last time */
+		Terminal::Position _cursor_pos;
 
 		typedef CELL *Char_cell_line;
 
+		Span _clean_span() const { return Span { (int)_num_cols, -1 }; }
+		Span _full_span()  const { return Span { 0, (int)_num_cols - 1 }; }
+
+		void _mark_cell_as_dirty(int column, int line)
+		{
+			Span &span = _dirty[line];
+			span.first = Genode::min(span.first, column);
+			span.last  = Genode::max(span.last,  column);
+		}
+
 		void _clear_line(Char_cell_line line)
 		{
 			for (unsigned col = 0; col < _num_cols; col++)
@@ -47,27 +93,78 @@ class Cell_array
 		void _mark_lines_as_dirty(int start, int end)
 		{
 			for (int line = start; line <= end; line++)
-				_line_dirty[line] = true;
+				_dirty[line] = _full_span();
+		}
+
+		/**
+		 * Record scroll operation for moving the rendered content
+		 *
+		 * \return false if the operation cannot be combined with the
+		 *         pending one, which must be rendered from scratch then
+		 */
+		bool _record_scroll(int start, int end, int lines)
+		{
+			if (!_track_scrolling)
+				return false;
+
+			bool const combinable = !_scroll.lines
+			                     || (_scroll.start == start && _scroll.end == end
+			                      && (_scroll.lines > 0) == (lines > 0));
+
+			int const total = _scroll.lines + lines;
+
+			if (!combinable || total >= end - start + 1 || -total >= end - start + 1) {
+
+				/* discard pending scroll operation */
+				if (_scroll.lines)
+					_mark_lines_as_dirty(_scroll.start, _scroll.end);
+
+				_scroll.lines = 0;
+				return false;
+			}
+
+			_scroll = Scroll { start, end, total };
+			return true;
 		}
 
 		void _scroll_vertically(int start, int end, bool up)
 		{
-			/* rotate lines of the scroll region */
+			/* rotate lines of the scroll region along with their dirty state */
 			Char_cell_line yanked_line = _array[up ? start : end];
 
 			if (up) {
-				for (int line = start; line <= end - 1; line++)
+				for (int line = start; line <= end - 1; line++) {
 					_array[line] = _array[line + 1];
+					_dirty[line] = _dirty[line + 1];
+				}
 			} else {
-				for (int line = end; line >= start + 1; line--)
+				for (int line = end; line >= start + 1; line--) {
 					_array[line] = _array[line - 1];
+					_dirty[line] = _dirty[line - 1];
+				}
 			}
 
 			_clear_line(yanked_line);
 
-			_array[up ? end: start] = yanked_line;
+			int const exposed = up ? end : start;
+
+			_array[exposed] = yanked_line;
+			_dirty[exposed] = _full_span();
 
-			_mark_lines_as_dirty(start, end);
+			if (!_record_scroll(start, end, up ? 1 : -1)) {
+				_mark_lines_as_dirty(start, end);
+				return;
+			}
+
+			/*
+			 * The rendered cursor moves along with the content, but the
+			 * cursor attribute stays at its position. Hence, the cell that
+			 * receives the rendered cursor must be rendered again.
+			 */
+			int const y = _cursor_pos.y + (up ? -1 : 1);
+			if (_cursor_pos.y >= start && _cursor_pos.y <= end
+			 && y >= start && y <= end && (unsigned)_cursor_pos.x < _num_cols)
+				_mark_cell_as_dirty(_cursor_pos.x, y);
 		}
 
 	public:
@@ -81,9 +178,9 @@ class Cell_array
 		{
 			_array = new (alloc) Char_cell_line[num_lines];
 
-			_line_dirty = new (alloc) bool[num_lines];
+			_dirty = new (alloc) Span[num_lines];
 			for (unsigned i = 0; i < num_lines; i++)
-				_line_dirty[i] = false;
+				_dirty[i] = _clean_span();
 
 			for (unsigned i = 0; i < num_lines; i++)
 				_array[i] = new (alloc) CELL[num_cols];
@@ -94,14 +191,14 @@ class Cell_array
 			for (unsigned i = 0; i < _num_lines; i++)
 				Genode::destroy(_alloc, _array[i]);
 
-			Genode::destroy(_alloc, _line_dirty);
+			Genode::destroy(_alloc, _dirty);
 			Genode::destroy(_alloc, _array);
 		}
 
 		void set_cell(int column, int line, CELL cell)
 		{
 			_array[line][column] = cell;
-			_line_dirty[line] = true;
+			_mark_cell_as_dirty(column, line);
 		}
 
 		CELL get_cell(int column, int line)
@@ -109,16 +206,50 @@ class Cell_array
 			return _array[line][column];
 		}
 
-		bool line_dirty(int line) { return _line_dirty[line]; }
+		bool line_dirty(int line) { return !_dirty[line].empty(); }
+
+		/**
+		 * Return range of columns modified since the line was marked as clean
+		 */
+		Span dirty_span(int line) { return _dirty[line]; }
 
 		void mark_line_as_clean(int line)
 		{
-			_line_dirty[line] = false;
+			_dirty[line] = _clean_span();
 		}
 
 		void mark_line_as_dirty(int line)
 		{
-			_line_dirty[line] = true;
+			_dirty[line] = _full_span();
+		}
+
+		/**
+		 * Enable recording of scroll operations
+		 *
+		 * Users of the cell array that enable scroll tracking must apply
+		 * pending scroll operations to their rendered content via
+		 * 'apply_scroll' before rendering the dirty cells.
+		 */
+		void track_scrolling(bool enable)
+		{
+			if (!enable && _scroll.lines)
+				_mark_lines_as_dirty(_scroll.start, _scroll.end);
+
+			_track_scrolling = enable;
+			_scroll.lines    = 0;
+		}
+
+		/**
+		 * Call 'fn' with the pending scroll operation, if any
+		 */
+		template <typename FN>
+		void apply_scroll(FN const &fn)
+		{
+			if (!_scroll.lines)
+				return;
+
+			fn(_scroll);
+			_scroll.lines = 0;
 		}
 
 		void scroll_up(int region_start, int region_end)
@@ -147,13 +278,14 @@ class Cell_array
 
 			CELL &cell = _array[pos.y][pos.x];
 
-			if (enable)
+			if (enable) {
 				cell.set_cursor();
-			else
+				_cursor_pos = pos;
+			} else
 				cell.clear_cursor();
 
 			if (mark_dirty)
-				_line_dirty[pos.y] = true;
+				_mark_cell_as_dirty(pos.x, pos.y);
 		}
 
 		unsigned num_cols()  { return _num_cols; }
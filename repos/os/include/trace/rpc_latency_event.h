@@ -0,0 +1,55 @@
+/*
+ * \brief  Trace event generated by the 'rpc_latency' policy
+ * \author Norman Feske
+ * \date   2017-11-29
+ *
+ * The event is shared between the policy module and the collector that
+ * evaluates the trace buffers. It is kept binary and small so that the
+ * policy can remain enabled on production components.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__TRACE__RPC_LATENCY_EVENT_H_
+#define _INCLUDE__TRACE__RPC_LATENCY_EVENT_H_
+
+#include <base/fixed_stdint.h>
+
+namespace Genode { namespace Trace { struct Rpc_latency_event; } }
+
+
+struct Genode::Trace::Rpc_latency_event
+{
+	enum Type { CALL = 1, RETURNED = 2, DISPATCH = 3, REPLY = 4 };
+
+	enum { MAX_NAME_LEN = 48 };
+
+	uint64_t timestamp;
+	uint8_t  type;
+	uint8_t  name_len;
+	char     name[MAX_NAME_LEN];
+
+	/**
+	 * Return size of an event with a name of 'name_len' characters
+	 */
+	static unsigned long size(unsigned name_len)
+	{
+		return __builtin_offsetof(Rpc_latency_event, name) + name_len;
+	}
+
+	/**
+	 * Return true if the buffer entry of size 'len' holds a valid event
+	 */
+	bool valid(unsigned long len) const
+	{
+		return len >= size(0) && type >= CALL && type <= REPLY
+		    && name_len <= MAX_NAME_LEN && len == size(name_len);
+	}
+};
+
+#endif /* _INCLUDE__TRACE__RPC_LATENCY_EVENT_H_ */
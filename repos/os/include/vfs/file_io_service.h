@@ -35,6 +35,15 @@ struct Vfs::File_io_service
 {
 	enum General_error { ERR_FD_INVALID, NUM_GENERAL_ERRORS };
 
+	/**
+	 * Buffer of a vectored read or write operation
+	 */
+	struct Io_vector
+	{
+		char      *base;
+		file_size  size;
+	};
+
 
 	/***********
 	 ** Write **
@@ -54,6 +63,50 @@ struct Vfs::File_io_service
 	                           char const *buf, file_size buf_size,
 	                           file_size &out_count) = 0;
 
+	/**
+	 * Write sequence of buffers
+	 *
+	 * File systems that pass the data to a consumer, e.g., a network
+	 * stack, may override this method to hand over all buffers at once.
+	 * The default implementation writes one buffer after another and
+	 * stops at the first short write. Like 'write', the method does not
+	 * advance the seek offset of the handle.
+	 */
+	virtual Write_result writev(Vfs_handle *vfs_handle,
+	                            Io_vector const *vec, unsigned vec_count,
+	                            file_size &out_count)
+	{
+		file_size const seek = vfs_handle->seek();
+
+		out_count = 0;
+
+		Write_result result = WRITE_OK;
+		for (unsigned i = 0; i < vec_count; i++) {
+
+			file_size count = 0;
+			try {
+				result = write(vfs_handle, vec[i].base, vec[i].size, count); }
+			catch (Insufficient_buffer) {
+				if (!out_count) throw;
+				break;
+			}
+
+			if (result != WRITE_OK)
+				break;
+
+			out_count += count;
+			vfs_handle->advance_seek(count);
+
+			if (count < vec[i].size)
+				break;
+		}
+
+		vfs_handle->seek(seek);
+
+		/* report an error only if no data was written at all */
+		return out_count ? WRITE_OK : result;
+	}
+
 
 	/**********
 	 ** Read **
@@ -74,10 +127,49 @@ struct Vfs::File_io_service
 		return true;
 	}
 
+	/**
+	 * Queue read operation into a sequence of buffers
+	 *
+	 * File systems that override 'complete_readv' must override this
+	 * method accordingly. The default implementation queues a read of the
+	 * first non-empty buffer, which is filled by the default
+	 * 'complete_readv'.
+	 *
+	 * \return false if queue is full
+	 */
+	virtual bool queue_readv(Vfs_handle *vfs_handle,
+	                         Io_vector const *vec, unsigned vec_count)
+	{
+		for (unsigned i = 0; i < vec_count; i++)
+			if (vec[i].size)
+				return queue_read(vfs_handle, vec[i].size);
+
+		return true;
+	}
+
 	virtual Read_result complete_read(Vfs_handle *vfs_handle,
 	                                  char *dst, file_size count,
 	                                  file_size &out_count) = 0;
 
+	/**
+	 * Complete read queued via 'queue_readv'
+	 *
+	 * The default implementation fills the first non-empty buffer only,
+	 * which is a valid short read.
+	 */
+	virtual Read_result complete_readv(Vfs_handle *vfs_handle,
+	                                   Io_vector const *vec, unsigned vec_count,
+	                                   file_size &out_count)
+	{
+		for (unsigned i = 0; i < vec_count; i++)
+			if (vec[i].size)
+				return complete_read(vfs_handle, vec[i].base, vec[i].size,
+				                     out_count);
+
+		out_count = 0;
+		return READ_OK;
+	}
+
 	/**
 	 * Return true if the handle has readable data
 	 */
@@ -0,0 +1,407 @@
+/*
+ * \brief  Collector of RPC latency histograms
+ * \author Norman Feske
+ * \date   2017-11-29
+ *
+ * The component enables tracing with the 'rpc_latency' policy for all
+ * threads that match a '<policy>' node of its configuration. Periodically,
+ * it pairs the call/returned and dispatch/reply events found in the trace
+ * buffers, accumulates the latencies per thread and RPC function, and
+ * reports the resulting histograms.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <trace_session/connection.h>
+#include <timer_session/connection.h>
+#include <rom_session/connection.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/trace/buffer.h>
+#include <os/reporter.h>
+#include <os/session_policy.h>
+#include <trace/timestamp.h>
+#include <trace/rpc_latency_event.h>
+
+namespace Rpc_latency_reporter {
+
+	using namespace Genode;
+
+	typedef Trace::Rpc_latency_event Event;
+
+	struct Histogram;
+	struct Rpc;
+	class  Subject;
+	struct Main;
+}
+
+
+/**
+ * Latency distribution with logarithmic buckets
+ */
+struct Rpc_latency_reporter::Histogram
+{
+	/* bucket i counts latencies below 2^i microseconds */
+	enum { NUM_BUCKETS = 24 };
+
+	unsigned long counts[NUM_BUCKETS] { };
+	unsigned long count  = 0;
+	uint64_t      sum_us = 0;
+	uint64_t      min_us = ~0ULL;
+	uint64_t      max_us = 0;
+
+	void record(uint64_t us)
+	{
+		unsigned i = 0;
+		while (i < NUM_BUCKETS - 1 && us >= (1ULL << i))
+			i++;
+
+		counts[i]++;
+		count++;
+		sum_us += us;
+		min_us  = min(min_us, us);
+		max_us  = max(max_us, us);
+	}
+
+	void report(Xml_generator &xml) const
+	{
+		xml.attribute("count",  count);
+		xml.attribute("min_us", min_us);
+		xml.attribute("max_us", max_us);
+		xml.attribute("avg_us", sum_us / max(count, 1UL));
+
+		for (unsigned i = 0; i < NUM_BUCKETS; i++) {
+			if (!counts[i])
+				continue;
+
+			xml.node("bucket", [&] () {
+				if (i < NUM_BUCKETS - 1)
+					xml.attribute("below_us", 1ULL << i);
+				xml.attribute("count", counts[i]);
+			});
+		}
+	}
+};
+
+
+/**
+ * Statistics of one RPC function as seen by one thread
+ */
+struct Rpc_latency_reporter::Rpc : List<Rpc>::Element
+{
+	enum Side { CLIENT, SERVER };
+
+	typedef String<Event::MAX_NAME_LEN + 1> Name;
+
+	Name      const name;
+	Side      const side;
+	Histogram       histogram { };
+
+	Rpc(Name const &name, Side side) : name(name), side(side) { }
+};
+
+
+/**
+ * Traced thread
+ */
+class Rpc_latency_reporter::Subject : public List<Subject>::Element
+{
+	private:
+
+		/**
+		 * Event that awaits its counterpart
+		 */
+		struct Pending
+		{
+			bool     valid = false;
+			uint64_t timestamp = 0;
+			Rpc::Name name { };
+		};
+
+		Trace::Subject_id const _id;
+
+		Session_label     const _label;
+		Trace::Thread_name const _thread;
+
+		Allocator  &_alloc;
+		Region_map &_rm;
+
+		Trace::Buffer        &_buffer;
+		Trace::Buffer::Entry  _cursor  { _buffer.first() };
+		unsigned              _wrapped { 0 };
+
+		/* timestamp of last event processed, used to skip stale entries */
+		uint64_t _last_timestamp = 0;
+
+		Pending _call     { };
+		Pending _dispatch { };
+
+		List<Rpc> _rpcs { };
+
+		Rpc &_rpc(Rpc::Name const &name, Rpc::Side side)
+		{
+			for (Rpc *rpc = _rpcs.first(); rpc; rpc = rpc->next())
+				if (rpc->side == side && rpc->name == name)
+					return *rpc;
+
+			Rpc *rpc = new (_alloc) Rpc(name, side);
+			_rpcs.insert(rpc);
+			return *rpc;
+		}
+
+		void _complete(Pending &pending, Event const &event, Rpc::Side side,
+		               uint64_t ticks_per_us)
+		{
+			Rpc::Name const name(Cstring(event.name, event.name_len));
+
+			if (pending.valid && pending.name == name)
+				_rpc(name, side).histogram.record((event.timestamp - pending.timestamp)
+				                                  / ticks_per_us);
+			pending.valid = false;
+		}
+
+		void _process(Event const &event, uint64_t ticks_per_us)
+		{
+			switch (event.type) {
+
+			case Event::CALL:
+			case Event::DISPATCH:
+				{
+					Pending &pending = (event.type == Event::CALL) ? _call : _dispatch;
+					pending.valid     = true;
+					pending.timestamp = event.timestamp;
+					pending.name      = Rpc::Name(Cstring(event.name, event.name_len));
+					break;
+				}
+
+			case Event::RETURNED:
+				_complete(_call, event, Rpc::CLIENT, ticks_per_us);
+				break;
+
+			case Event::REPLY:
+				_complete(_dispatch, event, Rpc::SERVER, ticks_per_us);
+				break;
+			}
+		}
+
+	public:
+
+		Subject(Allocator &alloc, Region_map &rm, Trace::Subject_id id,
+		        Trace::Subject_info const &info, Dataspace_capability buffer)
+		:
+			_id(id), _label(info.session_label()), _thread(info.thread_name()),
+			_alloc(alloc), _rm(rm),
+			_buffer(*(Trace::Buffer *)rm.attach(buffer))
+		{ }
+
+		~Subject()
+		{
+			while (Rpc *rpc = _rpcs.first()) {
+				_rpcs.remove(rpc);
+				destroy(_alloc, rpc);
+			}
+			_rm.detach(&_buffer);
+		}
+
+		Trace::Subject_id id() const { return _id; }
+
+		/**
+		 * Evaluate events added to the trace buffer since the last call
+		 */
+		void process(uint64_t ticks_per_us)
+		{
+			/* start over if the buffer wrapped, stale entries are skipped */
+			if (_buffer.wrapped() != _wrapped || _cursor.last()) {
+				_wrapped = _buffer.wrapped();
+				_cursor  = _buffer.first();
+			}
+
+			Trace::Buffer::Entry e = _cursor;
+			for (; !e.last() && e.length(); e = _buffer.next(e)) {
+
+				Event const &event = *(Event const *)e.data();
+				if (!event.valid(e.length()) || event.timestamp <= _last_timestamp)
+					continue;
+
+				_last_timestamp = event.timestamp;
+				_process(event, ticks_per_us);
+			}
+			_cursor = e;
+		}
+
+		void report(Xml_generator &xml) const
+		{
+			if (!_rpcs.first())
+				return;
+
+			xml.node("subject", [&] () {
+				xml.attribute("label",  _label);
+				xml.attribute("thread", _thread);
+
+				for (Rpc const *rpc = _rpcs.first(); rpc; rpc = rpc->next())
+					xml.node("rpc", [&] () {
+						xml.attribute("name", rpc->name);
+						xml.attribute("side", rpc->side == Rpc::CLIENT ? "client"
+						                                               : "server");
+						rpc->histogram.report(xml);
+					});
+			});
+		}
+};
+
+
+struct Rpc_latency_reporter::Main
+{
+	Env &_env;
+
+	enum { MAX_SUBJECTS = 256 };
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Heap              _heap  { _env.ram(), _env.rm() };
+	Timer::Connection _timer { _env };
+
+	Trace::Connection _trace { _env,
+		_config.xml().attribute_value("trace_quota", Number_of_bytes(4*1024*1024)),
+		32*1024, 0 };
+
+	size_t const _buffer_size {
+		_config.xml().attribute_value("buffer", Number_of_bytes(64*1024)) };
+
+	Reporter _reporter { _env, "rpc_latency", "rpc_latency", 64*1024 };
+
+	Trace::Policy_id _policy_id { };
+
+	uint64_t _ticks_per_us = 1;
+
+	Trace::Subject_id _subject_ids[MAX_SUBJECTS];
+
+	List<Subject> _subjects { };
+
+	Signal_handler<Main> _period_handler { _env.ep(), *this, &Main::_handle_period };
+
+	void _load_policy()
+	{
+		Rom_connection rom(_env, "rpc_latency");
+		Rom_dataspace_capability const rom_ds = rom.dataspace();
+		size_t const size = Dataspace_client(rom_ds).size();
+
+		_policy_id = _trace.alloc_policy(size);
+
+		void *dst = _env.rm().attach(_trace.policy(_policy_id));
+		void *src = _env.rm().attach(rom_ds);
+		memcpy(dst, src, size);
+		_env.rm().detach(src);
+		_env.rm().detach(dst);
+	}
+
+	/**
+	 * Determine the rate of the timestamp counter
+	 */
+	void _calibrate()
+	{
+		enum { DURATION_MS = 100 };
+
+		Trace::Timestamp const start = Trace::timestamp();
+		_timer.msleep(DURATION_MS);
+		Trace::Timestamp const end = Trace::timestamp();
+
+		_ticks_per_us = max((end - start) / (DURATION_MS*1000), (uint64_t)1);
+	}
+
+	Subject *_lookup(Trace::Subject_id id)
+	{
+		for (Subject *s = _subjects.first(); s; s = s->next())
+			if (s->id() == id)
+				return s;
+
+		return nullptr;
+	}
+
+	bool _selected(Trace::Subject_info const &info)
+	{
+		try {
+			Session_policy const policy(info.session_label(), _config.xml());
+
+			if (!policy.has_attribute("thread"))
+				return true;
+
+			return policy.attribute_value("thread", Trace::Thread_name())
+			       == info.thread_name();
+
+		} catch (Session_policy::No_policy_defined) { return false; }
+	}
+
+	void _update_subjects()
+	{
+		unsigned const num = _trace.subjects(_subject_ids, MAX_SUBJECTS);
+
+		for (unsigned i = 0; i < num; i++) {
+
+			Trace::Subject_id   const id   = _subject_ids[i];
+			Trace::Subject_info const info = _trace.subject_info(id);
+			Subject                  *s    = _lookup(id);
+
+			if (s && info.state() == Trace::Subject_info::DEAD) {
+				s->process(_ticks_per_us);
+				_subjects.remove(s);
+				destroy(_heap, s);
+				_trace.free(id);
+				continue;
+			}
+
+			if (s || info.state() != Trace::Subject_info::UNTRACED
+			      || !_selected(info))
+				continue;
+
+			try {
+				_trace.trace(id, _policy_id, _buffer_size);
+				_subjects.insert(new (_heap)
+					Subject(_heap, _env.rm(), id, info, _trace.buffer(id)));
+
+			} catch (...) {
+				warning("could not trace thread '", info.thread_name(), "' "
+				        "of '", info.session_label(), "'");
+			}
+		}
+	}
+
+	void _handle_period()
+	{
+		_update_subjects();
+
+		for (Subject *s = _subjects.first(); s; s = s->next())
+			s->process(_ticks_per_us);
+
+		Reporter::Xml_generator xml(_reporter, [&] () {
+			for (Subject const *s = _subjects.first(); s; s = s->next())
+				s->report(xml);
+		});
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		_load_policy();
+		_calibrate();
+
+		log("timestamp rate: ", _ticks_per_us, " ticks/us");
+
+		_reporter.enabled(true);
+
+		unsigned long const period_ms =
+			_config.xml().attribute_value("period_ms", 5000UL);
+
+		_timer.sigh(_period_handler);
+		_timer.trigger_periodic(period_ms*1000);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Rpc_latency_reporter::Main main(env); }
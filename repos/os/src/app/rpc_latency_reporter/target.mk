@@ -0,0 +1,3 @@
+TARGET = rpc_latency_reporter
+SRC_CC = main.cc
+LIBS  += base
@@ -9,10 +9,18 @@
  *
  * - TAP device to connect to (default is tap0)
  * - MAC address (default is 02-00-00-00-00-01)
+ * - Number of TAP queues (default is 1), more than one queue requires
+ *   a host kernel supporting multi-queue TAP devices
+ *
+ * A client may request multiple queue pairs for its NIC session. Each
+ * session queue is then backed by at least one TAP queue. The host kernel
+ * steers the packets of a flow to one TAP queue, which determines the
+ * receiving session queue.
+ * - Usage of virtio-net headers with checksum offloading (default is no)
  *
  * These can be set in the config section as follows:
  *  <config>
- *  	<nic mac="12:23:34:45:56:67" tap="tap1"/>
+ *  	<nic mac="12:23:34:45:56:67" tap="tap1" queues="4" vnet_hdr="yes"/>
  *  </config>
  */
 
@@ -36,6 +44,8 @@
 #include <base/heap.h>
 #include <base/thread.h>
 #include <base/log.h>
+#include <base/semaphore.h>
+#include <nic/flow_hash.h>
 #include <nic/root.h>
 
 /* Linux */
@@ -43,6 +53,8 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/select.h>
+#include <sys/uio.h>
 #include <net/if.h>
 #include <linux/if_tun.h>
 
@@ -53,31 +65,156 @@ namespace Server {
 }
 
 
+/**
+ * Header prepended to each packet when using IFF_VNET_HDR
+ *
+ * Mirrors 'struct virtio_net_hdr' of the Linux headers, which cannot be
+ * included from C++ code.
+ */
+struct Vnet_hdr
+{
+	enum { F_NEEDS_CSUM = 1 };
+
+	Genode::uint8_t  flags;
+	Genode::uint8_t  gso_type;
+	Genode::uint16_t hdr_len;
+	Genode::uint16_t gso_size;
+	Genode::uint16_t csum_start;
+	Genode::uint16_t csum_offset;
+} __attribute__((packed));
+
+
 class Linux_session_component : public Nic::Session_component
 {
 	private:
 
+		enum {
+			MAX_QUEUES = 8,
+
+			/*
+			 * Number of packets handled per direction before giving the
+			 * other direction a chance
+			 */
+			BATCH = 64,
+		};
+
+		struct Tap_fds
+		{
+			int      fd[MAX_QUEUES];
+			unsigned count;
+		};
+
+		/**
+		 * Thread that notifies the entrypoint about received packets
+		 *
+		 * After signalling, the thread waits until the entrypoint drained
+		 * all TAP queues. This way, a burst of packets results in one
+		 * signal instead of one signal per 'select' wakeup.
+		 *
+		 * TAP queues whose session queue is congested are not watched.
+		 * They are resumed by the entrypoint on the next acknowledgement
+		 * of the client. The entrypoint interrupts a pending 'select' via
+		 * the wakeup pipe whenever the set of congested queues changes.
+		 */
 		struct Rx_signal_thread : Genode::Thread
 		{
-			int                               fd;
+			Tap_fds const                     fds;
 			Genode::Signal_context_capability sigh;
 
-			Rx_signal_thread(Genode::Env &env, int fd, Genode::Signal_context_capability sigh)
-			: Genode::Thread(env, "rx_signal", 0x1000), fd(fd), sigh(sigh) { }
+			Genode::Lock      lock      { };
+			bool              waiting   { false };
+			unsigned          congested { 0 };
+			Genode::Semaphore rearm     { 0 };
+
+			int wakeup[2] { -1, -1 };
+
+			Rx_signal_thread(Genode::Env &env, Tap_fds const &fds,
+			                 Genode::Signal_context_capability sigh)
+			: Genode::Thread(env, "rx_signal", 0x1000), fds(fds), sigh(sigh)
+			{
+				if (pipe(wakeup) != 0
+				 || fcntl(wakeup[0], F_SETFL, O_NONBLOCK) < 0
+				 || fcntl(wakeup[1], F_SETFL, O_NONBLOCK) < 0) {
+					Genode::error("could not create wakeup pipe");
+					throw Genode::Exception();
+				}
+			}
+
+			/**
+			 * Called by the entrypoint once no packet is left to receive
+			 *
+			 * \param congested_queues  bit mask of TAP queues that could
+			 *                          not be drained because their session
+			 *                          queue is congested
+			 */
+			void drained(unsigned congested_queues)
+			{
+				Genode::Lock::Guard guard(lock);
+
+				bool const changed = (congested != congested_queues);
+				congested = congested_queues;
+
+				if (waiting) {
+					waiting = false;
+					rearm.up();
+					return;
+				}
+
+				/* let a pending 'select' pick up the new set of queues */
+				char const c = 0;
+				if (changed && write(wakeup[1], &c, 1) < 0 && errno != EAGAIN)
+					Genode::error("wakeup: errno=", errno);
+			}
 
 			void entry()
 			{
 				while (true) {
-					/* wait for packet arrival on fd */
+					/* wait for packet arrival on any uncongested queue */
 					int    ret;
+					int    max_fd;
 					fd_set rfds;
-
-					FD_ZERO(&rfds);
-					FD_SET(fd, &rfds);
-					do { ret = select(fd + 1, &rfds, 0, 0, 0); } while (ret < 0);
-
-					/* signal incoming packet */
+					bool   rx_ready = false;
+
+					do {
+						unsigned watched;
+						{
+							Genode::Lock::Guard guard(lock);
+							watched = ~congested;
+						}
+
+						FD_ZERO(&rfds);
+						FD_SET(wakeup[0], &rfds);
+						max_fd = wakeup[0];
+						for (unsigned i = 0; i < fds.count; i++) {
+							if (!(watched & (1U << i)))
+								continue;
+							FD_SET(fds.fd[i], &rfds);
+							max_fd = Genode::max(max_fd, fds.fd[i]);
+						}
+						ret = select(max_fd + 1, &rfds, 0, 0, 0);
+						if (ret < 0)
+							continue;
+
+						if (FD_ISSET(wakeup[0], &rfds)) {
+							char buf[16];
+							while (read(wakeup[0], buf, sizeof(buf)) > 0);
+						}
+
+						for (unsigned i = 0; i < fds.count; i++)
+							if ((watched & (1U << i)) && FD_ISSET(fds.fd[i], &rfds))
+								rx_ready = true;
+
+					} while (!rx_ready);
+
+					{
+						Genode::Lock::Guard guard(lock);
+						waiting = true;
+					}
+
+					/* signal incoming packets */
 					Genode::Signal_transmitter(sigh).submit();
+
+					rearm.down();
 				}
 			}
 		};
@@ -85,15 +222,37 @@ class Linux_session_component : public Nic::Session_component
 		Genode::Attached_rom_dataspace _config_rom;
 
 		Nic::Mac_address _mac_addr;
-		int              _tap_fd;
+		bool const       _vnet_hdr;
+		Tap_fds const    _tap;
 		Rx_signal_thread _rx_thread;
 
-		int _setup_tap_fd()
+		/* queue to receive from next, rotated for fairness */
+		unsigned _rx_queue { 0 };
+
+		bool _config_vnet_hdr()
 		{
-			/* open TAP device */
-			int ret;
-			struct ifreq ifr;
+			try {
+				return _config_rom.xml().sub_node("nic").attribute_value("vnet_hdr", false);
+			} catch (...) { return false; }
+		}
 
+		/**
+		 * Return number of TAP queues, at least one per session queue
+		 */
+		unsigned _config_queues()
+		{
+			unsigned queues = 1;
+			try {
+				queues = _config_rom.xml().sub_node("nic").attribute_value("queues", 1U);
+			} catch (...) { }
+
+			queues = Genode::max(queues, _num_queues);
+
+			return Genode::max(1U, Genode::min(queues, (unsigned)MAX_QUEUES));
+		}
+
+		int _open_tap_fd(struct ifreq &ifr)
+		{
 			int fd = open("/dev/net/tun", O_RDWR);
 			if (fd < 0) {
 				Genode::error("could not open /dev/net/tun: no virtual network emulation");
@@ -107,8 +266,45 @@ class Linux_session_component : public Nic::Session_component
 				throw Genode::Exception();
 			}
 
+			int ret = ioctl(fd, TUNSETIFF, (void *) &ifr);
+			if (ret != 0) {
+				Genode::error("could not configure /dev/net/tun: no virtual network emulation");
+				close(fd);
+				/* this error is fatal */
+				throw Genode::Exception();
+			}
+
+			if (!_vnet_hdr)
+				return fd;
+
+			/*
+			 * Let the host hand us packets with partial checksums, which
+			 * we complete in '_complete_checksum'. TSO/GSO are not enabled
+			 * because the NIC session has no way to convey segmentation
+			 * meta data.
+			 */
+			int hdr_size = sizeof(Vnet_hdr);
+			if (ioctl(fd, TUNSETVNETHDRSZ, &hdr_size) != 0
+			 || ioctl(fd, TUNSETOFFLOAD, TUN_F_CSUM) != 0) {
+				Genode::error("could not enable checksum offloading on TAP device");
+				close(fd);
+				throw Genode::Exception();
+			}
+
+			return fd;
+		}
+
+		Tap_fds _setup_tap_fds()
+		{
+			Tap_fds tap;
+			struct ifreq ifr;
+
+			tap.count = _config_queues();
+
 			Genode::memset(&ifr, 0, sizeof(ifr));
 			ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+			if (_vnet_hdr)      ifr.ifr_flags |= IFF_VNET_HDR;
+			if (tap.count > 1)  ifr.ifr_flags |= IFF_MULTI_QUEUE;
 
 			/* get tap device from config */
 			try {
@@ -121,38 +317,95 @@ class Linux_session_component : public Nic::Session_component
 				Genode::log("no config provided, using tap0");
 			}
 
-			ret = ioctl(fd, TUNSETIFF, (void *) &ifr);
-			if (ret != 0) {
-				Genode::error("could not configure /dev/net/tun: no virtual network emulation");
-				close(fd);
-				/* this error is fatal */
-				throw Genode::Exception();
-			}
+			for (unsigned i = 0; i < tap.count; i++)
+				tap.fd[i] = _open_tap_fd(ifr);
 
-			return fd;
+			if (tap.count > 1 || _vnet_hdr)
+				Genode::log("queues: ", tap.count, " vnet_hdr: ",
+				            _vnet_hdr ? "yes" : "no");
+
+			return tap;
 		}
 
-		bool _send()
+		/**
+		 * Select TAP queue by the flow hash of the packet
+		 *
+		 * Packets of one flow always use the same queue, which preserves
+		 * their order.
+		 */
+		int _tx_fd(char const *data, Genode::size_t size) const
+		{
+			if (_tap.count == 1)
+				return _tap.fd[0];
+
+			return _tap.fd[Nic::flow_hash(data, size) % _tap.count];
+		}
+
+		/**
+		 * Complete partial checksum announced by the virtio-net header
+		 */
+		static void _complete_checksum(Vnet_hdr const &hdr,
+		                               char *data, Genode::size_t size)
+		{
+			if (!(hdr.flags & Vnet_hdr::F_NEEDS_CSUM))
+				return;
+
+			Genode::size_t const start  = hdr.csum_start;
+			Genode::size_t const offset = hdr.csum_offset;
+			if (start + offset + 2 > size)
+				return;
+
+			Genode::uint32_t sum = 0;
+			unsigned char const *p = (unsigned char const *)data + start;
+			Genode::size_t len = size - start;
+			for (; len > 1; len -= 2, p += 2)
+				sum += (p[0] << 8) | p[1];
+			if (len)
+				sum += p[0] << 8;
+
+			while (sum >> 16)
+				sum = (sum & 0xffff) + (sum >> 16);
+
+			Genode::uint16_t const csum = ~sum;
+			data[start + offset]     = csum >> 8;
+			data[start + offset + 1] = csum & 0xff;
+		}
+
+		bool _send(unsigned queue)
 		{
 			using namespace Genode;
 
-			if (!_tx.sink()->ready_to_ack())
+			Session::Tx::Sink &tx = *_queue_tx(queue).sink();
+
+			if (!tx.ready_to_ack())
 				return false;
 
-			if (!_tx.sink()->packet_avail())
+			if (!tx.packet_avail())
 				return false;
 
-			Packet_descriptor packet = _tx.sink()->get_packet();
+			Packet_descriptor packet = tx.get_packet();
 			if (!packet.size()) {
 				warning("invalid tx packet");
 				return true;
 			}
 
+			char *data = tx.packet_content(packet);
+			int   fd   = _tx_fd(data, packet.size());
+
+			/* no offloading requested by us, hence a zeroed header suffices */
+			Vnet_hdr hdr;
+			Genode::memset(&hdr, 0, sizeof(hdr));
+
+			struct iovec iov[2] = { { &hdr, sizeof(hdr) },
+			                        { data, packet.size() } };
+			struct iovec *vec = _vnet_hdr ? iov : iov + 1;
+			int const     cnt = _vnet_hdr ? 2 : 1;
+
 			int ret;
 
 			/* non-blocking-write packet to TAP */
 			do {
-				ret = write(_tap_fd, _tx.sink()->packet_content(packet), packet.size());
+				ret = writev(fd, vec, cnt);
 				/* drop packet if write would block */
 				if (ret < 0 && errno == EAGAIN)
 					continue;
@@ -160,45 +413,133 @@ class Linux_session_component : public Nic::Session_component
 				if (ret < 0) Genode::error("write: errno=", errno);
 			} while (ret < 0);
 
-			_tx.sink()->acknowledge_packet(packet);
+			tx.acknowledge_packet(packet);
 
 			return true;
 		}
 
-		bool _receive()
+		enum Rx_result { RX_OK, RX_EMPTY, RX_CONGESTED };
+
+		/**
+		 * Receive packet from TAP queue
+		 *
+		 * The TAP queue determines the session queue of the packet.
+		 */
+		Rx_result _receive(unsigned tap_queue)
 		{
 			unsigned const max_size = Nic::Packet_allocator::DEFAULT_PACKET_SIZE;
 
-			if (!_rx.source()->ready_to_submit())
-				return false;
+			int                 const fd = _tap.fd[tap_queue];
+			Session::Rx::Source      &rx = *_queue_rx(tap_queue % _num_queues).source();
+
+			if (!rx.ready_to_submit())
+				return RX_CONGESTED;
 
 			Nic::Packet_descriptor p;
 			try {
-				p = _rx.source()->alloc_packet(max_size);
-			} catch (Session::Rx::Source::Packet_alloc_failed) { return false; }
+				p = rx.alloc_packet(max_size);
+			} catch (Session::Rx::Source::Packet_alloc_failed) { return RX_CONGESTED; }
+
+			char *data = rx.packet_content(p);
 
-			int size = read(_tap_fd, _rx.source()->packet_content(p), max_size);
+			Vnet_hdr hdr;
+			struct iovec iov[2] = { { &hdr, sizeof(hdr) },
+			                        { data, max_size } };
+
+			int size = _vnet_hdr ? readv(fd, iov, 2) - (int)sizeof(hdr)
+			                     : readv(fd, iov + 1, 1);
 			if (size <= 0) {
-				_rx.source()->release_packet(p);
-				return false;
+				rx.release_packet(p);
+				return RX_EMPTY;
 			}
 
+			if (_vnet_hdr)
+				_complete_checksum(hdr, data, size);
+
 			/* adjust packet size */
 			Nic::Packet_descriptor p_adjust(p.offset(), size);
-			_rx.source()->submit_packet(p_adjust);
+			rx.submit_packet(p_adjust);
 
-			return true;
+			return RX_OK;
+		}
+
+		/**
+		 * Receive a batch of packets from the TAP queues
+		 *
+		 * \return true if packets may still be pending
+		 */
+		bool _receive_batch()
+		{
+			unsigned received  = 0;
+			unsigned idle      = 0;
+			unsigned congested = 0;
+
+			while (received < BATCH && idle < _tap.count) {
+
+				unsigned const queue = _rx_queue;
+				_rx_queue = (_rx_queue + 1) % _tap.count;
+
+				switch (_receive(queue)) {
+				case RX_OK:
+					received++;
+					idle       = 0;
+					congested &= ~(1U << queue);
+					break;
+				case RX_EMPTY:
+					idle++;
+					congested &= ~(1U << queue);
+					break;
+				case RX_CONGESTED:
+					/* resumed on the next acknowledgement of the client */
+					idle++;
+					congested |= 1U << queue;
+					break;
+				}
+			}
+
+			if (idle < _tap.count)
+				return true;
+
+			/*
+			 * All queues are drained or congested, wait for new packets on
+			 * the uncongested queues
+			 */
+			_rx_thread.drained(congested);
+
+			return false;
+		}
+
+		bool _send_batch()
+		{
+			bool pending = false;
+
+			for (unsigned i = 0; i < _num_queues; i++) {
+				unsigned sent = 0;
+				while (sent < BATCH && _send(i)) sent++;
+
+				pending |= (sent == BATCH);
+			}
+
+			return pending;
 		}
 
 	protected:
 
 		void _handle_packet_stream() override
 		{
-			while (_rx.source()->ack_avail())
-				_rx.source()->release_packet(_rx.source()->get_acked_packet());
+			for (unsigned i = 0; i < _num_queues; i++) {
+				Session::Rx::Source &rx = *_queue_rx(i).source();
+				while (rx.ack_avail())
+					rx.release_packet(rx.get_acked_packet());
+			}
 
-			while (_send()) ;
-			while (_receive()) ;
+			/* alternate between both directions until both are idle */
+			for (bool pending = true; pending; ) {
+				bool const tx_pending = _send_batch();
+				bool const rx_pending = _receive_batch();
+
+				pending = tx_pending || rx_pending;
+			}
 		}
 
 	public:
@@ -206,11 +547,14 @@ class Linux_session_component : public Nic::Session_component
 		Linux_session_component(Genode::size_t const tx_buf_size,
 		                        Genode::size_t const rx_buf_size,
 		                        Genode::Allocator   &rx_block_md_alloc,
-		                        Server::Env         &env)
+		                        Server::Env         &env,
+		                        unsigned             queues)
 		:
-			Session_component(tx_buf_size, rx_buf_size, rx_block_md_alloc, env),
+			Session_component(tx_buf_size, rx_buf_size, rx_block_md_alloc, env,
+			                  queues),
 			_config_rom(env, "config"),
-			_tap_fd(_setup_tap_fd()), _rx_thread(env, _tap_fd, _packet_stream_dispatcher)
+			_vnet_hdr(_config_vnet_hdr()),
+			_tap(_setup_tap_fds()), _rx_thread(env, _tap, _packet_stream_dispatcher)
 		{
 			/* try using configured MAC address */
 			try {
@@ -240,7 +584,9 @@ struct Server::Main
 	Env  &_env;
 	Heap  _heap { _env.ram(), _env.rm() };
 
-	Nic::Root<Linux_session_component> nic_root { _env, _heap };
+	enum { MULTI_QUEUE = true };
+
+	Nic::Root<Linux_session_component, MULTI_QUEUE> nic_root { _env, _heap };
 
 	Main(Env &env) : _env(env)
 	{
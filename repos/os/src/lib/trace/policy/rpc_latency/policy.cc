@@ -0,0 +1,75 @@
+/*
+ * \brief  Policy recording timestamped RPC events for latency profiling
+ * \author Norman Feske
+ * \date   2017-11-29
+ *
+ * In contrast to the 'rpc_name' policy, the events are binary records
+ * evaluated by the 'rpc_latency' collector. Signal events are omitted.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <trace/policy.h>
+#include <trace/timestamp.h>
+#include <trace/rpc_latency_event.h>
+
+using namespace Genode;
+
+typedef Trace::Rpc_latency_event Event;
+
+
+static size_t event(char *dst, Event::Type type, char const *rpc_name)
+{
+	Event &e = *(Event *)dst;
+
+	e.timestamp = Trace::timestamp();
+	e.type      = type;
+
+	unsigned len = 0;
+	for (; len < Event::MAX_NAME_LEN && rpc_name[len]; len++)
+		e.name[len] = rpc_name[len];
+
+	e.name_len = len;
+	return Event::size(len);
+}
+
+
+size_t max_event_size()
+{
+	return sizeof(Event);
+}
+
+size_t rpc_call(char *dst, char const *rpc_name, Msgbuf_base const &)
+{
+	return event(dst, Event::CALL, rpc_name);
+}
+
+size_t rpc_returned(char *dst, char const *rpc_name, Msgbuf_base const &)
+{
+	return event(dst, Event::RETURNED, rpc_name);
+}
+
+size_t rpc_dispatch(char *dst, char const *rpc_name)
+{
+	return event(dst, Event::DISPATCH, rpc_name);
+}
+
+size_t rpc_reply(char *dst, char const *rpc_name)
+{
+	return event(dst, Event::REPLY, rpc_name);
+}
+
+size_t signal_submit(char *dst, unsigned const)
+{
+	return 0;
+}
+
+size_t signal_receive(char *dst, Signal_context const &, unsigned)
+{
+	return 0;
+}
@@ -0,0 +1,7 @@
+REQUIRES = bugfix_for_riscv_toolchain
+
+TARGET = rpc_latency_policy
+
+TARGET_POLICY = rpc_latency
+
+include $(PRG_DIR)/../policy.inc
@@ -40,6 +40,7 @@ class Vfs::Fs_file_system : public File_system
 		Lock _lock;
 
 		Genode::Env           &_env;
+		Genode::Allocator     &_alloc;
 		Genode::Allocator_avl  _fs_packet_alloc;
 		Io_response_handler   &_io_handler;
 
@@ -68,8 +69,66 @@ class Vfs::Fs_file_system : public File_system
 			::File_system::Packet_descriptor queued_sync_packet;
 		};
 
+		/*
+		 * Size of the read-ahead window and of the write-coalescing buffer
+		 * of each file handle, configured via the 'read_ahead' and
+		 * 'write_behind' attributes, zero if disabled
+		 */
+		file_size const _read_ahead;
+		file_size const _write_behind;
+
+		/**
+		 * State of the client-side cache of a file handle
+		 *
+		 * The read cache holds the data of the last read-ahead request. It is
+		 * invalidated on writes via the handle and on content-change
+		 * notifications by the server. Adjacent small writes are collected in
+		 * the write buffer and passed to the server as one packet.
+		 */
+		struct Cache_state
+		{
+			enum class Ra_request { NONE, HIT, FILL };
+
+			char       *ra_buf         = nullptr;
+			file_size   ra_size        = 0;
+			file_size   ra_offset      = 0;
+			file_size   ra_length      = 0;
+			bool        ra_valid       = false;
+			bool        ra_eof         = false;
+			bool        ra_stale       = false;
+			file_size   ra_fill_offset = 0;
+			Ra_request  ra_request     = Ra_request::NONE;
+
+			char       *wb_buf    = nullptr;
+			file_size   wb_size   = 0;
+			file_size   wb_offset = 0;
+			file_size   wb_length = 0;
+
+			void invalidate_read_cache()
+			{
+				ra_valid = false;
+
+				/* do not keep the data of a request in flight */
+				ra_stale = true;
+			}
+
+			/**
+			 * Return true if a read at 'pos' can be served from the cache
+			 *
+			 * A read that exceeds the cached data is served partially if the
+			 * cached data ends with the end of the file.
+			 */
+			bool cached(file_size pos, file_size count) const
+			{
+				file_size const end = ra_offset + ra_length;
+
+				return ra_valid && pos >= ra_offset && pos < end
+				    && (pos + count <= end || ra_eof);
+			}
+		};
+
 		struct Fs_vfs_handle : Vfs_handle, ::File_system::Node,
-		                       Handle_space::Element, Handle_state
+		                       Handle_space::Element, Handle_state, Cache_state
 		{
 			::File_system::Connection &_fs;
 			Io_response_handler       &_io_handler;
@@ -228,12 +287,67 @@ class Vfs::Fs_file_system : public File_system
 
 			bool queue_read(file_size count) override
 			{
-				return _queue_read(count, seek());
+				file_size const pos = seek();
+
+				if (!ra_buf || count >= ra_size)
+					return _queue_read(count, pos);
+
+				if (cached(pos, count)) {
+					ra_request = Ra_request::HIT;
+					return true;
+				}
+
+				/* read a whole window starting at the requested position */
+				if (!_queue_read(ra_size, pos))
+					return false;
+
+				ra_request     = Ra_request::FILL;
+				ra_fill_offset = pos;
+				ra_stale       = false;
+				return true;
 			}
 
 			Read_result complete_read(char *dst, file_size count,
 			                          file_size &out_count) override
 			{
+				switch (ra_request) {
+
+				case Ra_request::HIT:
+					{
+						file_size const pos = seek();
+
+						out_count = min(count, ra_offset + ra_length - pos);
+						memcpy(dst, ra_buf + (pos - ra_offset), out_count);
+
+						ra_request = Ra_request::NONE;
+						return READ_OK;
+					}
+
+				case Ra_request::FILL:
+					{
+						file_size length = 0;
+
+						Read_result const result =
+							_complete_read(ra_buf, ra_size, length);
+
+						if (result != READ_OK)
+							return result;
+
+						ra_request = Ra_request::NONE;
+						ra_offset  = ra_fill_offset;
+						ra_length  = length;
+						ra_eof     = length < ra_size;
+						ra_valid   = !ra_stale;
+
+						out_count = min(count, length);
+						memcpy(dst, ra_buf, out_count);
+						return READ_OK;
+					}
+
+				case Ra_request::NONE:
+					break;
+				}
+
 				return _complete_read(dst, count, out_count);
 			}
 		};
@@ -414,6 +528,106 @@ class Vfs::Fs_file_system : public File_system
 
 		Post_signal_hook _post_signal_hook { _env.ep(), _io_handler };
 
+		/**
+		 * Pass coalesced writes of the handle to the server
+		 *
+		 * \throw Insufficient_buffer
+		 */
+		void _flush(Fs_vfs_handle &handle)
+		{
+			if (!handle.wb_length)
+				return;
+
+			_write(handle, handle.wb_buf, handle.wb_length, handle.wb_offset);
+			handle.wb_length = 0;
+		}
+
+		/**
+		 * Flush coalesced writes, wait for packet-stream resources if needed
+		 *
+		 * Must be called without holding '_lock'.
+		 */
+		void _flush_blocking(Fs_vfs_handle &handle)
+		{
+			for (;;) {
+				{
+					Lock::Guard guard(_lock);
+
+					try {
+						_flush(handle);
+						return;
+					} catch (Insufficient_buffer) { }
+				}
+				_env.ep().wait_and_dispatch_one_io_signal();
+			}
+		}
+
+		/**
+		 * Flush coalesced writes of all handles, used before querying the
+		 * status of nodes
+		 */
+		void _flush_all()
+		{
+			Lock::Guard guard(_lock);
+
+			_handle_space.for_each<Fs_vfs_handle>([&] (Fs_vfs_handle &handle) {
+				try { _flush(handle); }
+				catch (Insufficient_buffer) {
+					Genode::warning("could not flush coalesced writes"); }
+			});
+		}
+
+		/**
+		 * Allocate cache buffers for a newly opened file
+		 */
+		void _init_cache(Fs_vfs_handle &handle, unsigned vfs_mode)
+		{
+			unsigned const accmode = vfs_mode & OPEN_MODE_ACCMODE;
+
+			if (_write_behind && accmode != OPEN_MODE_RDONLY) {
+				handle.wb_buf  = (char *)_alloc.alloc(_write_behind);
+				handle.wb_size = _write_behind;
+			}
+
+			if (!_read_ahead || accmode == OPEN_MODE_WRONLY)
+				return;
+
+			/*
+			 * Without a subscription to content-change notifications, we
+			 * would never learn about stale read-ahead data, so read ahead
+			 * only if the subscription can be submitted
+			 */
+			::File_system::Session::Tx::Source &source = *_fs.tx();
+			if (!source.ready_to_submit())
+				return;
+
+			try {
+				handle.ra_buf  = (char *)_alloc.alloc(_read_ahead);
+				handle.ra_size = _read_ahead;
+			}
+			catch (...) {
+				_destruct_cache(handle);
+				throw;
+			}
+
+			using ::File_system::Packet_descriptor;
+			source.submit_packet(Packet_descriptor(Packet_descriptor(),
+			                                       handle.file_handle(),
+			                                       Packet_descriptor::CONTENT_CHANGED,
+			                                       0, 0));
+		}
+
+		void _destruct_cache(Fs_vfs_handle &handle)
+		{
+			if (handle.wb_buf) _alloc.free(handle.wb_buf, handle.wb_size);
+			if (handle.ra_buf) _alloc.free(handle.ra_buf, handle.ra_size);
+
+			handle.wb_buf  = nullptr;
+			handle.wb_size = 0;
+			handle.ra_buf  = nullptr;
+			handle.ra_size = 0;
+		}
+
 		file_size _read(Fs_vfs_handle &handle, void *buf,
 		                file_size const count, file_size const seek_offset)
 		{
@@ -531,6 +745,7 @@ class Vfs::Fs_file_system : public File_system
 							break;
 
 						case Packet_descriptor::CONTENT_CHANGED:
+							handle.invalidate_read_cache();
 							_post_signal_hook.arm(handle.context);
 							break;
 
@@ -554,6 +769,13 @@ class Vfs::Fs_file_system : public File_system
 		Genode::Io_signal_handler<Fs_file_system> _ack_handler {
 			_env.ep(), *this, &Fs_file_system::_handle_ack };
 
+		static file_size _cache_size(Genode::Xml_node config, char const *attr)
+		{
+			/* each buffer must fit into a single packet */
+			return min((file_size)config.attribute_value(attr, Genode::Number_of_bytes(0)),
+			           (file_size)::File_system::DEFAULT_TX_BUF_SIZE / 2);
+		}
+
 	public:
 
 		Fs_file_system(Genode::Env         &env,
@@ -562,10 +784,13 @@ class Vfs::Fs_file_system : public File_system
 		               Io_response_handler &io_handler)
 		:
 			_env(env),
+			_alloc(alloc),
 			_fs_packet_alloc(&alloc),
 			_io_handler(io_handler),
 			_label(config.attribute_value("label", Label_string())),
 			_root( config.attribute_value("root",  Root_string())),
+			_read_ahead  (_cache_size(config, "read_ahead")),
+			_write_behind(_cache_size(config, "write_behind")),
 			_fs(env, _fs_packet_alloc,
 			    _label.string(), _root.string(),
 			    config.attribute_value("writeable", true),
@@ -590,6 +815,10 @@ class Vfs::Fs_file_system : public File_system
 		{
 			::File_system::Status status;
 
+			/* make the size of the file reflect coalesced writes */
+			if (_write_behind)
+				_flush_all();
+
 			try {
 				::File_system::Node_handle node = _fs.node(path);
 				Fs_handle_guard node_guard(*this, _fs, node, _handle_space,
@@ -753,9 +982,18 @@ class Vfs::Fs_file_system : public File_system
 				                                           file_name.base() + 1,
 				                                           mode, create);
 
-				*out_handle = new (alloc)
+				Fs_vfs_file_handle *handle = new (alloc)
 					Fs_vfs_file_handle(*this, alloc, vfs_mode, _handle_space,
 					                   file, _fs, _io_handler);
+
+				try { _init_cache(*handle, vfs_mode); }
+				catch (...) {
+					_fs.close(file);
+					destroy(alloc, handle);
+					throw;
+				}
+
+				*out_handle = handle;
 			}
 			catch (::File_system::Lookup_failed)       { return OPEN_ERR_UNACCESSIBLE;  }
 			catch (::File_system::Permission_denied)   { return OPEN_ERR_NO_PERM;       }
@@ -843,11 +1081,14 @@ class Vfs::Fs_file_system : public File_system
 		{
 			if (!vfs_handle) return;
 
-			Lock::Guard guard(_lock);
-
 			Fs_vfs_handle *fs_handle = static_cast<Fs_vfs_handle *>(vfs_handle);
 
+			_flush_blocking(*fs_handle);
+
+			Lock::Guard guard(_lock);
+
 			_fs.close(fs_handle->file_handle());
+			_destruct_cache(*fs_handle);
 			destroy(fs_handle->alloc(), fs_handle);
 		}
 
@@ -871,8 +1112,30 @@ class Vfs::Fs_file_system : public File_system
 
 			Fs_vfs_handle &handle = static_cast<Fs_vfs_handle &>(*vfs_handle);
 
-			out_count = _write(handle, buf, buf_size, handle.seek());
+			handle.invalidate_read_cache();
+
+			file_size const seek = handle.seek();
+
+			/* pass large writes directly */
+			if (!handle.wb_buf || buf_size >= handle.wb_size) {
+				_flush(handle);
+				out_count = _write(handle, buf, buf_size, seek);
+				return WRITE_OK;
+			}
+
+			/* coalesce adjacent writes */
+			if (handle.wb_length
+			 && (seek != handle.wb_offset + handle.wb_length
+			  || handle.wb_length + buf_size > handle.wb_size))
+				_flush(handle);
+
+			if (!handle.wb_length)
+				handle.wb_offset = seek;
 
+			memcpy(handle.wb_buf + handle.wb_length, buf, buf_size);
+			handle.wb_length += buf_size;
+
+			out_count = buf_size;
 			return WRITE_OK;
 		}
 
@@ -882,6 +1145,10 @@ class Vfs::Fs_file_system : public File_system
 
 			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
 
+			/* let the read observe preceding writes */
+			try { _flush(*handle); }
+			catch (Insufficient_buffer) { return false; }
+
 			return handle->queue_read(count);
 		}
 
@@ -935,7 +1202,10 @@ class Vfs::Fs_file_system : public File_system
 
 		Ftruncate_result ftruncate(Vfs_handle *vfs_handle, file_size len) override
 		{
-			Fs_vfs_handle const *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+
+			_flush_blocking(*handle);
+			handle->invalidate_read_cache();
 
 			try {
 				_fs.truncate(handle->file_handle(), len);
@@ -954,6 +1224,10 @@ class Vfs::Fs_file_system : public File_system
 
 			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
 
+			/* the sync acts as barrier for coalesced writes */
+			try { _flush(*handle); }
+			catch (Insufficient_buffer) { return false; }
+
 			return handle->queue_sync();
 		}
 
@@ -17,6 +17,7 @@
 #include <file_system/util.h>
 #include <os/path.h>
 #include <base/attached_ram_dataspace.h>
+#include <base/attached_rom_dataspace.h>
 #include <root/component.h>
 #include <base/component.h>
 #include <base/session_label.h>
@@ -33,15 +34,168 @@ namespace Fs_rom {
 
 	struct Packet_handler;
 
+	class Rom_file;
+	class Rom_file_cache;
 	class Rom_session_component;
 	class Rom_root;
 
 	typedef Genode::List<Rom_session_component> Sessions;
 
 	typedef File_system::Session_client::Tx::Source Tx_source;
+
+	enum { PATH_MAX_LEN = 512 };
+	typedef Genode::Path<PATH_MAX_LEN> Path;
 }
 
 
+struct Fs_rom::Packet_handler : Genode::Io_signal_handler<Packet_handler>
+{
+	Tx_source &source;
+
+	/* list of open sessions */
+	Sessions sessions { };
+
+	void handle_packets();
+
+	Packet_handler(Genode::Entrypoint &ep, Tx_source &source)
+	:
+		Genode::Io_signal_handler<Packet_handler>(
+			ep, *this, &Packet_handler::handle_packets),
+		source(source)
+	{ }
+};
+
+
+/**
+ * Content of one version of a file, shared by all sessions of the file
+ */
+class Fs_rom::Rom_file : public Genode::List<Rom_file>::Element
+{
+	private:
+
+		Path const                     _path;
+		Genode::Attached_ram_dataspace _ds;
+		unsigned                       _users = 0;
+
+		/*
+		 * Set once the file changed after the content was read. A stale
+		 * version is no longer handed out to new users but stays alive
+		 * as long as sessions refer to it.
+		 */
+		bool _stale = false;
+
+	public:
+
+		Rom_file(Genode::Env &env, Path const &path, size_t size)
+		: _path(path), _ds(env.ram(), env.rm(), size) { }
+
+		Path const &path()  const { return _path; }
+		size_t      size()  const { return _ds.size(); }
+		unsigned    users() const { return _users; }
+		bool        stale() const { return _stale; }
+
+		char *local_addr() { return _ds.local_addr<char>(); }
+
+		Genode::Dataspace_capability cap() const { return _ds.cap(); }
+
+		friend class Rom_file_cache;
+};
+
+
+/**
+ * Registry of file contents keyed by path
+ *
+ * If several clients request the same file, the file is read only once
+ * and all sessions share the same read-only dataspace. Each change
+ * notification for a file marks its cached content as stale so that the
+ * next request reads the new version.
+ */
+class Fs_rom::Rom_file_cache
+{
+	private:
+
+		Genode::Env           &_env;
+		Genode::Allocator     &_alloc;
+		bool            const  _verbose;
+		Genode::List<Rom_file> _files { };
+
+		/* RAM that would have been allocated without sharing */
+		size_t _saved_bytes = 0;
+
+		Rom_file *_lookup(Path const &path)
+		{
+			for (Rom_file *f = _files.first(); f; f = f->next())
+				if (!f->_stale && f->_path.equals(path))
+					return f;
+
+			return nullptr;
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param verbose  log the memory saved by sharing on each cache hit
+		 */
+		Rom_file_cache(Genode::Env &env, Genode::Allocator &alloc, bool verbose)
+		: _env(env), _alloc(alloc), _verbose(verbose) { }
+
+		/**
+		 * Acquire up-to-date file content of given size
+		 *
+		 * \param fresh  set to true if the returned content must be read
+		 *               from the file system
+		 */
+		Rom_file &acquire(Path const &path, size_t size, bool &fresh)
+		{
+			Rom_file *file = _lookup(path);
+
+			if (file && file->size() == size) {
+				file->_users++;
+				_saved_bytes += size;
+				fresh = false;
+
+				if (_verbose)
+					Genode::log(path, ": shared by ", file->_users, " sessions, "
+					            "saved ", _saved_bytes / 1024, " KiB in total");
+				return *file;
+			}
+
+			/* replace outdated content */
+			if (file)
+				invalidate(path);
+
+			file = new (_alloc) Rom_file(_env, path, size);
+			file->_users = 1;
+			_files.insert(file);
+			fresh = true;
+			return *file;
+		}
+
+		void release(Rom_file &file)
+		{
+			if (--file._users) {
+				_saved_bytes -= file.size();
+				return;
+			}
+
+			_files.remove(&file);
+			Genode::destroy(_alloc, &file);
+		}
+
+		/**
+		 * Mark content of file as outdated
+		 */
+		void invalidate(Path const &path)
+		{
+			for (Rom_file *f = _files.first(); f; f = f->next())
+				if (f->_path.equals(path))
+					f->_stale = true;
+		}
+};
+
+
 /**
  * A 'Rom_session_component' exports a single file of the file system
  */
@@ -54,8 +208,9 @@ class Fs_rom::Rom_session_component :
 
 		File_system::Session &_fs;
 
-		enum { PATH_MAX_LEN = 512 };
-		typedef Genode::Path<PATH_MAX_LEN> Path;
+		Rom_file_cache       &_cache;
+
+		Packet_handler       &_packet_handler;
 
 		/**
 		 * Name of requested file, interpreted at path into the file system
@@ -68,14 +223,9 @@ class Fs_rom::Rom_session_component :
 		Genode::Constructible<File_system::File_handle> _file_handle;
 
 		/**
-		 * Size of current version of the file
-		 */
-		File_system::file_size_t _file_size = 0;
-
-		/**
-		 * Read offset of the file
+		 * Number of bytes still to read into '_file'
 		 */
-		File_system::seek_off_t _file_seek = 0;
+		size_t _bytes_pending = 0;
 
 		/**
 		 * Handle of currently watched compound directory
@@ -86,9 +236,29 @@ class Fs_rom::Rom_session_component :
 		Genode::Constructible<File_system::Dir_handle> _compound_dir_handle;
 
 		/**
-		 * Dataspace exposed as ROM module to the client
+		 * Content exposed as ROM module to the client
+		 */
+		Rom_file *_file = nullptr;
+
+		/**
+		 * Remainders of short reads, requested again by 'submit_remainders'
+		 *
+		 * Each remainder replaces an acknowledged read request. Hence,
+		 * their number is bounded by the size of the packet queue.
 		 */
-		Genode::Attached_ram_dataspace _file_ds;
+		struct Read_range { File_system::seek_off_t offset; size_t length; };
+
+		Read_range _remainders[File_system::Session::TX_QUEUE_SIZE];
+		unsigned   _num_remainders = 0;
+
+		void _release_file()
+		{
+			if (_file)
+				_cache.release(*_file);
+
+			_file           = nullptr;
+			_num_remainders = 0;
+		}
 
 		/**
 		 * Signal destination for ROM file changes
@@ -209,31 +379,50 @@ class Fs_rom::Rom_session_component :
 		}
 
 		/**
-		 * Initialize '_file_ds' dataspace with file content
+		 * Request the file content starting at 'offset'
+		 *
+		 * Read requests are pipelined, i.e., as many chunks are submitted
+		 * as fit into the packet-stream buffer. Their acknowledgements are
+		 * processed in any order by 'process_packet'.
 		 */
-		void _update_dataspace()
+		void _submit_reads(File_system::seek_off_t offset, size_t length)
 		{
-			using namespace File_system;
+			Tx_source &source = *_fs.tx();
 
-			/*
-			 * On each repeated call of this function, the dataspace is
-			 * replaced with a new one that contains the most current file
-			 * content. The dataspace is re-allocated if the new version
-			 * of the file has become bigger.
-			 */
-			try {
-				File_handle const file_handle = _open_file(_fs, _file_path);
-				File_system::file_size_t const new_file_size =
-					_fs.status(file_handle).size;
-
-				if (_file_ds.size() && (new_file_size > _file_size)) {
-					/* mark as invalid */
-					_file_ds.realloc(&_env.ram(), 0);
-					_file_size = 0;
-					_file_seek = 0;
+			size_t const max_chunk = source.bulk_buffer_size() / 4;
+
+			while (length) {
+				if (!source.ready_to_submit()) {
+					_env.ep().wait_and_dispatch_one_io_signal();
+					continue;
 				}
-				_fs.close(file_handle);
-			} catch (Open_file_failed) { }
+
+				size_t const chunk_size = min(length, max_chunk);
+
+				try {
+					File_system::Packet_descriptor
+						packet(source.alloc_packet(chunk_size),
+						       *_file_handle,
+						       File_system::Packet_descriptor::READ,
+						       chunk_size, offset);
+					source.submit_packet(packet);
+				} catch (Tx_source::Packet_alloc_failed) {
+					/* wait for acknowledgements to free buffer space */
+					_env.ep().wait_and_dispatch_one_io_signal();
+					continue;
+				}
+
+				offset += chunk_size;
+				length -= chunk_size;
+			}
+		}
+
+		/**
+		 * Assign the most current file content to '_file'
+		 */
+		void _update_file()
+		{
+			using namespace File_system;
 
 			/* close and then re-open the file */
 			if (_file_handle.constructed()) {
@@ -262,50 +451,57 @@ class Fs_rom::Rom_session_component :
 			size_t const file_size = _file_handle.constructed()
 			                       ? _fs.status(*_file_handle).size : 0;
 
-			/* allocate new RAM dataspace according to file size */
-			if (file_size > 0) {
-				try {
-					_file_seek = 0;
-					_file_ds.realloc(&_env.ram(), file_size);
-					_file_size = file_size;
-				} catch (...) {
-					Genode::error("couldn't allocate memory for file, empty result");;
-					return;
-				}
-			} else {
+			if (file_size == 0) {
 				_register_for_compound_dir_changes();
 				return;
 			}
 
-			/* omit read if file is empty */
-			if (_file_size == 0)
+			/*
+			 * Apply pending change notifications to the cache before looking
+			 * up the content. Otherwise, an outdated version of the same size
+			 * would be handed out.
+			 */
+			_packet_handler.handle_packets();
+
+			bool fresh = false;
+			try {
+				_file = &_cache.acquire(_file_path, file_size, fresh);
+			} catch (...) {
+				Genode::error("couldn't allocate memory for file, empty result");
+				return;
+			}
+
+			if (!fresh)
 				return;
 
 			/* read content from file */
-			Tx_source &source = *_fs.tx();
-			while (_file_seek < _file_size) {
-				/* if we cannot submit then process acknowledgements */
-				if (source.ready_to_submit()) {
-					size_t chunk_size = min(_file_size - _file_seek,
-					                        source.bulk_buffer_size() / 2);
-					File_system::Packet_descriptor
-						packet(source.alloc_packet(chunk_size),
-						       *_file_handle,
-						       File_system::Packet_descriptor::READ,
-						       chunk_size,
-						       _file_seek);
-					source.submit_packet(packet);
-				}
+			_bytes_pending = file_size;
+			_submit_reads(0, file_size);
 
-				/*
-				 * Process the global signal handler until we got a response
-				 * for the read request (indicated by a change of the seek
-				 * position).
-				 */
-				size_t const orig_file_seek = _file_seek;
-				while (_file_seek == orig_file_seek)
-					_env.ep().wait_and_dispatch_one_io_signal();
-			}
+			/*
+			 * Process the I/O signal handler until all read requests got
+			 * acknowledged.
+			 */
+			while (_file && _bytes_pending)
+				_env.ep().wait_and_dispatch_one_io_signal();
+		}
+
+		void _update_dataspace()
+		{
+			/*
+			 * On each repeated call of this function, the file is re-opened
+			 * to pick up a replaced file. The content is read only if no
+			 * session already holds the current version of the file. The
+			 * previous version is released not before acquiring the new one
+			 * so that an unchanged file is not read again.
+			 */
+			Rom_file *previous = _file;
+			_file = nullptr;
+
+			_update_file();
+
+			if (previous)
+				_cache.release(*previous);
 		}
 
 		void _notify_client_about_new_version()
@@ -327,11 +523,13 @@ class Fs_rom::Rom_session_component :
 		 *                  creation time)
 		 */
 		Rom_session_component(Genode::Env &env,
-		                      File_system::Session &fs, const char *file_path)
+		                      File_system::Session &fs,
+		                      Rom_file_cache &cache,
+		                      Packet_handler &packet_handler,
+		                      const char *file_path)
 		:
-			_env(env), _fs(fs),
-			_file_path(file_path),
-			_file_ds(env.ram(), env.rm(), 0) /* realloc later */
+			_env(env), _fs(fs), _cache(cache), _packet_handler(packet_handler),
+			_file_path(file_path)
 		{
 			try {
 				_file_handle.construct(_open_file(_fs, _file_path));
@@ -345,6 +543,8 @@ class Fs_rom::Rom_session_component :
 		 */
 		~Rom_session_component()
 		{
+			_release_file();
+
 			/* close re-open the file */
 			if (_file_handle.constructed())
 				_fs.close(*_file_handle);
@@ -359,7 +559,8 @@ class Fs_rom::Rom_session_component :
 		Genode::Rom_dataspace_capability dataspace()
 		{
 			_update_dataspace();
-			Genode::Dataspace_capability ds = _file_ds.cap();
+			Genode::Dataspace_capability ds = _file ? _file->cap()
+			                                        : Genode::Dataspace_capability();
 			_handed_out_version = _curr_version;
 			return Genode::static_cap_cast<Genode::Rom_dataspace>(ds);
 		}
@@ -386,6 +587,7 @@ class Fs_rom::Rom_session_component :
 				if ((_file_handle.constructed() && (*_file_handle == packet.handle())) ||
 				    (_compound_dir_handle.constructed() && (*_compound_dir_handle == packet.handle())))
 				{
+					_cache.invalidate(_file_path);
 					_notify_client_about_new_version();
 					return true;
 				}
@@ -396,16 +598,34 @@ class Fs_rom::Rom_session_component :
 				if (!(_file_handle.constructed() && (*_file_handle == packet.handle())))
 					return false;
 
-				if (packet.position() > _file_seek || _file_seek >= _file_size) {
+				if (!_file || packet.position() >= _file->size()) {
 					error("bad packet seek position");
-					_file_ds.realloc(&_env.ram(), 0);
+					_release_file();
 					return true;
 				}
 
-				size_t const n = min(packet.length(), _file_size - _file_seek);
-				memcpy(_file_ds.local_addr<char>()+_file_seek,
+				size_t const position  = packet.position();
+				size_t const requested = packet.size();
+				size_t const n = min(packet.length(), _file->size() - position);
+
+				memcpy(_file->local_addr() + position,
 				       _fs.tx()->packet_content(packet), n);
-				_file_seek += n;
+				_bytes_pending -= min(n, _bytes_pending);
+
+				/*
+				 * Re-request the remainder of a short read once the
+				 * acknowledged packets are released.
+				 */
+				if (n && n < requested && position + n < _file->size()
+				 && _num_remainders < File_system::Session::TX_QUEUE_SIZE)
+					_remainders[_num_remainders++] = Read_range {
+						position + n, min(requested, _file->size() - position) - n };
+
+				/* give up if the file shrunk while reading */
+				if (!n) {
+					error(_file_path, ": unexpected end of file");
+					_release_file();
+				}
 				return true;
 			}
 
@@ -416,36 +636,40 @@ class Fs_rom::Rom_session_component :
 			}
 			return false;
 		}
+
+		/**
+		 * Request the remainders of short reads
+		 *
+		 * Called by the packet handler after releasing the acknowledged
+		 * packets, which frees the buffer space needed for the requests.
+		 */
+		void submit_remainders()
+		{
+			while (_file && _num_remainders) {
+				Read_range const range = _remainders[--_num_remainders];
+				_submit_reads(range.offset, range.length);
+			}
+		}
 };
 
-struct Fs_rom::Packet_handler : Genode::Io_signal_handler<Packet_handler>
+void Fs_rom::Packet_handler::handle_packets()
 {
-	Tx_source &source;
-
-	/* list of open sessions */
-	Sessions sessions;
-
-	void handle_packets()
-	{
-		while (source.ack_avail()) {
-			File_system::Packet_descriptor pack = source.get_acked_packet();
-			for (Rom_session_component *session = sessions.first();
-			     session; session = session->next())
-			{
-				if (session->process_packet(pack))
-					break;
-			}
-			source.release_packet(pack);
+	while (source.ack_avail()) {
+		File_system::Packet_descriptor pack = source.get_acked_packet();
+		for (Rom_session_component *session = sessions.first();
+		     session; session = session->next())
+		{
+			if (session->process_packet(pack))
+				break;
 		}
+		source.release_packet(pack);
 	}
 
-	Packet_handler(Genode::Entrypoint &ep, Tx_source &source)
-	:
-		Genode::Io_signal_handler<Packet_handler>(
-			ep, *this, &Packet_handler::handle_packets),
-		source(source)
-	{ }
-};
+	/* re-request data not delivered by short reads */
+	for (Rom_session_component *session = sessions.first();
+	     session; session = session->next())
+		session->submit_remainders();
+}
 
 
 class Fs_rom::Rom_root : public Genode::Root_component<Fs_rom::Rom_session_component>
@@ -461,6 +685,16 @@ class Fs_rom::Rom_root : public Genode::Root_component<Fs_rom::Rom_session_compo
 
 		Packet_handler _packet_handler { _env.ep(), *_fs.tx() };
 
+		static bool _verbose(Genode::Env &env)
+		{
+			try {
+				Genode::Attached_rom_dataspace config(env, "config");
+				return config.xml().attribute_value("verbose", false);
+			} catch (...) { return false; }
+		}
+
+		Rom_file_cache _cache { _env, _heap, _verbose(_env) };
+
 		Rom_session_component *_create_session(const char *args) override
 		{
 			Genode::Session_label const label = label_from_args(args);
@@ -470,7 +704,8 @@ class Fs_rom::Rom_root : public Genode::Root_component<Fs_rom::Rom_session_compo
 
 			/* create new session for the requested file */
 			Rom_session_component *session = new (md_alloc())
-				Rom_session_component(_env, _fs, module_name.string());
+				Rom_session_component(_env, _fs, _cache, _packet_handler,
+				                      module_name.string());
 
 			_packet_handler.sessions.insert(session);
 			return session;
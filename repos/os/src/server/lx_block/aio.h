@@ -0,0 +1,155 @@
+/*
+ * \brief  Thin wrapper around the native Linux AIO interface
+ * \author Josef Soentgen
+ * \date   2017-11-20
+ *
+ * The glibc does not provide wrappers for the native AIO system calls.
+ * Hence, we call them directly instead of depending on libaio.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _LX_BLOCK__AIO_H_
+#define _LX_BLOCK__AIO_H_
+
+/* Genode includes */
+#include <base/exception.h>
+#include <util/string.h>
+
+/* Linux includes */
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/aio_abi.h>
+
+namespace Lx_aio {
+
+	typedef struct iocb     Iocb;
+	typedef struct io_event Event;
+
+	enum Opcode { READ = IOCB_CMD_PREAD, WRITE = IOCB_CMD_PWRITE };
+
+	class Context;
+
+	/**
+	 * Block until at least one completion was signalled via 'fd'
+	 *
+	 * \return false if the wait got interrupted
+	 */
+	static inline bool wait_for_completion(int fd)
+	{
+		uint64_t count = 0;
+		return read(fd, &count, sizeof(count)) == sizeof(count);
+	}
+}
+
+
+class Lx_aio::Context
+{
+	private:
+
+		aio_context_t _ctx      { 0 };
+		int           _event_fd { -1 };
+
+		/*
+		 * Noncopyable
+		 */
+		Context(Context const &);
+		Context &operator = (Context const &);
+
+	public:
+
+		struct Setup_failed : Genode::Exception { };
+
+		/**
+		 * Constructor
+		 *
+		 * \param depth  maximum number of in-flight requests
+		 *
+		 * \throw Setup_failed
+		 */
+		Context(unsigned depth)
+		{
+			if (syscall(__NR_io_setup, depth, &_ctx) != 0)
+				throw Setup_failed();
+
+			_event_fd = eventfd(0, EFD_CLOEXEC);
+			if (_event_fd == -1) {
+				syscall(__NR_io_destroy, _ctx);
+				throw Setup_failed();
+			}
+		}
+
+		~Context()
+		{
+			/* blocks until all outstanding requests are completed */
+			syscall(__NR_io_destroy, _ctx);
+			close(_event_fd);
+		}
+
+		/**
+		 * File descriptor signalling the availability of completions
+		 */
+		int event_fd() const { return _event_fd; }
+
+		/**
+		 * Fill out control block
+		 *
+		 * \param cookie  opaque pointer handed back with the completion event
+		 */
+		void prepare(Iocb &iocb, Opcode op, int fd, void *buffer,
+		             Genode::size_t count, Genode::int64_t offset,
+		             void *cookie)
+		{
+			Genode::memset(&iocb, 0, sizeof(iocb));
+
+			iocb.aio_lio_opcode = op;
+			iocb.aio_fildes     = fd;
+			iocb.aio_buf        = (uint64_t)(Genode::addr_t)buffer;
+			iocb.aio_nbytes     = count;
+			iocb.aio_offset     = offset;
+			iocb.aio_data       = (uint64_t)(Genode::addr_t)cookie;
+			iocb.aio_flags      = IOCB_FLAG_RESFD;
+			iocb.aio_resfd      = _event_fd;
+		}
+
+		/**
+		 * Submit prepared control block
+		 *
+		 * \return false if the request could not be queued
+		 */
+		bool submit(Iocb &iocb)
+		{
+			Iocb *list[1] = { &iocb };
+			return syscall(__NR_io_submit, _ctx, 1, list) == 1;
+		}
+
+		/**
+		 * Collect completion events
+		 *
+		 * \param min  minimum number of events to wait for, 0 does not block
+		 *
+		 * \return number of events stored in 'events'
+		 */
+		int reap(Event *events, unsigned max, unsigned min)
+		{
+			struct timespec no_wait { 0, 0 };
+
+			int n;
+			do {
+				n = syscall(__NR_io_getevents, _ctx, min, max, events,
+				            min ? nullptr : &no_wait);
+			} while (n < 0 && errno == EINTR);
+
+			return n;
+		}
+};
+
+#endif /* _LX_BLOCK__AIO_H_ */
@@ -16,8 +16,11 @@
 #include <base/component.h>
 #include <base/heap.h>
 #include <base/log.h>
+#include <base/thread.h>
 #include <block/component.h>
 #include <block/driver.h>
+#include <timer_session/connection.h>
+#include <util/reconstructible.h>
 #include <util/string.h>
 
 /* libc includes */
@@ -27,6 +30,10 @@
 #include <fcntl.h>
 #include <stdio.h> /* perror */
 
+/* local includes */
+#include "aio.h"
+#include "stats.h"
+
 
 static bool xml_attr_ok(Genode::Xml_node node, char const *attr)
 {
@@ -38,6 +45,51 @@ class Lx_block_driver : public Block::Driver
 {
 	private:
 
+		enum {
+			DEFAULT_QUEUE_DEPTH = 64,
+			MAX_QUEUE_DEPTH     = Block::Session::TX_QUEUE_SIZE,
+			DIRECT_IO_ALIGN     = 512,
+		};
+
+		/**
+		 * Request slot of an in-flight asynchronous request
+		 */
+		struct Request
+		{
+			Block::Packet_descriptor packet   { };
+			Lx_aio::Iocb             iocb     { };
+			Lx_block::Stats::Time    start_us { 0 };
+			bool                     used     { false };
+		};
+
+		/**
+		 * Thread waiting for completions on the eventfd
+		 *
+		 * The thread merely forwards the completion notification as a
+		 * signal. The completions themselves are processed by the
+		 * entrypoint.
+		 */
+		struct Completion_thread : Genode::Thread
+		{
+			int                               const fd;
+			Genode::Signal_context_capability const sigh;
+
+			Completion_thread(Genode::Env &env, int fd,
+			                  Genode::Signal_context_capability sigh)
+			: Genode::Thread(env, "aio_completion", 0x2000), fd(fd), sigh(sigh)
+			{ }
+
+			void entry()
+			{
+				while (true) {
+					if (!Lx_aio::wait_for_completion(fd))
+						continue;
+
+					Genode::Signal_transmitter(sigh).submit();
+				}
+			}
+		};
+
 		Genode::Env &_env;
 
 		Block::sector_t            _block_count {   0 };
@@ -46,6 +98,150 @@ class Lx_block_driver : public Block::Driver
 
 		int _fd { -1 };
 
+		/*
+		 * When using O_DIRECT, requests with misaligned buffers are
+		 * directed to a second file descriptor opened without O_DIRECT.
+		 */
+		int  _buffered_fd { -1 };
+		bool _direct_io   { false };
+
+		unsigned _queue_depth { DEFAULT_QUEUE_DEPTH };
+		unsigned _pending     { 0 };
+
+		Request _requests[MAX_QUEUE_DEPTH];
+
+		Genode::Constructible<Lx_aio::Context> _aio;
+
+		Genode::Signal_handler<Lx_block_driver> _completion_handler {
+			_env.ep(), *this, &Lx_block_driver::_handle_completions };
+
+		Genode::Constructible<Completion_thread> _completion_thread;
+
+		Lx_block::Stats _stats;
+
+		Genode::Constructible<Timer::Connection> _timer;
+
+		Genode::Signal_handler<Lx_block_driver> _stats_handler {
+			_env.ep(), *this, &Lx_block_driver::_handle_stats };
+
+		void _handle_stats() { _stats.report(); }
+
+		bool _aligned(void const *buffer, Genode::size_t count) const
+		{
+			return !(((Genode::addr_t)buffer | count) & (DIRECT_IO_ALIGN - 1));
+		}
+
+		int _fd_for(void const *buffer, Genode::size_t count) const
+		{
+			return (!_direct_io || _aligned(buffer, count)) ? _fd : _buffered_fd;
+		}
+
+		Request *_alloc_request()
+		{
+			for (unsigned i = 0; i < _queue_depth; i++)
+				if (!_requests[i].used) {
+					_requests[i].used = true;
+					return &_requests[i];
+				}
+
+			return nullptr;
+		}
+
+		void _complete(Request &r, long res)
+		{
+			Genode::size_t const expected = r.packet.block_count() * _block_size;
+			bool const success = (res >= 0 && (Genode::size_t)res == expected);
+
+			if (!success)
+				Genode::error("request ", r.packet.operation() == Block::Packet_descriptor::READ
+				              ? "read" : "write", " block: ", r.packet.block_number(),
+				              " count: ", r.packet.block_count(), " failed (res=", res, ")");
+
+			_stats.complete(r.packet.operation(), _stats.now_us() - r.start_us);
+
+			Block::Packet_descriptor packet = r.packet;
+			r.used = false;
+			_pending--;
+
+			/* may re-enter '_submit' for a previously congested request */
+			ack_packet(packet, success);
+		}
+
+		/**
+		 * Process all completions available without blocking
+		 *
+		 * \param min  number of completions to wait for
+		 */
+		void _reap(unsigned min)
+		{
+			enum { BATCH = 32 };
+			Lx_aio::Event events[BATCH];
+
+			while (_pending) {
+				unsigned const want = min > BATCH ? (unsigned)BATCH : min;
+
+				int const n = _aio->reap(events, BATCH, want);
+				if (n <= 0)
+					break;
+
+				min = (unsigned)n >= min ? 0 : min - n;
+
+				for (int i = 0; i < n; i++)
+					_complete(*(Request *)(Genode::addr_t)events[i].data,
+					          (long)events[i].res);
+			}
+		}
+
+		void _handle_completions() { _reap(0); }
+
+		void _submit(Lx_aio::Opcode op, Block::sector_t block_number,
+		             Genode::size_t block_count, void *buffer,
+		             Block::Packet_descriptor &packet)
+		{
+			off_t  const offset = block_number * _block_size;
+			size_t const count  = block_count  * _block_size;
+
+			int const fd = _fd_for(buffer, count);
+
+			/* synchronous fallback if no AIO context is available */
+			if (!_aio.constructed()) {
+				Lx_block::Stats::Time const start = _stats.now_us();
+
+				ssize_t const n = (op == Lx_aio::READ)
+				                ? pread(fd, buffer, count, offset)
+				                : pwrite(fd, buffer, count, offset);
+				if (n == -1) {
+					perror(op == Lx_aio::READ ? "pread" : "pwrite");
+					throw Io_error();
+				}
+
+				_stats.complete(packet.operation(), _stats.now_us() - start);
+				ack_packet(packet);
+				return;
+			}
+
+			Request *r = _alloc_request();
+			if (!r)
+				throw Request_congestion();
+
+			r->packet   = packet;
+			r->start_us = _stats.now_us();
+			_aio->prepare(r->iocb, op, fd, buffer, count, offset, r);
+
+			if (!_aio->submit(r->iocb)) {
+				r->used = false;
+
+				/* the kernel's queue is exhausted, retry on next completion */
+				if (_pending)
+					throw Request_congestion();
+
+				Genode::error("io_submit failed");
+				throw Io_error();
+			}
+
+			_pending++;
+		}
+
 	public:
 
 		struct Could_not_open_file : Genode::Exception { };
@@ -71,6 +267,22 @@ class Lx_block_driver : public Block::Driver
 
 			bool const writeable = xml_attr_ok(config, "writeable");
 
+			_queue_depth = Genode::min(config.attribute_value("queue_depth",
+			                                                  (unsigned)DEFAULT_QUEUE_DEPTH),
+			                           (unsigned)MAX_QUEUE_DEPTH);
+
+			/*
+			 * Linux processes AIO requests for buffered files synchronously
+			 * within 'io_submit'. Hence, direct I/O is enabled by default
+			 * whenever requests are meant to be processed asynchronously.
+			 */
+			bool const async = _queue_depth > 1;
+			_direct_io = config.attribute_value("direct_io", async);
+			if (_direct_io && (_block_size % DIRECT_IO_ALIGN)) {
+				Genode::warning("block size not suitable for direct I/O, disabling it");
+				_direct_io = false;
+			}
+
 			struct stat st;
 			if (stat(file.string(), &st)) {
 				perror("stat");
@@ -80,23 +292,69 @@ class Lx_block_driver : public Block::Driver
 			_block_count = st.st_size / _block_size;
 
 			/* open file */
-			_fd = open(file.string(), writeable ? O_RDWR : O_RDONLY);
+			int const flags = writeable ? O_RDWR : O_RDONLY;
+			_fd = open(file.string(), flags | (_direct_io ? O_DIRECT : 0));
+			if (_fd == -1 && _direct_io) {
+				Genode::warning("file system does not support direct I/O, disabling it");
+				_direct_io = false;
+				_fd = open(file.string(), flags);
+			}
 			if (_fd == -1) {
 				perror("open");
 				throw Could_not_open_file();
 			}
 
+			if (_direct_io) {
+				_buffered_fd = open(file.string(), flags);
+				if (_buffered_fd == -1) {
+					perror("open");
+					close(_fd);
+					throw Could_not_open_file();
+				}
+			}
+
 			_block_ops.set_operation(Block::Packet_descriptor::READ);
 			if (writeable) {
 				_block_ops.set_operation(Block::Packet_descriptor::WRITE);
 			}
 
+			/* queue depth of 1 selects the synchronous mode of operation */
+			if (_queue_depth > 1) {
+				try {
+					_aio.construct(_queue_depth);
+					_completion_thread.construct(env, _aio->event_fd(),
+					                             _completion_handler);
+					_completion_thread->start();
+				} catch (Lx_aio::Context::Setup_failed) {
+					Genode::warning("Linux AIO unavailable, falling back to synchronous I/O");
+					_queue_depth = 1;
+				}
+			}
+
+			if (_aio.constructed() && !_direct_io)
+				Genode::warning("requests are processed synchronously without "
+				                "direct I/O, queue_depth has no effect");
+
+			unsigned const stats_interval_ms =
+				config.attribute_value("stats_interval_ms", 0U);
+			if (stats_interval_ms) {
+				_timer.construct(env);
+				_timer->sigh(_stats_handler);
+				_timer->trigger_periodic(stats_interval_ms * 1000);
+			}
+
 			Genode::log("Provide '", file.string(), "' as block device "
 			            "block_size: ", _block_size, " block_count: ",
-			            _block_count, " writeable: ", writeable ? "yes" : "no");
+			            _block_count, " writeable: ", writeable ? "yes" : "no",
+			            " queue_depth: ", _queue_depth,
+			            " direct_io: ", _direct_io ? "yes" : "no");
 		}
 
-		~Lx_block_driver() { close(_fd); }
+		~Lx_block_driver()
+		{
+			if (_buffered_fd != -1) close(_buffered_fd);
+			close(_fd);
+		}
 
 
 		/*****************************
@@ -117,16 +375,7 @@ class Lx_block_driver : public Block::Driver
 				throw Io_error();
 			}
 
-			off_t const offset = block_number * _block_size;
-			size_t const count = block_count * _block_size;
-
-			ssize_t const n = pread(_fd, buffer, count, offset);
-			if (n == -1) {
-				perror("pread");
-				throw Io_error();
-			}
-
-			ack_packet(packet);
+			_submit(Lx_aio::READ, block_number, block_count, buffer, packet);
 		}
 
 		void write(Block::sector_t           block_number,
@@ -139,19 +388,35 @@ class Lx_block_driver : public Block::Driver
 				throw Io_error();
 			}
 
-			off_t const offset = block_number * _block_size;
-			size_t const count = block_count * _block_size;
+			_submit(Lx_aio::WRITE, block_number, block_count,
+			        const_cast<char *>(buffer), packet);
+		}
 
-			ssize_t const n = pwrite(_fd, buffer, count, offset);
-			if (n == -1) {
-				perror("pwrite");
-				throw Io_error();
-			}
+		/**
+		 * Wait for all in-flight requests before flushing the file
+		 */
+		void sync() override
+		{
+			if (_aio.constructed())
+				_reap(_pending);
 
-			ack_packet(packet);
+			if (_block_ops.supported(Block::Packet_descriptor::WRITE)
+			 && fdatasync(_fd) == -1)
+				perror("fdatasync");
 		}
 
-		void sync() { }
+		/**
+		 * Drop requests of a closed session
+		 *
+		 * The packet-stream buffer of the session is going to vanish.
+		 * Hence, we have to wait until the kernel finished all requests
+		 * referring to it.
+		 */
+		void session_invalidated() override
+		{
+			if (_aio.constructed())
+				_reap(_pending);
+		}
 };
 
 
@@ -0,0 +1,125 @@
+/*
+ * \brief  Request statistics of the Linux block driver
+ * \author Josef Soentgen
+ * \date   2017-11-20
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _LX_BLOCK__STATS_H_
+#define _LX_BLOCK__STATS_H_
+
+/* Genode includes */
+#include <base/log.h>
+#include <block_session/block_session.h>
+
+/* Linux includes */
+#include <time.h>
+
+namespace Lx_block { class Stats; }
+
+
+/**
+ * IOPS and latency histogram
+ *
+ * Latencies are accounted in buckets of powers of two microseconds,
+ * which is precise enough to judge percentiles while keeping the
+ * accounting cheap.
+ */
+class Lx_block::Stats
+{
+	public:
+
+		typedef Genode::uint64_t Time;
+
+	private:
+
+		enum { BUCKETS = 32 };
+
+		unsigned long _reads        { 0 };
+		unsigned long _writes       { 0 };
+		unsigned long _buckets[BUCKETS];
+		Time          _max_us       { 0 };
+		Time          _last_report  { now_us() };
+
+		static unsigned _bucket(Time us)
+		{
+			unsigned i = 0;
+			for (; us && i < BUCKETS - 1; us >>= 1) i++;
+			return i;
+		}
+
+		/**
+		 * Return upper bound of the latency of the given percentile
+		 */
+		Time _percentile(unsigned percent) const
+		{
+			unsigned long const total     = _reads + _writes;
+			unsigned long const threshold = (total * percent + 99) / 100;
+
+			unsigned long sum = 0;
+			for (unsigned i = 0; i < BUCKETS; i++) {
+				sum += _buckets[i];
+				if (sum >= threshold)
+					return i ? (Time)1 << i : 0;
+			}
+			return _max_us;
+		}
+
+		void _reset()
+		{
+			_reads = _writes = 0;
+			_max_us = 0;
+			for (unsigned i = 0; i < BUCKETS; i++) _buckets[i] = 0;
+		}
+
+	public:
+
+		Stats() { _reset(); }
+
+		static Time now_us()
+		{
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return (Time)ts.tv_sec * 1000 * 1000 + ts.tv_nsec / 1000;
+		}
+
+		void complete(Block::Packet_descriptor::Opcode op, Time latency_us)
+		{
+			if (op == Block::Packet_descriptor::READ) _reads++;
+			else                                      _writes++;
+
+			_buckets[_bucket(latency_us)]++;
+
+			if (latency_us > _max_us) _max_us = latency_us;
+		}
+
+		/**
+		 * Log statistics of the period since the last report and reset
+		 */
+		void report()
+		{
+			Time const now    = now_us();
+			Time const period = now - _last_report;
+			_last_report = now;
+
+			if (!period) return;
+
+			unsigned long const total = _reads + _writes;
+			unsigned long const iops  = (unsigned long)(total * 1000 * 1000 / period);
+
+			Genode::log("IOPS: ", iops, " (reads: ", _reads, " writes: ", _writes,
+			            ") latency us p50<=", _percentile(50),
+			            " p90<=", _percentile(90), " p99<=", _percentile(99),
+			            " max=", _max_us);
+
+			_reset();
+		}
+};
+
+#endif /* _LX_BLOCK__STATS_H_ */
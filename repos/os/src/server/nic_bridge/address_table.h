@@ -0,0 +1,198 @@
+/*
+ * \brief  Hash table of address nodes
+ * \author Stefan Kalkowski
+ * \date   2017-11-23
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _ADDRESS_TABLE_H_
+#define _ADDRESS_TABLE_H_
+
+/* Genode */
+#include <base/log.h>
+#include <util/string.h>
+
+namespace Net {
+
+	template <typename NODE, unsigned SLOTS> class Address_table;
+	template <typename TABLE>                class Address_cache;
+}
+
+
+/**
+ * Open-addressing hash table mapping network addresses to address nodes
+ *
+ * The table uses linear probing, which keeps all probes of a lookup
+ * within a few adjacent cache lines. Each slot holds a copy of the
+ * address, so a lookup does not need to dereference any node except the
+ * one found. Removed entries are compacted by shifting subsequent entries
+ * backwards instead of leaving tombstones behind.
+ *
+ * \param NODE   address node type
+ * \param SLOTS  number of slots, must be a power of two
+ */
+template <typename NODE, unsigned SLOTS>
+class Net::Address_table
+{
+	public:
+
+		using Node    = NODE;
+		using Address = typename NODE::Address;
+
+	private:
+
+		static_assert(!(SLOTS & (SLOTS - 1)), "SLOTS must be a power of two");
+
+		enum { MASK = SLOTS - 1 };
+
+		struct Slot
+		{
+			Address  addr;
+			NODE    *node;
+		};
+
+		Slot          _slots[SLOTS];
+		unsigned      _count      { 0 };
+		unsigned long _generation { 0 };
+
+		static unsigned _home(Address const &addr)
+		{
+			/* FNV-1a */
+			Genode::uint32_t hash = 2166136261u;
+			for (unsigned i = 0; i < sizeof(addr.addr); i++)
+				hash = (hash ^ addr.addr[i]) * 16777619u;
+
+			return hash & MASK;
+		}
+
+		/**
+		 * Return whether 'i' lies cyclically within the range (from, to]
+		 */
+		static bool _within(unsigned from, unsigned i, unsigned to)
+		{
+			return from <= to ? (from < i && i <= to)
+			                  : (from < i || i <= to);
+		}
+
+	public:
+
+		Address_table() { Genode::memset(_slots, 0, sizeof(_slots)); }
+
+		/**
+		 * Counter that changes whenever the content of the table changes
+		 *
+		 * Used for invalidating lookup caches.
+		 */
+		unsigned long generation() const { return _generation; }
+
+		/**
+		 * Insert node using its current address as key
+		 *
+		 * \return false if the table is full
+		 */
+		bool insert(NODE &node)
+		{
+			if (_count == SLOTS - 1) {
+				Genode::warning("address table full, dropped ", node.addr());
+				return false;
+			}
+
+			Address const addr = node.addr();
+
+			unsigned i = _home(addr);
+			while (_slots[i].node)
+				i = (i + 1) & MASK;
+
+			_slots[i].addr = addr;
+			_slots[i].node = &node;
+			_count++;
+			_generation++;
+			return true;
+		}
+
+		/**
+		 * Remove node
+		 *
+		 * \return false if the node was not part of the table
+		 */
+		bool remove(NODE &node)
+		{
+			unsigned i = _home(node.addr());
+			for (; _slots[i].node != &node; i = (i + 1) & MASK)
+				if (!_slots[i].node)
+					return false;
+
+			/* shift back entries that would become unreachable */
+			for (unsigned j = (i + 1) & MASK; _slots[j].node; j = (j + 1) & MASK) {
+				if (_within(i, _home(_slots[j].addr), j))
+					continue;
+
+				_slots[i] = _slots[j];
+				i = j;
+			}
+
+			_slots[i].node = nullptr;
+			_count--;
+			_generation++;
+			return true;
+		}
+
+		/**
+		 * Find node by address
+		 *
+		 * \return node or nullptr if the address is unknown
+		 */
+		NODE *find(Address const &addr) const
+		{
+			for (unsigned i = _home(addr); _slots[i].node; i = (i + 1) & MASK)
+				if (_slots[i].addr == addr)
+					return _slots[i].node;
+
+			return nullptr;
+		}
+};
+
+
+/**
+ * Cache of the most recent lookup result
+ *
+ * Subsequent packets of a session tend to have the same destination.
+ * The cache avoids hashing their address again as long as the table
+ * remains unchanged.
+ */
+template <typename TABLE>
+class Net::Address_cache
+{
+	private:
+
+		using Node    = typename TABLE::Node;
+		using Address = typename TABLE::Address;
+
+		TABLE const   &_table;
+		Address        _addr       { };
+		Node          *_node       { nullptr };
+		unsigned long  _generation { ~0UL };
+
+	public:
+
+		Address_cache(TABLE const &table) : _table(table) { }
+
+		Node *find(Address const &addr)
+		{
+			if (_generation == _table.generation() && addr == _addr)
+				return _node;
+
+			_addr       = addr;
+			_node       = _table.find(addr);
+			_generation = _table.generation();
+			return _node;
+		}
+};
+
+#endif /* _ADDRESS_TABLE_H_ */
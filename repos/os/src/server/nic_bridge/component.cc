@@ -38,12 +38,8 @@ bool Session_component::handle_arp(Ethernet_frame *eth, Genode::size_t size)
 		 if (arp->src_ip() == arp->dst_ip())
 			return false;
 
-		Ipv4_address_node *node = vlan().ip_tree.first();
-		if (node)
-			node = node->find_by_address(arp->dst_ip());
-		if (!node) {
+		if (!vlan().ip_table.find(arp->dst_ip()))
 			arp->src_mac(_nic.mac());
-		}
 	}
 	return true;
 }
@@ -74,9 +70,7 @@ bool Session_component::handle_ip(Ethernet_frame *eth, Genode::size_t size)
 void Session_component::finalize_packet(Ethernet_frame *eth,
                                                     Genode::size_t size)
 {
-	Mac_address_node *node = vlan().mac_tree.first();
-	if (node)
-		node = node->find_by_address(eth->dst());
+	Mac_address_node *node = _dst_cache.find(eth->dst());
 	if (node)
 		node->component().send(eth, size);
 	else {
@@ -89,10 +83,7 @@ void Session_component::finalize_packet(Ethernet_frame *eth,
 
 void Session_component::_unset_ipv4_node()
 {
-	Ipv4_address_node * first = vlan().ip_tree.first();
-	if (!first) return;
-	if (first->find_by_address(_ipv4_node.addr()))
-		vlan().ip_tree.remove(&_ipv4_node);
+	vlan().ip_table.remove(_ipv4_node);
 }
 
 
@@ -103,7 +94,7 @@ void Session_component::set_ipv4_address(Ipv4_address ip_addr)
 {
 	_unset_ipv4_node();
 	_ipv4_node.addr(ip_addr);
-	vlan().ip_tree.insert(&_ipv4_node);
+	vlan().ip_table.insert(_ipv4_node);
 }
 
 
@@ -125,9 +116,10 @@ Session_component::Session_component(Genode::Ram_session        &ram,
   Packet_handler(ep, nic.vlan()),
   _mac_node(*this, vmac),
   _ipv4_node(*this),
-  _nic(nic)
+  _nic(nic),
+  _dst_cache(nic.vlan().mac_table)
 {
-	vlan().mac_tree.insert(&_mac_node);
+	vlan().mac_table.insert(_mac_node);
 	vlan().mac_list.insert(&_mac_node);
 
 	/* static ip parsing */
@@ -150,7 +142,7 @@ Session_component::Session_component(Genode::Ram_session        &ram,
 
 
 Session_component::~Session_component() {
-	vlan().mac_tree.remove(&_mac_node);
+	vlan().mac_table.remove(_mac_node);
 	vlan().mac_list.remove(&_mac_node);
 	_unset_ipv4_node();
 }
@@ -105,6 +105,9 @@ class Net::Session_component : public  Net::Stream_allocator,
 		Net::Nic                         &_nic;
 		Genode::Signal_context_capability _link_state_sigh;
 
+		/* fast path for consecutive packets to the same destination */
+		Address_cache<Vlan::Mac_address_table> _dst_cache;
+
 		void _unset_ipv4_node();
 
 	public:
@@ -32,9 +32,7 @@ bool Net::Nic::handle_arp(Ethernet_frame *eth, Genode::size_t size) {
 		return true;
 
 	/* look whether the IP address is one of our client's */
-	Ipv4_address_node *node = vlan().ip_tree.first();
-	if (node)
-		node = node->find_by_address(arp->dst_ip());
+	Ipv4_address_node *node = vlan().ip_table.find(arp->dst_ip());
 	if (node) {
 		if (arp->opcode() == Arp_packet::REQUEST) {
 			/*
@@ -93,9 +91,7 @@ bool Net::Nic::handle_ip(Ethernet_frame *eth, Genode::size_t size) {
 					 */
 					if (msg_type == Dhcp_packet::Message_type::ACK) {
 						Mac_address_node *node =
-							vlan().mac_tree.first();
-						if (node)
-							node = node->find_by_address(dhcp->client_mac());
+							vlan().mac_table.find(dhcp->client_mac());
 						if (node)
 							node->component().set_ipv4_address(dhcp->yiaddr());
 					}
@@ -107,17 +103,14 @@ bool Net::Nic::handle_ip(Ethernet_frame *eth, Genode::size_t size) {
 
 	/* is it an unicast message to one of our clients ? */
 	if (eth->dst() == mac()) {
-		Ipv4_address_node *node = vlan().ip_tree.first();
+		Ipv4_address_node *node = _dst_cache.find(ip->dst());
 		if (node) {
-			node = node->find_by_address(ip->dst());
-			if (node) {
-				/* overwrite destination MAC */
-				eth->dst(node->component().mac_address().addr);
-
-				/* deliver the packet to the client */
-				node->component().send(eth, size);
-				return false;
-			}
+			/* overwrite destination MAC */
+			eth->dst(node->component().mac_address().addr);
+
+			/* deliver the packet to the client */
+			node->component().send(eth, size);
+			return false;
 		}
 	}
 	return true;
@@ -128,7 +121,8 @@ Net::Nic::Nic(Genode::Env &env, Genode::Heap &heap, Net::Vlan &vlan)
 : Packet_handler(env.ep(), vlan),
   _tx_block_alloc(&heap),
   _nic(env, &_tx_block_alloc, BUF_SIZE, BUF_SIZE),
-  _mac(_nic.mac_address().addr)
+  _mac(_nic.mac_address().addr),
+  _dst_cache(vlan.ip_table)
 {
 	_nic.rx_channel()->sigh_ready_to_ack(_sink_ack);
 	_nic.rx_channel()->sigh_packet_avail(_sink_submit);
@@ -35,6 +35,9 @@ class Net::Nic : public Net::Packet_handler
 		::Nic::Connection           _nic;
 		Mac_address _mac;
 
+		/* fast path for consecutive packets to the same client */
+		Address_cache<Vlan::Ipv4_address_table> _dst_cache;
+
 	public:
 
 		Nic(Genode::Env&, Genode::Heap&, Vlan&);
@@ -67,9 +67,15 @@ void Packet_handler::broadcast_to_clients(Ethernet_frame *eth, Genode::size_t si
 		Mac_address_node *node =
 			_vlan.mac_list.first();
 		while (node) {
-			/* deliver packet */
-			node->component().send(eth, size);
+			Session_component &client = node->component();
 			node = node->next();
+
+			/* do not reflect the packet to its sender */
+			if (static_cast<Packet_handler *>(&client) == this)
+				continue;
+
+			/* deliver packet */
+			client.send(eth, size);
 		}
 	}
 }
@@ -0,0 +1,272 @@
+/*
+ * \brief  Capturing of packets to a file in pcap-ng format
+ * \author Martin Stein
+ * \date   2017-12-18
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/log.h>
+#include <cpu/atomic.h>
+#include <file_system/util.h>
+
+/* local includes */
+#include <capture.h>
+#include <interface.h>
+
+using namespace Net;
+using namespace Genode;
+
+
+/*
+ * Block types and constants of the pcap-ng format
+ */
+enum {
+	SECTION_HEADER_BLOCK        = 0x0a0d0d0a,
+	INTERFACE_DESCRIPTION_BLOCK = 0x00000001,
+	ENHANCED_PACKET_BLOCK       = 0x00000006,
+	BYTE_ORDER_MAGIC            = 0x1a2b3c4d,
+	LINKTYPE_ETHERNET           = 1,
+	OPT_ENDOFOPT                = 0,
+	OPT_IF_NAME                 = 2,
+	OPT_EPB_DROPCOUNT           = 4,
+};
+
+
+static size_t pad4(size_t size) { return align_addr(size, 2); }
+
+
+static Xml_node capture_node(Xml_node config) {
+	return config.sub_node("capture"); }
+
+
+static size_t snaplen(Xml_node config, size_t max)
+{
+	size_t const value =
+		capture_node(config).attribute_value("snaplen", (unsigned long)max);
+
+	return value && value < max ? value : max;
+}
+
+
+Capture::Capture(Env               &env,
+                 Allocator         &alloc,
+                 Timer::Connection &timer,
+                 Xml_node           config)
+:
+	_alloc(alloc), _timer(timer),
+	_filter(alloc, capture_node(config).attribute_value("filter",
+	                                                    Packet_filter::Expression())),
+	_ring(alloc,
+	      capture_node(config).attribute_value("buffer",
+	                                           Number_of_bytes(DEFAULT_BUFFER)),
+	      snaplen(config, MAX_SNAPLEN)),
+	_fs(env, _fs_packet_alloc, "capture"),
+	_file(_open(config)),
+	_ep(env, STACK_SIZE, "capture"),
+	_drain_handler(_ep, *this, &Capture::_handle_drain)
+{
+	_write_section_header();
+
+	/* the order of the descriptions defines the interface IDs */
+	_write_interface_description(
+		config.attribute_value("uplink", Interface_label()).string());
+	_write_interface_description(
+		config.attribute_value("downlink", Interface_label()).string());
+	_flush();
+}
+
+
+File_system::File_handle Capture::_open(Xml_node config)
+{
+	using File_name = String<File_system::MAX_NAME_LEN>;
+
+	File_name const path =
+		capture_node(config).attribute_value("file", File_name("nic_dump.pcapng"));
+
+	/* the file is located in the root directory of the session */
+	char const *name = path.string();
+	while (*name == '/') {
+		name++; }
+
+	try {
+		File_system::Dir_handle const dir = _fs.dir("/", false);
+		File_system::Handle_guard dir_guard(_fs, dir);
+		try {
+			return _fs.file(dir, name, File_system::WRITE_ONLY, true); }
+
+		catch (File_system::Node_already_exists) {
+			File_system::File_handle const file =
+				_fs.file(dir, name, File_system::WRITE_ONLY, false);
+
+			_fs.truncate(file, 0);
+			return file;
+		}
+	}
+	catch (...) {
+		error("failed to open capture file '", Cstring(name), "'");
+		throw Open_failed();
+	}
+}
+
+
+/******************************
+ ** Producer, the forwarding **
+ ******************************/
+
+void Capture::packet(Link link, void const *eth_base, size_t eth_size)
+{
+	if (!_filter.match(eth_base, eth_size)) {
+		return; }
+
+	uint64_t const time_us = _timer.curr_time().trunc_to_plain_us().value;
+	if (!_ring.push(time_us, link, _dropped, eth_base, eth_size)) {
+		_dropped++;
+		return;
+	}
+	_dropped = 0;
+
+	/* the atomic operation orders the flag after the ring update */
+	if (_writer_waiting && cmpxchg(&_writer_waiting, 1, 0)) {
+		Signal_transmitter(_drain_handler).submit(); }
+}
+
+
+/**************************
+ ** Consumer, the writer **
+ **************************/
+
+void Capture::_handle_drain()
+{
+	for (;;) {
+		_ring.drain([&] (Capture_ring::Record const &record) {
+			_write_packet(record); });
+
+		_flush();
+
+		/* the atomic operation orders the flag before the ring check */
+		cmpxchg(&_writer_waiting, 0, 1);
+		if (_ring.empty()) {
+			return; }
+
+		/*
+		 * Packets arrived before the flag was set. If the producer cleared
+		 * the flag meanwhile, it also submitted a signal that lets us drain
+		 * them. Otherwise, drain them right away.
+		 */
+		if (!cmpxchg(&_writer_waiting, 1, 0)) {
+			return; }
+	}
+}
+
+
+void Capture::_put(void const *src, size_t size)
+{
+	memcpy(_buf + _buf_used, src, size);
+	_buf_used += size;
+}
+
+
+void Capture::_put_padded(void const *src, size_t size)
+{
+	static char const zeros[4] { };
+	_put(src, size);
+	_put(zeros, pad4(size) - size);
+}
+
+
+void Capture::_reserve(size_t size)
+{
+	if (_buf_used + size > sizeof(_buf)) {
+		_flush(); }
+}
+
+
+void Capture::_flush()
+{
+	size_t const size = _buf_used;
+	_buf_used = 0;
+	if (!size || _failed) {
+		return; }
+
+	try {
+		if (File_system::write(_fs, _file, _buf, size, _offset) == size) {
+			_offset += size;
+			return;
+		}
+	}
+	catch (...) { }
+
+	error("failed to write capture file, stop capturing");
+	_failed = true;
+}
+
+
+void Capture::_write_section_header()
+{
+	enum { SIZE = 28 };
+
+	_reserve(SIZE);
+	_put_u32(SECTION_HEADER_BLOCK);
+	_put_u32(SIZE);
+	_put_u32(BYTE_ORDER_MAGIC);
+	_put_u16(1);              /* major version        */
+	_put_u16(0);              /* minor version        */
+	_put_u64(~(uint64_t)0);   /* unknown section size */
+	_put_u32(SIZE);
+}
+
+
+void Capture::_write_interface_description(char const *name)
+{
+	size_t const name_len = strlen(name);
+	size_t const opt_size = name_len ? 4 + pad4(name_len) + 4 : 0;
+	size_t const size     = 20 + opt_size;
+
+	_reserve(size);
+	_put_u32(INTERFACE_DESCRIPTION_BLOCK);
+	_put_u32(size);
+	_put_u16(LINKTYPE_ETHERNET);
+	_put_u16(0);
+	_put_u32(_ring.snaplen());
+	if (name_len) {
+		_put_u16(OPT_IF_NAME);
+		_put_u16(name_len);
+		_put_padded(name, name_len);
+		_put_u16(OPT_ENDOFOPT);
+		_put_u16(0);
+	}
+	_put_u32(size);
+}
+
+
+void Capture::_write_packet(Capture_ring::Record const &record)
+{
+	size_t const opt_size = record.dropped ? 4 + 8 + 4 : 0;
+	size_t const size     = 32 + pad4(record.cap_len) + opt_size;
+
+	/* the timestamp resolution defaults to microseconds */
+	_reserve(size);
+	_put_u32(ENHANCED_PACKET_BLOCK);
+	_put_u32(size);
+	_put_u32(record.link);
+	_put_u32(record.time_us >> 32);
+	_put_u32(record.time_us);
+	_put_u32(record.cap_len);
+	_put_u32(record.orig_len);
+	_put_padded(record.data(), record.cap_len);
+	if (record.dropped) {
+		_put_u16(OPT_EPB_DROPCOUNT);
+		_put_u16(8);
+		_put_u64(record.dropped);
+		_put_u16(OPT_ENDOFOPT);
+		_put_u16(0);
+	}
+	_put_u32(size);
+}
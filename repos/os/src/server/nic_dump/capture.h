@@ -0,0 +1,119 @@
+/*
+ * \brief  Capturing of packets to a file in pcap-ng format
+ * \author Martin Stein
+ * \date   2017-12-18
+ *
+ * The entrypoint that forwards the packets merely evaluates the filter and
+ * copies the selected packets into the capture ring. A dedicated thread
+ * drains the ring and writes the packets to a file-system session. Thus,
+ * forwarding never waits for the file system. If the writer falls behind,
+ * packets are dropped from the capture (not from forwarding) and the number
+ * of lost packets is recorded with the next captured packet.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _CAPTURE_H_
+#define _CAPTURE_H_
+
+/* Genode includes */
+#include <base/allocator_avl.h>
+#include <base/entrypoint.h>
+#include <file_system_session/connection.h>
+#include <nic/packet_allocator.h>
+#include <timer_session/connection.h>
+#include <util/xml_node.h>
+
+/* local includes */
+#include <capture_ring.h>
+#include <packet_filter.h>
+
+namespace Net { class Capture; }
+
+
+class Net::Capture
+{
+	public:
+
+		/**
+		 * Interface that received a packet, used as pcap-ng interface ID
+		 */
+		enum Link { UPLINK = 0, DOWNLINK = 1 };
+
+		struct Open_failed : Genode::Exception { };
+
+	private:
+
+		enum {
+			STACK_SIZE     = 8 * 1024 * sizeof(long),
+			WRITE_BUF_SIZE = 64 * 1024,
+			MAX_SNAPLEN    = Nic::Packet_allocator::DEFAULT_PACKET_SIZE,
+			DEFAULT_BUFFER = 1024 * 1024,
+		};
+
+		Genode::Allocator               &_alloc;
+		Timer::Connection               &_timer;
+		Packet_filter                    _filter;
+		Capture_ring                     _ring;
+		Genode::Allocator_avl            _fs_packet_alloc { &_alloc };
+		File_system::Connection          _fs;
+		File_system::File_handle         _file;
+		File_system::seek_off_t          _offset = 0;
+		char                             _buf[WRITE_BUF_SIZE];
+		Genode::size_t                   _buf_used = 0;
+		bool                             _failed = false;
+		unsigned                         _dropped = 0;
+		int volatile                     _writer_waiting = 1;
+		Genode::Entrypoint               _ep;
+		Genode::Signal_handler<Capture>  _drain_handler;
+
+		/*
+		 * Noncopyable
+		 */
+		Capture(Capture const &);
+		Capture &operator = (Capture const &);
+
+		File_system::File_handle _open(Genode::Xml_node config);
+
+		void _put(void const *src, Genode::size_t size);
+		void _put_u16(Genode::uint16_t value) { _put(&value, sizeof(value)); }
+		void _put_u32(Genode::uint32_t value) { _put(&value, sizeof(value)); }
+		void _put_u64(Genode::uint64_t value) { _put(&value, sizeof(value)); }
+		void _put_padded(void const *src, Genode::size_t size);
+
+		void _reserve(Genode::size_t size);
+		void _flush();
+
+		void _write_section_header();
+		void _write_interface_description(char const *name);
+		void _write_packet(Capture_ring::Record const &record);
+
+		void _handle_drain();
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \throw Packet_filter::Invalid_expression
+		 * \throw Open_failed
+		 */
+		Capture(Genode::Env       &env,
+		        Genode::Allocator &alloc,
+		        Timer::Connection &timer,
+		        Genode::Xml_node   config);
+
+		/**
+		 * Capture packet if selected by the filter
+		 *
+		 * Must be called only by the entrypoint that forwards the packets.
+		 */
+		void packet(Link link, void const *eth_base, Genode::size_t eth_size);
+};
+
+#endif /* _CAPTURE_H_ */
@@ -0,0 +1,157 @@
+/*
+ * \brief  Ring that buffers captured packets for the capture writer
+ * \author Martin Stein
+ * \date   2017-12-18
+ *
+ * The ring has exactly one producer, the entrypoint that forwards packets,
+ * and one consumer, the thread that writes the capture file. Hence, it needs
+ * no lock. All slots have the same size, which is determined by the maximum
+ * number of bytes that are captured per packet.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _CAPTURE_RING_H_
+#define _CAPTURE_RING_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <cpu/memory_barrier.h>
+#include <util/misc_math.h>
+#include <util/string.h>
+
+namespace Net { class Capture_ring; }
+
+
+class Net::Capture_ring
+{
+	public:
+
+		/**
+		 * Meta data of a captured packet
+		 */
+		struct Record
+		{
+			Genode::uint64_t time_us;   /* arrival time          */
+			Genode::uint32_t orig_len;  /* size of the packet    */
+			Genode::uint32_t cap_len;   /* number of saved bytes */
+			Genode::uint32_t dropped;   /* packets lost before   */
+			Genode::uint32_t link;      /* receiving interface   */
+
+			char const *data() const { return (char const *)(this + 1); }
+			char       *data()       { return (char *)(this + 1); }
+		};
+
+	private:
+
+		Genode::Allocator    &_alloc;
+		Genode::size_t const  _snaplen;
+		Genode::size_t const  _slot_size;
+		unsigned       const  _slots;
+		char          *const  _buf;
+
+		/* number of pushed and popped packets, wrapping at 2^32 */
+		unsigned volatile _head = 0;
+		unsigned volatile _tail = 0;
+
+		/*
+		 * Noncopyable
+		 */
+		Capture_ring(Capture_ring const &);
+		Capture_ring &operator = (Capture_ring const &);
+
+		static Genode::size_t _slot_size_for(Genode::size_t snaplen) {
+			return Genode::align_addr(sizeof(Record) + snaplen, 3); }
+
+		/**
+		 * Return the largest power of two of slots that fit into 'size'
+		 */
+		static unsigned _slots_for(Genode::size_t size, Genode::size_t slot_size)
+		{
+			unsigned slots = 2;
+			while ((Genode::size_t)slots * 2 * slot_size <= size) {
+				slots *= 2; }
+
+			return slots;
+		}
+
+		Record &_slot(unsigned idx) {
+			return *(Record *)(_buf + (idx & (_slots - 1)) * _slot_size); }
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param size     buffer size in bytes, the ring has at least two slots
+		 * \param snaplen  maximum number of bytes stored per packet
+		 */
+		Capture_ring(Genode::Allocator &alloc,
+		             Genode::size_t     size,
+		             Genode::size_t     snaplen)
+		:
+			_alloc(alloc), _snaplen(snaplen),
+			_slot_size(_slot_size_for(snaplen)),
+			_slots(_slots_for(size, _slot_size)),
+			_buf((char *)alloc.alloc(_slots * _slot_size))
+		{ }
+
+		~Capture_ring() { _alloc.free(_buf, _slots * _slot_size); }
+
+		Genode::size_t snaplen() const { return _snaplen; }
+
+		bool empty() const { return _head == _tail; }
+
+		/**
+		 * Copy packet into ring, to be called by the producer
+		 *
+		 * \return  false if the ring is full
+		 */
+		bool push(Genode::uint64_t  time_us,
+		          unsigned          link,
+		          unsigned          dropped,
+		          void const       *packet,
+		          Genode::size_t    size)
+		{
+			unsigned const head = _head;
+			if (head - _tail == _slots) {
+				return false; }
+
+			Record &record  = _slot(head);
+			record.time_us  = time_us;
+			record.orig_len = size;
+			record.cap_len  = Genode::min(size, _snaplen);
+			record.dropped  = dropped;
+			record.link     = link;
+			Genode::memcpy(record.data(), packet, record.cap_len);
+
+			/* publish the packet before advancing the head */
+			Genode::memory_barrier();
+			_head = head + 1;
+			return true;
+		}
+
+		/**
+		 * Pass all packets of the ring to 'fn', to be called by the consumer
+		 */
+		template <typename FN>
+		void drain(FN const &fn)
+		{
+			for (unsigned tail = _tail; tail != _head; ) {
+
+				Genode::memory_barrier();
+				fn((Record const &)_slot(tail));
+
+				/* finish reading before releasing the slot */
+				Genode::memory_barrier();
+				_tail = ++tail;
+			}
+		}
+};
+
+#endif /* _CAPTURE_RING_H_ */
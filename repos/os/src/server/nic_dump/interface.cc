@@ -31,18 +31,23 @@ void Interface::_handle_eth(void              *const  eth_base,
 		Interface &remote = _remote.deref();
 		Packet_log_config log_cfg;
 
-		if (_log_time) {
-			Genode::Duration const new_time    = _timer.curr_time();
-			unsigned long    const new_time_ms = new_time.trunc_to_plain_us().value / 1000;
-			unsigned long    const old_time_ms = _curr_time.trunc_to_plain_us().value / 1000;
-
-			log("\033[33m(", remote._label, " <- ", _label, ")\033[0m ",
-			    packet_log(eth, log_cfg), " \033[33mtime ", new_time_ms,
-			    " ms (Δ ", new_time_ms - old_time_ms, " ms)\033[0m");
-
-			_curr_time = new_time;
-		} else {
-			log("\033[33m(", remote._label, " <- ", _label, ")\033[0m ",  packet_log(eth, log_cfg));
+		if (_capture) {
+			_capture->packet(_capture_link, eth_base, eth_size); }
+
+		if (_log) {
+			if (_log_time) {
+				Genode::Duration const new_time    = _timer.curr_time();
+				unsigned long    const new_time_ms = new_time.trunc_to_plain_us().value / 1000;
+				unsigned long    const old_time_ms = _curr_time.trunc_to_plain_us().value / 1000;
+
+				log("\033[33m(", remote._label, " <- ", _label, ")\033[0m ",
+				    packet_log(eth, log_cfg), " \033[33mtime ", new_time_ms,
+				    " ms (Δ ", new_time_ms - old_time_ms, " ms)\033[0m");
+
+				_curr_time = new_time;
+			} else {
+				log("\033[33m(", remote._label, " <- ", _label, ")\033[0m ",  packet_log(eth, log_cfg));
+			}
 		}
 		remote._send(eth, eth_size);
 	}
@@ -98,6 +103,7 @@ Interface::Interface(Entrypoint        &ep,
                      Timer::Connection &timer,
                      Duration          &curr_time,
                      bool               log_time,
+                     bool               log,
                      Allocator         &alloc)
 :
 	_sink_ack     (ep, *this, &Interface::_ack_avail),
@@ -105,5 +111,5 @@ Interface::Interface(Entrypoint        &ep,
 	_source_ack   (ep, *this, &Interface::_ready_to_ack),
 	_source_submit(ep, *this, &Interface::_packet_avail),
 	_alloc(alloc), _label(label), _timer(timer), _curr_time(curr_time),
-	_log_time(log_time)
+	_log_time(log_time), _log(log)
 { }
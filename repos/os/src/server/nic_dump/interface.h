@@ -15,6 +15,7 @@
 #define _INTERFACE_H_
 
 /* local includes */
+#include <capture.h>
 #include <pointer.h>
 
 /* Genode includes */
@@ -52,6 +53,9 @@ class Net::Interface
 		Timer::Connection  &_timer;
 		Genode::Duration   &_curr_time;
 		bool                _log_time;
+		bool                _log;
+		Capture            *_capture = nullptr;
+		Capture::Link       _capture_link = Capture::UPLINK;
 
 		void _send(Ethernet_frame &eth, Genode::size_t const eth_size);
 
@@ -80,9 +84,19 @@ class Net::Interface
 		          Timer::Connection  &timer,
 		          Genode::Duration   &curr_time,
 		          bool                log_time,
+		          bool                log,
 		          Genode::Allocator  &alloc);
 
 		void remote(Interface &remote) { _remote.set(remote); }
+
+		/**
+		 * Pass each packet received at this interface to 'capture'
+		 */
+		void capture(Capture &capture, Capture::Link link)
+		{
+			_capture      = &capture;
+			_capture_link = link;
+		}
 };
 
 #endif /* _INTERFACE_H_ */
@@ -15,6 +15,7 @@
 #include <base/component.h>
 #include <base/heap.h>
 #include <base/attached_rom_dataspace.h>
+#include <base/log.h>
 #include <timer_session/connection.h>
 
 /* local includes */
@@ -32,8 +33,11 @@ class Main
 		Timer::Connection      _timer;
 		Duration               _curr_time { Microseconds(0UL) };
 		Heap                   _heap;
+		Capture               *_capture;
 		Net::Root              _root;
 
+		Capture *_init_capture(Env &env);
+
 	public:
 
 		Main(Env &env);
@@ -43,12 +47,30 @@ class Main
 Main::Main(Env &env)
 :
 	_config(env, "config"), _timer(env), _heap(&env.ram(), &env.rm()),
-	_root(env, _heap, _config.xml(), _timer, _curr_time)
+	_capture(_init_capture(env)),
+	_root(env, _heap, _config.xml(), _timer, _curr_time, _capture)
 {
 	env.parent().announce(env.ep().manage(_root));
 }
 
 
+Capture *Main::_init_capture(Env &env)
+{
+	if (!_config.xml().has_sub_node("capture")) {
+		return nullptr; }
+
+	try { return new (_heap) Capture(env, _heap, _timer, _config.xml()); }
+	catch (Packet_filter::Invalid_expression) {
+		error("invalid capture filter, capturing disabled"); }
+	catch (Capture::Open_failed) {
+		error("capturing disabled"); }
+	catch (...) {
+		error("failed to initialize capture, capturing disabled"); }
+
+	return nullptr;
+}
+
+
 void Component::construct(Env &env)
 {
 	/* XXX execute constructors of global statics */
@@ -0,0 +1,462 @@
+/*
+ * \brief  Filter expression that selects the packets to capture
+ * \author Martin Stein
+ * \date   2017-12-18
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <net/ipv4.h>
+
+/* local includes */
+#include <packet_filter.h>
+
+using namespace Net;
+using namespace Genode;
+
+
+/***********
+ ** Frame **
+ ***********/
+
+class Net::Packet_filter::Frame
+{
+	private:
+
+		enum {
+			ETH_HDR_SIZE   = 14,
+			ARP_SIZE       = 28,
+			IPV4_HDR_SIZE  = 20,
+			ETH_TYPE_IPV4  = 0x0800,
+			ETH_TYPE_ARP   = 0x0806,
+		};
+
+		static uint16_t _be16(uint8_t const *p) {
+			return (uint16_t)(p[0] << 8 | p[1]); }
+
+		static uint32_t _be32(uint8_t const *p) {
+			return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]; }
+
+	public:
+
+		enum { PROTO_ICMP = 1, PROTO_TCP = 6, PROTO_UDP = 17 };
+
+		bool     arp      = false;
+		bool     ipv4     = false;
+		bool     has_addr = false;
+		bool     has_port = false;
+		uint8_t  protocol = 0;
+		uint32_t src_ip   = 0;
+		uint32_t dst_ip   = 0;
+		uint16_t src_port = 0;
+		uint16_t dst_port = 0;
+
+		Frame(void const *base, size_t size)
+		{
+			uint8_t const *const eth = (uint8_t const *)base;
+			if (size < ETH_HDR_SIZE) {
+				return; }
+
+			uint8_t const *const l3      = eth + ETH_HDR_SIZE;
+			size_t         const l3_size = size - ETH_HDR_SIZE;
+			switch (_be16(eth + 12)) {
+			case ETH_TYPE_ARP:
+
+				if (l3_size < ARP_SIZE) {
+					return; }
+
+				arp      = true;
+				has_addr = true;
+				src_ip   = _be32(l3 + 14);
+				dst_ip   = _be32(l3 + 24);
+				return;
+
+			case ETH_TYPE_IPV4:
+			{
+				if (l3_size < IPV4_HDR_SIZE || (l3[0] >> 4) != 4) {
+					return; }
+
+				size_t const ihl = (l3[0] & 0xf) * 4;
+				if (ihl < IPV4_HDR_SIZE) {
+					return; }
+
+				ipv4     = true;
+				has_addr = true;
+				protocol = l3[9];
+				src_ip   = _be32(l3 + 12);
+				dst_ip   = _be32(l3 + 16);
+
+				/* only the first fragment carries the ports */
+				bool const first_fragment = !(_be16(l3 + 6) & 0x1fff);
+				bool const with_ports = protocol == PROTO_TCP ||
+				                        protocol == PROTO_UDP;
+
+				if (!first_fragment || !with_ports || l3_size < ihl + 4) {
+					return; }
+
+				has_port = true;
+				src_port = _be16(l3 + ihl);
+				dst_port = _be16(l3 + ihl + 2);
+				return;
+			}
+			default: return;
+			}
+		}
+};
+
+
+/***********
+ ** Nodes **
+ ***********/
+
+namespace {
+
+	using Node  = Packet_filter::Node;
+	using Frame = Packet_filter::Frame;
+
+	enum Direction { SRC, DST, SRC_OR_DST };
+
+	struct Protocol_node : Node
+	{
+		enum Protocol { ARP, IP, ICMP, TCP, UDP };
+
+		Protocol const protocol;
+
+		Protocol_node(Protocol protocol) : protocol(protocol) { }
+
+		bool match(Frame const &frame) const override
+		{
+			switch (protocol) {
+			case ARP:  return frame.arp;
+			case IP:   return frame.ipv4;
+			case ICMP: return frame.ipv4 && frame.protocol == Frame::PROTO_ICMP;
+			case TCP:  return frame.ipv4 && frame.protocol == Frame::PROTO_TCP;
+			case UDP:  return frame.ipv4 && frame.protocol == Frame::PROTO_UDP;
+			}
+			return false;
+		}
+	};
+
+	struct Address_node : Node
+	{
+		Direction const direction;
+		uint32_t  const address;
+		uint32_t  const mask;
+
+		Address_node(Direction direction, uint32_t address, uint32_t mask)
+		: direction(direction), address(address & mask), mask(mask) { }
+
+		bool match(Frame const &frame) const override
+		{
+			if (!frame.has_addr) {
+				return false; }
+
+			bool const src = (frame.src_ip & mask) == address;
+			bool const dst = (frame.dst_ip & mask) == address;
+			switch (direction) {
+			case SRC:        return src;
+			case DST:        return dst;
+			case SRC_OR_DST: return src || dst;
+			}
+			return false;
+		}
+	};
+
+	struct Port_node : Node
+	{
+		Direction const direction;
+		uint16_t  const port;
+
+		Port_node(Direction direction, uint16_t port)
+		: direction(direction), port(port) { }
+
+		bool match(Frame const &frame) const override
+		{
+			if (!frame.has_port) {
+				return false; }
+
+			bool const src = frame.src_port == port;
+			bool const dst = frame.dst_port == port;
+			switch (direction) {
+			case SRC:        return src;
+			case DST:        return dst;
+			case SRC_OR_DST: return src || dst;
+			}
+			return false;
+		}
+	};
+
+	struct Not_node : Node
+	{
+		Allocator &alloc;
+		Node      &operand;
+
+		Not_node(Allocator &alloc, Node &operand)
+		: alloc(alloc), operand(operand) { }
+
+		~Not_node() { destroy(alloc, &operand); }
+
+		bool match(Frame const &frame) const override {
+			return !operand.match(frame); }
+	};
+
+	struct Binary_node : Node
+	{
+		enum Operator { AND, OR };
+
+		Allocator      &alloc;
+		Operator const  op;
+		Node           &left;
+		Node           &right;
+
+		Binary_node(Allocator &alloc, Operator op, Node &left, Node &right)
+		: alloc(alloc), op(op), left(left), right(right) { }
+
+		~Binary_node()
+		{
+			destroy(alloc, &left);
+			destroy(alloc, &right);
+		}
+
+		bool match(Frame const &frame) const override
+		{
+			if (op == AND) {
+				return left.match(frame) && right.match(frame); }
+
+			return left.match(frame) || right.match(frame);
+		}
+	};
+}
+
+
+/************
+ ** Parser **
+ ************/
+
+class Net::Packet_filter::Parser
+{
+	private:
+
+		using Token = String<32>;
+
+		Allocator  &_alloc;
+		char const *_pos;
+		Token       _token { };
+
+		static bool _delimiter(char c)
+		{
+			return c == 0 || c == ' ' || c == '\t' || c == '\n' ||
+			       c == '(' || c == ')' || c == '!' || c == '&' || c == '|';
+		}
+
+		/**
+		 * Read the next token into '_token', an empty token marks the end
+		 */
+		void _next()
+		{
+			while (*_pos == ' ' || *_pos == '\t' || *_pos == '\n') {
+				_pos++; }
+
+			char const *const start = _pos;
+			if (*_pos == '(' || *_pos == ')' || *_pos == '!') {
+				_pos++;
+
+			} else if (*_pos == '&' || *_pos == '|') {
+				if (_pos[1] != _pos[0]) {
+					throw Invalid_expression(); }
+
+				_pos += 2;
+
+			} else {
+				while (!_delimiter(*_pos)) {
+					_pos++; }
+			}
+			size_t const len = _pos - start;
+			if (len >= Token::capacity()) {
+				throw Invalid_expression(); }
+
+			_token = Token(Cstring(start, len));
+		}
+
+		bool _accept(char const *token)
+		{
+			if (_token != token) {
+				return false; }
+
+			_next();
+			return true;
+		}
+
+		void _expect(char const *token)
+		{
+			if (!_accept(token)) {
+				throw Invalid_expression(); }
+		}
+
+		/**
+		 * Convert the current token to a number and advance
+		 */
+		unsigned long _number(unsigned long max)
+		{
+			unsigned long value = 0;
+			size_t const len = ascii_to_unsigned(_token.string(), value, 10);
+			if (!len || len != _token.length() - 1 || value > max) {
+				throw Invalid_expression(); }
+
+			_next();
+			return value;
+		}
+
+		/**
+		 * Convert the current token to an address and prefix mask and advance
+		 */
+		void _address(uint32_t &address, uint32_t &mask, bool with_prefix)
+		{
+			char const *const str = _token.string();
+			Ipv4_address ip;
+			size_t len = Genode::ascii_to(str, ip);
+			if (!len) {
+				throw Invalid_expression(); }
+
+			unsigned long prefix = 32;
+			if (with_prefix && str[len] == '/') {
+				size_t const prefix_len =
+					ascii_to_unsigned(str + len + 1, prefix, 10);
+
+				if (!prefix_len || prefix > 32) {
+					throw Invalid_expression(); }
+
+				len += prefix_len + 1;
+			}
+			if (len != _token.length() - 1) {
+				throw Invalid_expression(); }
+
+			address = (uint32_t)ip.addr[0] << 24 | ip.addr[1] << 16 |
+			          ip.addr[2] << 8 | ip.addr[3];
+			mask    = prefix ? ~(uint32_t)0 << (32 - prefix) : 0;
+			_next();
+		}
+
+		Node &_primitive()
+		{
+			if (_accept("arp"))  { return *new (_alloc) Protocol_node(Protocol_node::ARP); }
+			if (_accept("ip"))   { return *new (_alloc) Protocol_node(Protocol_node::IP); }
+			if (_accept("icmp")) { return *new (_alloc) Protocol_node(Protocol_node::ICMP); }
+			if (_accept("tcp"))  { return *new (_alloc) Protocol_node(Protocol_node::TCP); }
+			if (_accept("udp"))  { return *new (_alloc) Protocol_node(Protocol_node::UDP); }
+
+			Direction direction = SRC_OR_DST;
+			if      (_accept("src")) { direction = SRC; }
+			else if (_accept("dst")) { direction = DST; }
+
+			uint32_t address = 0;
+			uint32_t mask    = 0;
+			if (_accept("host")) {
+				_address(address, mask, false);
+				return *new (_alloc) Address_node(direction, address, mask);
+			}
+			if (_accept("net")) {
+				_address(address, mask, true);
+				return *new (_alloc) Address_node(direction, address, mask);
+			}
+			if (_accept("port")) {
+				uint16_t const port = (uint16_t)_number(0xffff);
+				return *new (_alloc) Port_node(direction, port);
+			}
+			throw Invalid_expression();
+		}
+
+		Node &_factor()
+		{
+			if (_accept("not") || _accept("!")) {
+				return *new (_alloc) Not_node(_alloc, _factor()); }
+
+			if (_accept("(")) {
+				Node &node = _expr();
+				try { _expect(")"); }
+				catch (...) {
+					destroy(_alloc, &node);
+					throw;
+				}
+				return node;
+			}
+			return _primitive();
+		}
+
+		template <typename OPERAND_FN>
+		Node &_binary(Binary_node::Operator op, char const *word,
+		              char const *symbol, OPERAND_FN const &operand_fn)
+		{
+			Node *left = &operand_fn();
+			while (_accept(word) || _accept(symbol)) {
+				try {
+					Node &right = operand_fn();
+					left = new (_alloc) Binary_node(_alloc, op, *left, right);
+				}
+				catch (...) {
+					destroy(_alloc, left);
+					throw;
+				}
+			}
+			return *left;
+		}
+
+		Node &_term() {
+			return _binary(Binary_node::AND, "and", "&&", [&] () -> Node & { return _factor(); }); }
+
+		Node &_expr() {
+			return _binary(Binary_node::OR, "or", "||", [&] () -> Node & { return _term(); }); }
+
+	public:
+
+		Parser(Allocator &alloc, char const *expression)
+		: _alloc(alloc), _pos(expression) { _next(); }
+
+		/**
+		 * Return the root of the compiled expression or nullptr if empty
+		 */
+		Node *parse()
+		{
+			if (_token == "") {
+				return nullptr; }
+
+			Node &root = _expr();
+			if (_token != "") {
+				destroy(_alloc, &root);
+				throw Invalid_expression();
+			}
+			return &root;
+		}
+};
+
+
+/*******************
+ ** Packet_filter **
+ *******************/
+
+Packet_filter::Packet_filter(Allocator &alloc, Expression const &expression)
+:
+	_alloc(alloc), _root(Parser(alloc, expression.string()).parse())
+{ }
+
+
+Packet_filter::~Packet_filter()
+{
+	if (_root) {
+		destroy(_alloc, _root); }
+}
+
+
+bool Packet_filter::match(void const *eth_base, size_t eth_size) const
+{
+	if (!_root) {
+		return true; }
+
+	return _root->match(Frame(eth_base, eth_size));
+}
@@ -0,0 +1,95 @@
+/*
+ * \brief  Filter expression that selects the packets to capture
+ * \author Martin Stein
+ * \date   2017-12-18
+ *
+ * The syntax is a subset of the one of tcpdump:
+ *
+ * ! expr      := term { ("or" | "||") term }
+ * ! term      := factor { ("and" | "&&") factor }
+ * ! factor    := ("not" | "!") factor | "(" expr ")" | primitive
+ * ! primitive := "arp" | "ip" | "icmp" | "tcp" | "udp"
+ * !            | [ "src" | "dst" ] "host" A.B.C.D
+ * !            | [ "src" | "dst" ] "net"  A.B.C.D/N
+ * !            | [ "src" | "dst" ] "port" N
+ *
+ * An expression is compiled once into a tree of nodes that is evaluated
+ * directly on the raw Ethernet frame. Thus, a rejected packet costs neither
+ * a copy nor the construction of protocol objects.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _PACKET_FILTER_H_
+#define _PACKET_FILTER_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <base/exception.h>
+#include <util/string.h>
+
+namespace Net { class Packet_filter; }
+
+
+class Net::Packet_filter
+{
+	public:
+
+		struct Invalid_expression : Genode::Exception { };
+
+		using Expression = Genode::String<256>;
+
+		/**
+		 * View on the headers of a raw Ethernet frame
+		 */
+		class Frame;
+
+		/**
+		 * Node of the compiled expression
+		 */
+		struct Node
+		{
+			virtual bool match(Frame const &frame) const = 0;
+
+			virtual ~Node() { }
+		};
+
+	private:
+
+		class Parser;
+
+		Genode::Allocator &_alloc;
+		Node              *_root;
+
+		/*
+		 * Noncopyable
+		 */
+		Packet_filter(Packet_filter const &);
+		Packet_filter &operator = (Packet_filter const &);
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param expression  filter expression, an empty expression
+		 *                    matches all packets
+		 *
+		 * \throw Invalid_expression
+		 */
+		Packet_filter(Genode::Allocator &alloc, Expression const &expression);
+
+		~Packet_filter();
+
+		/**
+		 * Return whether the filter selects the given Ethernet frame
+		 */
+		bool match(void const *eth_base, Genode::size_t eth_size) const;
+};
+
+#endif /* _PACKET_FILTER_H_ */
@@ -31,7 +31,9 @@ Net::Uplink::Uplink(Env               &env,
 	Nic::Packet_allocator(&alloc),
 	Nic::Connection(env, this, BUF_SIZE, BUF_SIZE),
 	Interface(env.ep(), config.attribute_value("uplink", Interface_label()),
-	          timer, curr_time, config.attribute_value("time", false), alloc)
+	          timer, curr_time, config.attribute_value("time", false),
+	          config.attribute_value("log", !config.has_sub_node("capture")),
+	          alloc)
 {
 	rx_channel()->sigh_ready_to_ack(_sink_ack);
 	rx_channel()->sigh_packet_avail(_sink_submit);
@@ -44,14 +44,16 @@ class Nic_loopback::Session_component : public Nic::Session_component
 		 * \param ram_session        RAM session to allocate tx and rx buffers
 		 * \param ep                 entry point used for packet stream
 		 *                           channels
+		 * \param queues             number of queue pairs
 		 */
 		Session_component(size_t const tx_buf_size,
 		                  size_t const rx_buf_size,
 		                  Allocator   &rx_block_md_alloc,
-		                  Env         &env)
+		                  Env         &env,
+		                  unsigned     queues)
 		:
 			Nic::Session_component(tx_buf_size, rx_buf_size, rx_block_md_alloc,
-			                       env)
+			                       env, queues)
 		{ }
 
 		Nic::Mac_address mac_address() override
@@ -67,74 +69,100 @@ class Nic_loopback::Session_component : public Nic::Session_component
 			return true;
 		}
 
+		bool _echo(unsigned queue);
+
 		void _handle_packet_stream() override;
 };
 
 
-void Nic_loopback::Session_component::_handle_packet_stream()
+/**
+ * Echo one packet sent via the given queue
+ *
+ * The echoed packet is received via the queue selected by the flow
+ * steering of the session.
+ *
+ * \return true if a packet was processed
+ */
+bool Nic_loopback::Session_component::_echo(unsigned queue)
 {
 	size_t const alloc_size = Nic::Packet_allocator::DEFAULT_PACKET_SIZE;
 
-	/* loop while we can make progress */
-	for (;;) {
+	Session::Tx::Sink &tx = *_queue_tx(queue).sink();
+
+	/*
+	 * If the client cannot accept new acknowledgements for a sent packets,
+	 * we won't consume the sent packet.
+	 */
+	if (!tx.ready_to_ack())
+		return false;
+
+	/*
+	 * Nothing to be done if the client has not sent any packets.
+	 */
+	if (!tx.packet_avail())
+		return false;
+
+	/*
+	 * Here we know that the client has submitted a packet to us and is also
+	 * able it receive the corresponding acknowledgement.
+	 */
+
+	Packet_descriptor const packet_from_client = tx.peek_packet();
+	if (!packet_from_client.size() || !tx.packet_valid(packet_from_client)) {
+		warning("received invalid packet");
+		tx.acknowledge_packet(tx.get_packet());
+		return true;
+	}
 
-		/* flush acknowledgements for the echoes packets */
-		while (_rx.source()->ack_avail())
-			_rx.source()->release_packet(_rx.source()->get_acked_packet());
+	char const * const content = tx.packet_content(packet_from_client);
 
-		/*
-		 * If the client cannot accept new acknowledgements for a sent packets,
-		 * we won't consume the sent packet.
-		 */
-		if (!_tx.sink()->ready_to_ack())
-			return;
-
-		/*
-		 * Nothing to be done if the client has not sent any packets.
-		 */
-		if (!_tx.sink()->packet_avail())
-			return;
+	Session::Rx::Source &rx =
+		*_queue_rx(_steer(content, packet_from_client.size())).source();
 
-		/*
-		 * Here we know that the client has submitted a packet to us and is also
-		 * able it receive the corresponding acknowledgement.
-		 */
+	/*
+	 * The client fails to pick up the packets from the rx channel. So we
+	 * won't try to submit new packets.
+	 */
+	if (!rx.ready_to_submit())
+		return false;
 
-		/*
-		 * The client fails to pick up the packets from the rx channel. So we
-		 * won't try to submit new packets.
-		 */
-		if (!_rx.source()->ready_to_submit())
-			return;
+	/*
+	 * We are safe to process one packet without blocking.
+	 */
 
-		/*
-		 * We are safe to process one packet without blocking.
-		 */
+	Packet_descriptor packet_to_client;
+	try {
+		packet_to_client = rx.alloc_packet(alloc_size); }
+	catch (Session::Rx::Source::Packet_alloc_failed) {
+		return false; }
 
+	memcpy(rx.packet_content(packet_to_client), content,
+	       packet_from_client.size());
 
-		Packet_descriptor packet_to_client;
-		try {
-			packet_to_client = _rx.source()->alloc_packet(alloc_size); }
-		catch (Session::Rx::Source::Packet_alloc_failed) {
-			continue; }
+	packet_to_client = Packet_descriptor(packet_to_client.offset(),
+	                                     packet_from_client.size());
+	rx.submit_packet(packet_to_client);
 
-		/* obtain packet */
-		Packet_descriptor const packet_from_client = _tx.sink()->get_packet();
-		if (!packet_from_client.size()) {
-			warning("received zero-size packet");
-			_rx.source()->release_packet(packet_to_client);
-			continue;
-		}
+	tx.acknowledge_packet(tx.get_packet());
+	return true;
+}
 
-		memcpy(_rx.source()->packet_content(packet_to_client),
-		       _tx.sink()->packet_content(packet_from_client),
-		       packet_from_client.size());
 
-		packet_to_client = Packet_descriptor(packet_to_client.offset(),
-		                                     packet_from_client.size());
-		_rx.source()->submit_packet(packet_to_client);
+void Nic_loopback::Session_component::_handle_packet_stream()
+{
+	/* flush acknowledgements for the echoes packets */
+	for (unsigned i = 0; i < _num_queues; i++) {
+		Session::Rx::Source &rx = *_queue_rx(i).source();
+		while (rx.ack_avail())
+			rx.release_packet(rx.get_acked_packet());
+	}
 
-		_tx.sink()->acknowledge_packet(packet_from_client);
+	/* loop while we can make progress */
+	for (bool progress = true; progress; ) {
+		progress = false;
+		for (unsigned i = 0; i < _num_queues; i++)
+			while (_echo(i))
+				progress = true;
 	}
 }
 
@@ -152,6 +180,9 @@ class Nic_loopback::Root : public Root_component<Session_component>
 			size_t ram_quota   = Arg_string::find_arg(args, "ram_quota"  ).ulong_value(0);
 			size_t tx_buf_size = Arg_string::find_arg(args, "tx_buf_size").ulong_value(0);
 			size_t rx_buf_size = Arg_string::find_arg(args, "rx_buf_size").ulong_value(0);
+			unsigned queues    = Arg_string::find_arg(args, "queues"     ).ulong_value(1);
+
+			queues = max(1U, min(queues, (unsigned)Nic::Session::MAX_QUEUES));
 
 			/* deplete ram quota by the memory needed for the session structure */
 			size_t session_size = max(4096UL, (size_t)sizeof(Session_component));
@@ -159,18 +190,19 @@ class Nic_loopback::Root : public Root_component<Session_component>
 				throw Insufficient_ram_quota();
 
 			/*
-			 * Check if donated ram quota suffices for both communication
-			 * buffers and check for overflow
+			 * Check if donated ram quota suffices for the communication
+			 * buffers of all queues and check for overflow
 			 */
-			if (tx_buf_size + rx_buf_size < tx_buf_size ||
-			    tx_buf_size + rx_buf_size > ram_quota - session_size) {
+			size_t const queue_size = tx_buf_size + rx_buf_size;
+			if (queue_size < tx_buf_size ||
+			    queue_size > (ram_quota - session_size) / queues) {
 				error("insufficient 'ram_quota', got ", ram_quota, ", "
-				      "need ", tx_buf_size + rx_buf_size + session_size);
+				      "need ", queue_size*queues + session_size);
 				throw Insufficient_ram_quota();
 			}
 
 			return new (md_alloc()) Session_component(tx_buf_size, rx_buf_size,
-			                                          *md_alloc(), _env);
+			                                          *md_alloc(), _env, queues);
 		}
 
 	public:
@@ -35,5 +35,13 @@ Arp_waiter::Arp_waiter(Interface               &src,
 Arp_waiter::~Arp_waiter()
 {
 	_src.own_arp_waiters().remove(&_src_le);
+	if (!_resolved) {
+		_dst.foreign_arp_waiters().remove(&_dst_le); }
+}
+
+
+void Arp_waiter::resolve()
+{
 	_dst.foreign_arp_waiters().remove(&_dst_le);
+	_resolved = true;
 }
@@ -39,6 +39,7 @@ class Net::Arp_waiter
 		Interface               &_dst;
 		Ipv4_address      const  _ip;
 		Packet_descriptor const  _packet;
+		bool                     _resolved = false;
 
 	public:
 
@@ -49,14 +50,23 @@ class Net::Arp_waiter
 
 		~Arp_waiter();
 
+		/**
+		 * Detach from the destination interface
+		 *
+		 * The waiter stays at its source interface, which continues the
+		 * handling of the packet by its own entrypoint.
+		 */
+		void resolve();
+
 
 		/***************
 		 ** Accessors **
 		 ***************/
 
-		Interface               &src()    const { return _src; }
-		Ipv4_address      const &ip()     const { return _ip; }
-		Packet_descriptor const &packet() const { return _packet; }
+		Interface               &src()      const { return _src; }
+		Ipv4_address      const &ip()       const { return _ip; }
+		Packet_descriptor const &packet()   const { return _packet; }
+		bool                     resolved() const { return _resolved; }
 };
 
 #endif /* _ARP_WAITER_H_ */
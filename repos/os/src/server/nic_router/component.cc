@@ -117,12 +117,16 @@ Session_component *Net::Root::_create_session(char const *args)
 		size_t const session_size =
 			max((size_t)4096, sizeof(Session_component));
 
-		if (ram_quota < session_size) {
+		size_t const handoff_size =
+			Interface::handoff_rings_size(_config.workers(), *md_alloc());
+
+		if (ram_quota < session_size + handoff_size) {
 			throw Insufficient_ram_quota(); }
 
-		if (tx_buf_size               > ram_quota - session_size ||
-		    rx_buf_size               > ram_quota - session_size ||
-		    tx_buf_size + rx_buf_size > ram_quota - session_size)
+		size_t const avail = ram_quota - session_size - handoff_size;
+		if (tx_buf_size               > avail ||
+		    rx_buf_size               > avail ||
+		    tx_buf_size + rx_buf_size > avail)
 		{
 			error("insufficient 'ram_quota' for session creation");
 			throw Insufficient_ram_quota();
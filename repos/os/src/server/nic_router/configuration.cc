@@ -36,14 +36,20 @@ Microseconds Configuration::_init_rtt(Xml_node const node)
 
 
 Configuration::Configuration(Xml_node const  node,
-                             Allocator      &alloc)
+                             Allocator      &alloc,
+                             Worker_pool    &workers)
 :
 	_alloc(alloc), _verbose(node.attribute_value("verbose", false)),
-	_rtt(_init_rtt(node)), _node(node)
+	_rtt(_init_rtt(node)), _workers(workers), _node(node)
 {
-	/* read domains */
+	/* read domains and distribute them over the workers in order */
 	node.for_each_sub_node("domain", [&] (Xml_node const node) {
-		try { _domains.insert(*new (_alloc) Domain(*this, node, _alloc)); }
+		try {
+			Domain &domain = *new (_alloc)
+				Domain(*this, node, _alloc, _workers.assign());
+
+			_domains.insert(domain);
+		}
 		catch (Domain::Invalid) { warning("invalid domain"); }
 	});
 	/* as they must resolve domain names, create rules after domains */
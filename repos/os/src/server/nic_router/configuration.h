@@ -16,6 +16,7 @@
 
 /* local includes */
 #include <domain.h>
+#include <worker.h>
 
 /* Genode includes */
 #include <os/duration.h>
@@ -32,6 +33,7 @@ class Net::Configuration
 		Genode::Allocator          &_alloc;
 		bool                 const  _verbose;
 		Genode::Microseconds const  _rtt;
+		Worker_pool                &_workers;
 		Domain_tree                 _domains;
 		Genode::Xml_node     const  _node;
 
@@ -41,7 +43,9 @@ class Net::Configuration
 
 		enum { DEFAULT_RTT_SEC = 6 };
 
-		Configuration(Genode::Xml_node const node, Genode::Allocator &alloc);
+		Configuration(Genode::Xml_node const  node,
+		              Genode::Allocator      &alloc,
+		              Worker_pool            &workers);
 
 
 		/***************
@@ -51,6 +55,7 @@ class Net::Configuration
 		bool                  verbose() const { return _verbose; }
 		Genode::Microseconds  rtt()     const { return _rtt; }
 		Domain_tree          &domains()       { return _domains; }
+		Worker_pool          &workers()       { return _workers; }
 		Genode::Xml_node      node()    const { return _node; }
 };
 
@@ -0,0 +1,73 @@
+/*
+ * \brief  Timeout that is handled by the initial entrypoint
+ * \author Martin Stein
+ * \date   2017-12-14
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* local includes */
+#include <deferred_timeout.h>
+
+using namespace Net;
+using namespace Genode;
+
+
+/*
+ * The queue lock is never held while acquiring another lock. So, it can be
+ * taken by timeout handlers as well as by threads that hold the routing lock.
+ */
+static Lock                        _queue_lock;
+static List<Deferred_timeout_base> _queue;
+static Signal_context_capability   _sigh;
+
+
+void Net::deferred_timeouts_sigh(Signal_context_capability sigh) { _sigh = sigh; }
+
+
+void Net::handle_deferred_timeouts()
+{
+	for (;;) {
+		Deferred_timeout_base *timeout;
+		{
+			Lock::Guard guard(_queue_lock);
+			timeout = _queue.first();
+			if (!timeout) {
+				return; }
+
+			_queue.remove(timeout);
+			timeout->_queued = false;
+		}
+		timeout->_handle();
+	}
+}
+
+
+void Deferred_timeout_base::_enqueue()
+{
+	{
+		Lock::Guard guard(_queue_lock);
+		if (_queued) {
+			return; }
+
+		_queue.insert(this);
+		_queued = true;
+	}
+	Signal_transmitter(_sigh).submit();
+}
+
+
+void Deferred_timeout_base::_dequeue()
+{
+	Lock::Guard guard(_queue_lock);
+	if (!_queued) {
+		return; }
+
+	_queue.remove(this);
+	_queued = false;
+}
@@ -0,0 +1,121 @@
+/*
+ * \brief  Timeout that is handled by the initial entrypoint
+ * \author Martin Stein
+ * \date   2017-12-14
+ *
+ * The timeout framework may call a timeout handler from within any thread
+ * that schedules a timeout. Furthermore, destructing a timeout blocks while
+ * its handler is executed. Thus, a handler that acquires the routing lock
+ * could deadlock with a thread that holds the routing lock while scheduling
+ * or destructing a timeout. The handler of a deferred timeout therefore
+ * merely queues the timeout. The initial entrypoint calls the actual
+ * handlers of all queued timeouts with the routing lock held.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _DEFERRED_TIMEOUT_H_
+#define _DEFERRED_TIMEOUT_H_
+
+/* Genode includes */
+#include <timer_session/connection.h>
+#include <util/list.h>
+
+namespace Net {
+
+	class Deferred_timeout_base;
+	template <typename> class Deferred_timeout;
+
+	/**
+	 * Register signal handler that calls 'handle_deferred_timeouts'
+	 */
+	void deferred_timeouts_sigh(Genode::Signal_context_capability sigh);
+
+	/**
+	 * Call the handlers of all queued timeouts
+	 *
+	 * Must be called by the initial entrypoint with the routing lock held.
+	 */
+	void handle_deferred_timeouts();
+}
+
+
+class Net::Deferred_timeout_base : public Genode::List<Deferred_timeout_base>::Element
+{
+	friend void Net::handle_deferred_timeouts();
+
+	private:
+
+		bool _queued = false;
+
+		virtual void _handle() = 0;
+
+	protected:
+
+		/**
+		 * Queue timeout and notify the initial entrypoint
+		 */
+		void _enqueue();
+
+		/**
+		 * Revoke queued timeout
+		 */
+		void _dequeue();
+
+		virtual ~Deferred_timeout_base() { }
+};
+
+
+template <typename HANDLER>
+class Net::Deferred_timeout : private Deferred_timeout_base
+{
+	private:
+
+		typedef void (HANDLER::*Handler_method)();
+
+		HANDLER                                   &_object;
+		Handler_method                      const  _method;
+		Timer::One_shot_timeout<Deferred_timeout>  _timeout;
+
+		void _handle_timeout(Genode::Duration) { _enqueue(); }
+
+
+		/***************************
+		 ** Deferred_timeout_base **
+		 ***************************/
+
+		void _handle() override { (_object.*_method)(); }
+
+	public:
+
+		Deferred_timeout(Timer::Connection &timer,
+		                 HANDLER           &object,
+		                 Handler_method     method)
+		:
+			_object(object), _method(method),
+			_timeout(timer, *this, &Deferred_timeout::_handle_timeout)
+		{ }
+
+		~Deferred_timeout()
+		{
+			/* wait for a running handler before revoking its outcome */
+			_timeout.discard();
+			_dequeue();
+		}
+
+		/**
+		 * (Re-)schedule timeout, revokes a not yet handled expiration
+		 */
+		void schedule(Genode::Microseconds duration)
+		{
+			_dequeue();
+			_timeout.schedule(duration);
+		}
+};
+
+#endif /* _DEFERRED_TIMEOUT_H_ */
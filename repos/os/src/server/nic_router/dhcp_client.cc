@@ -75,7 +75,7 @@ Microseconds Dhcp_client::_rerequest_timeout(unsigned lease_time_div_log2)
 }
 
 
-void Dhcp_client::_handle_timeout(Duration)
+void Dhcp_client::_handle_timeout()
 {
 	switch (_state) {
 	case State::BOUND:  _rerequest(State::RENEW);  break;
@@ -18,6 +18,9 @@
 #include <timer_session/connection.h>
 #include <net/dhcp.h>
 
+/* local includes */
+#include <deferred_timeout.h>
+
 namespace Net {
 
 	class Domain;
@@ -36,15 +39,15 @@ class Net::Dhcp_client
 			INIT = 0, SELECT = 1, REQUEST = 2, BOUND = 3, RENEW = 4, REBIND = 5
 		};
 
-		Genode::Allocator                  &_alloc;
-		Interface                          &_interface;
-		State                                _state { State::INIT };
-		Timer::One_shot_timeout<Dhcp_client> _timeout;
-		unsigned long                        _lease_time_sec;
+		Genode::Allocator             &_alloc;
+		Interface                     &_interface;
+		State                          _state { State::INIT };
+		Deferred_timeout<Dhcp_client>  _timeout;
+		unsigned long                  _lease_time_sec;
 
 		void _handle_dhcp_reply(Dhcp_packet &dhcp);
 
-		void _handle_timeout(Genode::Duration);
+		void _handle_timeout();
 
 		void _rerequest(State next_state);
 
@@ -136,7 +136,7 @@ void Dhcp_allocation::print(Output &output) const
 }
 
 
-void Dhcp_allocation::_handle_timeout(Duration)
+void Dhcp_allocation::_handle_timeout()
 {
 	_interface.dhcp_allocation_expired(*this);
 }
@@ -17,6 +17,7 @@
 /* local includes */
 #include <ipv4_address_prefix.h>
 #include <bit_allocator_dynamic.h>
+#include <deferred_timeout.h>
 
 /* Genode includes */
 #include <net/mac_address.h>
@@ -98,13 +99,13 @@ class Net::Dhcp_allocation : public  Genode::Avl_node<Dhcp_allocation>,
 {
 	protected:
 
-		Interface                                &_interface;
-		Ipv4_address                       const  _ip;
-		Mac_address                        const  _mac;
-		Timer::One_shot_timeout<Dhcp_allocation>  _timeout;
-		bool                                      _bound { false };
+		Interface                         &_interface;
+		Ipv4_address                const  _ip;
+		Mac_address                 const  _mac;
+		Deferred_timeout<Dhcp_allocation>  _timeout;
+		bool                               _bound { false };
 
-		void _handle_timeout(Genode::Duration);
+		void _handle_timeout();
 
 		bool _higher(Mac_address const &mac) const;
 
@@ -103,12 +103,14 @@ void Domain::print(Output &output) const
 }
 
 
-Domain::Domain(Configuration &config, Xml_node const node, Allocator &alloc)
+Domain::Domain(Configuration &config, Xml_node const node, Allocator &alloc,
+               Worker *worker)
 :
 	Domain_base(node), _avl_member(_name, *this), _config(config),
 	_node(node), _alloc(alloc),
 	_ip_config(_node.attribute_value("interface", Ipv4_address_prefix()),
-	           _node.attribute_value("gateway",   Ipv4_address()))
+	           _node.attribute_value("gateway",   Ipv4_address())),
+	_worker(worker)
 {
 	if (_name == Domain_name()) {
 		error("Missing name attribute in domain node");
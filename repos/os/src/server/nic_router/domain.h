@@ -34,6 +34,7 @@ namespace Net {
 
 	class Interface;
 	class Configuration;
+	class Worker;
 	class Domain_avl_member;
 	class Domain_base;
 	class Domain;
@@ -91,6 +92,7 @@ class Net::Domain : public Domain_base
 		Pointer<Interface>                    _interface;
 		Pointer<Dhcp_server>                  _dhcp_server;
 		Genode::Reconstructible<Ipv4_config>  _ip_config;
+		Worker                        * const _worker;
 
 		void _read_forward_rules(Genode::Cstring  const &protocol,
 		                         Domain_tree            &domains,
@@ -111,9 +113,16 @@ class Net::Domain : public Domain_base
 		struct Invalid     : Genode::Exception { };
 		struct No_next_hop : Genode::Exception { };
 
+		/**
+		 * Constructor
+		 *
+		 * \param worker  worker that handles the interface of the domain,
+		 *                nullptr for the initial entrypoint
+		 */
 		Domain(Configuration          &config,
 		       Genode::Xml_node const  node,
-		       Genode::Allocator      &alloc);
+		       Genode::Allocator      &alloc,
+		       Worker                 *worker);
 
 		~Domain();
 
@@ -151,6 +160,7 @@ class Net::Domain : public Domain_base
 		Configuration       &config()        const { return _config; }
 		Domain_avl_member   &avl_member()          { return _avl_member; }
 		Dhcp_server         &dhcp_server()         { return _dhcp_server.deref(); }
+		Worker              *worker()        const { return _worker; }
 };
 
 
@@ -0,0 +1,95 @@
+/*
+ * \brief  Ring for handing packets over to the interface of another thread
+ * \author Martin Stein
+ * \date   2017-12-14
+ *
+ * A ring has exactly one producer, the thread of its slot, and one consumer,
+ * the thread of the receiving interface. Hence, it needs no lock. The
+ * producer copies the packet into the ring and the consumer copies it into
+ * the packet stream of its interface.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _HANDOFF_RING_H_
+#define _HANDOFF_RING_H_
+
+/* Genode includes */
+#include <cpu/memory_barrier.h>
+#include <nic/packet_allocator.h>
+#include <util/string.h>
+
+namespace Net { class Handoff_ring; }
+
+
+class Net::Handoff_ring
+{
+	public:
+
+		enum {
+			SLOTS     = 32,
+			SLOT_SIZE = Nic::Packet_allocator::DEFAULT_PACKET_SIZE,
+		};
+
+	private:
+
+		struct Slot
+		{
+			Genode::size_t size;
+			char           data[SLOT_SIZE];
+		};
+
+		/* number of pushed and popped packets, wrapping at 2^32 */
+		unsigned volatile _head = 0;
+		unsigned volatile _tail = 0;
+
+		Slot _slots[SLOTS];
+
+	public:
+
+		/**
+		 * Copy packet into ring, to be called by the producer
+		 *
+		 * \return  false if the ring is full or the packet too large
+		 */
+		bool push(void const *packet, Genode::size_t size)
+		{
+			unsigned const head = _head;
+			if (head - _tail == SLOTS || size > SLOT_SIZE) {
+				return false; }
+
+			Slot &slot = _slots[head % SLOTS];
+			Genode::memcpy(slot.data, packet, size);
+			slot.size = size;
+
+			/* publish the packet before advancing the head */
+			Genode::memory_barrier();
+			_head = head + 1;
+			return true;
+		}
+
+		/**
+		 * Pass all packets of the ring to 'fn', to be called by the consumer
+		 */
+		template <typename FN>
+		void drain(FN const &fn)
+		{
+			for (unsigned tail = _tail; tail != _head; ) {
+
+				Genode::memory_barrier();
+				Slot &slot = _slots[tail % SLOTS];
+				fn(slot.data, slot.size);
+
+				/* finish reading before releasing the slot */
+				Genode::memory_barrier();
+				_tail = ++tail;
+			}
+		}
+};
+
+#endif /* _HANDOFF_RING_H_ */
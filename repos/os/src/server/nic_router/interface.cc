@@ -15,6 +15,8 @@
 #include <net/tcp.h>
 #include <net/udp.h>
 #include <net/arp.h>
+#include <cpu/atomic.h>
+#include <cpu/memory_barrier.h>
 
 /* local includes */
 #include <interface.h>
@@ -133,6 +135,16 @@ static void _src_port(L3_protocol  const prot,
 }
 
 
+static int _atomic_add(int volatile &value, int const diff)
+{
+	for (;;) {
+		int const old_value = value;
+		if (cmpxchg(&value, old_value, old_value + diff)) {
+			return old_value + diff; }
+	}
+}
+
+
 static void *_prot_base(L3_protocol const  prot,
                         size_t      const  prot_size,
                         Ipv4_packet       &ip)
@@ -148,24 +160,54 @@ static void *_prot_base(L3_protocol const  prot,
  ** Interface **
  ***************/
 
-void Interface::_pass_prot(Ethernet_frame       &eth,
-                           size_t         const  eth_size,
-                           Ipv4_packet          &ip,
-                           L3_protocol    const  prot,
-                           void          *const  prot_base,
-                           size_t         const  prot_size)
+void Interface::_forward(Interface            &target,
+                         Ethernet_frame       &eth,
+                         size_t         const  eth_size,
+                         Ipv4_packet          &ip,
+                         L3_protocol    const  prot,
+                         void          *const  prot_base,
+                         size_t         const  prot_size)
 {
-	_update_checksum(prot, prot_base, prot_size, ip.src(), ip.dst());
-	_pass_ip(eth, eth_size, ip);
+	target._acquire();
+	_pending.construct(Pending_forward { target, eth, eth_size, ip, prot,
+	                                     prot_base, prot_size });
 }
 
 
-void Interface::_pass_ip(Ethernet_frame &eth,
-                         size_t   const  eth_size,
-                         Ipv4_packet    &ip)
+void Interface::_forward_ip(Interface      &target,
+                            Ethernet_frame &eth,
+                            size_t   const  eth_size,
+                            Ipv4_packet    &ip)
 {
-	ip.checksum(Ipv4_packet::calculate_checksum(ip));
-	send(eth, eth_size);
+	_forward(target, eth, eth_size, ip, ip.protocol(), nullptr, 0);
+}
+
+
+void Interface::_pass_pending()
+{
+	if (!_pending.constructed()) {
+		return; }
+
+	Pending_forward &fwd = *_pending;
+	if (fwd.prot_base) {
+		_update_checksum(fwd.prot, fwd.prot_base, fwd.prot_size,
+		                 fwd.ip.src(), fwd.ip.dst());
+	}
+	fwd.ip.checksum(Ipv4_packet::calculate_checksum(fwd.ip));
+	fwd.target.send(fwd.eth, fwd.eth_size);
+	fwd.target._release();
+	_pending.destruct();
+}
+
+
+void Interface::_acquire() { _atomic_add(_users, 1); }
+
+
+void Interface::_release()
+{
+	/* the atomic operation orders the check of '_dying' after the update */
+	if (!_atomic_add(_users, -1) && _dying) {
+		_users_gone.up(); }
 }
 
 
@@ -272,6 +314,9 @@ void Interface::_adapt_eth(Ethernet_frame          &eth,
                            Packet_descriptor const &pkt,
                            Interface               &interface)
 {
+	if (interface._dying) {
+		throw Packet_ignored("target interface is closing"); }
+
 	Ipv4_address const &hop_ip = interface._domain.next_hop(ip);
 	try { eth.dst(interface._arp_cache.find_by_ip(hop_ip).mac()); }
 	catch (Arp_cache::No_match) {
@@ -306,7 +351,7 @@ void Interface::_nat_link_and_pass(Ethernet_frame        &eth,
 	Link_side_id const remote = { ip.dst(), _dst_port(prot, prot_base),
 	                              ip.src(), _src_port(prot, prot_base) };
 	_new_link(prot, local, remote_port_alloc, interface, remote);
-	interface._pass_prot(eth, eth_size, ip, prot, prot_base, prot_size);
+	_forward(interface, eth, eth_size, ip, prot, prot_base, prot_size);
 }
 
 
@@ -587,7 +632,7 @@ void Interface::_handle_ip(Ethernet_frame          &eth,
 			_src_port(prot, prot_base, remote_side.dst_port());
 			_dst_port(prot, prot_base, remote_side.src_port());
 
-			interface._pass_prot(eth, eth_size, ip, prot, prot_base, prot_size);
+			_forward(interface, eth, eth_size, ip, prot, prot_base, prot_size);
 			_link_packet(prot, prot_base, link, client);
 			return;
 		}
@@ -644,7 +689,7 @@ void Interface::_handle_ip(Ethernet_frame          &eth,
 			log("Using IP rule: ", rule); }
 
 		_adapt_eth(eth, eth_size, ip.dst(), pkt, interface);
-		interface._pass_ip(eth, eth_size, ip);
+		_forward_ip(interface, eth, eth_size, ip);
 		return;
 	}
 	catch (Ip_rule_list::No_match) { }
@@ -695,8 +740,12 @@ void Interface::_handle_arp_reply(Arp_packet &arp)
 			Arp_waiter &waiter = *waiter_le->object();
 			waiter_le = waiter_le->next();
 			if (ip != waiter.ip()) { continue; }
-			waiter.src()._continue_handle_eth(waiter.packet());
-			destroy(waiter.src()._alloc, &waiter);
+
+			/*
+			 * The packet is continued by the entrypoint of its interface
+			 * once the routing lock is released.
+			 */
+			waiter.src()._resume_arp_waiter(waiter);
 		}
 	}
 }
@@ -760,34 +809,114 @@ void Interface::_handle_arp(Ethernet_frame &eth, size_t const eth_size)
 
 void Interface::_ready_to_submit()
 {
+	Lock::Guard busy_guard(_busy);
+	if (_dying) {
+		return; }
+
 	while (_sink().packet_avail()) {
 
 		Packet_descriptor const pkt = _sink().get_packet();
 		if (!pkt.size()) {
 			continue; }
 
-		try { _handle_eth(_sink().packet_content(pkt), pkt.size(), pkt); }
-		catch (Packet_postponed) { continue; }
-		_ack_packet(pkt);
+		_handle_packet(pkt);
 	}
 }
 
 
-void Interface::_continue_handle_eth(Packet_descriptor const &pkt)
+void Interface::_handle_packet(Packet_descriptor const &pkt)
 {
-	try { _handle_eth(_sink().packet_content(pkt), pkt.size(), pkt); }
-	catch (Packet_postponed) { error("failed twice to handle packet"); }
+	{
+		Lock::Guard guard(routing_lock());
+		try { _handle_eth(_sink().packet_content(pkt), pkt.size(), pkt); }
+		catch (Packet_postponed) { return; }
+	}
+	_pass_pending();
 	_ack_packet(pkt);
 }
 
 
+Arp_waiter *Interface::_resolved_arp_waiter()
+{
+	for (Arp_waiter_list_element *waiter_le = _own_arp_waiters.first();
+	     waiter_le; waiter_le = waiter_le->next())
+	{
+		if (waiter_le->object()->resolved()) {
+			return waiter_le->object(); }
+	}
+	return nullptr;
+}
+
+
+void Interface::_resume_arp_waiter(Arp_waiter &waiter)
+{
+	waiter.resolve();
+	Signal_transmitter(_arp_resolved).submit();
+}
+
+
+void Interface::_handle_resolved_arp_waiters()
+{
+	Lock::Guard busy_guard(_busy);
+	if (_dying) {
+		return; }
+
+	/*
+	 * Like '_handle_packet', route each packet with the routing lock held
+	 * but pass it on without the lock.
+	 */
+	for (;;) {
+		Packet_descriptor pkt;
+		{
+			Lock::Guard guard(routing_lock());
+			Arp_waiter *const waiter = _resolved_arp_waiter();
+			if (!waiter) {
+				return; }
+
+			pkt = waiter->packet();
+			destroy(_alloc, waiter);
+
+			try { _handle_eth(_sink().packet_content(pkt), pkt.size(), pkt); }
+			catch (Packet_postponed) { error("failed twice to handle packet"); }
+		}
+		_pass_pending();
+		_ack_packet(pkt);
+	}
+}
+
+
 void Interface::_ready_to_ack()
 {
+	Lock::Guard busy_guard(_busy);
+	if (_dying) {
+		return; }
+
 	while (_source().ack_avail()) {
 		_source().release_packet(_source().get_acked_packet()); }
 }
 
 
+void Interface::_handle_handoff()
+{
+	Lock::Guard busy_guard(_busy);
+	if (_dying) {
+		return; }
+
+	/* clear the flag first to not miss packets that are handed over meanwhile */
+	_handoff_pending = 0;
+	memory_barrier();
+
+	for (unsigned slot = 0; slot < Worker_pool::MAX_SLOTS; slot++) {
+		Handoff_ring *const ring = _handoff_rings[slot];
+		if (!ring) {
+			continue; }
+
+		ring->drain([&] (void const *frame, size_t const size) {
+			_send_frame(frame, size); });
+	}
+}
+
+
 void Interface::_destroy_dhcp_allocation(Dhcp_allocation &allocation)
 {
 	_domain.dhcp_server().free_ip(allocation.ip());
@@ -876,11 +1005,21 @@ void Interface::send(Ethernet_frame &eth, Genode::size_t const size)
 {
 	if (_config().verbose()) {
 		log("\033[33m(", _domain, " <- router)\033[0m ", eth); }
+
+	if (_myself()) {
+		_send_frame(&eth, size); }
+	else {
+		_hand_over(&eth, size); }
+}
+
+
+void Interface::_send_frame(void const *frame, Genode::size_t const size)
+{
 	try {
 		/* copy and submit packet */
 		Packet_descriptor const pkt = _source().alloc_packet(size);
 		char *content = _source().packet_content(pkt);
-		Genode::memcpy((void *)content, (void *)&eth, size);
+		Genode::memcpy((void *)content, frame, size);
 		_source().submit_packet(pkt);
 	}
 	catch (Packet_stream_source::Packet_alloc_failed) {
@@ -890,6 +1029,62 @@ void Interface::send(Ethernet_frame &eth, Genode::size_t const size)
 }
 
 
+void Interface::_hand_over(void const *frame, Genode::size_t const size)
+{
+	/* only the calling thread pushes to its ring */
+	Handoff_ring *const ring = _handoff_rings[_workers().current_slot()];
+	if (!ring || !ring->push(frame, size)) {
+		if (_config().verbose()) {
+			log("Failed to hand over packet"); }
+		return;
+	}
+	if (cmpxchg(&_handoff_pending, 0, 1)) {
+		Signal_transmitter(_handoff_avail).submit(); }
+}
+
+
+unsigned Interface::_own_slot() const
+{
+	return _domain.worker() ? _domain.worker()->slot() : 0;
+}
+
+
+void Interface::_alloc_handoff_rings()
+{
+	/*
+	 * The rings are allocated upfront from the session quota. So, threads
+	 * that hand over packets never allocate on behalf of the interface.
+	 */
+	try {
+		for (unsigned slot = 0; slot <= _workers().num(); slot++) {
+			if (slot != _own_slot()) {
+				_handoff_rings[slot] = new (_alloc) Handoff_ring; }
+		}
+	}
+	catch (...) {
+		_free_handoff_rings();
+		throw;
+	}
+}
+
+
+void Interface::_free_handoff_rings()
+{
+	for (unsigned slot = 0; slot < Worker_pool::MAX_SLOTS; slot++) {
+		if (_handoff_rings[slot]) {
+			destroy(_alloc, _handoff_rings[slot]);
+			_handoff_rings[slot] = nullptr;
+		}
+	}
+}
+
+
+static Entrypoint &_ep_of_domain(Domain &domain, Entrypoint &ep)
+{
+	return domain.worker() ? domain.worker()->ep() : ep;
+}
+
+
 Interface::Interface(Entrypoint        &ep,
                      Timer::Connection &timer,
                      Mac_address const  router_mac,
@@ -897,25 +1092,32 @@ Interface::Interface(Entrypoint        &ep,
                      Mac_address const  mac,
                      Domain            &domain)
 :
-	_sink_ack(ep, *this, &Interface::_ack_avail),
-	_sink_submit(ep, *this, &Interface::_ready_to_submit),
-	_source_ack(ep, *this, &Interface::_ready_to_ack),
-	_source_submit(ep, *this, &Interface::_packet_avail),
+	_ep(_ep_of_domain(domain, ep)),
+	_sink_ack(_ep, *this, &Interface::_ack_avail),
+	_sink_submit(_ep, *this, &Interface::_ready_to_submit),
+	_source_ack(_ep, *this, &Interface::_ready_to_ack),
+	_source_submit(_ep, *this, &Interface::_packet_avail),
+	_handoff_avail(_ep, *this, &Interface::_handle_handoff),
+	_arp_resolved(_ep, *this, &Interface::_handle_resolved_arp_waiters),
 	_router_mac(router_mac), _mac(mac), _timer(timer), _alloc(alloc),
 	_domain(domain)
 {
+	_alloc_handoff_rings();
+
 	if (_config().verbose()) {
 		log("Interface connected ", *this);
 		log("  MAC ", _mac);
 		log("  Router identity: MAC ", _router_mac, " IP ",
 		    _router_ip(), "/", _ip_config().interface.prefix);
 	}
+	Lock::Guard guard(routing_lock());
 	_domain.interface().set(*this);
 }
 
 
 void Interface::_init()
 {
+	Lock::Guard guard(routing_lock());
 	if (!_domain.ip_config().valid) {
 		_dhcp_client.discover();
 	}
@@ -942,17 +1144,35 @@ void Interface::_cancel_arp_waiting(Arp_waiter &waiter)
 
 Interface::~Interface()
 {
-	_domain.interface().unset();
+	/* keep the signal handlers of the interface off */
+	Lock::Guard busy_guard(_busy);
+	{
+		Lock::Guard guard(routing_lock());
+		_domain.interface().unset();
+		_dying = true;
+	}
+	/*
+	 * Wait until other threads finished sending to the interface. No new
+	 * users can show up as the interface is no longer reachable.
+	 */
+	if (_users) {
+		_users_gone.down(); }
+
+	Lock::Guard guard(routing_lock());
 	if (_config().verbose()) {
 		log("Interface disconnected ", *this); }
 
 	/* destroy ARP waiters */
 	while (_own_arp_waiters.first()) {
-		_cancel_arp_waiting(*_foreign_arp_waiters.first()->object()); }
+		_cancel_arp_waiting(*_own_arp_waiters.first()->object()); }
 
 	while (_foreign_arp_waiters.first()) {
 		Arp_waiter &waiter = *_foreign_arp_waiters.first()->object();
-		waiter.src()._cancel_arp_waiting(waiter); }
+		if (waiter.src()._myself()) {
+			waiter.src()._cancel_arp_waiting(waiter); }
+		else {
+			waiter.src()._resume_arp_waiter(waiter); }
+	}
 
 	/* destroy links */
 	_destroy_links<Tcp_link>(_tcp_links, _closed_tcp_links, _alloc);
@@ -964,12 +1184,16 @@ Interface::~Interface()
 		_dhcp_allocations.remove(allocation);
 		_destroy_dhcp_allocation(*allocation);
 	}
+	_free_handoff_rings();
 }
 
 
 Configuration &Interface::_config() const { return _domain.config(); }
 
 
+Worker_pool &Interface::_workers() const { return _config().workers(); }
+
+
 Ipv4_config const &Interface::_ip_config() const { return _domain.ip_config(); }
 
 
@@ -21,10 +21,14 @@
 #include <l3_protocol.h>
 #include <dhcp_client.h>
 #include <dhcp_server.h>
+#include <handoff_ring.h>
+#include <worker.h>
 
 /* Genode includes */
 #include <nic_session/nic_session.h>
 #include <net/dhcp.h>
+#include <util/reconstructible.h>
+#include <base/semaphore.h>
 
 namespace Net {
 
@@ -49,10 +53,21 @@ class Net::Interface
 
 		using Signal_handler = Genode::Signal_handler<Interface>;
 
+		/*
+		 * The packet streams of an interface are accessed only by the
+		 * entrypoint of the interface, except for the destructor, which
+		 * holds the busy lock to keep the signal handlers off.
+		 */
+		Genode::Entrypoint &_ep;
+		Genode::Lock        _busy;
+		bool                _dying = false;
+
 		Signal_handler    _sink_ack;
 		Signal_handler    _sink_submit;
 		Signal_handler    _source_ack;
 		Signal_handler    _source_submit;
+		Signal_handler    _handoff_avail;
+		Signal_handler    _arp_resolved;
 		Mac_address const _router_mac;
 		Mac_address const _mac;
 
@@ -60,6 +75,24 @@ class Net::Interface
 
 	private:
 
+		/**
+		 * Packet that is routed but not yet sent
+		 *
+		 * Calculating the checksums and sending is done without the
+		 * routing lock. Meanwhile, the target interface is kept alive
+		 * via its user count.
+		 */
+		struct Pending_forward
+		{
+			Interface            &target;
+			Ethernet_frame       &eth;
+			Genode::size_t const  eth_size;
+			Ipv4_packet          &ip;
+			L3_protocol    const  prot;
+			void          *const  prot_base;
+			Genode::size_t const  prot_size;
+		};
+
 		Timer::Connection    &_timer;
 		Genode::Allocator    &_alloc;
 		Domain               &_domain;
@@ -74,6 +107,13 @@ class Net::Interface
 		Dhcp_allocation_list  _released_dhcp_allocations;
 		Dhcp_client           _dhcp_client { _alloc, _timer, *this };
 
+		Genode::Constructible<Pending_forward> _pending { };
+
+		Handoff_ring           *_handoff_rings[Worker_pool::MAX_SLOTS] { };
+		int            volatile _handoff_pending = 0;
+		int            volatile _users           = 0;
+		Genode::Semaphore       _users_gone { };
+
 		void _new_link(L3_protocol                   const  protocol,
 		               Link_side_id                  const &local_id,
 		               Pointer<Port_allocator_guard> const  remote_port_alloc,
@@ -129,18 +169,44 @@ class Net::Interface
 
 		void _broadcast_arp_request(Ipv4_address const &ip);
 
-		void _pass_prot(Ethernet_frame         &eth,
-		                Genode::size_t   const  eth_size,
-		                Ipv4_packet            &ip,
-		                L3_protocol      const  prot,
-		                void            *const  prot_base,
-		                Genode::size_t   const  prot_size);
+		void _forward(Interface              &target,
+		              Ethernet_frame         &eth,
+		              Genode::size_t   const  eth_size,
+		              Ipv4_packet            &ip,
+		              L3_protocol      const  prot,
+		              void            *const  prot_base,
+		              Genode::size_t   const  prot_size);
+
+		void _forward_ip(Interface            &target,
+		                 Ethernet_frame       &eth,
+		                 Genode::size_t const  eth_size,
+		                 Ipv4_packet          &ip);
+
+		void _pass_pending();
+
+		void _handle_packet(Packet_descriptor const &pkt);
+
+		Arp_waiter *_resolved_arp_waiter();
 
-		void _pass_ip(Ethernet_frame       &eth,
-		              Genode::size_t const  eth_size,
-		              Ipv4_packet          &ip);
+		void _resume_arp_waiter(Arp_waiter &waiter);
 
-		void _continue_handle_eth(Packet_descriptor const &pkt);
+		void _send_frame(void const *frame, Genode::size_t const size);
+
+		void _hand_over(void const *frame, Genode::size_t const size);
+
+		unsigned _own_slot() const;
+
+		void _alloc_handoff_rings();
+
+		void _free_handoff_rings();
+
+		bool _myself() { return _ep.rpc_ep().is_myself(); }
+
+		void _acquire();
+
+		void _release();
+
+		Worker_pool &_workers() const;
 
 		Link_list &_closed_links(L3_protocol const protocol);
 
@@ -173,6 +239,8 @@ class Net::Interface
 		void _ack_avail() { }
 		void _ready_to_ack();
 		void _packet_avail() { }
+		void _handle_handoff();
+		void _handle_resolved_arp_waiters();
 
 	public:
 
@@ -191,6 +259,19 @@ class Net::Interface
 			Packet_ignored(char const *reason) : reason(reason) { }
 		};
 
+		/**
+		 * Return RAM consumed by the handoff rings of an interface
+		 *
+		 * There is one ring for each thread except the one of the
+		 * interface.
+		 */
+		static Genode::size_t handoff_rings_size(Worker_pool       &workers,
+		                                         Genode::Allocator &alloc)
+		{
+			Genode::size_t const size = sizeof(Handoff_ring);
+			return workers.num() * (size + alloc.overhead(size));
+		}
+
 		Interface(Genode::Entrypoint &ep,
 		          Timer::Connection  &timer,
 		          Mac_address const   router_mac,
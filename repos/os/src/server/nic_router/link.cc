@@ -131,7 +131,7 @@ Link::Link(Interface                           &cln_interface,
 }
 
 
-void Link::_handle_close_timeout(Duration)
+void Link::_handle_close_timeout()
 {
 	dissolve();
 	_client._interface.link_closed(*this, _protocol);
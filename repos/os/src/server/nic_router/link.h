@@ -24,6 +24,7 @@
 /* local includes */
 #include <pointer.h>
 #include <l3_protocol.h>
+#include <deferred_timeout.h>
 
 namespace Net {
 
@@ -128,11 +129,11 @@ class Net::Link : public Link_list::Element
 		Link_side                            _client;
 		Pointer<Port_allocator_guard> const  _server_port_alloc;
 		Link_side                            _server;
-		Timer::One_shot_timeout<Link>        _close_timeout;
+		Deferred_timeout<Link>               _close_timeout;
 		Genode::Microseconds          const  _close_timeout_us;
 		L3_protocol                   const  _protocol;
 
-		void _handle_close_timeout(Genode::Duration);
+		void _handle_close_timeout();
 
 		void _packet() { _close_timeout.schedule(_close_timeout_us); }
 
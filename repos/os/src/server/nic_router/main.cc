@@ -22,6 +22,7 @@
 #include <component.h>
 #include <uplink.h>
 #include <configuration.h>
+#include <deferred_timeout.h>
 
 using namespace Net;
 using namespace Genode;
@@ -34,10 +35,18 @@ class Main
 		Timer::Connection              _timer;
 		Genode::Heap                   _heap;
 		Genode::Attached_rom_dataspace _config_rom;
+		Worker_pool                    _workers;
 		Configuration                  _config;
+		Signal_handler<Main>           _timeouts_handler;
 		Uplink                         _uplink;
 		Net::Root                      _root;
 
+		void _handle_timeouts()
+		{
+			Lock::Guard guard(routing_lock());
+			handle_deferred_timeouts();
+		}
+
 	public:
 
 		Main(Env &env);
@@ -47,10 +56,15 @@ class Main
 Main::Main(Env &env)
 :
 	_timer(env), _heap(&env.ram(), &env.rm()), _config_rom(env, "config"),
-	_config(_config_rom.xml(), _heap), _uplink(env, _timer, _heap, _config),
+	_workers(env, _heap,
+	         _config_rom.xml().attribute_value("worker_threads", 0U)),
+	_config(_config_rom.xml(), _heap, _workers),
+	_timeouts_handler(env.ep(), *this, &Main::_handle_timeouts),
+	_uplink(env, _timer, _heap, _config),
 	_root(env.ep(), _timer, _heap, _uplink.router_mac(), _config,
 	      env.ram(), env.rm())
 {
+	deferred_timeouts_sigh(_timeouts_handler);
 	env.parent().announce(env.ep().manage(_root));
 }
 
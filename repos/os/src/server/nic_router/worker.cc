@@ -0,0 +1,90 @@
+/*
+ * \brief  Threads that handle the packets of domains
+ * \author Martin Stein
+ * \date   2017-12-14
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/log.h>
+#include <base/allocator.h>
+
+/* local includes */
+#include <worker.h>
+
+using namespace Net;
+using namespace Genode;
+
+
+Lock &Net::routing_lock()
+{
+	static Lock lock;
+	return lock;
+}
+
+
+/************
+ ** Worker **
+ ************/
+
+Worker::Worker(Env &env, unsigned slot, Affinity::Location location)
+:
+	_slot(slot), _ep(env, STACK_SIZE, "worker", location)
+{ }
+
+
+/*****************
+ ** Worker_pool **
+ *****************/
+
+Worker_pool::Worker_pool(Env &env, Allocator &alloc, unsigned num_workers)
+:
+	_alloc(alloc)
+{
+	if (num_workers > MAX_WORKERS) {
+		warning("limit number of worker threads to ", (unsigned)MAX_WORKERS);
+		num_workers = MAX_WORKERS;
+	}
+	/* leave the first CPU to the initial entrypoint */
+	Affinity::Space space = env.cpu().affinity_space();
+	for (; _num_workers < num_workers; _num_workers++) {
+		_workers[_num_workers] = new (_alloc)
+			Worker(env, _num_workers + 1,
+			       space.location_of_index(_num_workers + 1));
+	}
+}
+
+
+Worker_pool::~Worker_pool()
+{
+	while (_num_workers) {
+		destroy(_alloc, _workers[--_num_workers]); }
+}
+
+
+Worker *Worker_pool::assign()
+{
+	if (!_num_workers) {
+		return nullptr; }
+
+	Worker *const worker = _workers[_next];
+	_next = (_next + 1) % _num_workers;
+	return worker;
+}
+
+
+unsigned Worker_pool::current_slot()
+{
+	for (unsigned i = 0; i < _num_workers; i++) {
+		if (_workers[i]->myself()) {
+			return _workers[i]->slot(); }
+	}
+	return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * \brief  Threads that handle the packets of domains
+ * \author Martin Stein
+ * \date   2017-12-14
+ *
+ * By default, the initial entrypoint handles the packets of all domains. If
+ * configured, the domains are distributed over worker threads instead.
+ * Each worker has its own entrypoint at which the interfaces of its domains
+ * receive their packet-stream signals. The routing state, i.e., links, ARP
+ * caches and waiters, DHCP allocations, and NAT ports, is shared by all
+ * threads and serialized by the routing lock. Calculating checksums and
+ * copying packets to the interface of another thread are done without the
+ * lock.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _WORKER_H_
+#define _WORKER_H_
+
+/* Genode includes */
+#include <base/entrypoint.h>
+#include <base/lock.h>
+
+namespace Genode { class Allocator; }
+
+namespace Net {
+
+	class Worker;
+	class Worker_pool;
+
+	/**
+	 * Lock that serializes all accesses to the routing state
+	 */
+	Genode::Lock &routing_lock();
+}
+
+
+class Net::Worker
+{
+	private:
+
+		enum { STACK_SIZE = 16*1024*sizeof(long) };
+
+		unsigned const     _slot;
+		Genode::Entrypoint _ep;
+
+	public:
+
+		Worker(Genode::Env                &env,
+		       unsigned                    slot,
+		       Genode::Affinity::Location  location);
+
+
+		/***************
+		 ** Accessors **
+		 ***************/
+
+		unsigned            slot() const { return _slot; }
+		Genode::Entrypoint &ep()         { return _ep; }
+		bool                myself()     { return _ep.rpc_ep().is_myself(); }
+};
+
+
+class Net::Worker_pool
+{
+	public:
+
+		/*
+		 * Each thread that hands packets over to the interfaces of other
+		 * threads has a slot. Slot 0 belongs to the initial entrypoint.
+		 */
+		enum { MAX_WORKERS = 16, MAX_SLOTS = MAX_WORKERS + 1 };
+
+	private:
+
+		Genode::Allocator &_alloc;
+		Worker            *_workers[MAX_WORKERS] { };
+		unsigned           _num_workers = 0;
+		unsigned           _next        = 0;
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param num_workers  number of worker threads, 0 lets the initial
+		 *                     entrypoint handle all domains
+		 */
+		Worker_pool(Genode::Env &env, Genode::Allocator &alloc,
+		            unsigned num_workers);
+
+		~Worker_pool();
+
+		/**
+		 * Return worker for the next domain
+		 *
+		 * \return  nullptr if the initial entrypoint handles all domains
+		 */
+		Worker *assign();
+
+		/**
+		 * Return handoff slot of the calling thread
+		 */
+		unsigned current_slot();
+
+
+		/***************
+		 ** Accessors **
+		 ***************/
+
+		unsigned num() const { return _num_workers; }
+};
+
+#endif /* _WORKER_H_ */
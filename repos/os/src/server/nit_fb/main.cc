@@ -123,6 +123,12 @@ struct Framebuffer::Session_component : Genode::Rpc_object<Framebuffer::Session>
 
 	bool _dataspace_is_new = true;
 
+	/*
+	 * True if the client reports damage via the damage ring, not via
+	 * 'refresh'
+	 */
+	bool _damage_ring_used = false;
+
 
 	/**
 	 * Constructor
@@ -168,6 +174,12 @@ struct Framebuffer::Session_component : Genode::Rpc_object<Framebuffer::Session>
 		 */
 		_dataspace_is_new = true;
 
+		/* a client using the damage ring never calls 'refresh' */
+		if (_damage_ring_used) {
+			_view_updater.update_view();
+			_dataspace_is_new = false;
+		}
+
 		return _nit_fb.dataspace();
 	}
 
@@ -204,6 +216,27 @@ struct Framebuffer::Session_component : Genode::Rpc_object<Framebuffer::Session>
 
 		_nit_fb.sync_sigh(sigh);
 	}
+
+	Genode::Dataspace_capability damage_ring() override
+	{
+		/*
+		 * The virtual framebuffer is the buffer of our nitpicker session.
+		 * Hence, the client can use the damage ring of the nitpicker session
+		 * directly.
+		 */
+		Genode::Dataspace_capability ds = _nit_fb.damage_ring();
+		if (!ds.valid())
+			return ds;
+
+		_damage_ring_used = true;
+
+		if (_dataspace_is_new) {
+			_view_updater.update_view();
+			_dataspace_is_new = false;
+		}
+
+		return ds;
+	}
 };
 
 
@@ -14,6 +14,10 @@
 #ifndef _FRAMEBUFFER_SESSION_COMPONENT_H_
 #define _FRAMEBUFFER_SESSION_COMPONENT_H_
 
+/* Genode includes */
+#include <base/allocator_guard.h>
+#include <framebuffer_session/damage_ring.h>
+
 /* local includes */
 #include "buffer.h"
 
@@ -42,6 +46,14 @@ class Framebuffer::Session_component : public Rpc_object<Session>
 		Framebuffer::Mode             _mode;
 		bool                          _alpha = false;
 
+		Ram_session                  &_ram;
+		Region_map                   &_rm;
+		Allocator_guard              &_session_alloc;
+
+		enum { DAMAGE_RING_DS_SIZE = (sizeof(Damage_ring) + 0xfff) & ~0xfff };
+
+		Constructible<Attached_ram_dataspace> _damage_ring_ds;
+
 	public:
 
 		/**
@@ -50,14 +62,24 @@ class Framebuffer::Session_component : public Rpc_object<Session>
 		Session_component(View_stack                   &view_stack,
 		                  Nitpicker::Session_component &session,
 		                  Framebuffer::Session         &framebuffer,
-		                  Buffer_provider              &buffer_provider)
+		                  Buffer_provider              &buffer_provider,
+		                  Ram_session                  &ram,
+		                  Region_map                   &rm,
+		                  Allocator_guard              &session_alloc)
 		:
 			_view_stack(view_stack),
 			_session(session),
 			_framebuffer(framebuffer),
-			_buffer_provider(buffer_provider)
+			_buffer_provider(buffer_provider),
+			_ram(ram), _rm(rm), _session_alloc(session_alloc)
 		{ }
 
+		~Session_component()
+		{
+			if (_damage_ring_ds.constructed())
+				_session_alloc.upgrade(DAMAGE_RING_DS_SIZE);
+		}
+
 		/**
 		 * Change virtual framebuffer mode
 		 *
@@ -79,6 +101,14 @@ class Framebuffer::Session_component : public Rpc_object<Session>
 				Signal_transmitter(_mode_sigh).submit();
 		}
 
+		/**
+		 * Mark the regions reported via the damage ring as dirty
+		 *
+		 * Called once per frame. The regions are merged before applying them
+		 * to the views of the session.
+		 */
+		void merge_damage();
+
 		void submit_sync()
 		{
 			if (_sync_sigh.valid())
@@ -110,6 +140,26 @@ class Framebuffer::Session_component : public Rpc_object<Session>
 		}
 
 		void refresh(int x, int y, int w, int h) override;
+
+		Dataspace_capability damage_ring() override
+		{
+			if (_damage_ring_ds.constructed())
+				return _damage_ring_ds->cap();
+
+			/* the ring is accounted to the session quota like the buffer */
+			if (!_session_alloc.withdraw(DAMAGE_RING_DS_SIZE))
+				return Dataspace_capability();
+
+			try {
+				_damage_ring_ds.construct(_ram, _rm, DAMAGE_RING_DS_SIZE);
+				construct_at<Damage_ring>(_damage_ring_ds->local_addr<void>());
+				return _damage_ring_ds->cap();
+			}
+			catch (...) {
+				_session_alloc.upgrade(DAMAGE_RING_DS_SIZE);
+				return Dataspace_capability();
+			}
+		}
 };
 
 #endif /* _FRAMEBUFFER_SESSION_COMPONENT_H_ */
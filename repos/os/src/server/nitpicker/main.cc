@@ -64,6 +64,36 @@ void Framebuffer::Session_component::refresh(int x, int y, int w, int h)
 }
 
 
+void Framebuffer::Session_component::merge_damage()
+{
+	if (!_damage_ring_ds.constructed())
+		return;
+
+	Damage_ring &ring = *_damage_ring_ds->local_addr<Damage_ring>();
+
+	/* limit coordinates to sane values as the ring is shared with the client */
+	enum { MAX_COORD = 1 << 15 };
+	auto clamp = [] (int v) { return max(-MAX_COORD, min(v, (int)MAX_COORD)); };
+
+	Nitpicker::Dirty_rect damage;
+
+	bool const whole_buffer = ring.consume([&] (int x, int y, int w, int h) {
+		if (w > 0 && h > 0)
+			damage.mark_as_dirty(Rect(Point(clamp(x), clamp(y)),
+			                          Area(min(w, (int)MAX_COORD),
+			                               min(h, (int)MAX_COORD)))); });
+
+	if (whole_buffer) {
+		_view_stack.mark_session_views_as_dirty(_session,
+			Rect(Point(0, 0), Area(_mode.width(), _mode.height())));
+		return;
+	}
+
+	damage.flush([&] (Rect const &rect) {
+		_view_stack.mark_session_views_as_dirty(_session, rect); });
+}
+
+
 /*****************************************
  ** Implementation of Nitpicker service **
  *****************************************/
@@ -445,6 +475,10 @@ void Nitpicker::Main::_handle_input()
 	if (result.motion_activity)
 		_view_stack.geometry(_pointer_origin, Rect(_user_state.pointer_pos(), Area()));
 
+	/* apply the regions reported by the clients since the last frame */
+	for (Session_component *s = _session_list.first(); s; s = s->next())
+		s->merge_damage();
+
 	/* perform redraw and flush pixels to the framebuffer */
 	_view_stack.draw(_fb_screen->screen).flush([&] (Rect const &rect) {
 		_framebuffer.refresh(rect.x1(), rect.y1(),
@@ -172,7 +172,8 @@ class Nitpicker::Session_component : public Rpc_object<Session>,
 			_label(label),
 			_session_alloc(&session_alloc, ram_quota),
 			_framebuffer(framebuffer),
-			_framebuffer_session_component(view_stack, *this, framebuffer, *this),
+			_framebuffer_session_component(view_stack, *this, framebuffer, *this,
+			                               _env.ram(), _env.rm(), _session_alloc),
 			_view_stack(view_stack), _focus_controller(focus_controller),
 			_pointer_origin(pointer_origin),
 			_builtin_background(builtin_background),
@@ -325,6 +326,11 @@ class Nitpicker::Session_component : public Rpc_object<Session>,
 
 		void upgrade_ram_quota(size_t ram_quota) { _session_alloc.upgrade(ram_quota); }
 
+		/**
+		 * Mark regions reported via the client's damage ring as dirty
+		 */
+		void merge_damage() { _framebuffer_session_component.merge_damage(); }
+
 		/**
 		 * Deliver sync signal to the client's virtual frame buffer
 		 */
@@ -32,18 +32,26 @@ namespace Block {
 
 
 class Block::Session_component : public Block::Session_rpc_object,
-                                 public List<Block::Session_component>::Element,
+                                 public Fifo<Block::Session_component>::Element,
                                  public Block_dispatcher
 {
 	private:
 
+		/*
+		 * Maximum number of requests a session may pass to the back end
+		 * before the other sessions get their turn
+		 */
+		enum { QUANTUM = 16 };
+
+		enum class Progress { IDLE, MORE, CONGESTED };
+
 		Ram_dataspace_capability          _rq_ds;
-		addr_t                            _rq_phys;
+		Driver::Slice                    *_slice;
 		Partition                        *_partition;
 		Signal_handler<Session_component> _sink_ack;
 		Signal_handler<Session_component> _sink_submit;
-		bool                              _req_queue_full;
-		bool                              _ack_queue_full;
+		bool                              _pending;
+		bool                              _scheduled;
 		Packet_descriptor                 _p_to_handle;
 		unsigned                          _p_in_fly;
 		Block::Driver                    &_driver;
@@ -69,36 +77,73 @@ class Block::Session_component : public Block::Session_rpc_object,
 
 		/**
 		 * Handle a single request
+		 *
+		 * \return false if the back end is congested
 		 */
-		void _handle_packet(Packet_descriptor packet)
+		bool _handle_packet(Packet_descriptor packet)
 		{
 			_p_to_handle = packet;
 			_p_to_handle.succeeded(false);
 
-			/* ignore invalid packets */
-			if (!packet.size() || !_range_check(_p_to_handle)) {
-				_ack_packet(_p_to_handle);
-				return;
-			}
-
 			bool write   = _p_to_handle.operation() == Packet_descriptor::WRITE;
 			sector_t off = _p_to_handle.block_number() + _partition->lba;
 			size_t cnt   = _p_to_handle.block_count();
 			void* addr   = tx_sink()->packet_content(_p_to_handle);
 
+			/* ignore invalid packets */
+			if (!addr || !_range_check(_p_to_handle)
+			 || packet.size() < cnt * _driver.blk_size()) {
+				_ack_packet(_p_to_handle);
+				return true;
+			}
+
 			if (write && !_writeable) {
 				_ack_packet(_p_to_handle);
-				return;
+				return true;
 			}
 
 			try {
-				_driver.io(write, off, cnt, addr, *this, _p_to_handle);
+				_driver.io(write, off, cnt, addr, *this, _p_to_handle, _slice);
 			} catch (Block::Session::Tx::Source::Packet_alloc_failed) {
-				if (!_req_queue_full) {
-					_req_queue_full = true;
-					Session_component::wait_queue().insert(this);
+				return false;
+			}
+			return true;
+		}
+
+		/**
+		 * Pass up to QUANTUM requests to the back end
+		 */
+		Progress _process()
+		{
+			for (unsigned i = 0; i < QUANTUM; i++) {
+
+				if (!_pending) {
+
+					/* each request in flight needs a slot for its ack */
+					if (!tx_sink()->packet_avail()
+					 || _p_in_fly >= tx_sink()->ack_slots_free())
+						return Progress::IDLE;
+
+					_p_to_handle = tx_sink()->get_packet();
+					_pending     = true;
+					_p_in_fly++;
 				}
+
+				if (!_handle_packet(_p_to_handle))
+					return Progress::CONGESTED;
+
+				_pending = false;
 			}
+			return Progress::MORE;
+		}
+
+		void _enqueue()
+		{
+			if (_scheduled)
+				return;
+
+			_scheduled = true;
+			ready_queue().enqueue(this);
 		}
 
 		/**
@@ -106,17 +151,8 @@ class Block::Session_component : public Block::Session_rpc_object,
 		 */
 		void _packet_avail()
 		{
-			_ack_queue_full = _p_in_fly >= tx_sink()->ack_slots_free();
-
-			/*
-			 * as long as more packets are available, and we're able to ack
-			 * them, and the driver's request queue isn't full,
-			 * direct the packet request to the driver backend
-			 */
-			for (; !_req_queue_full && tx_sink()->packet_avail() &&
-					 !_ack_queue_full; _p_in_fly++,
-					 _ack_queue_full = _p_in_fly >= tx_sink()->ack_slots_free())
-					_handle_packet(tx_sink()->get_packet());
+			_enqueue();
+			run();
 		}
 
 		/**
@@ -128,21 +164,27 @@ class Block::Session_component : public Block::Session_rpc_object,
 
 		/**
 		 * Constructor
+		 *
+		 * \param slice  part of the back-end buffer used as packet buffer,
+		 *               or nullptr if 'rq_ds' is used
 		 */
 		Session_component(Ram_dataspace_capability  rq_ds,
+		                  Driver::Slice            *slice,
 		                  Partition                *partition,
 		                  Genode::Entrypoint       &ep,
 		                  Genode::Region_map       &rm,
 		                  Block::Driver            &driver,
 		                  bool                      writeable)
-		: Session_rpc_object(rm, rq_ds, ep.rpc_ep()),
+		: Session_rpc_object(rm, slice ? slice->dataspace()
+		                               : Dataspace_capability(rq_ds),
+		                     ep.rpc_ep()),
 		  _rq_ds(rq_ds),
-		  _rq_phys(Dataspace_client(_rq_ds).phys_addr()),
+		  _slice(slice),
 		  _partition(partition),
 		  _sink_ack(ep, *this, &Session_component::_ready_to_ack),
 		  _sink_submit(ep, *this, &Session_component::_packet_avail),
-		  _req_queue_full(false),
-		  _ack_queue_full(false),
+		  _pending(false),
+		  _scheduled(false),
 		  _p_in_fly(0),
 		  _driver(driver),
 		  _writeable(writeable)
@@ -155,16 +197,18 @@ class Block::Session_component : public Block::Session_rpc_object,
 		{
 			_driver.remove_dispatcher(*this);
 
-			if (_req_queue_full)
-				wait_queue().remove(this);
+			if (_scheduled)
+				ready_queue().remove(this);
 		}
 
 		Ram_dataspace_capability const rq_ds() const { return _rq_ds; }
+		Driver::Slice *slice() { return _slice; }
 		Partition *partition() { return _partition; }
 
-		void dispatch(Packet_descriptor &request, Packet_descriptor &reply)
+		void dispatch(Packet_descriptor &request, Packet_descriptor &reply,
+		              bool copy)
 		{
-			if (request.operation() == Block::Packet_descriptor::READ) {
+			if (copy && request.operation() == Block::Packet_descriptor::READ) {
 				void *src =
 					_driver.session().tx()->packet_content(reply);
 				Genode::size_t sz =
@@ -174,27 +218,51 @@ class Block::Session_component : public Block::Session_rpc_object,
 			request.succeeded(reply.succeeded());
 			_ack_packet(request);
 
-			if (_ack_queue_full)
-				_packet_avail();
+			/* the session is served once the driver processed all acks */
+			if (tx_sink()->packet_avail())
+				_enqueue();
 		}
 
-		static List<Session_component>& wait_queue()
+		/**
+		 * Sessions with requests waiting for the back end
+		 */
+		static Fifo<Session_component>& ready_queue()
 		{
-			static List<Session_component> l;
-			return l;
+			static Fifo<Session_component> q;
+			return q;
 		}
 
-		static void wake_up()
+		/**
+		 * Let the ready sessions pass their requests to the back end in turn
+		 *
+		 * A session that exhausted its quantum is queued again, so that a
+		 * busy client cannot starve the clients of other partitions.
+		 */
+		static void run()
 		{
-			for (; Session_component *c = wait_queue().first();)
-			{
-				wait_queue().remove(c);
-				c->_req_queue_full = false;
-				c->_handle_packet(c->_p_to_handle);
-				c->_packet_avail();
+			while (Session_component *c = ready_queue().dequeue()) {
+
+				c->_scheduled = false;
+
+				switch (c->_process()) {
+				case Progress::IDLE:
+					break;
+
+				case Progress::MORE:
+					c->_enqueue();
+					break;
+
+				case Progress::CONGESTED:
+
+					/* resume once the back end acknowledged requests */
+					c->_enqueue();
+					return;
+				}
 			}
 		}
 
+		static void wake_up() { run(); }
+
 		/*******************************
 		 **  Block session interface  **
 		 *******************************/
@@ -238,8 +306,13 @@ class Block::Root :
 		void _destroy_session(Session_component *session) override
 		{
 			Ram_dataspace_capability rq_ds = session->rq_ds();
+			Driver::Slice           *slice = session->slice();
 			Genode::Root_component<Session_component>::_destroy_session(session);
-			_env.ram().free(rq_ds);
+
+			if (slice)
+				_driver.free_slice(*slice);
+			else
+				_env.ram().free(rq_ds);
 		}
 
 		/**
@@ -305,14 +378,20 @@ class Block::Root :
 			if (writeable)
 				writeable = Arg_string::find_arg(args, "writeable").bool_value(true);
 
+			/* use part of the back-end buffer if possible */
+			Driver::Slice *slice = _driver.alloc_slice(tx_buf_size);
+
 			Ram_dataspace_capability ds_cap;
-			ds_cap = _env.ram().alloc(tx_buf_size);
+			if (!slice)
+				ds_cap = _env.ram().alloc(tx_buf_size);
+
 			Session_component *session = new (md_alloc())
-				Session_component(ds_cap, _table.partition(num),
+				Session_component(ds_cap, slice, _table.partition(num),
 				                  _env.ep(), _env.rm(), _driver,
 				                  writeable);
 
-			log("session opened at partition ", num, " for '", label_str, "'");
+			log("session opened at partition ", num, " for '", label_str, "'",
+			    slice ? " (zero copy)" : "");
 			return session;
 		}
 
@@ -19,8 +19,11 @@
 #include <base/signal.h>
 #include <base/tslab.h>
 #include <base/heap.h>
-#include <util/list.h>
+#include <util/fifo.h>
+#include <util/reconstructible.h>
 #include <block_session/connection.h>
+#include <rm_session/connection.h>
+#include <region_map/client.h>
 
 namespace Block {
 	class Block_dispatcher;
@@ -32,14 +35,22 @@ class Block::Block_dispatcher
 {
 	public:
 
-		virtual void dispatch(Packet_descriptor&, Packet_descriptor&) = 0;
+		/**
+		 * Complete request of a client
+		 *
+		 * \param copy  true if the payload resides in the back-end buffer
+		 *              and must be copied for read requests
+		 */
+		virtual void dispatch(Packet_descriptor &request,
+		                      Packet_descriptor &reply, bool copy) = 0;
 };
 
 
 bool operator== (const Block::Packet_descriptor& p1,
                  const Block::Packet_descriptor& p2)
 {
-	return p1.operation()    == p2.operation()    &&
+	return p1.offset()       == p2.offset()       &&
+	       p1.operation()    == p2.operation()    &&
 	       p1.block_number() == p2.block_number() &&
 	       p1.block_count()  == p2.block_count();
 }
@@ -49,38 +60,90 @@ class Block::Driver
 {
 	public:
 
-	class Request : public Genode::List<Request>::Element
+	/**
+	 * Region of the back-end packet buffer used as a client's buffer
+	 *
+	 * The client's packet buffer is a managed dataspace that maps the
+	 * slice. Hence, requests can be passed to the back end without copying
+	 * the payload. The slice remains reserved as long as requests that refer
+	 * to it are in flight.
+	 */
+	class Slice
 	{
 		private:
 
-			Block_dispatcher &_dispatcher;
+			friend class Driver;
+
+			Genode::addr_t              const _offset;
+			Genode::size_t              const _size;
+			Genode::Capability<Genode::Region_map> _rm_cap;
+
+			unsigned _users = 1; /* client session and requests in flight */
+
+			Slice(Genode::addr_t offset, Genode::size_t size,
+			      Genode::Capability<Genode::Region_map> rm_cap)
+			: _offset(offset), _size(size), _rm_cap(rm_cap) { }
+
+		public:
+
+			Genode::addr_t offset() const { return _offset; }
+			Genode::size_t size()   const { return _size;   }
+
+			Genode::Dataspace_capability dataspace() {
+				return Genode::Region_map_client(_rm_cap).dataspace(); }
+	};
+
+	class Request : public Genode::Fifo<Request>::Element
+	{
+		private:
+
+			Block_dispatcher *_dispatcher;
 			Packet_descriptor _cli;
 			Packet_descriptor _srv;
+			Slice            *_slice;
 
 		public:
 
 			Request(Block_dispatcher &d,
 			        Packet_descriptor &cli,
-			        Packet_descriptor &srv)
-			: _dispatcher(d), _cli(cli), _srv(srv) {}
+			        Packet_descriptor &srv,
+			        Slice             *slice)
+			: _dispatcher(&d), _cli(cli), _srv(srv), _slice(slice) {}
+
+			bool matches(Packet_descriptor const &reply) const {
+				return reply == _srv; }
 
-			bool handle(Packet_descriptor& reply)
+			void handle(Packet_descriptor& reply)
 			{
-				bool ret =  reply == _srv;
-				if (ret) _dispatcher.dispatch(_cli, reply);
-				return ret;
+				if (_dispatcher)
+					_dispatcher->dispatch(_cli, reply, !_slice);
 			}
 
+			Slice *slice() { return _slice; }
+
 			bool same_dispatcher(Block_dispatcher &same) {
-				return &same == &_dispatcher; }
+				return &same == _dispatcher; }
+
+			/**
+			 * Drop reply of the request, the client is gone
+			 */
+			void orphan() { _dispatcher = nullptr; }
 	};
 
 	private:
 
-		enum { BLK_SZ = Session::TX_QUEUE_SIZE*sizeof(Request) };
+		enum {
+			BLK_SZ             = Session::TX_QUEUE_SIZE*sizeof(Request),
+			DEFAULT_IO_BUFFER  = 4 * 1024 * 1024,
+			SLICE_ALIGN_LOG2   = 12,
+
+			/* alignment of packets allocated via 'dma_alloc_packet' */
+			DMA_ALIGN_LOG2     = 11,
+		};
 
+		Genode::Heap                  &_heap;
 		Genode::Tslab<Request, BLK_SZ> _r_slab;
-		Genode::List<Request>          _r_list;
+		Genode::Fifo<Request>          _r_fifo;
 		Genode::Allocator_avl          _block_alloc;
 		Block::Connection              _session;
 		Block::sector_t                _blk_cnt;
@@ -89,36 +152,68 @@ class Block::Driver
 		Genode::Signal_handler<Driver> _source_submit;
 		Block::Session::Operations     _ops;
 
+		Genode::Constructible<Genode::Rm_connection> _rm;
+
 		void _ready_to_submit();
 
+		void _release(Slice &slice)
+		{
+			if (--slice._users)
+				return;
+
+			_rm->destroy(slice._rm_cap);
+			_block_alloc.free((void *)slice._offset, slice._size);
+			Genode::destroy(&_heap, &slice);
+		}
+
 		void _ack_avail()
 		{
 			/* check for acknowledgements */
 			while (_session.tx()->ack_avail()) {
 				Packet_descriptor p = _session.tx()->get_acked_packet();
-				for (Request *r = _r_list.first(); r; r = r->next()) {
-					if (r->handle(p)) {
-						_r_list.remove(r);
-						Genode::destroy(&_r_slab, r);
-						break;
-					}
+
+				/* requests are mostly completed in order */
+				Request *r = _r_fifo.head();
+				for (; r && !r->matches(p); r = r->next());
+
+				if (r) {
+					_r_fifo.remove(r);
+					r->handle(p);
 				}
-				_session.tx()->release_packet(p);
+
+				/* the payload of zero-copy requests belongs to a slice */
+				if (r && r->slice())
+					_release(*r->slice());
+				else
+					_session.tx()->release_packet(p);
+
+				if (r)
+					Genode::destroy(&_r_slab, r);
 			}
 
 			_ready_to_submit();
 		}
 
+		static Genode::size_t _io_buffer_size(Genode::Xml_node config)
+		{
+			return config.attribute_value("io_buffer",
+			                              Genode::Number_of_bytes(DEFAULT_IO_BUFFER));
+		}
+
 	public:
 
-		Driver(Genode::Env &env, Genode::Heap &heap)
-		: _r_slab(&heap),
+		Driver(Genode::Env &env, Genode::Heap &heap, Genode::Xml_node config)
+		: _heap(heap),
+		  _r_slab(&heap),
 		  _block_alloc(&heap),
-		  _session(env, &_block_alloc, 4 * 1024 * 1024),
+		  _session(env, &_block_alloc, _io_buffer_size(config)),
 		  _source_ack(env.ep(), *this, &Driver::_ack_avail),
 		  _source_submit(env.ep(), *this, &Driver::_ready_to_submit)
 		{
 			_session.info(&_blk_cnt, &_blk_size, &_ops);
+
+			if (config.attribute_value("zero_copy", false))
+				_rm.construct(env);
 		}
 
 		Genode::size_t blk_size() { return _blk_size; }
@@ -134,8 +229,47 @@ class Block::Driver
 
 		static Driver& driver();
 
+		/**
+		 * Reserve part of the back-end buffer as client buffer
+		 *
+		 * \return slice, or nullptr if zero-copy operation is disabled or
+		 *         the back-end buffer is exhausted
+		 */
+		Slice *alloc_slice(Genode::size_t size)
+		{
+			if (!_rm.constructed())
+				return nullptr;
+
+			size = Genode::align_addr(size, SLICE_ALIGN_LOG2);
+
+			void *offset = nullptr;
+			if (_block_alloc.alloc_aligned(size, &offset, SLICE_ALIGN_LOG2).error())
+				return nullptr;
+
+			Genode::Capability<Genode::Region_map> rm_cap;
+			try {
+				rm_cap = _rm->create(size);
+				Genode::Region_map_client(rm_cap).attach(_session.tx()->dataspace(),
+				                                         size, (Genode::addr_t)offset);
+				return new (&_heap) Slice((Genode::addr_t)offset, size, rm_cap);
+
+			} catch (...) {
+				Genode::warning("could not map back-end buffer, fall back to copying");
+				if (rm_cap.valid())
+					_rm->destroy(rm_cap);
+				_block_alloc.free(offset, size);
+				return nullptr;
+			}
+		}
+
+		/**
+		 * Release slice of a closed client session
+		 */
+		void free_slice(Slice &slice) { _release(slice); }
+
 		void io(bool write, sector_t nr, Genode::size_t cnt, void* addr,
-		        Block_dispatcher &dispatcher, Packet_descriptor& cli)
+		        Block_dispatcher &dispatcher, Packet_descriptor& cli,
+		        Slice *slice = nullptr)
 		{
 			if (!_session.tx()->ready_to_submit())
 				throw Block::Session::Tx::Source::Packet_alloc_failed();
@@ -144,12 +278,26 @@ class Block::Driver
 			    ? Block::Packet_descriptor::WRITE
 			    : Block::Packet_descriptor::READ;
 			Genode::size_t size = _blk_size * cnt;
-			Packet_descriptor p(_session.dma_alloc_packet(size),
-			                    op,  nr, cnt);
-			Request *r = new (&_r_slab) Request(dispatcher, cli, p);
-			_r_list.insert(r);
 
-			if (write)
+			/*
+			 * Requests within a slice are passed as is, provided their
+			 * payload is aligned like packets allocated by ourself.
+			 */
+			Genode::addr_t const offset = slice ? slice->offset() + cli.offset() : 0;
+			if (slice && (offset & ((1UL << DMA_ALIGN_LOG2) - 1)))
+				slice = nullptr;
+
+			Packet_descriptor p = slice
+				? Packet_descriptor(Packet_descriptor(offset, size), op, nr, cnt)
+				: Packet_descriptor(_session.dma_alloc_packet(size), op, nr, cnt);
+
+			if (slice)
+				slice->_users++;
+
+			Request *r = new (&_r_slab) Request(dispatcher, cli, p, slice);
+			_r_fifo.enqueue(r);
+
+			if (write && !slice)
 				Genode::memcpy(_session.tx()->packet_content(p),
 				               addr, size);
 
@@ -158,18 +306,10 @@ class Block::Driver
 
 		void remove_dispatcher(Block_dispatcher &dispatcher)
 		{
-			for (Request *r = _r_list.first(); r;) {
-				if (!r->same_dispatcher(dispatcher)) {
-					r = r->next();
-					continue;
-				}
-
-				Request *remove = r;
-				r = r->next();
-
-				_r_list.remove(remove);
-				Genode::destroy(&_r_slab, remove);
-			}
+			/* keep requests until acknowledged to retain their buffers */
+			for (Request *r = _r_fifo.head(); r; r = r->next())
+				if (r->same_dispatcher(dispatcher))
+					r->orphan();
 		}
 };
 
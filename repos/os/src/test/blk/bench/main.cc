@@ -3,6 +3,11 @@
  * \author Sebastian Sumpf
  * \author Stefan Kalkowski
  * \date   2015-03-24
+ *
+ * The benchmark reads (and optionally writes) a configurable amount of data
+ * in requests of a configurable size, similar to 'dd'. Example config:
+ *
+ * ! <config request_size="64K" test_size="256M" queue_depth="32" write="yes"/>
  */
 
 /*
@@ -13,21 +18,16 @@
  */
 
 #include <base/allocator_avl.h>
+#include <base/attached_rom_dataspace.h>
 #include <base/component.h>
 #include <base/heap.h>
 #include <base/log.h>
 #include <block_session/connection.h>
 #include <timer_session/connection.h>
+#include <util/string.h>
 
 using namespace Genode;
 
-enum {
-	TEST_WRITE   = false,
-	TEST_SIZE    = 1024 * 1024 * 1024,
-	REQUEST_SIZE = 8 * 512,
-	TX_BUFFER    = Block::Session::TX_QUEUE_SIZE * REQUEST_SIZE
-};
-
 
 class Throughput
 {
@@ -35,10 +35,28 @@ class Throughput
 
 		typedef Genode::size_t size_t;
 
-		Env &             _env;
+		Env &                  _env;
+		Attached_rom_dataspace _config  { _env, "config" };
+
+		size_t const _request_size {
+			_config.xml().attribute_value("request_size",
+			                              Number_of_bytes(8 * 512)) };
+
+		uint64_t const _test_size {
+			_config.xml().attribute_value("test_size",
+			                              Number_of_bytes(1024 * 1024 * 1024)) };
+
+		unsigned const _queue_depth {
+			max(1U, min(_config.xml().attribute_value("queue_depth",
+			                                          (unsigned)Block::Session::TX_QUEUE_SIZE),
+			            (unsigned)Block::Session::TX_QUEUE_SIZE)) };
+
+		bool const _test_write {
+			_config.xml().attribute_value("write", false) };
+
 		Heap              _heap    { _env.ram(), _env.rm() };
 		Allocator_avl     _alloc   { &_heap };
-		Block::Connection _session { _env, &_alloc, TX_BUFFER };
+		Block::Connection _session { _env, &_alloc, _queue_depth * _request_size };
 		Timer::Connection _timer   { _env };
 
 		Signal_handler<Throughput> _disp_ack    { _env.ep(), *this,
@@ -50,27 +68,30 @@ class Throughput
 
 		unsigned long   _start = 0;
 		unsigned long   _stop  = 0;
-		size_t          _bytes = 0;
+		uint64_t        _bytes = 0;
 		Block::sector_t _current = 0;
+		unsigned        _in_fly  = 0;
 
 		size_t          _blk_size;
 		Block::sector_t _blk_count;
 
 		void _submit()
 		{
-			static size_t count = REQUEST_SIZE / _blk_size;
+			size_t const count = _request_size / _blk_size;
 
-			if (_read_done && (_write_done || !TEST_WRITE))
+			if (_read_done && (_write_done || !_test_write))
 				return;
 
 			try {
-				while (_session.tx()->ready_to_submit()) {
+				while (_session.tx()->ready_to_submit()
+				    && _in_fly < _queue_depth) {
 					Block::Packet_descriptor p(
-						_session.tx()->alloc_packet(REQUEST_SIZE),
+						_session.tx()->alloc_packet(_request_size),
 						!_read_done ? Block::Packet_descriptor::READ : Block::Packet_descriptor::WRITE,
 						_current, count);
 
 					_session.tx()->submit_packet(p);
+					_in_fly++;
 
 					/* increment for next read */
 					_current += count;
@@ -93,9 +114,10 @@ class Throughput
 					_bytes += p.size();
 
 				_session.tx()->release_packet(p);
+				_in_fly--;
 			}
 
-			if (_bytes >= TEST_SIZE) {
+			if (_bytes >= _test_size) {
 				_finish();
 				return;
 			}
@@ -105,7 +127,7 @@ class Throughput
 
 		void _finish()
 		{
-			if (_read_done && (_write_done || !TEST_WRITE))
+			if (_read_done && (_write_done || !_test_write))
 				return;
 
 			_stop = _timer.elapsed_ms();
@@ -120,11 +142,11 @@ class Throughput
 				_start      = _timer.elapsed_ms();
 				_bytes      = 0;
 				_current    = 0;
-				if (TEST_WRITE)
+				if (_test_write)
 					_submit();
 				else
 					log("Done");
-			} else if (!_write_done && TEST_WRITE) {
+			} else if (!_write_done && _test_write) {
 				_write_done = true;
 				log("Done");
 			}
@@ -142,7 +164,16 @@ class Throughput
 			_session.info(&_blk_count, &_blk_size, &blk_ops);
 
 			warning("block count ", _blk_count, " size ", _blk_size);
-			log("read/write ", TEST_SIZE / 1024, " KiB ...");
+
+			if (!_request_size || _request_size % _blk_size) {
+				error("request size ", _request_size, " is not a multiple "
+				      "of the block size");
+				throw Exception();
+			}
+
+			log("read", _test_write ? "/write " : " ", _test_size / 1024,
+			    " KiB in requests of ", _request_size, " bytes, queue depth ",
+			    _queue_depth, " ...");
 			_start = _timer.elapsed_ms();
 			_submit();
 		}
@@ -0,0 +1,212 @@
+/*
+ * \brief  Test of the internet checksum
+ * \author Martin Stein
+ * \date   2017-12-21
+ *
+ * The test compares 'checksum_add' and 'checksum_finish' as well as the
+ * IPv4, TCP, and UDP checksums with a plain implementation of RFC 1071
+ * for various sizes and alignments of the checksummed data.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/log.h>
+#include <net/internet_checksum.h>
+#include <net/ipv4.h>
+#include <net/tcp.h>
+#include <net/udp.h>
+
+using namespace Genode;
+using namespace Net;
+
+
+/**
+ * Reference implementation of RFC 1071
+ *
+ * Sums up 16-bit words in network byte order, one at a time.
+ *
+ * \return  checksum in host byte order
+ */
+static uint16_t reference(uint8_t const *data, size_t size, uint32_t sum = 0)
+{
+	for (size_t i = 0; i + 1 < size; i += 2)
+		sum += data[i] << 8 | data[i + 1];
+
+	if (size & 1)
+		sum += data[size - 1] << 8;
+
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return (uint16_t)~sum;
+}
+
+
+/**
+ * Return checksum field value in host byte order
+ */
+static uint16_t from_field(uint16_t field)
+{
+	uint8_t const *bytes = (uint8_t const *)&field;
+	return bytes[0] << 8 | bytes[1];
+}
+
+
+struct Main
+{
+	enum { MAX_SIZE = 1600, MAX_OFFSET = 8 };
+
+	uint8_t  _buf[MAX_SIZE + MAX_OFFSET + 64];
+	uint32_t _seed = 1;
+	unsigned _checks = 0;
+	bool     _failed = false;
+
+	uint8_t _random()
+	{
+		_seed = _seed * 1103515245 + 12345;
+		return (uint8_t)(_seed >> 16);
+	}
+
+	void _fill(uint8_t *data, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+			data[i] = _random();
+	}
+
+	void _check(char const *what, size_t size, unsigned offset,
+	            uint16_t result, uint16_t expected)
+	{
+		_checks++;
+		if (result == expected)
+			return;
+
+		error(what, " of size ", size, " at offset ", offset, ": got ",
+		      Hex(result), ", expected ", Hex(expected));
+		_failed = true;
+	}
+
+	void _test_checksum(size_t size, unsigned offset)
+	{
+		uint8_t *data = _buf + offset;
+		_fill(data, size);
+
+		uint16_t const expected = reference(data, size);
+
+		_check("checksum", size, offset,
+		       from_field(checksum_finish(checksum_add(0, data, size))),
+		       expected);
+
+		/* sum up in two parts, the first being of even size */
+		size_t const first = (size / 3) & ~(size_t)1;
+		_check("split checksum", size, offset,
+		       from_field(checksum_finish(checksum_add(checksum_add(0, data, first),
+		                                               data + first, size - first))),
+		       expected);
+	}
+
+	/**
+	 * Return reference sum of the IPv4 pseudo header
+	 */
+	static uint32_t _pseudo_header(Ipv4_address const &src,
+	                               Ipv4_address const &dst,
+	                               uint8_t protocol, size_t size)
+	{
+		uint32_t sum = 0;
+		for (unsigned i = 0; i < Ipv4_packet::ADDR_LEN; i += 2)
+			sum += (src.addr[i] << 8 | src.addr[i + 1])
+			     + (dst.addr[i] << 8 | dst.addr[i + 1]);
+
+		return sum + protocol + (uint32_t)size;
+	}
+
+	void _test_ipv4(unsigned offset)
+	{
+		uint8_t *data = _buf + offset;
+		_fill(data, sizeof(Ipv4_packet));
+
+		Ipv4_packet &ip = *new (data) Ipv4_packet(sizeof(Ipv4_packet));
+
+		/* the checksum field is excluded from the calculation */
+		data[10] = data[11] = 0;
+		uint16_t const expected = reference(data, sizeof(Ipv4_packet));
+		_fill(data + 10, 2);
+
+		_check("IPv4 checksum", sizeof(Ipv4_packet), offset,
+		       Ipv4_packet::calculate_checksum(ip), expected);
+	}
+
+	void _test_udp(size_t size, unsigned offset)
+	{
+		uint8_t *data = _buf + offset;
+		_fill(data, size);
+
+		Ipv4_address src, dst;
+		_fill(src.addr, Ipv4_packet::ADDR_LEN);
+		_fill(dst.addr, Ipv4_packet::ADDR_LEN);
+
+		Udp_packet &udp = *new (data) Udp_packet(size);
+		udp.length(size);
+
+		data[6] = data[7] = 0;
+		uint16_t const expected =
+			reference(data, size, _pseudo_header(src, dst, 17, size));
+
+		udp.update_checksum(src, dst);
+		_check("UDP checksum", size, offset, udp.checksum(), expected);
+	}
+
+	void _test_tcp(size_t size, unsigned offset)
+	{
+		uint8_t *data = _buf + offset;
+		_fill(data, size);
+
+		Ipv4_address src, dst;
+		_fill(src.addr, Ipv4_packet::ADDR_LEN);
+		_fill(dst.addr, Ipv4_packet::ADDR_LEN);
+
+		Tcp_packet &tcp = *new (data) Tcp_packet(size);
+
+		data[16] = data[17] = 0;
+		uint16_t const expected =
+			reference(data, size, _pseudo_header(src, dst, 6, size));
+
+		tcp.update_checksum(src, dst, size);
+		_check("TCP checksum", size, offset, tcp.checksum(), expected);
+	}
+
+	Main(Env &env)
+	{
+		log("--- internet checksum test ---");
+
+		for (unsigned offset = 0; offset < MAX_OFFSET; offset++) {
+
+			for (size_t size = 0; size <= 70; size++)
+				_test_checksum(size, offset);
+
+			for (size_t size = 71; size <= MAX_SIZE; size += 37)
+				_test_checksum(size, offset);
+
+			_test_ipv4(offset);
+
+			for (size_t size = sizeof(Udp_packet); size <= MAX_SIZE; size += 13)
+				_test_udp(size, offset);
+
+			for (size_t size = sizeof(Tcp_packet); size <= MAX_SIZE; size += 13)
+				_test_tcp(size, offset);
+		}
+
+		log(_checks, " checks ", _failed ? "failed" : "succeeded");
+		log("--- internet checksum test ", _failed ? "failed" : "finished", " ---");
+		env.parent().exit(_failed ? -1 : 0);
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
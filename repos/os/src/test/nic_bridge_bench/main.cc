@@ -0,0 +1,222 @@
+/*
+ * \brief  Forwarding benchmark for the NIC bridge with many clients
+ * \author Stefan Kalkowski
+ * \date   2017-11-23
+ *
+ * The test opens a configurable number of NIC sessions at the bridge.
+ * Each client sends unicast frames to the MAC address of its successor,
+ * which lets the bridge look up a different destination for each client.
+ * Optionally, every n-th frame is sent as broadcast to measure the cost
+ * of the fan-out.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/log.h>
+#include <base/heap.h>
+#include <base/allocator_avl.h>
+#include <nic_session/connection.h>
+#include <nic/packet_allocator.h>
+#include <timer_session/connection.h>
+#include <net/ethernet.h>
+#include <net/ipv4.h>
+#include <util/list.h>
+
+namespace Test {
+	struct Client;
+	struct Main;
+
+	using namespace Genode;
+	using namespace Net;
+}
+
+
+struct Test::Client : List<Client>::Element
+{
+	enum {
+		WINDOW   = 16,
+		BUF_SIZE = Nic::Packet_allocator::DEFAULT_PACKET_SIZE * WINDOW * 2,
+	};
+
+	Allocator_avl   _tx_block_alloc;
+	Nic::Connection _nic;
+
+	Signal_handler<Client> _handler;
+
+	Mac_address const _mac { _nic.mac_address() };
+	Mac_address       _dst { };
+
+	size_t   const _packet_size;
+	unsigned const _broadcast_interval;
+
+	unsigned      _sent      { 0 };
+	unsigned long _received  { 0 };
+	bool          _running   { false };
+
+	void _fill(char *content, bool broadcast)
+	{
+		Ethernet_frame &eth = *new (content) Ethernet_frame();
+		eth.dst(broadcast ? Ethernet_frame::BROADCAST : _dst);
+		eth.src(_mac);
+		eth.type(Ethernet_frame::Type::IPV4);
+
+		/* IPv4 header without any transport protocol the bridge inspects */
+		Ipv4_packet &ip = *new (eth.data<void>())
+			Ipv4_packet(_packet_size - sizeof(Ethernet_frame));
+		ip.header_length(sizeof(Ipv4_packet) / 4);
+		ip.version(4);
+		ip.total_length(_packet_size - sizeof(Ethernet_frame));
+		ip.time_to_live(64);
+		ip.protocol(Ipv4_packet::Protocol::TCP);
+	}
+
+	void _handle()
+	{
+		while (_nic.tx()->ack_avail())
+			_nic.tx()->release_packet(_nic.tx()->get_acked_packet());
+
+		while (_nic.rx()->packet_avail() && _nic.rx()->ready_to_ack()) {
+			_nic.rx()->acknowledge_packet(_nic.rx()->get_packet());
+			_received++;
+		}
+
+		while (_running && _nic.tx()->ready_to_submit()) {
+			Nic::Packet_descriptor packet;
+			try { packet = _nic.tx()->alloc_packet(_packet_size); }
+			catch (Nic::Session::Tx::Source::Packet_alloc_failed) { break; }
+
+			bool const broadcast = _broadcast_interval
+			                    && !(++_sent % _broadcast_interval);
+
+			_fill(_nic.tx()->packet_content(packet), broadcast);
+			_nic.tx()->submit_packet(packet);
+		}
+	}
+
+	Client(Env &env, Allocator &alloc, char const *label,
+	       size_t packet_size, unsigned broadcast_interval)
+	:
+		_tx_block_alloc(&alloc),
+		_nic(env, &_tx_block_alloc, BUF_SIZE, BUF_SIZE, label),
+		_handler(env.ep(), *this, &Client::_handle),
+		_packet_size(packet_size), _broadcast_interval(broadcast_interval)
+	{
+		_nic.tx_channel()->sigh_ready_to_submit(_handler);
+		_nic.tx_channel()->sigh_ack_avail      (_handler);
+		_nic.rx_channel()->sigh_ready_to_ack   (_handler);
+		_nic.rx_channel()->sigh_packet_avail   (_handler);
+	}
+
+	Mac_address mac() const { return _mac; }
+
+	void start(Mac_address dst)
+	{
+		_dst     = dst;
+		_running = true;
+		_handle();
+	}
+
+	void stop() { _running = false; }
+
+	unsigned long received() const { return _received; }
+};
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	unsigned const _num_clients {
+		_config.xml().attribute_value("clients", 200U) };
+
+	unsigned const _duration_ms {
+		_config.xml().attribute_value("duration_ms", 10000U) };
+
+	size_t const _packet_size {
+		max(min(_config.xml().attribute_value("packet_size", (size_t)128),
+		        (size_t)Nic::Packet_allocator::DEFAULT_PACKET_SIZE),
+		    (size_t)Ethernet_frame::MIN_SIZE) };
+
+	unsigned const _broadcast_interval {
+		_config.xml().attribute_value("broadcast_interval", 0U) };
+
+	Heap              _heap  { _env.ram(), _env.rm() };
+	Timer::Connection _timer { _env };
+	List<Client>      _clients { };
+
+	unsigned long _start_ms      { 0 };
+	unsigned long _last_ms       { 0 };
+	unsigned long _last_received { 0 };
+
+	Signal_handler<Main> _timer_handler { _env.ep(), *this, &Main::_handle_timer };
+
+	unsigned long _received() const
+	{
+		unsigned long sum = 0;
+		for (Client const *c = _clients.first(); c; c = c->next())
+			sum += c->received();
+		return sum;
+	}
+
+	void _handle_timer()
+	{
+		unsigned long const now      = _timer.elapsed_ms();
+		unsigned long const received = _received();
+
+		if (now > _last_ms)
+			log("forwarded ", (received - _last_received) * 1000 / (now - _last_ms),
+			    " packets/s");
+
+		_last_ms       = now;
+		_last_received = received;
+
+		if (now - _start_ms < _duration_ms)
+			return;
+
+		for (Client *c = _clients.first(); c; c = c->next())
+			c->stop();
+
+		log("forwarded ", received, " packets in ", now - _start_ms, " ms (",
+		    received * 1000 / max(now - _start_ms, 1UL), " packets/s)");
+		log("--- finished NIC bridge benchmark ---");
+		_env.parent().exit(0);
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- NIC bridge benchmark ---");
+		log("clients: ", _num_clients, " packet size: ", _packet_size,
+		    " broadcast interval: ", _broadcast_interval);
+
+		Client *last = nullptr;
+		for (unsigned i = 0; i < _num_clients; i++) {
+			String<32> const label("client_", i);
+			Client *c = new (_heap) Client(_env, _heap, label.string(),
+			                               _packet_size, _broadcast_interval);
+			_clients.insert(c, last);
+			last = c;
+		}
+
+		_timer.sigh(_timer_handler);
+		_timer.trigger_periodic(1000 * 1000);
+		_start_ms = _last_ms = _timer.elapsed_ms();
+
+		/* each client sends to its successor, the last one to the first */
+		for (Client *c = _clients.first(); c; c = c->next()) {
+			Client const *dst = c->next() ? c->next() : _clients.first();
+			c->start(dst->mac());
+		}
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
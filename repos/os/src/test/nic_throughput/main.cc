@@ -0,0 +1,421 @@
+/*
+ * \brief  Throughput test for NIC sessions
+ * \author Stefan Kalkowski
+ * \date   2017-11-22
+ *
+ * The test floods the NIC session with UDP packets for a configurable
+ * duration and counts the acknowledged and received packets. Packets are
+ * spread over several flows by varying the UDP source port, which allows
+ * drivers to distribute them over multiple queues.
+ *
+ * When connected to a loop-back service, each sent packet is received
+ * again. When connected to a NIC driver, only the packets injected by the
+ * peer of the driver are received.
+ *
+ * With the 'queues' attribute set, the test requests multiple queue pairs
+ * for the session and serves each pair by a dedicated entrypoint. Each
+ * flow is always sent via the same queue.
+ *
+ * The test answers ARP requests for its source IP address. Hence, it can
+ * also be used as peer of a router.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/*
+ * Needs to be included first because otherwise
+ * util/xml_node.h will not pick up the ascii_to
+ * overloads.
+ */
+#include <nic/xml_node.h>
+#include <net/ipv4.h>
+
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/log.h>
+#include <base/heap.h>
+#include <base/allocator_avl.h>
+#include <base/entrypoint.h>
+#include <nic_session/connection.h>
+#include <nic/packet_allocator.h>
+#include <timer_session/connection.h>
+#include <net/ethernet.h>
+#include <net/udp.h>
+#include <net/arp.h>
+#include <util/reconstructible.h>
+
+namespace Test {
+	struct Counter;
+	struct Rate;
+	struct Traffic;
+	struct Worker;
+	struct Extra_queue;
+	struct Main;
+
+	using namespace Genode;
+	using namespace Net;
+}
+
+
+struct Test::Counter
+{
+	unsigned long packets { 0 };
+	unsigned long bytes   { 0 };
+
+	void count(size_t size) { packets++; bytes += size; }
+
+	void add(Counter const &other)
+	{
+		packets += other.packets;
+		bytes   += other.bytes;
+	}
+
+	Counter since(Counter const &earlier) const
+	{
+		Counter result;
+		result.packets = packets - earlier.packets;
+		result.bytes   = bytes   - earlier.bytes;
+		return result;
+	}
+};
+
+
+struct Test::Rate
+{
+	Counter const  counter;
+	unsigned long  ms;
+
+	Rate(Counter const &counter, unsigned long ms) : counter(counter), ms(ms) { }
+
+	void print(Output &out) const
+	{
+		if (!ms) return;
+
+		unsigned long const kbit =
+			(unsigned long)((Genode::uint64_t)counter.bytes * 8 / ms);
+
+		Genode::print(out, counter.packets, " packets, ",
+		              counter.packets * 1000 / ms, " packets/s, ",
+		              kbit / 1000, ".", (kbit % 1000) / 100, " Mbit/s");
+	}
+};
+
+
+/**
+ * Properties of the generated packets
+ */
+struct Test::Traffic
+{
+	size_t       const packet_size;
+	unsigned     const flows;
+	Mac_address  const dst_mac;
+	Mac_address  const src_mac;
+	Ipv4_address const src_ip;
+	Ipv4_address const dst_ip;
+
+	void fill(char *content, unsigned flow) const
+	{
+		enum { SRC_PORT_BASE = 50000, DST_PORT = 9 /* discard */ };
+
+		Ethernet_frame &eth = *new (content) Ethernet_frame();
+		eth.dst(dst_mac);
+		eth.src(src_mac);
+		eth.type(Ethernet_frame::Type::IPV4);
+
+		size_t const ip_size = packet_size - sizeof(Ethernet_frame);
+
+		Ipv4_packet &ip = *new (eth.data<void>()) Ipv4_packet(ip_size);
+		ip.header_length(sizeof(Ipv4_packet) / 4);
+		ip.version(4);
+		ip.diff_service(0);
+		ip.ecn(0);
+		ip.total_length(ip_size);
+		ip.identification(0);
+		ip.flags(0);
+		ip.fragment_offset(0);
+		ip.time_to_live(64);
+		ip.protocol(Ipv4_packet::Protocol::UDP);
+		ip.src(src_ip);
+		ip.dst(dst_ip);
+		ip.checksum(0);
+		ip.checksum(Ipv4_packet::calculate_checksum(ip));
+
+		Udp_packet &udp = *new (ip.data<void>()) Udp_packet(ip_size - sizeof(Ipv4_packet));
+		udp.src_port(Port(SRC_PORT_BASE + flow));
+		udp.dst_port(Port(DST_PORT));
+		udp.length(ip_size - sizeof(Ipv4_packet));
+		udp.update_checksum(src_ip, dst_ip);
+	}
+};
+
+
+/**
+ * Traffic generator and sink operating on one queue pair
+ *
+ * The counters are updated by the entrypoint of the worker and read by the
+ * main entrypoint without synchronization, which suffices for statistics.
+ */
+struct Test::Worker
+{
+	Traffic const &_traffic;
+
+	Nic::Session::Tx &_tx;
+	Nic::Session::Rx &_rx;
+
+	/* flows sent by this worker */
+	unsigned const _first_flow;
+	unsigned const _flow_stride;
+	unsigned       _flow = _first_flow;
+
+	Counter tx { }, rx { };
+
+	bool volatile done { false };
+
+	Signal_handler<Worker> _handler;
+
+	void _send()
+	{
+		Nic::Session::Tx::Source &source = *_tx.source();
+
+		while (source.ready_to_submit()) {
+			Nic::Packet_descriptor packet;
+			try { packet = source.alloc_packet(_traffic.packet_size); }
+			catch (Nic::Session::Tx::Source::Packet_alloc_failed) { return; }
+
+			_traffic.fill(source.packet_content(packet), _flow);
+			source.submit_packet(packet);
+
+			_flow += _flow_stride;
+			if (_flow >= _traffic.flows)
+				_flow = _first_flow;
+		}
+	}
+
+	/**
+	 * Answer ARP request for the source IP address of the traffic
+	 */
+	void _answer_arp(char *content, size_t size)
+	{
+		Nic::Session::Tx::Source &source = *_tx.source();
+
+		try {
+			Ethernet_frame &eth = *new (content) Ethernet_frame(size);
+			if (eth.type() != Ethernet_frame::Type::ARP)
+				return;
+
+			Arp_packet &arp = *new (eth.data<void>())
+				Arp_packet(size - sizeof(Ethernet_frame));
+
+			if (!arp.ethernet_ipv4() || arp.opcode() != Arp_packet::REQUEST
+			 || arp.dst_ip() != _traffic.src_ip || !source.ready_to_submit())
+				return;
+
+			/* turn request into reply */
+			arp.dst_ip(arp.src_ip());
+			arp.dst_mac(arp.src_mac());
+			eth.dst(eth.src());
+			arp.src_ip(_traffic.src_ip);
+			arp.src_mac(_traffic.src_mac);
+			eth.src(_traffic.src_mac);
+			arp.opcode(Arp_packet::REPLY);
+
+			Nic::Packet_descriptor const reply = source.alloc_packet(size);
+			memcpy(source.packet_content(reply), content, size);
+			source.submit_packet(reply);
+		}
+		catch (Ethernet_frame::No_ethernet_frame) { }
+		catch (Arp_packet::No_arp_packet) { }
+		catch (Nic::Session::Tx::Source::Packet_alloc_failed) { }
+	}
+
+	void _handle()
+	{
+		if (done)
+			return;
+
+		Nic::Session::Tx::Source &source = *_tx.source();
+		Nic::Session::Rx::Sink   &sink   = *_rx.sink();
+
+		while (source.ack_avail()) {
+			Nic::Packet_descriptor const packet = source.get_acked_packet();
+			tx.count(packet.size());
+			source.release_packet(packet);
+		}
+
+		while (sink.packet_avail() && sink.ready_to_ack()) {
+			Nic::Packet_descriptor const packet = sink.get_packet();
+			rx.count(packet.size());
+			_answer_arp(sink.packet_content(packet), packet.size());
+			sink.acknowledge_packet(packet);
+		}
+
+		_send();
+	}
+
+	/**
+	 * Constructor
+	 *
+	 * \param index  index of the queue pair
+	 * \param count  number of queue pairs
+	 */
+	Worker(Entrypoint &ep, Traffic const &traffic,
+	       Nic::Session::Tx &tx, Nic::Session::Rx &rx,
+	       unsigned index, unsigned count)
+	:
+		_traffic(traffic), _tx(tx), _rx(rx),
+		_first_flow(index % traffic.flows),
+		_flow_stride(min(count, traffic.flows)),
+		_handler(ep, *this, &Worker::_handle)
+	{
+		_tx.sigh_ready_to_submit(_handler);
+		_tx.sigh_ack_avail      (_handler);
+		_rx.sigh_ready_to_ack   (_handler);
+		_rx.sigh_packet_avail   (_handler);
+
+		/* start sending from within the entrypoint of the worker */
+		Signal_transmitter(_handler).submit();
+	}
+};
+
+
+/**
+ * Additional queue pair served by a dedicated entrypoint
+ */
+struct Test::Extra_queue
+{
+	enum { STACK_SIZE = 8*1024*sizeof(long) };
+
+	Entrypoint         _ep;
+	Allocator_avl      _tx_block_alloc;
+	Nic::Queue_client  _queue;
+	Worker             worker;
+
+	Extra_queue(Env &env, Allocator &alloc, Nic::Connection &nic,
+	            Traffic const &traffic, unsigned index, unsigned count)
+	:
+		_ep(env, STACK_SIZE, "queue_ep",
+		    env.cpu().affinity_space().location_of_index(index)),
+		_tx_block_alloc(&alloc),
+		_queue(nic, index, _tx_block_alloc, env.rm()),
+		worker(_ep, traffic, *_queue.tx_channel(), *_queue.rx_channel(),
+		       index, count)
+	{ }
+};
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	unsigned const _duration_ms;
+
+	Heap          _heap           { _env.ram(), _env.rm() };
+	Allocator_avl _tx_block_alloc { &_heap };
+
+	enum { BUF_SIZE = Nic::Packet_allocator::DEFAULT_PACKET_SIZE * 128 };
+
+	Nic::Connection   _nic;
+	Timer::Connection _timer { _env };
+
+	unsigned const _queues = _nic.queues();
+
+	Traffic const _traffic;
+
+	Worker _worker { _env.ep(), _traffic,
+	                 *_nic.tx_channel(), *_nic.rx_channel(), 0, _queues };
+
+	Constructible<Extra_queue> _extra_queues[Nic::Session::MAX_QUEUES];
+
+	unsigned long _start_ms    { 0 };
+	unsigned long _last_ms     { 0 };
+	bool          _done        { false };
+
+	Counter _last_tx { }, _last_rx { };
+
+	Signal_handler<Main> _timer_handler { _env.ep(), *this, &Main::_handle_timer };
+
+	template <typename FN>
+	void _for_each_worker(FN const &fn)
+	{
+		fn(_worker);
+		for (unsigned i = 1; i < _queues; i++)
+			fn(_extra_queues[i]->worker);
+	}
+
+	void _handle_timer()
+	{
+		if (_done)
+			return;
+
+		unsigned long const now = _timer.elapsed_ms();
+
+		Counter tx, rx;
+		_for_each_worker([&] (Worker const &worker) {
+			tx.add(worker.tx);
+			rx.add(worker.rx);
+		});
+
+		log("tx: ", Rate(tx.since(_last_tx), now - _last_ms));
+		log("rx: ", Rate(rx.since(_last_rx), now - _last_ms));
+
+		_last_tx = tx;
+		_last_rx = rx;
+		_last_ms = now;
+
+		if (now - _start_ms < _duration_ms)
+			return;
+
+		_done = true;
+		_for_each_worker([&] (Worker &worker) { worker.done = true; });
+
+		log("total tx: ", Rate(tx, now - _start_ms));
+		log("total rx: ", Rate(rx, now - _start_ms));
+		log("--- finished NIC throughput test ---");
+		_env.parent().exit(0);
+	}
+
+	template <typename T>
+	T _config_attr(char const *name, T const &default_value)
+	{
+		return _config.xml().attribute_value(name, default_value);
+	}
+
+	Main(Env &env)
+	:
+		_env(env),
+		_duration_ms(_config_attr("duration_ms", 10000U)),
+		_nic(_env, &_tx_block_alloc, BUF_SIZE, BUF_SIZE, "",
+		     _config_attr("queues", 1U)),
+		_traffic {
+			max(min(_config_attr("packet_size", (size_t)1514),
+			        (size_t)Nic::Packet_allocator::DEFAULT_PACKET_SIZE),
+			    sizeof(Ethernet_frame) + sizeof(Ipv4_packet) + sizeof(Udp_packet)),
+			max(_config_attr("flows", 1U), 1U),
+			_config_attr("dst_mac", Ethernet_frame::BROADCAST),
+			_nic.mac_address(),
+			_config_attr("src_ip", Ipv4_address()),
+			_config_attr("dst_ip", Ipv4_packet::BROADCAST) }
+	{
+		log("--- NIC throughput test ---");
+		log("packet size: ", _traffic.packet_size, " flows: ", _traffic.flows,
+		    " queues: ", _queues, " duration: ", _duration_ms, " ms");
+
+		for (unsigned i = 1; i < _queues; i++)
+			_extra_queues[i].construct(_env, _heap, _nic, _traffic, i, _queues);
+
+		_timer.sigh(_timer_handler);
+		_timer.trigger_periodic(1000 * 1000);
+
+		_start_ms = _last_ms = _timer.elapsed_ms();
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
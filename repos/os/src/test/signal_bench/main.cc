@@ -0,0 +1,107 @@
+/*
+ * \brief  Benchmark of the signal-dispatch cost depending on the number of contexts
+ * \author Norman Feske
+ * \date   2017-11-24
+ *
+ * For an increasing number of signal contexts managed by one receiver, the
+ * benchmark measures the round-trip time of submitting a signal and
+ * receiving it again. The signal is always submitted to the context that
+ * was registered first, which is the worst case for a linear lookup of the
+ * signal imprint.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <timer_session/connection.h>
+
+using namespace Genode;
+
+
+struct Context : Signal_context, List<Context>::Element { };
+
+
+struct Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Heap              _heap  { _env.ram(), _env.rm() };
+	Timer::Connection _timer { _env };
+	Signal_receiver   _receiver { };
+	List<Context>     _contexts { };
+	unsigned          _num_contexts { 0 };
+
+	unsigned const _rounds {
+		_config.xml().attribute_value("rounds", 10000U) };
+
+	unsigned const _max_contexts {
+		_config.xml().attribute_value("max_contexts", 4096U) };
+
+	void _add_contexts(unsigned num)
+	{
+		for (unsigned i = 0; i < num; i++) {
+			Context *c = new (_heap) Context();
+			_receiver.manage(c);
+			_contexts.insert(c);
+		}
+		_num_contexts += num;
+	}
+
+	void _measure(Signal_context_capability cap)
+	{
+		Signal_transmitter transmitter(cap);
+
+		unsigned long const start = _timer.elapsed_ms();
+
+		for (unsigned i = 0; i < _rounds; i++) {
+			transmitter.submit();
+			_receiver.wait_for_signal();
+		}
+
+		unsigned long const duration = _timer.elapsed_ms() - start;
+
+		log("contexts: ", _num_contexts, " rounds: ", _rounds,
+		    " duration: ", duration, " ms (",
+		    duration * 1000 * 1000 / _rounds, " ns per signal)");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- signal-dispatch benchmark ---");
+
+		/* the context to signal is registered first */
+		Context first;
+		Signal_context_capability const cap = _receiver.manage(&first);
+		_num_contexts = 1;
+
+		_measure(cap);
+
+		for (unsigned n = 16; n <= _max_contexts; n *= 4) {
+			_add_contexts(n - _num_contexts);
+			_measure(cap);
+		}
+
+		while (Context *c = _contexts.first()) {
+			_contexts.remove(c);
+			_receiver.dissolve(c);
+			destroy(_heap, c);
+		}
+		_receiver.dissolve(&first);
+
+		log("--- signal-dispatch benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
@@ -53,6 +53,11 @@ namespace Noux {
 			{
 				return call<Rpc_lookup_region_map>(addr);
 			}
+
+			Dataspace_capability pipe_buffer(int fd)
+			{
+				return call<Rpc_pipe_buffer>(fd);
+			}
 	};
 }
 
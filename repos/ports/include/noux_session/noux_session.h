@@ -88,6 +88,7 @@ namespace Noux {
 			SYSCALL_SYNC,
 			SYSCALL_KILL,
 			SYSCALL_GETDTABLESIZE,
+			SYSCALL_SPLICE,
 			SYSCALL_INVALID = -1
 		};
 
@@ -138,6 +139,7 @@ namespace Noux {
 			NOUX_DECL_SYSCALL_NAME(SYNC)
 			NOUX_DECL_SYSCALL_NAME(KILL)
 			NOUX_DECL_SYSCALL_NAME(GETDTABLESIZE)
+			NOUX_DECL_SYSCALL_NAME(SPLICE)
 			case SYSCALL_INVALID: return 0;
 			}
 			return 0;
@@ -161,6 +163,16 @@ namespace Noux {
 		 */
 		virtual int next_open_fd(int start_fd) = 0;
 
+		/**
+		 * Return shared buffer of the pipe referred to by 'fd'
+		 *
+		 * The dataspace contains a 'Pipe_ring'. By mapping it, a process
+		 * is able to transfer data through the pipe without a syscall.
+		 *
+		 * \return  invalid capability if 'fd' does not refer to a pipe
+		 */
+		virtual Dataspace_capability pipe_buffer(int fd) = 0;
+
 		/*********************
 		 ** RPC declaration **
 		 *********************/
@@ -170,9 +182,10 @@ namespace Noux {
 		           lookup_region_map, addr_t);
 		GENODE_RPC(Rpc_syscall, bool, syscall, Syscall);
 		GENODE_RPC(Rpc_next_open_fd, int, next_open_fd, int);
+		GENODE_RPC(Rpc_pipe_buffer, Dataspace_capability, pipe_buffer, int);
 
 		GENODE_RPC_INTERFACE(Rpc_sysio_dataspace, Rpc_lookup_region_map,
-		                     Rpc_syscall, Rpc_next_open_fd);
+		                     Rpc_syscall, Rpc_next_open_fd, Rpc_pipe_buffer);
 	};
 }
 
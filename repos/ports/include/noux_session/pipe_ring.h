@@ -0,0 +1,442 @@
+/*
+ * \brief  Pipe buffer shared between noux and its processes
+ * \author Norman Feske
+ * \date   2017-12-06
+ *
+ * The buffer of a pipe is located in a dataspace that processes can map to
+ * transfer data without a syscall. Each end of the ring has one index, the
+ * head advanced by the writing party and the tail advanced by the reading
+ * party. At each end, only one party is active at a time.
+ *
+ * Processes that share a pipe end serialize their accesses via a busy flag
+ * of the end. Noux never waits for this flag. Before accessing an end, noux
+ * raises a flag of its own. If a process is busy at the end, noux blocks
+ * the affected syscall instead. A process that finds the noux flag raised
+ * backs off and takes the syscall path.
+ *
+ * The ring is writable by the processes. Hence, noux keeps the capacity of
+ * the ring in its own memory, reads each index only once per operation,
+ * and checks the indices before copying any data. A ring with inconsistent
+ * indices is reported as 'Corrupt'.
+ *
+ * Noux marks a pipe end as waiting whenever it blocks a process at it. A
+ * process that accessed the ring clears the flags and, if one was set, lets
+ * noux wake up the blocked processes.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__NOUX_SESSION__PIPE_RING_H_
+#define _INCLUDE__NOUX_SESSION__PIPE_RING_H_
+
+#include <cpu/atomic.h>
+#include <cpu/memory_barrier.h>
+#include <util/misc_math.h>
+#include <util/string.h>
+
+namespace Noux { class Pipe_ring; }
+
+
+class Noux::Pipe_ring
+{
+	public:
+
+		enum {
+			DATA_OFFSET      = 4096,
+			MIN_CAPACITY     = 4096,
+			DEFAULT_CAPACITY = 64*1024,
+			MAX_CAPACITY     = 1024*1024,
+		};
+
+		/**
+		 * Exception type, the ring was replaced by a ring of another size
+		 */
+		class Retired { };
+
+		/**
+		 * Exception type, the indices of the ring are inconsistent
+		 */
+		class Corrupt { };
+
+		/**
+		 * Return ring capacity for the requested pipe size
+		 *
+		 * \return  0 if the size exceeds 'MAX_CAPACITY'
+		 */
+		static unsigned capacity_for(unsigned long size)
+		{
+			if (size > MAX_CAPACITY)
+				return 0;
+
+			unsigned capacity = MIN_CAPACITY;
+			while (capacity < size)
+				capacity <<= 1;
+
+			return capacity;
+		}
+
+		/**
+		 * Return true if 'capacity' is valid for a buffer of 'size' bytes
+		 */
+		static bool capacity_valid(unsigned capacity, Genode::size_t size)
+		{
+			return capacity >= MIN_CAPACITY && capacity <= MAX_CAPACITY
+			    && !(capacity & (capacity - 1))
+			    && DATA_OFFSET + capacity <= size;
+		}
+
+	private:
+
+		struct End
+		{
+			int volatile busy;     /* a process accesses the end */
+			int volatile noux;     /* noux accesses the end */
+			int volatile waiting;  /* noux blocks a process at the end */
+		};
+
+		End _writer { 0, 0, 0 };
+		End _reader { 0, 0, 0 };
+
+		/* number of bytes written and read, wrapping at 2^32 */
+		unsigned volatile _head = 0;
+		unsigned volatile _tail = 0;
+
+		int volatile _retired = 0;
+
+		/* capacity as announced to processes, not used by noux */
+		unsigned const _capacity;
+
+		char *_data() { return (char *)this + DATA_OFFSET; }
+
+		/**
+		 * Return number of used bytes for a snapshot of the indices
+		 *
+		 * \throw Corrupt
+		 */
+		static unsigned _used(unsigned head, unsigned tail, unsigned capacity)
+		{
+			unsigned const used = head - tail;
+			if (used > capacity)
+				throw Corrupt();
+
+			return used;
+		}
+
+		void _copy_in(unsigned capacity, unsigned pos,
+		              char const *src, Genode::size_t len)
+		{
+			unsigned       const offset = pos & (capacity - 1);
+			Genode::size_t const upper  = Genode::min(len, (Genode::size_t)(capacity - offset));
+
+			Genode::memcpy(_data() + offset, src, upper);
+			Genode::memcpy(_data(), src + upper, len - upper);
+		}
+
+		void _copy_out(unsigned capacity, unsigned pos,
+		               char *dst, Genode::size_t len)
+		{
+			unsigned       const offset = pos & (capacity - 1);
+			Genode::size_t const upper  = Genode::min(len, (Genode::size_t)(capacity - offset));
+
+			Genode::memcpy(dst, _data() + offset, upper);
+			Genode::memcpy(dst + upper, _data(), len - upper);
+		}
+
+		Genode::size_t _write(unsigned capacity, char const *src, Genode::size_t len)
+		{
+			unsigned       const head = _head;
+			unsigned       const used = _used(head, _tail, capacity);
+			Genode::size_t const n    = Genode::min(len, (Genode::size_t)(capacity - used));
+
+			_copy_in(capacity, head, src, n);
+
+			/* publish the data before advancing the head */
+			Genode::memory_barrier();
+			_head = head + n;
+
+			return n;
+		}
+
+		Genode::size_t _read(unsigned capacity, char *dst, Genode::size_t len)
+		{
+			unsigned       const tail = _tail;
+			unsigned       const used = _used(_head, tail, capacity);
+			Genode::size_t const n    = Genode::min(len, (Genode::size_t)used);
+
+			Genode::memory_barrier();
+			_copy_out(capacity, tail, dst, n);
+
+			/* finish reading before releasing the space */
+			Genode::memory_barrier();
+			_tail = tail + n;
+
+			return n;
+		}
+
+		/**
+		 * Clear flag
+		 *
+		 * \return true if the flag was set
+		 */
+		static bool _clear(int volatile &flag)
+		{
+			/* the atomic operation orders the flag after the index update */
+			return Genode::cmpxchg(&flag, 1, 0);
+		}
+
+		/**
+		 * Set flag
+		 */
+		static void _set(int volatile &flag)
+		{
+			/* the atomic operation orders the flag before the subsequent check */
+			Genode::cmpxchg(&flag, 0, 1);
+		}
+
+		/**
+		 * Access of a ring end by a process
+		 */
+		struct Process_guard
+		{
+			End &end;
+			bool entered = false;
+
+			Process_guard(End &end) : end(end)
+			{
+				/* serialize with other processes that share the pipe end */
+				while (!Genode::cmpxchg(&end.busy, 0, 1));
+
+				/* the atomic operation orders the check after the flag */
+				entered = !end.noux;
+			}
+
+			~Process_guard()
+			{
+				Genode::memory_barrier();
+				end.busy = 0;
+			}
+		};
+
+		/**
+		 * Raise noux flag of a ring end
+		 *
+		 * \return  true if no process accesses the end
+		 */
+		static bool _noux_enter(End &end)
+		{
+			_set(end.noux);
+			if (!end.busy)
+				return true;
+
+			/* let the process wake us up when leaving */
+			_set(end.waiting);
+			return !end.busy;
+		}
+
+		static void _noux_leave(End &end)
+		{
+			Genode::memory_barrier();
+			end.noux = 0;
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param capacity  power of two, the ring must be followed by
+		 *                  'capacity' bytes starting at 'DATA_OFFSET'
+		 */
+		Pipe_ring(unsigned capacity) : _capacity(capacity) { }
+
+
+		/*****************************
+		 ** Interface for processes **
+		 *****************************/
+
+		/**
+		 * Return capacity announced by noux
+		 *
+		 * A process must check the value with 'capacity_valid' when
+		 * mapping the ring.
+		 */
+		unsigned capacity() const { return _capacity; }
+
+		/**
+		 * Write to ring
+		 *
+		 * \param capacity  checked capacity of the ring
+		 *
+		 * \return  number of written bytes, 0 if the ring is full or if
+		 *          noux accesses the pipe end
+		 * \throw   Retired
+		 * \throw   Corrupt
+		 */
+		Genode::size_t write(unsigned capacity, char const *src, Genode::size_t len)
+		{
+			Process_guard guard(_writer);
+
+			if (!guard.entered)
+				return 0;
+
+			if (_retired)
+				throw Retired();
+
+			return _write(capacity, src, len);
+		}
+
+		/**
+		 * Read from ring
+		 *
+		 * \param capacity  checked capacity of the ring
+		 *
+		 * \return  number of read bytes, 0 if the ring is empty or if
+		 *          noux accesses the pipe end
+		 * \throw   Retired
+		 * \throw   Corrupt
+		 */
+		Genode::size_t read(unsigned capacity, char *dst, Genode::size_t len)
+		{
+			Process_guard guard(_reader);
+
+			if (!guard.entered)
+				return 0;
+
+			if (_retired)
+				throw Retired();
+
+			return _read(capacity, dst, len);
+		}
+
+		/**
+		 * Return true if noux must wake up blocked processes
+		 *
+		 * To be called after each access of the ring.
+		 */
+		bool noux_to_wake_up()
+		{
+			bool const reader = _clear(_reader.waiting);
+			bool const writer = _clear(_writer.waiting);
+
+			return reader || writer;
+		}
+
+
+		/************************
+		 ** Interface for noux **
+		 ************************/
+
+		/*
+		 * The 'capacity' arguments are the capacity as known by noux.
+		 */
+
+		/**
+		 * Obtain exclusive access to the writing end
+		 *
+		 * If a process accesses the end, it wakes up noux when leaving.
+		 *
+		 * \return  true if noux may access the end
+		 */
+		bool noux_enter_writer() { return _noux_enter(_writer); }
+		bool noux_enter_reader() { return _noux_enter(_reader); }
+
+		void noux_leave_writer() { _noux_leave(_writer); }
+		void noux_leave_reader() { _noux_leave(_reader); }
+
+		/**
+		 * Write to ring, noux must hold the writing end
+		 *
+		 * \throw Corrupt
+		 */
+		Genode::size_t noux_write(unsigned capacity, char const *src,
+		                          Genode::size_t len)
+		{
+			return _write(capacity, src, len);
+		}
+
+		/**
+		 * Read from ring, noux must hold the reading end
+		 *
+		 * \throw Corrupt
+		 */
+		Genode::size_t noux_read(unsigned capacity, char *dst, Genode::size_t len)
+		{
+			return _read(capacity, dst, len);
+		}
+
+		/**
+		 * Return number of bytes available for reading
+		 *
+		 * \throw Corrupt
+		 */
+		unsigned used(unsigned capacity) const
+		{
+			return _used(_head, _tail, capacity);
+		}
+
+		/**
+		 * Mark reader as blocked
+		 *
+		 * \return  true if data became available meanwhile
+		 * \throw   Corrupt
+		 */
+		bool reader_blocks(unsigned capacity)
+		{
+			_set(_reader.waiting);
+			return used(capacity) > 0;
+		}
+
+		/**
+		 * Mark writer as blocked
+		 *
+		 * \return  true if space became available meanwhile
+		 * \throw   Corrupt
+		 */
+		bool writer_blocks(unsigned capacity)
+		{
+			_set(_writer.waiting);
+			return used(capacity) < capacity;
+		}
+
+		/**
+		 * Return true if a blocked reader must be woken up after writing
+		 */
+		bool reader_to_wake_up() { return _clear(_reader.waiting); }
+
+		/**
+		 * Return true if a blocked writer must be woken up after reading
+		 */
+		bool writer_to_wake_up() { return _clear(_writer.waiting); }
+
+		/**
+		 * Move content to a ring of another size, noux must hold both ends
+		 *
+		 * Processes that access the ring afterwards get a 'Retired'
+		 * exception and must obtain the new ring.
+		 *
+		 * \return  false if the content does not fit into 'ring'
+		 * \throw   Corrupt
+		 */
+		bool retire(unsigned capacity, Pipe_ring &ring, unsigned ring_capacity)
+		{
+			unsigned const tail = _tail;
+			unsigned const used = _used(_head, tail, capacity);
+			if (used > ring_capacity)
+				return false;
+
+			Genode::memory_barrier();
+			_copy_out(capacity, tail, ring._data(), used);
+			ring._head = used;
+
+			Genode::memory_barrier();
+			_retired = 1;
+			return true;
+		}
+};
+
+#endif /* _INCLUDE__NOUX_SESSION__PIPE_RING_H_ */
@@ -155,7 +155,10 @@ struct Noux::Sysio
 	enum Fcntl_cmd {
 		FCNTL_CMD_GET_FILE_STATUS_FLAGS,
 		FCNTL_CMD_SET_FILE_STATUS_FLAGS,
-		FCNTL_CMD_SET_FD_FLAGS
+		FCNTL_CMD_SET_FD_FLAGS,
+		FCNTL_CMD_GET_PIPE_SIZE,
+		FCNTL_CMD_SET_PIPE_SIZE,
+		FCNTL_CMD_WAKE_UP_PIPE_PEER
 	};
 
 	/**
@@ -308,7 +311,8 @@ struct Noux::Sysio
 	 */
 	enum Clock_Id        { CLOCK_ID_SECOND };
 
-	enum Fcntl_error     { FCNTL_ERR_CMD_INVALID = Vfs::Directory_service::NUM_GENERAL_ERRORS };
+	enum Fcntl_error     { FCNTL_ERR_CMD_INVALID = Vfs::Directory_service::NUM_GENERAL_ERRORS,
+	                       FCNTL_ERR_BUSY, FCNTL_ERR_NO_PERM, FCNTL_ERR_NO_MEM };
 	enum Mkdir_error     { MKDIR_ERR_EXISTS,   MKDIR_ERR_NO_ENTRY,
 	                       MKDIR_ERR_NO_SPACE, MKDIR_ERR_NO_PERM,
 	                       MKDIR_ERR_NAME_TOO_LONG };
@@ -364,6 +368,9 @@ struct Noux::Sysio
 
 	enum Kill_error      { KILL_ERR_SRCH };
 
+	enum Splice_error    { SPLICE_ERR_INVALID, SPLICE_ERR_AGAIN,
+	                       SPLICE_ERR_INTERRUPT, SPLICE_ERR_IO };
+
 	union {
 		Vfs::Directory_service::General_error   general;
 		Vfs::Directory_service::Stat_result     stat;
@@ -394,6 +401,7 @@ struct Noux::Sysio
 		Wait4_error    wait4;
 		Kill_error     kill;
 		Fork_error     fork;
+		Splice_error   splice;
 
 	} error;
 
@@ -512,6 +520,9 @@ struct Noux::Sysio
 		SYSIO_DECL(kill,        { int pid; Signal sig; }, { });
 
 		SYSIO_DECL(getdtablesize, { }, { int n; });
+
+		SYSIO_DECL(splice,      { int fd_in; int fd_out; size_t count; },
+		                        { size_t count; });
 	};
 };
 
@@ -23,6 +23,7 @@
 
 /* noux includes */
 #include <noux_session/connection.h>
+#include <noux_session/pipe_ring.h>
 #include <noux_session/sysio.h>
 
 /* libc plugin includes */
@@ -56,6 +57,17 @@
 #undef DIOCGMEDIASIZE
 #define DIOCGMEDIASIZE _IOR('d', 129, int64_t)
 
+/*
+ * Linux-specific fcntl commands for adjusting the pipe size, which are
+ * not defined by the FreeBSD headers
+ */
+#ifndef F_SETPIPE_SZ
+#define F_SETPIPE_SZ 1031
+#endif
+#ifndef F_GETPIPE_SZ
+#define F_GETPIPE_SZ 1032
+#endif
+
 
 /* libc-internal includes */
 #include <libc_mem_alloc.h>
@@ -948,6 +960,194 @@ static Libc::Plugin_context *noux_context(int noux_fd)
 }
 
 
+/*
+ * Pipe buffers mapped into the local address space
+ *
+ * The buffer of a pipe is probed on the first read or write access to a
+ * file descriptor. For file descriptors that do not refer to a pipe, noux
+ * hands out an invalid capability.
+ */
+
+enum { MAX_PIPE_RING_FDS = 64 };
+
+struct Pipe_ring_slot
+{
+	bool             probed;
+	bool             write_end;
+	Noux::Pipe_ring *ring;
+	unsigned         capacity;  /* checked when mapping the ring */
+};
+
+static Pipe_ring_slot pipe_ring_slots[MAX_PIPE_RING_FDS];
+
+
+static Noux::Pipe_ring *pipe_ring(int fd, bool write_end)
+{
+	if (fd < 0 || fd >= MAX_PIPE_RING_FDS)
+		return nullptr;
+
+	Pipe_ring_slot &slot = pipe_ring_slots[fd];
+
+	if (!slot.probed) {
+		slot.probed = true;
+
+		Genode::Dataspace_capability ds_cap = noux()->pipe_buffer(fd);
+		if (!ds_cap.valid())
+			return nullptr;
+
+		sysio()->fcntl_in.fd  = fd;
+		sysio()->fcntl_in.cmd = Noux::Sysio::FCNTL_CMD_GET_FILE_STATUS_FLAGS;
+		if (!noux_syscall(Noux::Session::SYSCALL_FCNTL))
+			return nullptr;
+
+		slot.write_end = (sysio()->fcntl_out.result == Noux::Sysio::OPEN_MODE_WRONLY);
+
+		try { slot.ring = _env_ptr->rm().attach(ds_cap); }
+		catch (...) {
+			warning("could not map pipe buffer of fd ", fd);
+			return nullptr;
+		}
+
+		/* read the capacity only once, the ring is writable by other processes */
+		slot.capacity = slot.ring->capacity();
+		if (!Noux::Pipe_ring::capacity_valid(slot.capacity,
+		                                     Genode::Dataspace_client(ds_cap).size())) {
+			warning("invalid pipe buffer of fd ", fd);
+			_env_ptr->rm().detach(slot.ring);
+			slot.ring = nullptr;
+		}
+	}
+
+	return (slot.write_end == write_end) ? slot.ring : nullptr;
+}
+
+
+static void release_pipe_ring(int fd)
+{
+	if (fd < 0 || fd >= MAX_PIPE_RING_FDS)
+		return;
+
+	Pipe_ring_slot &slot = pipe_ring_slots[fd];
+
+	if (slot.ring)
+		_env_ptr->rm().detach(slot.ring);
+
+	slot = Pipe_ring_slot();
+}
+
+
+static void wake_up_pipe_peer(int fd)
+{
+	sysio()->fcntl_in.fd  = fd;
+	sysio()->fcntl_in.cmd = Noux::Sysio::FCNTL_CMD_WAKE_UP_PIPE_PEER;
+	noux_syscall(Noux::Session::SYSCALL_FCNTL);
+}
+
+
+/**
+ * Write to mapped pipe buffer
+ *
+ * \return  number of written bytes, 0 if the buffer is full, noux
+ *          accesses the pipe end, or the file descriptor does not refer
+ *          to a pipe
+ */
+static Genode::size_t write_pipe_ring(int fd, char const *src, Genode::size_t count)
+{
+	for (;;) {
+		Noux::Pipe_ring *ring = pipe_ring(fd, true);
+		if (!ring)
+			return 0;
+
+		try {
+			Genode::size_t const n =
+				ring->write(pipe_ring_slots[fd].capacity, src, count);
+
+			if (ring->noux_to_wake_up())
+				wake_up_pipe_peer(fd);
+
+			return n;
+		}
+
+		/* the pipe was resized, obtain the new buffer */
+		catch (Noux::Pipe_ring::Retired) { release_pipe_ring(fd); }
+
+		/* let noux detect the corruption on the syscall path */
+		catch (Noux::Pipe_ring::Corrupt) { return 0; }
+	}
+}
+
+
+/**
+ * Read from mapped pipe buffer
+ *
+ * \return  number of read bytes, 0 if the buffer is empty, noux
+ *          accesses the pipe end, or the file descriptor does not refer
+ *          to a pipe
+ */
+static Genode::size_t read_pipe_ring(int fd, char *dst, Genode::size_t count)
+{
+	for (;;) {
+		Noux::Pipe_ring *ring = pipe_ring(fd, false);
+		if (!ring)
+			return 0;
+
+		try {
+			Genode::size_t const n =
+				ring->read(pipe_ring_slots[fd].capacity, dst, count);
+
+			if (ring->noux_to_wake_up())
+				wake_up_pipe_peer(fd);
+
+			return n;
+		}
+
+		/* the pipe was resized, obtain the new buffer */
+		catch (Noux::Pipe_ring::Retired) { release_pipe_ring(fd); }
+
+		/* let noux detect the corruption on the syscall path */
+		catch (Noux::Pipe_ring::Corrupt) { return 0; }
+	}
+}
+
+
+/**
+ * Move data between file descriptors without copying it to the caller
+ *
+ * In contrast to Linux, neither end has to be a pipe. Explicit file offsets
+ * are not supported.
+ */
+extern "C" ssize_t splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out,
+                          size_t len, unsigned flags)
+{
+	if (off_in || off_out) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	sysio()->splice_in.fd_in  = fd_in;
+	sysio()->splice_in.fd_out = fd_out;
+	sysio()->splice_in.count  = len;
+
+	if (!noux_syscall(Noux::Session::SYSCALL_SPLICE)) {
+		switch (sysio()->error.splice) {
+		case Noux::Sysio::SPLICE_ERR_INVALID:   errno = EINVAL; break;
+		case Noux::Sysio::SPLICE_ERR_AGAIN:     errno = EAGAIN; break;
+		case Noux::Sysio::SPLICE_ERR_INTERRUPT: errno = EINTR;  break;
+		case Noux::Sysio::SPLICE_ERR_IO:        errno = EIO;    break;
+		default:
+			if (sysio()->error.general == Vfs::Directory_service::ERR_FD_INVALID)
+				errno = EBADF;
+			else
+				errno = 0;
+			break;
+		}
+		return -1;
+	}
+
+	return sysio()->splice_out.count;
+}
+
+
 namespace {
 
 	class Plugin : public Libc::Plugin
@@ -1240,6 +1440,16 @@ namespace {
 		char *src = (char *)buf;
 		while (count > 0) {
 
+			/* bypass noux while the pipe buffer has space left */
+			Genode::size_t const direct_count =
+				write_pipe_ring(noux_fd(fd->context), src, count);
+
+			if (direct_count) {
+				count -= direct_count;
+				src   += direct_count;
+				continue;
+			}
+
 			Genode::size_t curr_count = Genode::min((::size_t)Noux::Sysio::CHUNK_SIZE, count);
 
 			sysio()->write_in.fd = noux_fd(fd->context);
@@ -1273,6 +1483,13 @@ namespace {
 	{
 		if (!buf) { errno = EFAULT; return -1; }
 
+		/* bypass noux if the pipe buffer contains data */
+		Genode::size_t const direct_count =
+			read_pipe_ring(noux_fd(fd->context), (char *)buf, count);
+
+		if (direct_count)
+			return direct_count;
+
 		Genode::size_t sum_read_count = 0;
 
 		while (count > 0) {
@@ -1322,6 +1539,8 @@ namespace {
 
 	int Plugin::close(Libc::File_descriptor *fd)
 	{
+		release_pipe_ring(noux_fd(fd->context));
+
 		sysio()->close_in.fd = noux_fd(fd->context);
 		if (!noux_syscall(Noux::Session::SYSCALL_CLOSE)) {
 			error("close error");
@@ -1511,6 +1730,9 @@ namespace {
 		 */
 		new_fd->context = noux_context(new_fd->libc_fd);
 
+		/* the target file descriptor may have referred to another pipe */
+		release_pipe_ring(new_fd->libc_fd);
+
 		sysio()->dup2_in.fd    = noux_fd(fd->context);
 		sysio()->dup2_in.to_fd = noux_fd(new_fd->context);
 
@@ -1622,6 +1844,15 @@ namespace {
 			sysio()->fcntl_in.long_arg = arg;
 			break;
 
+		case F_SETPIPE_SZ:
+			sysio()->fcntl_in.cmd      = Noux::Sysio::FCNTL_CMD_SET_PIPE_SIZE;
+			sysio()->fcntl_in.long_arg = arg;
+			break;
+
+		case F_GETPIPE_SZ:
+			sysio()->fcntl_in.cmd = Noux::Sysio::FCNTL_CMD_GET_PIPE_SIZE;
+			break;
+
 		default:
 			error("fcntl: unsupported command ", cmd);
 			errno = EINVAL;
@@ -1633,6 +1864,9 @@ namespace {
 			warning("fcntl failed (libc_fd=", fd->libc_fd, ", cmd=", Hex(cmd), ")");
 			switch (sysio()->error.fcntl) {
 				case Noux::Sysio::FCNTL_ERR_CMD_INVALID: errno = EINVAL; break;
+				case Noux::Sysio::FCNTL_ERR_BUSY:        errno = EBUSY;  break;
+				case Noux::Sysio::FCNTL_ERR_NO_PERM:     errno = EPERM;  break;
+				case Noux::Sysio::FCNTL_ERR_NO_MEM:      errno = ENOMEM; break;
 				default:
 					switch (sysio()->error.general) {
 					case Vfs::Directory_service::ERR_FD_INVALID: errno = EINVAL; break;
@@ -423,6 +423,14 @@ class Noux::Child : public Rpc_object<Session>,
 			return _pd.lookup_region_map(addr);
 		}
 
+		Dataspace_capability pipe_buffer(int fd)
+		{
+			Shared_pointer<Io_channel> io = io_channel_by_fd(fd);
+
+			return io ? io->pipe_buffer(_ds_registry, _heap)
+			          : Dataspace_capability();
+		}
+
 		bool syscall(Syscall sc);
 
 		int next_open_fd(int start_fd)
@@ -32,6 +32,13 @@ namespace Noux {
 struct Noux::Dataspace_user : List<Dataspace_user>::Element
 {
 	virtual void dissolve(Dataspace_info &ds) = 0;
+
+	/**
+	 * Replace the attached dataspace by the specified one
+	 *
+	 * \return  true if the dataspace is attached as executable
+	 */
+	virtual bool reattach(Dataspace_capability ds) = 0;
 };
 
 
@@ -70,6 +77,20 @@ class Noux::Dataspace_info : public Object_pool<Dataspace_info>::Entry
 			_users.remove(&user);
 		}
 
+		bool has_users()
+		{
+			Lock::Guard guard(_users_lock);
+			return _users.first() != nullptr;
+		}
+
+		template <typename FN>
+		void for_each_user(FN const &fn)
+		{
+			Lock::Guard guard(_users_lock);
+			for (Dataspace_user *user = _users.first(); user; user = user->next())
+				fn(*user);
+		}
+
 		void dissolve_users()
 		{
 			for (;;) {
@@ -121,6 +142,19 @@ class Noux::Dataspace_info : public Object_pool<Dataspace_info>::Entry
 		virtual void poke(Region_map &local_rm, addr_t dst_offset,
 		                  char const *src, size_t len) = 0;
 
+		/**
+		 * Return dataspace to be attached in place of the registered one
+		 *
+		 * A RAM dataspace that was frozen by a fork is replaced by a
+		 * managed dataspace that holds the process-local content.
+		 */
+		virtual Dataspace_capability attach_cap() { return ds_cap(); }
+
+		/**
+		 * Return true if the info is to be destroyed with its last user
+		 */
+		virtual bool release_when_unused() const { return false; }
+
 		/**
 		 * Return leaf region map that covers a given address
 		 *
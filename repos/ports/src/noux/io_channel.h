@@ -32,6 +32,7 @@ namespace Noux {
 
 	class Io_channel_backend;
 	class Io_channel;
+	class Dataspace_registry;
 
 	class Terminal_io_channel;
 }
@@ -85,6 +86,18 @@ class Noux::Io_channel : public Reference_counter
 		virtual bool     ioctl(Sysio &sysio)                 { return false; }
 		virtual bool     lseek(Sysio &sysio)                 { return false; }
 
+		/**
+		 * Return shared buffer of a pipe
+		 *
+		 * \param ds_registry  registry of the process that maps the buffer
+		 * \param alloc        allocator for the registry entry
+		 */
+		virtual Dataspace_capability pipe_buffer(Dataspace_registry &ds_registry,
+		                                         Allocator          &alloc)
+		{
+			return Dataspace_capability();
+		}
+
 		/**
 		 * Return true if an unblocking condition of the channel is satisfied
 		 *
@@ -95,6 +108,13 @@ class Noux::Io_channel : public Reference_counter
 		virtual bool check_unblock(bool rd, bool wr, bool ex) const {
 			return false; }
 
+		/**
+		 * Return number of bytes that can be written without blocking
+		 *
+		 * Channels that cannot tell report no limit.
+		 */
+		virtual size_t write_space() const { return ~(size_t)0; }
+
 		/**
 		 * Return true if the channel is set to non-blocking mode
 		 */
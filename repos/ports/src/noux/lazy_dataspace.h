@@ -0,0 +1,392 @@
+/*
+ * \brief  Lazily copied RAM dataspaces of forked noux processes
+ * \author Norman Feske
+ * \date   2017-12-04
+ *
+ * When forking a process, the content of a RAM dataspace is frozen in a
+ * snapshot. The parent and the child each obtain a view of the snapshot,
+ * which is a managed dataspace that is populated chunk by chunk. On the
+ * first access of a chunk, the corresponding part of the snapshot is copied
+ * into a RAM dataspace private to the view.
+ *
+ * Region maps cannot attach a dataspace read-only. Hence, the views cannot
+ * share the snapshot as long as more than one view exists. Once the only
+ * remaining view is left, e.g., after the child called 'execve', this view
+ * adopts the snapshot by attaching its yet untouched parts directly.
+ */
+
+/*
+ * Copyright (C) 2017 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _NOUX__LAZY_DATASPACE_H_
+#define _NOUX__LAZY_DATASPACE_H_
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/lock.h>
+#include <base/signal.h>
+#include <base/log.h>
+#include <dataspace/client.h>
+#include <rm_session/connection.h>
+#include <region_map/client.h>
+#include <util/construct_at.h>
+#include <util/list.h>
+
+namespace Noux {
+
+	class Fork_snapshot;
+	class Lazy_dataspace;
+
+	using namespace Genode;
+
+	/**
+	 * Lock that serializes the population, forking, and destruction of views
+	 */
+	Lock &lazy_dataspace_lock();
+
+	/**
+	 * Return RM session used for creating views
+	 *
+	 * \return  nullptr if lazy forking is disabled
+	 */
+	Rm_connection *lazy_dataspace_rm();
+
+	/**
+	 * Enable lazy forking if configured
+	 */
+	void init_lazy_fork(Env &env, bool enabled);
+}
+
+
+/**
+ * Content of a RAM dataspace at the time of a fork
+ *
+ * The snapshot is owned by its views. The last view releases the snapshot
+ * along with the RAM dataspace.
+ */
+class Noux::Fork_snapshot
+{
+	private:
+
+		friend class Lazy_dataspace;
+
+		Ram_allocator                 &_ram;
+		Ram_dataspace_capability const _ds;
+		size_t                   const _size;
+
+		List<Lazy_dataspace> _views;
+		unsigned             _num_views = 0;
+
+	public:
+
+		Fork_snapshot(Ram_allocator &ram, Ram_dataspace_capability ds)
+		:
+			_ram(ram), _ds(ds), _size(Dataspace_client(ds).size())
+		{ }
+};
+
+
+class Noux::Lazy_dataspace : public List<Lazy_dataspace>::Element
+{
+	public:
+
+		enum { CHUNK_SIZE = 64*1024 };
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Lazy_dataspace(Lazy_dataspace const &);
+		Lazy_dataspace &operator = (Lazy_dataspace const &);
+
+		struct Chunk
+		{
+			/* private copy of the snapshot content */
+			Ram_dataspace_capability ds;
+
+			/* snapshot content attached directly */
+			bool adopted = false;
+		};
+
+		Env           &_env;
+		Allocator     &_alloc;
+		Rm_connection &_rm_connection;
+		Fork_snapshot &_snapshot;
+
+		unsigned const _num_chunks = (_snapshot._size + CHUNK_SIZE - 1)/CHUNK_SIZE;
+
+		Capability<Region_map> const _rm_cap = _create_region_map();
+		Region_map_client            _rm { _rm_cap };
+
+		/* obtained once because NOVA hands out a new capability per call */
+		Dataspace_capability const _ds_cap = _rm.dataspace();
+
+		Chunk * const _chunks = _alloc_chunks();
+
+		bool _executable = false;
+
+		Signal_handler<Lazy_dataspace> _fault_handler {
+			_env.ep(), *this, &Lazy_dataspace::_handle_fault };
+
+		Capability<Region_map> _create_region_map()
+		{
+			for (;;) {
+				try { return _rm_connection.create(_snapshot._size); }
+				catch (Out_of_ram)  { _rm_connection.upgrade_ram(8*1024); }
+				catch (Out_of_caps) { _rm_connection.upgrade_caps(2); }
+			}
+		}
+
+		Chunk *_alloc_chunks()
+		{
+			Chunk * const chunks = (Chunk *)_alloc.alloc(_num_chunks*sizeof(Chunk));
+			for (unsigned i = 0; i < _num_chunks; i++)
+				construct_at<Chunk>(&chunks[i]);
+			return chunks;
+		}
+
+		addr_t _chunk_offset(unsigned i) const { return (addr_t)i*CHUNK_SIZE; }
+
+		size_t _chunk_size(unsigned i) const
+		{
+			return min((size_t)CHUNK_SIZE, _snapshot._size - _chunk_offset(i));
+		}
+
+		bool _present(unsigned i) const
+		{
+			return _chunks[i].ds.valid() || _chunks[i].adopted;
+		}
+
+		void _attach(unsigned i, Dataspace_capability ds, addr_t offset)
+		{
+			enum { USE_LOCAL_ADDR = true };
+			for (;;) {
+				try {
+					_rm.attach(ds, _chunk_size(i), offset, USE_LOCAL_ADDR,
+					           _chunk_offset(i), _executable);
+					return;
+				}
+				catch (Out_of_ram)  { _rm_connection.upgrade_ram(8*1024); }
+				catch (Out_of_caps) { _rm_connection.upgrade_caps(2); }
+			}
+		}
+
+		/**
+		 * Copy chunk-sized part of 'src' to 'dst' via the local address space
+		 */
+		void _copy(Dataspace_capability dst, Dataspace_capability src,
+		           addr_t src_offset, size_t size)
+		{
+			Region_map &rm = _env.rm();
+
+			char * const dst_ptr = rm.attach(dst, size);
+			try {
+				char * const src_ptr = rm.attach(src, size, src_offset);
+				memcpy(dst_ptr, src_ptr, size);
+				rm.detach(src_ptr);
+			} catch (...) { rm.detach(dst_ptr); throw; }
+
+			rm.detach(dst_ptr);
+		}
+
+		/**
+		 * Back chunk by a private copy of the chunk-sized part of 'src'
+		 */
+		void _populate(unsigned i, Dataspace_capability src, addr_t src_offset)
+		{
+			size_t const size = _chunk_size(i);
+
+			Ram_dataspace_capability ds = _env.ram().alloc(size);
+			try {
+				_copy(ds, src, src_offset, size);
+				_attach(i, ds, 0);
+			} catch (...) { _env.ram().free(ds); throw; }
+
+			_chunks[i].ds = ds;
+		}
+
+		void _handle_fault()
+		{
+			Lock::Guard guard(lazy_dataspace_lock());
+
+			for (;;) {
+				Region_map::State const state = _rm.state();
+				if (state.type == Region_map::State::READY)
+					return;
+
+				unsigned const i = state.addr/CHUNK_SIZE;
+				if (i >= _num_chunks || _present(i)) {
+					error("unresolvable fault in forked dataspace at ", Hex(state.addr));
+					return;
+				}
+
+				try { _populate(i, _snapshot._ds, _chunk_offset(i)); }
+				catch (...) {
+					error("could not populate forked dataspace at ", Hex(state.addr));
+					return;
+				}
+			}
+		}
+
+		/**
+		 * Attach untouched parts of the snapshot directly
+		 *
+		 * Called once the view is the only one of the snapshot.
+		 */
+		void _adopt()
+		{
+			try {
+				for (unsigned i = 0; i < _num_chunks; i++) {
+					if (_present(i))
+						continue;
+
+					_attach(i, _snapshot._ds, _chunk_offset(i));
+					_chunks[i].adopted = true;
+				}
+			}
+			catch (...) { warning("could not adopt snapshot of forked dataspace"); }
+		}
+
+		/**
+		 * Revert '_adopt' before the snapshot is shared with another view
+		 */
+		void _unadopt()
+		{
+			for (unsigned i = 0; i < _num_chunks; i++) {
+				if (!_chunks[i].adopted)
+					continue;
+
+				_rm.detach(_chunk_offset(i));
+				_chunks[i].adopted = false;
+			}
+		}
+
+		Lazy_dataspace(Env &env, Allocator &alloc, Rm_connection &rm_connection,
+		               Fork_snapshot &snapshot, bool executable)
+		:
+			_env(env), _alloc(alloc), _rm_connection(rm_connection),
+			_snapshot(snapshot), _executable(executable)
+		{
+			_rm.fault_handler(_fault_handler);
+
+			_snapshot._views.insert(this);
+			_snapshot._num_views++;
+		}
+
+	public:
+
+		/**
+		 * Create snapshot of RAM dataspace along with a first view
+		 *
+		 * The returned view must replace the dataspace for its users. The
+		 * snapshot takes over the ownership of the dataspace.
+		 *
+		 * The function must be called with 'lazy_dataspace_lock' held.
+		 */
+		static Lazy_dataspace &create(Env &env, Allocator &alloc,
+		                              Rm_connection &rm_connection,
+		                              Ram_allocator &ram,
+		                              Ram_dataspace_capability ds)
+		{
+			Fork_snapshot &snapshot = *new (alloc) Fork_snapshot(ram, ds);
+			try {
+				return *new (alloc) Lazy_dataspace(env, alloc, rm_connection,
+				                                   snapshot, false);
+			} catch (...) { destroy(alloc, &snapshot); throw; }
+		}
+
+		/**
+		 * Destructor
+		 *
+		 * Must be called with 'lazy_dataspace_lock' held.
+		 */
+		~Lazy_dataspace()
+		{
+			_rm_connection.destroy(_rm_cap);
+
+			for (unsigned i = 0; i < _num_chunks; i++) {
+				if (_chunks[i].ds.valid())
+					_env.ram().free(_chunks[i].ds);
+				_chunks[i].~Chunk();
+			}
+			_alloc.free(_chunks, _num_chunks*sizeof(Chunk));
+
+			_snapshot._views.remove(this);
+			_snapshot._num_views--;
+
+			if (_snapshot._num_views == 1)
+				_snapshot._views.first()->_adopt();
+
+			if (_snapshot._num_views == 0) {
+				_snapshot._ram.free(_snapshot._ds);
+				destroy(_alloc, &_snapshot);
+			}
+		}
+
+		Dataspace_capability cap() const { return _ds_cap; }
+
+		/**
+		 * Permit execution of the content of chunks populated from now on
+		 */
+		void executable(bool executable) { _executable = executable; }
+
+		/**
+		 * Create view of the same snapshot for a forked process
+		 *
+		 * Chunks that are already populated by this view are copied eagerly.
+		 * The function must be called with 'lazy_dataspace_lock' held.
+		 */
+		Lazy_dataspace &fork()
+		{
+			_unadopt();
+
+			Lazy_dataspace &view = *new (_alloc)
+				Lazy_dataspace(_env, _alloc, _rm_connection, _snapshot, _executable);
+
+			try {
+				for (unsigned i = 0; i < _num_chunks; i++)
+					if (_chunks[i].ds.valid())
+						view._populate(i, _chunks[i].ds, 0);
+
+			} catch (...) { destroy(_alloc, &view); throw; }
+
+			return view;
+		}
+
+		/**
+		 * Write raw byte sequence into view
+		 *
+		 * The function must be called with 'lazy_dataspace_lock' held.
+		 */
+		void poke(addr_t dst_offset, char const *src, size_t len)
+		{
+			while (len) {
+				unsigned const i        = dst_offset/CHUNK_SIZE;
+				addr_t   const at       = dst_offset - _chunk_offset(i);
+				size_t   const curr_len = min(len, _chunk_size(i) - at);
+
+				if (!_present(i))
+					_populate(i, _snapshot._ds, _chunk_offset(i));
+
+				Dataspace_capability const ds =
+					_chunks[i].adopted ? Dataspace_capability(_snapshot._ds)
+					                   : Dataspace_capability(_chunks[i].ds);
+				addr_t const ds_offset = _chunks[i].adopted ? _chunk_offset(i) : 0;
+
+				char * const ptr = _env.rm().attach(ds, _chunk_size(i), ds_offset);
+				memcpy(ptr + at, src, curr_len);
+				_env.rm().detach(ptr);
+
+				dst_offset += curr_len;
+				src        += curr_len;
+				len        -= curr_len;
+			}
+		}
+};
+
+#endif /* _NOUX__LAZY_DATASPACE_H_ */
@@ -18,6 +18,7 @@
 
 /* Noux includes */
 #include <child.h>
+#include <lazy_dataspace.h>
 #include <construct.h>
 #include <noux_session/sysio.h>
 #include <vfs_io_channel.h>
@@ -163,6 +164,37 @@ Genode::Lock &Noux::signal_lock()
 }
 
 
+Genode::Lock &Noux::lazy_dataspace_lock()
+{
+	static Genode::Lock inst;
+	return inst;
+}
+
+
+static Genode::Constructible<Genode::Rm_connection> &lazy_fork_rm()
+{
+	static Genode::Constructible<Genode::Rm_connection> inst;
+	return inst;
+}
+
+
+Genode::Rm_connection *Noux::lazy_dataspace_rm()
+{
+	return lazy_fork_rm().constructed() ? &*lazy_fork_rm() : nullptr;
+}
+
+
+void Noux::init_lazy_fork(Genode::Env &env, bool enabled)
+{
+	if (!enabled)
+		return;
+
+	try { lazy_fork_rm().construct(env); }
+	catch (...) {
+		Genode::warning("RM service unavailable, fork copies memory eagerly"); }
+}
+
+
 namespace Noux { struct Main; }
 
 
@@ -250,6 +282,9 @@ struct Noux::Main
 
 	bool _network_initialized = (init_network(), true);
 
+	bool _lazy_fork_initialized =
+		(init_lazy_fork(_env, _config.xml().attribute_value("lazy_fork", true)), true);
+
 	Signal_handler<Main> _destruct_handler {
 		_env.ep(), *this, &Main::_handle_destruct };
 
@@ -31,6 +31,7 @@
 /* Noux includes */
 #include <region_map_component.h>
 #include <dataspace_registry.h>
+#include <lazy_dataspace.h>
 
 namespace Noux {
 	struct Ram_dataspace_info;
@@ -42,14 +43,54 @@ namespace Noux {
 struct Noux::Ram_dataspace_info : Dataspace_info,
                                   List<Ram_dataspace_info>::Element
 {
-	Ram_dataspace_info(Ram_dataspace_capability ds_cap)
-	: Dataspace_info(ds_cap) { }
+	Env       &_env;
+	Allocator &_alloc;
 
-	Dataspace_capability fork(Ram_allocator      &ram,
-	                          Region_map         &local_rm,
-	                          Allocator          &alloc,
-	                          Dataspace_registry &ds_registry,
-	                          Rpc_entrypoint     &) override
+	/* lazy copy that replaces the dataspace after a fork */
+	Lazy_dataspace *_view = nullptr;
+
+	Ram_dataspace_info(Env &env, Allocator &alloc, Ram_dataspace_capability ds_cap)
+	: Dataspace_info(ds_cap), _env(env), _alloc(alloc) { }
+
+	/**
+	 * Constructor used for the dataspace of a forked process
+	 */
+	Ram_dataspace_info(Env &env, Allocator &alloc, Lazy_dataspace &view)
+	: Dataspace_info(view.cap()), _env(env), _alloc(alloc), _view(&view) { }
+
+	~Ram_dataspace_info()
+	{
+		if (!_view)
+			return;
+
+		Lock::Guard guard(lazy_dataspace_lock());
+		destroy(_alloc, _view);
+	}
+
+	/**
+	 * Return true if the backing store is owned by a fork snapshot
+	 */
+	bool lazy() const { return _view != nullptr; }
+
+	/**
+	 * Freeze content of the dataspace and let its users attach a lazy copy
+	 */
+	void _freeze(Rm_connection &rm)
+	{
+		_view = &Lazy_dataspace::create(_env, _alloc, rm, _env.ram(),
+		                                static_cap_cast<Ram_dataspace>(ds_cap()));
+
+		bool executable = false;
+		for_each_user([&] (Dataspace_user &user) {
+			executable |= user.reattach(_view->cap()); });
+
+		_view->executable(executable);
+	}
+
+	Dataspace_capability _fork_eagerly(Ram_allocator      &ram,
+	                                   Region_map         &local_rm,
+	                                   Allocator          &alloc,
+	                                   Dataspace_registry &ds_registry)
 	{
 		size_t const size = Dataspace_client(ds_cap()).size();
 		Ram_dataspace_capability dst_ds_cap;
@@ -61,7 +102,7 @@ struct Noux::Ram_dataspace_info : Dataspace_info,
 			Attached_dataspace dst_ds(local_rm, dst_ds_cap);
 			memcpy(dst_ds.local_addr<char>(), src_ds.local_addr<char>(), size);
 
-			ds_registry.insert(new (alloc) Ram_dataspace_info(dst_ds_cap));
+			ds_registry.insert(new (alloc) Ram_dataspace_info(_env, alloc, dst_ds_cap));
 			return dst_ds_cap;
 
 		} catch (...) {
@@ -74,6 +115,33 @@ struct Noux::Ram_dataspace_info : Dataspace_info,
 		}
 	}
 
+	Dataspace_capability fork(Ram_allocator      &ram,
+	                          Region_map         &local_rm,
+	                          Allocator          &alloc,
+	                          Dataspace_registry &ds_registry,
+	                          Rpc_entrypoint     &) override
+	{
+		Lock::Guard guard(lazy_dataspace_lock());
+
+		Rm_connection * const rm = lazy_dataspace_rm();
+		if (!rm)
+			return _fork_eagerly(ram, local_rm, alloc, ds_registry);
+
+		try {
+			if (!_view)
+				_freeze(*rm);
+
+			Lazy_dataspace &view = _view->fork();
+
+			ds_registry.insert(new (alloc) Ram_dataspace_info(_env, alloc, view));
+			return view.cap();
+
+		} catch (...) {
+			error("fork of RAM dataspace failed");
+			return Dataspace_capability();
+		}
+	}
+
 	void poke(Region_map &rm, addr_t dst_offset, char const *src, size_t len) override
 	{
 		if (!src) return;
@@ -84,10 +152,22 @@ struct Noux::Ram_dataspace_info : Dataspace_info,
 		}
 
 		try {
+			Lock::Guard guard(lazy_dataspace_lock());
+
+			if (_view) {
+				_view->poke(dst_offset, src, len);
+				return;
+			}
+
 			Attached_dataspace ds(rm, ds_cap());
 			memcpy(ds.local_addr<char>() + dst_offset, src, len);
 		} catch (...) { warning("poke: failed to attach RAM dataspace"); }
 	}
+
+	Dataspace_capability attach_cap() override
+	{
+		return _view ? _view->cap() : ds_cap();
+	}
 };
 
 
@@ -95,6 +175,8 @@ class Noux::Pd_session_component : public Rpc_object<Pd_session>
 {
 	private:
 
+		Env &_env;
+
 		Rpc_entrypoint &_ep;
 
 		Pd_connection _pd;
@@ -135,7 +217,7 @@ class Noux::Pd_session_component : public Rpc_object<Pd_session>
 		                     Child_policy::Name const &name,
 		                     Dataspace_registry &ds_registry)
 		:
-			_ep(ep), _pd(env, name.string()), _ref_pd(env.pd()),
+			_env(env), _ep(ep), _pd(env, name.string()), _ref_pd(env.pd()),
 			_address_space(alloc, _ep, ds_registry, _pd, _pd.address_space()),
 			_stack_area   (alloc, _ep, ds_registry, _pd, _pd.stack_area()),
 			_linker_area  (alloc, _ep, ds_registry, _pd, _pd.linker_area()),
@@ -270,7 +352,7 @@ class Noux::Pd_session_component : public Rpc_object<Pd_session>
 		{
 			Ram_dataspace_capability ds_cap = _ram.alloc(size, cached);
 
-			Ram_dataspace_info *ds_info = new (_alloc) Ram_dataspace_info(ds_cap);
+			Ram_dataspace_info *ds_info = new (_alloc) Ram_dataspace_info(_env, _alloc, ds_cap);
 
 			_ds_registry.insert(ds_info);
 			_ds_list.insert(ds_info);
@@ -297,7 +379,10 @@ class Noux::Pd_session_component : public Rpc_object<Pd_session>
 				_ds_registry.remove(ds_info);
 				ds_info->dissolve_users();
 				_ds_list.remove(ds_info);
-				_ram.free(ds_cap);
+
+				/* the backing store of a forked dataspace is freed along with 'ds_info' */
+				if (!ds_info->lazy())
+					_ram.free(ds_cap);
 
 				_used_ram_quota = Ram_quota { _used_ram_quota.value - ds_size };
 			};
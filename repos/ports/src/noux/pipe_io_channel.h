@@ -14,11 +14,18 @@
 #ifndef _NOUX__PIPE_IO_CHANNEL_H_
 #define _NOUX__PIPE_IO_CHANNEL_H_
 
+/* Genode includes */
+#include <base/attached_ram_dataspace.h>
+#include <noux_session/pipe_ring.h>
+#include <util/construct_at.h>
+
 /* Noux includes */
 #include <io_channel.h>
+#include <dataspace_registry.h>
 
 namespace Noux {
 	class Pipe;
+	class Pipe_buffer_info;
 	class Pipe_sink_io_channel;
 	class Pipe_source_io_channel;
 }
@@ -26,61 +33,193 @@ namespace Noux {
 
 class Noux::Pipe : public Reference_counter
 {
+	public:
+
+		struct Invalid_size : Exception { };
+		struct Busy         : Exception { };
+		struct Broken       : Exception { };
+
 	private:
 
 		Lock mutable _lock;
 
-		enum { BUFFER_SIZE = 4096 };
-		char _buffer[BUFFER_SIZE];
+		Env       &_env;
+		Allocator &_alloc;
+
+		/**
+		 * Ring located in a dataspace that can be mapped by processes
+		 */
+		struct Buffer
+		{
+			/* capacity as known by noux, never read back from the ring */
+			unsigned const capacity;
+
+			Attached_ram_dataspace ds;
+
+			/* number of processes that map the buffer */
+			unsigned mappings = 0;
+
+			/* ring ends held by noux */
+			bool writer_held = false;
+			bool reader_held = false;
+
+			Buffer(Env &env, unsigned capacity)
+			:
+				capacity(capacity),
+				ds(env.ram(), env.rm(), Pipe_ring::DATA_OFFSET + capacity)
+			{
+				construct_at<Pipe_ring>(ds.local_addr<void>(), capacity);
+			}
 
-		unsigned _read_offset;
-		unsigned _write_offset;
+			Pipe_ring &ring() { return *ds.local_addr<Pipe_ring>(); }
+
+			bool enter_writer()
+			{
+				if (!writer_held)
+					writer_held = ring().noux_enter_writer();
+
+				return writer_held;
+			}
+
+			bool enter_reader()
+			{
+				if (!reader_held)
+					reader_held = ring().noux_enter_reader();
+
+				return reader_held;
+			}
+
+			void leave_writer()
+			{
+				if (writer_held)
+					ring().noux_leave_writer();
+
+				writer_held = false;
+			}
+
+			void leave_reader()
+			{
+				if (reader_held)
+					ring().noux_leave_reader();
+
+				reader_held = false;
+			}
+		};
+
+		Buffer *_buffer;
+
+		/* buffer replaced by '_resize' that is still mapped by a process */
+		Buffer *_retired = nullptr;
 
 		Signal_context_capability _read_ready_sigh;
 		Signal_context_capability _write_ready_sigh;
 
 		bool _writer_is_gone;
 
-		/**
-		 * Return space available in the buffer for writing, in bytes
-		 */
-		size_t _avail_buffer_space() const
-		{
-			if (_read_offset < _write_offset)
-				return (BUFFER_SIZE - _write_offset) + _read_offset - 1;
-
-			if (_read_offset > _write_offset)
-				return _read_offset - _write_offset - 1;
+		/* the ring was found corrupt, which ends the pipe */
+		bool mutable _broken = false;
 
-			/* _read_offset == _write_offset */
-			return BUFFER_SIZE - 1;
-		}
+		Pipe_ring &_ring() const { return _buffer->ring(); }
 
-		bool _any_space_avail_for_writing() const
-		{
-			return _avail_buffer_space() > 0;;
-		}
+		unsigned _capacity() const { return _buffer->capacity; }
 
-		void _wake_up_reader()
+		void _wake_up_reader() const
 		{
 			if (_read_ready_sigh.valid())
 				Signal_transmitter(_read_ready_sigh).submit();
 		}
 
-		void _wake_up_writer()
+		void _wake_up_writer() const
 		{
 			if (_write_ready_sigh.valid())
 				Signal_transmitter(_write_ready_sigh).submit();
 		}
 
+		void _break() const
+		{
+			if (!_broken)
+				warning("pipe buffer corrupted by a process, closing pipe");
+
+			_broken = true;
+			_wake_up_reader();
+			_wake_up_writer();
+		}
+
+		/**
+		 * Replace buffer by a buffer of the specified size
+		 *
+		 * 	hrow Invalid_size  size exceeds 'Pipe_ring::MAX_CAPACITY'
+		 * 	hrow Busy          buffered data does not fit into the new
+		 *                      buffer, a process accesses the buffer, or
+		 *                      a previously replaced buffer is still mapped
+		 * 	hrow Out_of_ram
+		 * 	hrow Out_of_caps
+		 */
+		void _resize(unsigned long size)
+		{
+			unsigned const capacity = Pipe_ring::capacity_for(size);
+			if (!capacity)
+				throw Invalid_size();
+
+			if (capacity == _capacity())
+				return;
+
+			if (_retired || _broken)
+				throw Busy();
+
+			if (!_buffer->enter_writer() || !_buffer->enter_reader())
+				throw Busy();
+
+			Buffer &buffer = *new (_alloc) Buffer(_env, capacity);
+
+			bool moved = false;
+			try { moved = _ring().retire(_capacity(), buffer.ring(), capacity); }
+			catch (Pipe_ring::Corrupt) { _break(); }
+
+			if (!moved) {
+				destroy(_alloc, &buffer);
+				throw Busy();
+			}
+
+			_buffer->leave_writer();
+			_buffer->leave_reader();
+
+			if (_buffer->mappings)
+				_retired = _buffer;
+			else
+				destroy(_alloc, _buffer);
+
+			_buffer = &buffer;
+
+			/* let blocked processes reevaluate the state of the new buffer */
+			_wake_up_reader();
+			_wake_up_writer();
+		}
+
+		Buffer *_buffer_by_ds(Dataspace_capability ds)
+		{
+			if (_buffer->ds.cap() == ds) return _buffer;
+			if (_retired && _retired->ds.cap() == ds) return _retired;
+			return nullptr;
+		}
+
 	public:
 
-		Pipe()
-		: _read_offset(0), _write_offset(0), _writer_is_gone(false) { }
+		Pipe(Env &env, Allocator &alloc)
+		:
+			_env(env), _alloc(alloc),
+			_buffer(new (alloc) Buffer(env, Pipe_ring::DEFAULT_CAPACITY)),
+			_writer_is_gone(false)
+		{ }
 
 		~Pipe()
 		{
 			Lock::Guard guard(_lock);
+
+			destroy(_alloc, _buffer);
+
+			if (_retired)
+				destroy(_alloc, _retired);
 		}
 
 		void writer_close()
@@ -98,107 +237,124 @@ class Noux::Pipe : public Reference_counter
 			_read_ready_sigh = Signal_context_capability();
 		}
 
-		bool writer_is_gone() const
-		{
-			Lock::Guard guard(_lock);
-			return _writer_is_gone;
-		}
-
+		/**
+		 * Return true if there is space for writing
+		 *
+		 * On success, noux holds the writing end of the ring until the
+		 * next write. Otherwise, the writer is marked as blocked so that
+		 * a process that accesses the mapped buffer wakes it up.
+		 */
 		bool any_space_avail_for_writing() const
 		{
 			Lock::Guard guard(_lock);
-			return _any_space_avail_for_writing();
+
+			if (_broken)
+				return true;
+
+			try {
+				return _buffer->enter_writer()
+				    && (_ring().used(_capacity()) < _capacity()
+				     || _ring().writer_blocks(_capacity()));
+			}
+			catch (Pipe_ring::Corrupt) { _break(); }
+
+			return true;
 		}
 
+		/**
+		 * Return true if there is data for reading or the writer is gone
+		 *
+		 * On success, noux holds the reading end of the ring until the
+		 * next read. Otherwise, the reader is marked as blocked so that
+		 * a process that accesses the mapped buffer wakes it up.
+		 */
 		bool data_avail_for_reading() const
 		{
 			Lock::Guard guard(_lock);
 
-			return _read_offset != _write_offset;
+			if (_broken)
+				return true;
+
+			try {
+				return _buffer->enter_reader()
+				    && (_ring().used(_capacity()) > 0
+				     || _writer_is_gone
+				     || _ring().reader_blocks(_capacity()));
+			}
+			catch (Pipe_ring::Corrupt) { _break(); }
+
+			return true;
 		}
 
+		/**
+		 * Read from pipe buffer
+		 *
+		 * 
+eturn number of read bytes, 0 at the end of the pipe
+		 */
 		size_t read(char *dst, size_t dst_len)
 		{
 			Lock::Guard guard(_lock);
 
-			if (_read_offset < _write_offset) {
-
-				size_t len = min(dst_len, _write_offset - _read_offset);
-				memcpy(dst, &_buffer[_read_offset], len);
-
-				_read_offset += len;
-				_wake_up_writer();
-
-				return len;
-			}
+			if (_broken || !_buffer->enter_reader())
+				return 0;
 
-			if (_read_offset > _write_offset) {
+			size_t len = 0;
+			try { len = _ring().noux_read(_capacity(), dst, dst_len); }
+			catch (Pipe_ring::Corrupt) { _break(); }
 
-				size_t const upper_len = min(dst_len, BUFFER_SIZE - _read_offset);
-				memcpy(dst, &_buffer[_read_offset], upper_len);
+			_buffer->leave_reader();
 
-				size_t const lower_len = min(dst_len - upper_len, _write_offset);
-				if (lower_len) {
-					memcpy(dst + upper_len, &_buffer[0], lower_len);
-					_read_offset = lower_len;
-				} else {
-					_read_offset += upper_len;
-				}
+			if (len && _ring().writer_to_wake_up())
 				_wake_up_writer();
 
-				return upper_len + lower_len;
-			}
-
-			/* _read_offset == _write_offset */
-			return 0;
+			return len;
 		}
 
 		/**
 		 * Write to pipe buffer
 		 *
-		 * \return number of written bytes (may be less than 'len')
+		 * 
+eturn number of written bytes (may be less than 'len')
+		 * 	hrow  Broken
 		 */
 		size_t write(char *src, size_t len)
 		{
 			Lock::Guard guard(_lock);
 
-			/* trim write request to the available buffer space */
-			size_t const trimmed_len = min(len, _avail_buffer_space());
+			if (_broken)
+				throw Broken();
 
-			/*
-			 * Remember pipe state prior writing to see whether a reader
-			 * must be unblocked after writing.
-			 */
-			bool const pipe_was_empty = (_read_offset == _write_offset);
+			if (!_buffer->enter_writer())
+				return 0;
 
-			/* write data up to the upper boundary of the pipe buffer */
-			size_t const upper_len = min(BUFFER_SIZE - _write_offset, trimmed_len);
-			memcpy(&_buffer[_write_offset], src, upper_len);
+			size_t written_len = 0;
+			try { written_len = _ring().noux_write(_capacity(), src, len); }
+			catch (Pipe_ring::Corrupt) {
+				_break();
+				throw Broken();
+			}
 
-			_write_offset += upper_len;
+			_buffer->leave_writer();
 
-			/*
-			 * Determine number of remaining bytes beyond the buffer boundary.
-			 * The buffer wraps. So this data will end up in the lower part
-			 * of the pipe buffer.
-			 */
-			size_t const lower_len = trimmed_len - upper_len;
+			if (written_len && _ring().reader_to_wake_up())
+				_wake_up_reader();
 
-			if (lower_len > 0) {
+			return written_len;
+		}
 
-				/* pipe buffer wrap-around, write remaining data to the lower part */
-				memcpy(&_buffer[0], src + upper_len, lower_len);
-				_write_offset = lower_len;
-			}
+		/**
+		 * Return number of bytes that can be written without blocking
+		 */
+		size_t write_space() const
+		{
+			Lock::Guard guard(_lock);
 
-			/*
-			 * Wake up reader who may block for incoming data.
-			 */
-			if (pipe_was_empty || !_any_space_avail_for_writing())
-				_wake_up_reader();
+			if (_broken)
+				return 0;
 
-			/* return number of written bytes */
-			return trimmed_len;
+			try { return _capacity() - _ring().used(_capacity()); }
+			catch (Pipe_ring::Corrupt) { return 0; }
 		}
 
 		void register_write_ready_sigh(Signal_context_capability sigh)
@@ -212,6 +368,139 @@ class Noux::Pipe : public Reference_counter
 			Lock::Guard guard(_lock);
 			_read_ready_sigh = sigh;
 		}
+
+		/**
+		 * Wake up blocked processes after a process accessed the mapped buffer
+		 */
+		void wake_up()
+		{
+			Lock::Guard guard(_lock);
+			_wake_up_reader();
+			_wake_up_writer();
+		}
+
+		Dataspace_capability buffer_dataspace() const
+		{
+			Lock::Guard guard(_lock);
+			return _buffer->ds.cap();
+		}
+
+		/**
+		 * Account a process that maps the buffer
+		 */
+		void buffer_mapped(Dataspace_capability ds)
+		{
+			Lock::Guard guard(_lock);
+
+			if (Buffer *buffer = _buffer_by_ds(ds))
+				buffer->mappings++;
+		}
+
+		/**
+		 * Release accounting of a process that mapped the buffer
+		 *
+		 * A replaced buffer is freed as soon as no process maps it anymore.
+		 */
+		void buffer_unmapped(Dataspace_capability ds)
+		{
+			Lock::Guard guard(_lock);
+
+			Buffer *buffer = _buffer_by_ds(ds);
+			if (!buffer || !buffer->mappings)
+				return;
+
+			if (--buffer->mappings || buffer != _retired)
+				return;
+
+			destroy(_alloc, _retired);
+			_retired = nullptr;
+		}
+
+		/**
+		 * Handle fcntl commands common to both pipe ends
+		 */
+		bool fcntl(Sysio &sysio)
+		{
+			Lock::Guard guard(_lock);
+
+			switch (sysio.fcntl_in.cmd) {
+
+			case Sysio::FCNTL_CMD_GET_PIPE_SIZE:
+				sysio.fcntl_out.result = _capacity();
+				return true;
+
+			case Sysio::FCNTL_CMD_SET_PIPE_SIZE:
+				try {
+					_resize(sysio.fcntl_in.long_arg);
+					sysio.fcntl_out.result = _capacity();
+					return true;
+				}
+				catch (Invalid_size) { sysio.error.fcntl = Sysio::FCNTL_ERR_NO_PERM; }
+				catch (Busy)         { sysio.error.fcntl = Sysio::FCNTL_ERR_BUSY; }
+				catch (Out_of_ram)   { sysio.error.fcntl = Sysio::FCNTL_ERR_NO_MEM; }
+				catch (Out_of_caps)  { sysio.error.fcntl = Sysio::FCNTL_ERR_NO_MEM; }
+				return false;
+
+			default:
+				sysio.error.fcntl = Sysio::FCNTL_ERR_CMD_INVALID;
+				return false;
+			}
+		}
+};
+
+
+/**
+ * Registry entry of a pipe buffer mapped by a process
+ *
+ * The entry keeps the pipe alive while its buffer is mapped, accounts the
+ * mapping at the pipe, and lets a forked process inherit the mapping.
+ */
+class Noux::Pipe_buffer_info : public Dataspace_info
+{
+	private:
+
+		Shared_pointer<Pipe> _pipe;
+
+	public:
+
+		Pipe_buffer_info(Shared_pointer<Pipe> pipe, Dataspace_capability ds)
+		: Dataspace_info(ds), _pipe(pipe) { _pipe->buffer_mapped(ds); }
+
+		~Pipe_buffer_info() { _pipe->buffer_unmapped(ds_cap()); }
+
+		/**
+		 * Register current buffer of pipe unless already known
+		 */
+		static Dataspace_capability insert(Dataspace_registry   &ds_registry,
+		                                   Allocator            &alloc,
+		                                   Shared_pointer<Pipe>  pipe,
+		                                   Dataspace_capability  ds)
+		{
+			bool known = false;
+			ds_registry.apply(ds, [&] (Dataspace_info *info) {
+				known = (info != nullptr); });
+
+			if (!known)
+				ds_registry.insert(new (alloc) Pipe_buffer_info(pipe, ds));
+
+			return ds;
+		}
+
+		Dataspace_capability fork(Ram_allocator      &,
+		                          Region_map         &,
+		                          Allocator          &alloc,
+		                          Dataspace_registry &ds_registry,
+		                          Rpc_entrypoint     &) override
+		{
+			return insert(ds_registry, alloc, _pipe, ds_cap());
+		}
+
+		void poke(Region_map &, addr_t, char const *, size_t) override
+		{
+			error("attempt to poke onto a pipe buffer");
+		}
+
+		bool release_when_unused() const override { return true; }
 };
 
 
@@ -254,12 +543,19 @@ class Noux::Pipe_sink_io_channel : public Io_channel
 			 */
 
 			/* dimension the pipe write operation to the not yet written data */
-			size_t curr_count = _pipe->write(sysio.write_in.chunk + offset,
-			                                 sysio.write_in.count - offset);
-			offset += curr_count;
-			return true;
+			try {
+				offset += _pipe->write(sysio.write_in.chunk + offset,
+				                       sysio.write_in.count - offset);
+				return true;
+			}
+			catch (Pipe::Broken) {
+				sysio.error.write = Vfs::File_io_service::WRITE_ERR_IO;
+				return false;
+			}
 		}
 
+		size_t write_space() const override { return _pipe->write_space(); }
+
 		bool fcntl(Sysio &sysio) override
 		{
 			switch (sysio.fcntl_in.cmd) {
@@ -268,11 +564,22 @@ class Noux::Pipe_sink_io_channel : public Io_channel
 					sysio.fcntl_out.result = Sysio::OPEN_MODE_WRONLY;
 					return true;
 
+				case Sysio::FCNTL_CMD_WAKE_UP_PIPE_PEER:
+					_pipe->wake_up();
+					return true;
+
 				default:
-					return false;
+					return _pipe->fcntl(sysio);
 			}
 		}
 
+		Dataspace_capability pipe_buffer(Dataspace_registry &ds_registry,
+		                                  Allocator          &alloc) override
+		{
+			return Pipe_buffer_info::insert(ds_registry, alloc, _pipe,
+			                                _pipe->buffer_dataspace());
+		}
+
 		bool fstat(Sysio &sysio) override
 		{
 			sysio.fstat_out.st.mode = Sysio::STAT_MODE_CHARDEV;
@@ -305,11 +612,8 @@ class Noux::Pipe_source_io_channel : public Io_channel
 
 		bool check_unblock(bool rd, bool wr, bool ex) const override
 		{
-			/* unblock if the writer has already closed its pipe end */
-			if (_pipe->writer_is_gone())
-				return true;
-
-			return (rd && _pipe->data_avail_for_reading());
+			/* also unblocks if the writer has already closed its pipe end */
+			return rd && _pipe->data_avail_for_reading();
 		}
 
 		bool read(Sysio &sysio) override
@@ -332,11 +636,22 @@ class Noux::Pipe_source_io_channel : public Io_channel
 					sysio.fcntl_out.result = Sysio::OPEN_MODE_RDONLY;
 					return true;
 
+				case Sysio::FCNTL_CMD_WAKE_UP_PIPE_PEER:
+					_pipe->wake_up();
+					return true;
+
 				default:
-					return false;
+					return _pipe->fcntl(sysio);
 			}
 		}
 
+		Dataspace_capability pipe_buffer(Dataspace_registry &ds_registry,
+		                                  Allocator          &alloc) override
+		{
+			return Pipe_buffer_info::insert(ds_registry, alloc, _pipe,
+			                                _pipe->buffer_dataspace());
+		}
+
 		bool fstat(Sysio &sysio) override
 		{
 			sysio.fstat_out.st.mode = Sysio::STAT_MODE_CHARDEV;
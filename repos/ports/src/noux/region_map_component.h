@@ -77,6 +77,7 @@ class Noux::Region_map_component : public Rpc_object<Region_map>,
 			}
 
 			inline void dissolve(Dataspace_info &ds);
+			inline bool reattach(Dataspace_capability ds);
 		};
 
 		Lock         _region_lock;
@@ -101,6 +102,26 @@ class Noux::Region_map_component : public Rpc_object<Region_map>,
 
 		Dataspace_registry &_ds_registry;
 
+		/**
+		 * Replace dataspace of a region at core, keeping its record
+		 */
+		void _reattach(Region &region, Dataspace_capability ds)
+		{
+			enum { USE_LOCAL_ADDR = true };
+
+			_rm.detach(region.local_addr);
+
+			for (;;) {
+				try {
+					_rm.attach(ds, region.size, region.offset, USE_LOCAL_ADDR,
+					           region.local_addr, region.executable);
+					return;
+				}
+				catch (Out_of_ram)  { _pd.upgrade_ram(8*1024); }
+				catch (Out_of_caps) { _pd.upgrade_caps(2); }
+			}
+		}
+
 	public:
 
 		/**
@@ -242,9 +263,14 @@ class Noux::Region_map_component : public Rpc_object<Region_map>,
 			 */
 			if (size == 0) size = Dataspace_client(ds).size() - offset;
 
+			/* a dataspace frozen by a fork is replaced by its lazy copy */
+			Dataspace_capability attach_ds = ds;
+			_ds_registry.apply(ds, [&] (Dataspace_info *info) {
+				if (info) attach_ds = info->attach_cap(); });
+
 			for (;;) {
 				try {
-					local_addr = _rm.attach(ds, size, offset, use_local_addr,
+					local_addr = _rm.attach(attach_ds, size, offset, use_local_addr,
 					                        local_addr, executable);
 					break;
 				}
@@ -296,8 +322,21 @@ class Noux::Region_map_component : public Rpc_object<Region_map>,
 				_regions.remove(region);
 			}
 
+			Dataspace_info *unused_info = nullptr;
 			_ds_registry.apply(region->ds, [&] (Dataspace_info *info) {
-				if (info) info->unregister_user(*region); });
+				if (!info)
+					return;
+
+				info->unregister_user(*region);
+
+				if (info->release_when_unused() && !info->has_users()) {
+					_ds_registry.remove(info);
+					unused_info = info;
+				}
+			});
+
+			if (unused_info)
+				destroy(_alloc, unused_info);
 
 			destroy(_alloc, region);
 
@@ -418,4 +457,11 @@ inline void Noux::Region_map_component::Region::dissolve(Dataspace_info &ds)
 }
 
 
+inline bool Noux::Region_map_component::Region::reattach(Dataspace_capability ds)
+{
+	rm._reattach(*this, ds);
+	return executable;
+}
+
+
 #endif /* _NOUX__REGION_MAP_COMPONENT_H_ */
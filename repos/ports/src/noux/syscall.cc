@@ -93,6 +93,104 @@ bool Noux::Child::syscall(Noux::Session::Syscall sc)
 				break;
 			}
 
+		case SYSCALL_SPLICE:
+			{
+				Shared_pointer<Io_channel> in  = _lookup_channel(_sysio.splice_in.fd_in);
+				Shared_pointer<Io_channel> out = _lookup_channel(_sysio.splice_in.fd_out);
+
+				/*
+				 * The data is moved chunk-wise through a scratch sysio
+				 * buffer, which keeps the transfer inside noux.
+				 */
+				Sysio &scratch = *new (_heap) Sysio;
+
+				size_t const count = _sysio.splice_in.count;
+				size_t       total = 0;
+
+				Sysio::Splice_error error = Sysio::SPLICE_ERR_IO;
+				bool                eof   = false;
+				bool                stop  = false;
+
+				while (total < count && !eof && !stop) {
+
+					/* block for input only as long as nothing was moved */
+					if (total == 0 && !in->nonblocking())
+						_block_for_io_channel(in, true, false, false);
+
+					if (!in->check_unblock(true, false, false)) {
+						error = in->nonblocking() ? Sysio::SPLICE_ERR_AGAIN
+						                          : Sysio::SPLICE_ERR_INTERRUPT;
+						break;
+					}
+
+					/*
+					 * Take no more from the input than the output accepts
+					 * without blocking. Otherwise, a short write would lose
+					 * the data already taken from the input.
+					 */
+					if (total == 0 && !out->nonblocking())
+						_block_for_io_channel(out, false, true, false);
+
+					size_t const space = out->check_unblock(false, true, false)
+					                   ? out->write_space() : 0;
+					if (space == 0) {
+						error = out->nonblocking() ? Sysio::SPLICE_ERR_AGAIN
+						                           : Sysio::SPLICE_ERR_INTERRUPT;
+						break;
+					}
+
+					scratch.read_in.fd    = _sysio.splice_in.fd_in;
+					scratch.read_in.count = min(min(count - total, space),
+					                            sizeof(scratch.read_out.chunk));
+
+					if (!in->read(scratch))
+						break;
+
+					size_t const n = scratch.read_out.count;
+
+					/* end of file */
+					if (n == 0) {
+						eof = true;
+						break;
+					}
+
+					/* 'read_out' and 'write_in' share the same memory */
+					memmove(scratch.write_in.chunk, scratch.read_out.chunk, n);
+					scratch.write_in.fd    = _sysio.splice_in.fd_out;
+					scratch.write_in.count = n;
+
+					size_t offset = 0;
+					while (offset != n) {
+
+						if (!out->nonblocking())
+							_block_for_io_channel(out, false, true, false);
+
+						if (!out->check_unblock(false, true, false)
+						 || !out->write(scratch, offset)) {
+							stop = true;
+							break;
+						}
+					}
+
+					total += offset;
+
+					/* the output was filled by another writer meanwhile */
+					if (offset != n)
+						warning("splice: dropped ", n - offset, " bytes");
+				}
+
+				Genode::destroy(_heap, &scratch);
+
+				_sysio.splice_out.count = total;
+
+				/* report an error only if nothing was moved */
+				result = (total > 0) || eof;
+				if (!result)
+					_sysio.error.splice = error;
+
+				break;
+			}
+
 		case SYSCALL_FTRUNCATE:
 			{
 				Shared_pointer<Io_channel> io = _lookup_channel(_sysio.ftruncate_in.fd);
@@ -611,7 +709,7 @@ bool Noux::Child::syscall(Noux::Session::Syscall sc)
 
 		case SYSCALL_PIPE:
 			{
-				Shared_pointer<Pipe>       pipe       (new (_heap) Pipe,                                    _heap);
+				Shared_pointer<Pipe>       pipe       (new (_heap) Pipe(_env, _heap),                      _heap);
 				Shared_pointer<Io_channel> pipe_sink  (new (_heap) Pipe_sink_io_channel  (pipe, _env.ep()), _heap);
 				Shared_pointer<Io_channel> pipe_source(new (_heap) Pipe_source_io_channel(pipe, _env.ep()), _heap);
 
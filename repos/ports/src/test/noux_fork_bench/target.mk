@@ -0,0 +1,3 @@
+TARGET = test-noux_fork_bench
+SRC_CC = test.cc
+LIBS   = posix libc_noux
@@ -0,0 +1,90 @@
+/*
+ * \brief  Benchmark of fork followed by execve
+ * \author Norman Feske
+ * \date   2017-12-04
+ *
+ * The program populates a large heap and measures how long it takes to fork
+ * a child that immediately replaces itself with a new program, as done by a
+ * shell.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+enum {
+	HEAP_SIZE  = 64*1024*1024,
+	ITERATIONS = 20,
+};
+
+extern char **environ;
+
+
+static unsigned long long now_us()
+{
+	struct timeval tv;
+	gettimeofday(&tv, nullptr);
+	return tv.tv_sec*1000000ULL + tv.tv_usec;
+}
+
+
+int main(int argc, char **argv)
+{
+	/* program executed by the forked child */
+	if (argc > 1 && strcmp(argv[1], "exit") == 0)
+		return 0;
+
+	printf("--- test-noux_fork_bench started ---\n");
+
+	char *heap = (char *)malloc(HEAP_SIZE);
+	if (!heap) {
+		printf("Error: could not allocate heap of %d bytes\n", HEAP_SIZE);
+		return -1;
+	}
+	memset(heap, 0x5a, HEAP_SIZE);
+
+	unsigned long long fork_us = 0, total_us = 0;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+
+		unsigned long long const start = now_us();
+
+		pid_t pid = fork();
+		if (pid < 0) {
+			printf("Error: fork returned %d, errno=%d\n", pid, errno);
+			return -1;
+		}
+
+		if (pid == 0) {
+			char *args[] = { argv[0], (char *)"exit", nullptr };
+			execve("/test-noux_fork_bench", args, environ);
+			printf("Error: execve failed, errno=%d\n", errno);
+			_exit(-1);
+		}
+
+		unsigned long long const forked = now_us();
+
+		waitpid(pid, nullptr, 0);
+
+		unsigned long long const done = now_us();
+
+		fork_us  += forked - start;
+		total_us += done   - start;
+
+		/* dirty part of the heap as a shell would between commands */
+		memset(heap + (i % 64)*(HEAP_SIZE/64), i, HEAP_SIZE/64);
+	}
+
+	printf("heap size:             %d KiB\n", HEAP_SIZE/1024);
+	printf("fork:                  %llu us\n", fork_us/ITERATIONS);
+	printf("fork + execve + exit:  %llu us\n", total_us/ITERATIONS);
+
+	free(heap);
+
+	printf("--- test-noux_fork_bench finished ---\n");
+	return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * \brief  Benchmark of pipe throughput in noux
+ * \author Norman Feske
+ * \date   2017-12-06
+ *
+ * The program streams data through a pipe to a forked reader, first with the
+ * default pipe size and then with an enlarged pipe. Finally, it moves the
+ * content of a file into the pipe via 'splice'.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#ifndef F_SETPIPE_SZ
+#define F_SETPIPE_SZ 1031
+#endif
+#ifndef F_GETPIPE_SZ
+#define F_GETPIPE_SZ 1032
+#endif
+
+extern "C" ssize_t splice(int, off_t *, int, off_t *, size_t, unsigned);
+
+enum {
+	TRANSFER_SIZE = 64*1024*1024,
+	CHUNK_SIZE    = 256*1024,
+	LARGE_PIPE    = 1024*1024,
+};
+
+static char buf[CHUNK_SIZE];
+
+
+static unsigned long long now_us()
+{
+	struct timeval tv;
+	gettimeofday(&tv, nullptr);
+	return tv.tv_sec*1000000ULL + tv.tv_usec;
+}
+
+
+/**
+ * Fork reader that consumes the pipe until end of file
+ */
+static pid_t spawn_reader(int fds[2])
+{
+	pid_t pid = fork();
+	if (pid != 0)
+		return pid;
+
+	close(fds[1]);
+
+	unsigned long long total = 0;
+	for (ssize_t n; (n = read(fds[0], buf, sizeof(buf))) > 0; total += n);
+
+	close(fds[0]);
+	_exit(total ? 0 : -1);
+}
+
+
+static void print_throughput(char const *what, unsigned long long bytes,
+                             unsigned long long us)
+{
+	printf("%-22s %llu KiB in %llu us (%llu MiB/s)\n", what, bytes/1024, us,
+	       us ? (bytes*1000000ULL/us)/(1024*1024) : 0);
+}
+
+
+static int bench_write(char const *what, long pipe_size)
+{
+	int fds[2];
+	if (pipe(fds) != 0) {
+		printf("Error: pipe failed, errno=%d\n", errno);
+		return -1;
+	}
+
+	if (pipe_size && fcntl(fds[1], F_SETPIPE_SZ, pipe_size) < 0) {
+		printf("Error: F_SETPIPE_SZ failed, errno=%d\n", errno);
+		return -1;
+	}
+
+	printf("pipe size:             %d bytes\n", fcntl(fds[1], F_GETPIPE_SZ));
+
+	pid_t const pid = spawn_reader(fds);
+	close(fds[0]);
+
+	memset(buf, 0x5a, sizeof(buf));
+
+	unsigned long long const start = now_us();
+
+	for (unsigned long long total = 0; total < TRANSFER_SIZE; ) {
+		ssize_t const n = write(fds[1], buf, sizeof(buf));
+		if (n <= 0) {
+			printf("Error: write returned %zd, errno=%d\n", n, errno);
+			return -1;
+		}
+		total += n;
+	}
+
+	close(fds[1]);
+
+	int status = 0;
+	waitpid(pid, &status, 0);
+
+	print_throughput(what, TRANSFER_SIZE, now_us() - start);
+	return 0;
+}
+
+
+static int bench_splice(char const *path)
+{
+	int file = open(path, O_RDONLY);
+	if (file < 0) {
+		printf("Error: could not open %s\n", path);
+		return -1;
+	}
+
+	int fds[2];
+	if (pipe(fds) != 0 || fcntl(fds[1], F_SETPIPE_SZ, LARGE_PIPE) < 0) {
+		printf("Error: could not create pipe, errno=%d\n", errno);
+		return -1;
+	}
+
+	pid_t const pid = spawn_reader(fds);
+	close(fds[0]);
+
+	unsigned long long const start = now_us();
+	unsigned long long       total = 0;
+
+	for (ssize_t n; (n = splice(file, nullptr, fds[1], nullptr, LARGE_PIPE, 0)) != 0; ) {
+		if (n < 0) {
+			printf("Error: splice failed, errno=%d\n", errno);
+			return -1;
+		}
+		total += n;
+	}
+
+	close(fds[1]);
+	close(file);
+
+	int status = 0;
+	waitpid(pid, &status, 0);
+
+	print_throughput("splice file to pipe:", total, now_us() - start);
+	return 0;
+}
+
+
+int main(int, char **)
+{
+	printf("--- test-noux_pipe_bench started ---\n");
+
+	if (bench_write("write default pipe:", 0)
+	 || bench_write("write large pipe:", LARGE_PIPE)
+	 || bench_splice("/test-noux_pipe_bench"))
+		return -1;
+
+	printf("--- test-noux_pipe_bench finished ---\n");
+	return 0;
+}